@@ -66,17 +66,35 @@ void XXXNeverCalled_javaxpcom()
   XPCOM_NATIVE(getServiceManager) (nsnull, nsnull);
 
   JAVAPROXY_NATIVE(callXPCOMMethod) (nsnull, nsnull, nsnull, nsnull, nsnull);
+  JAVABINDING_NATIVE(callXPCOMMethod) (nsnull, nsnull, 0, nsnull, nsnull);
+  JAVABINDING_NATIVE(callXPCOMMethodRaw) (nsnull, nsnull, 0, nsnull, nsnull);
 
-  JAVAPROXY_NATIVE(finalizeProxy) (nsnull, nsnull, nsnull);
+  JAVAPROXY_NATIVE(releaseInstances) (nsnull, nsnull, nsnull);
 
   JAVAPROXY_NATIVE(isSameXPCOMObject) (nsnull, nsnull, nsnull, nsnull);
 
   LOCKPROXY_NATIVE(release) (nsnull, nsnull, nsnull);
 
+  DIRECTBUFFER_NATIVE(freeBuffer) (nsnull, nsnull, 0);
+
+  INTERFACELIST_NATIVE(wrapElement) (nsnull, nsnull, 0, 0);
+  INTERFACELIST_NATIVE(releaseArray) (nsnull, nsnull, 0);
+
+  ASYNCQUEUE_NATIVE(scheduleDrain) (nsnull, nsnull);
+
+  JAVABATCH_NATIVE(invoke) (nsnull, nsnull, nsnull, 0, nsnull, nsnull, nsnull);
+  JAVABATCH_NATIVE(resolveMethod) (nsnull, nsnull, 0, nsnull);
+
   MOZILLA_NATIVE(getNativeHandleFromAWT) (nsnull, nsnull, nsnull);
 
   JXUTILS_NATIVE(wrapJavaObject) (nsnull, nsnull, nsnull, nsnull);
 
   JXUTILS_NATIVE(wrapXPCOMObject) (nsnull, nsnull, nsnull, nsnull);
+
+  JXUTILS_NATIVE(setCallStatsEnabled) (nsnull, nsnull, nsnull);
+
+  JXUTILS_NATIVE(getCallStats) (nsnull, nsnull);
+
+  JXUTILS_NATIVE(resetCallStats) (nsnull, nsnull);
 }
 
@@ -119,7 +119,7 @@ public:
     mArraySize = env->GetArrayLength(aJavaFileArray);
   }
 
-  ~DirectoryEnumerator()
+  virtual ~DirectoryEnumerator()
   {
     GetJNIEnv()->DeleteGlobalRef(mJavaFileArray);
   }
@@ -203,14 +203,8 @@ nsAppFileLocProviderProxy::GetFiles(const char* aProp,
       // nsresult from the exception instance.  Else, default to
       // NS_ERROR_FAILURE.
       if (env->IsInstanceOf(exp, xpcomExceptionClass)) {
-        jfieldID fid;
-        fid = env->GetFieldID(xpcomExceptionClass, "errorcode", "J");
-        if (fid) {
-          rv = static_cast<nsresult>(env->GetLongField(exp, fid));
-        } else {
-          rv = NS_ERROR_FAILURE;
-        }
-        NS_ASSERTION(fid, "Couldn't get 'errorcode' field of XPCOMException");
+        rv = static_cast<nsresult>(env->GetLongField(exp,
+                                                  xpcomExceptionErrorcodeFID));
       } else {
         rv = NS_ERROR_FAILURE;
       }
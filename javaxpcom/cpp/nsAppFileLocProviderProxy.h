@@ -46,7 +46,7 @@ class nsAppFileLocProviderProxy : public nsIDirectoryServiceProvider2
 {
 public:
   nsAppFileLocProviderProxy(jobject aJavaLocProvider);
-  ~nsAppFileLocProviderProxy();
+  virtual ~nsAppFileLocProviderProxy();
 
   NS_DECL_ISUPPORTS
   NS_DECL_NSIDIRECTORYSERVICEPROVIDER
@@ -0,0 +1,203 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include "mozilla/Atomics.h"
+#include "nsJavaCallArena.h"
+#include "nsDebug.h"
+#include "prinit.h"
+#include "prthread.h"
+
+
+// Usual size of a chunk, including its header.  Most calls need only a small
+// fraction of this.
+static const size_t kChunkSize = 16 * 1024;
+
+static const size_t kAlignment = 8;
+
+struct nsJavaCallArena::Chunk
+{
+  Chunk*  next;
+  size_t  size;     // usable bytes, following the header
+
+  char* Data()
+  {
+    return reinterpret_cast<char*>(this) + sizeof(Chunk);
+  }
+
+  PRBool IsLarge() const
+  {
+    return size > kChunkSize - sizeof(Chunk);
+  }
+};
+
+// Thread-private index holding each thread's arena
+static PRUintn sArenaIndex;
+static PRCallOnceType sArenaIndexOnce;
+
+static mozilla::Atomic<PRUint32> sHighWater;
+static mozilla::Atomic<PRUint32> sChunkAllocations;
+static mozilla::Atomic<PRUint32> sLargeAllocations;
+
+static void PR_CALLBACK
+DestroyArena(void* aData)
+{
+  delete static_cast<nsJavaCallArena*>(aData);
+}
+
+static PRStatus PR_CALLBACK
+CreateArenaIndex()
+{
+  return PR_NewThreadPrivateIndex(&sArenaIndex, DestroyArena);
+}
+
+nsJavaCallArena::nsJavaCallArena()
+  : mFirst(nullptr)
+  , mCurrent(nullptr)
+  , mOffset(0)
+  , mUsedBefore(0)
+  , mHighWater(0)
+{
+}
+
+nsJavaCallArena::~nsJavaCallArena()
+{
+  NS_ASSERTION(!mCurrent, "arena destroyed during a call");
+  while (mFirst) {
+    Chunk* next = mFirst->next;
+    moz_free(mFirst);
+    mFirst = next;
+  }
+}
+
+nsJavaCallArena*
+nsJavaCallArena::Get()
+{
+  if (PR_CallOnce(&sArenaIndexOnce, CreateArenaIndex) != PR_SUCCESS) {
+    NS_RUNTIMEABORT("Failed to create call arena thread-private index");
+  }
+
+  nsJavaCallArena* arena =
+    static_cast<nsJavaCallArena*>(PR_GetThreadPrivate(sArenaIndex));
+  if (!arena) {
+    arena = new nsJavaCallArena();
+    if (PR_SetThreadPrivate(sArenaIndex, arena) != PR_SUCCESS) {
+      NS_RUNTIMEABORT("Failed to store call arena");
+    }
+  }
+  return arena;
+}
+
+void*
+nsJavaCallArena::Allocate(size_t aSize)
+{
+  aSize = (aSize + kAlignment - 1) & ~(kAlignment - 1);
+
+  if (!mCurrent || mOffset + aSize > mCurrent->size) {
+    // Move on to the next chunk, or insert a new one if that is missing or
+    // too small.
+    Chunk* next = mCurrent ? mCurrent->next : mFirst;
+    if (!next || next->size < aSize) {
+      size_t size = PR_MAX(kChunkSize - sizeof(Chunk), aSize);
+      Chunk* chunk = static_cast<Chunk*>(moz_xmalloc(sizeof(Chunk) + size));
+      chunk->size = size;
+      chunk->next = next;
+      if (mCurrent) {
+        mCurrent->next = chunk;
+      } else {
+        mFirst = chunk;
+      }
+      next = chunk;
+
+      sChunkAllocations++;
+      if (chunk->IsLarge()) {
+        sLargeAllocations++;
+      }
+    }
+
+    if (mCurrent) {
+      mUsedBefore += mOffset;
+    }
+    mCurrent = next;
+    mOffset = 0;
+  }
+
+  void* result = mCurrent->Data() + mOffset;
+  mOffset += aSize;
+
+  // Only touch the shared counter when this thread sets a new record, which
+  // stops happening once its calls reach a steady state.
+  size_t used = mUsedBefore + mOffset;
+  if (used > mHighWater) {
+    mHighWater = used;
+    PRUint32 highWater = sHighWater;
+    while (used > highWater &&
+           !sHighWater.compareExchange(highWater, (PRUint32) used)) {
+      highWater = sHighWater;
+    }
+  }
+
+  return result;
+}
+
+void
+nsJavaCallArena::Rewind(Chunk* aChunk, size_t aOffset, size_t aUsedBefore)
+{
+  // Everything after aChunk is now unused.  Keep the usual-sized chunks for
+  // the next call, but give large ones back.
+  Chunk** link = aChunk ? &aChunk->next : &mFirst;
+  while (*link) {
+    Chunk* chunk = *link;
+    if (chunk->IsLarge()) {
+      *link = chunk->next;
+      moz_free(chunk);
+    } else {
+      link = &chunk->next;
+    }
+  }
+
+  mCurrent = aChunk;
+  mOffset = aOffset;
+  mUsedBefore = aUsedBefore;
+}
+
+void
+nsJavaCallArena::GetStats(nsJavaCallArenaStats* aStats)
+{
+  aStats->highWater = sHighWater;
+  aStats->chunkAllocations = sChunkAllocations;
+  aStats->largeAllocations = sLargeAllocations;
+}
@@ -0,0 +1,130 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef _nsJavaCallArena_h_
+#define _nsJavaCallArena_h_
+
+#include "nscore.h"
+#include <stddef.h>
+
+
+/**
+ * Counters reported by nsJavaCallArena::GetStats().
+ */
+struct nsJavaCallArenaStats
+{
+  PRUint32 highWater;         // most bytes in use at once by any thread
+  PRUint32 chunkAllocations;  // chunks allocated, across all threads
+  PRUint32 largeAllocations;  // of those, chunks too large to be kept
+};
+
+/**
+ * Per-thread scratch memory for temporaries that only live for the duration
+ * of a single call across the bridge: the nsXPTCVariant and jvalue arrays,
+ * 'in' strings and IIDs, and 'in' arrays.
+ *
+ * Memory is handed out by bumping a pointer through a list of chunks, and is
+ * given back all at once when the enclosing nsJavaCallArena::Mark goes out of
+ * scope.  Chunks are kept for the next call, so once a thread has made a
+ * call of a given shape, later calls allocate nothing from the heap.  Calls
+ * may nest (Java -> XPCOM -> Java ...), since each Mark only rewinds to where
+ * it started.  Chunks larger than the usual size, made for unusually large
+ * params, are freed on rewind rather than kept.
+ */
+class nsJavaCallArena
+{
+  struct Chunk;
+
+public:
+  /**
+   * Returns the arena for the calling thread, creating it on first use.
+   */
+  static nsJavaCallArena* Get();
+
+  /**
+   * Returns memory aligned to 8 bytes, which suits any param type.  The
+   * memory stays valid until the innermost enclosing Mark is destroyed.
+   * Like moz_xmalloc(), this never returns null.
+   */
+  void* Allocate(size_t aSize);
+
+  /**
+   * @param aStats  receives the current counters
+   */
+  static void GetStats(nsJavaCallArenaStats* aStats);
+
+  /**
+   * Records the current position of an arena, and rewinds the arena to it
+   * when destroyed.
+   */
+  class Mark
+  {
+  public:
+    Mark(nsJavaCallArena* aArena)
+      : mArena(aArena)
+      , mChunk(aArena->mCurrent)
+      , mOffset(aArena->mOffset)
+      , mUsedBefore(aArena->mUsedBefore)
+    { }
+
+    ~Mark()
+    {
+      mArena->Rewind(mChunk, mOffset, mUsedBefore);
+    }
+
+  private:
+    nsJavaCallArena*  mArena;
+    Chunk*            mChunk;
+    size_t            mOffset;
+    size_t            mUsedBefore;
+  };
+
+  ~nsJavaCallArena();
+
+private:
+  nsJavaCallArena();
+
+  void Rewind(Chunk* aChunk, size_t aOffset, size_t aUsedBefore);
+
+  Chunk*  mFirst;       // all chunks, in the order they are used
+  Chunk*  mCurrent;     // chunk being allocated from; null if none yet
+  size_t  mOffset;      // bytes used in mCurrent
+  size_t  mUsedBefore;  // bytes used in the chunks before mCurrent
+  size_t  mHighWater;   // highest mUsedBefore + mOffset so far
+};
+
+#endif // _nsJavaCallArena_h_
@@ -0,0 +1,563 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include "nsJavaCallStats.h"
+#include "nsAutoLock.h"
+#include "nsIInterfaceInfo.h"
+#include "nsStringAPI.h"
+#include "pldhash.h"
+#include "prinit.h"
+#include "prprf.h"
+#include "prthread.h"
+#include <string.h>
+
+
+mozilla::Atomic<bool, mozilla::Relaxed> nsJavaCallStats::sEnabled(false);
+
+// A counter is only ever written by the thread that owns it, but is read by
+// other threads while a report is made.  Since there is a single writer, a
+// relaxed load and store keeps the count exact without the cost of an atomic
+// add.
+typedef mozilla::Atomic<PRUint64, mozilla::Relaxed> Counter;
+
+static void
+Bump(Counter& aCounter, PRUint64 aAmount)
+{
+  aCounter = aCounter + aAmount;
+}
+
+enum {
+  kCalls,
+  kMarshalTime,   // nsecs
+  kInvokeTime,    // nsecs
+  kBytes,
+  kCounterCount
+};
+
+static const char* const kDirectionNames[] = {
+  "java-to-xpcom",
+  "xpcom-to-java"
+};
+
+static PRUint64
+ToNanoseconds(const mozilla::TimeDuration& aDuration)
+{
+  return PRUint64(aDuration.ToMicroseconds() * 1000);
+}
+
+struct nsJavaCallStats::Counters
+{
+  Counters()
+  {
+    memset(base, 0, sizeof(base));
+  }
+
+  /**
+   * Returns the count since the last reset.
+   */
+  PRUint64 Get(int aIndex) const
+  {
+    return value[aIndex] - base[aIndex];
+  }
+
+  Counter   value[kCounterCount];
+  PRUint64  base[kCounterCount];    // value at the last reset; guarded by sLock
+};
+
+/**
+ * The counters of one thread, for each method it has called, indexed by
+ * interface info and method index.
+ *
+ * Only the owning thread looks up counters in its table.  New counters are
+ * added under sLock, which is also held while other threads read the table,
+ * so the owning thread needs no lock for the common case of a method it has
+ * called before.
+ */
+class nsJavaCallStats::ThreadStats
+{
+public:
+  ThreadStats();
+  ~ThreadStats();
+
+  /**
+   * Returns the table of the calling thread, or null if it has none and
+   * aCreate is false, or if it could not be created.
+   */
+  static ThreadStats* Get(PRBool aCreate);
+
+  /**
+   * Sets up the globals below.  Returns PR_FALSE on failure.
+   */
+  static PRBool InitGlobals();
+
+  /**
+   * Returns the counters for the given method, or null if it has none yet.
+   */
+  Counters* Find(Direction aDirection, nsIInterfaceInfo* aIInfo,
+                 PRUint16 aMethodIndex);
+
+  /**
+   * Like Find(), but creates the counters if needed.  sLock must be held.
+   */
+  Counters* Add(Direction aDirection, nsIInterfaceInfo* aIInfo,
+                PRUint16 aMethodIndex);
+
+  /**
+   * Adds the counts of aOther since its last reset to this table, which must
+   * not belong to a running thread.  sLock must be held.
+   */
+  void MergeFrom(ThreadStats* aOther);
+
+  /**
+   * Makes the current counts the new zero.  sLock must be held.
+   */
+  void Reset();
+
+  /**
+   * Appends a line (or JSON object) to aResult for each method called.
+   */
+  void AppendReport(PRBool aJSON, nsACString& aResult);
+
+  static PRLock*        sLock;
+  static ThreadStats*   sFirst;     // tables of running threads
+  static ThreadStats*   sRetired;   // counts of threads that have exited
+
+  PLDHashTable*   mTable;           // null if out of memory
+  ThreadStats*    mNext;            // guarded by sLock
+  PRUint64        mPendingBytes;    // only used by the owning thread
+
+private:
+  struct Entry : public PLDHashEntryHdr
+  {
+    nsIInterfaceInfo*   key;        // strong reference
+    PRUint16            methodCount;
+    Counters*           counters[kDirectionCount];  // null until first call
+  };
+
+  struct ReportClosure
+  {
+    PRBool      json;
+    nsACString* result;
+  };
+
+  static PRStatus PR_CALLBACK CreateGlobals();
+  static void PR_CALLBACK DestroyForThread(void* aData);
+
+  static PLDHashOperator DestroyEntry(PLDHashTable* aTable,
+                                      PLDHashEntryHdr* aHeader,
+                                      PRUint32 aNumber, void* aData);
+  static PLDHashOperator MergeEntry(PLDHashTable* aTable,
+                                    PLDHashEntryHdr* aHeader,
+                                    PRUint32 aNumber, void* aData);
+  static PLDHashOperator ResetEntry(PLDHashTable* aTable,
+                                    PLDHashEntryHdr* aHeader,
+                                    PRUint32 aNumber, void* aData);
+  static PLDHashOperator ReportEntry(PLDHashTable* aTable,
+                                     PLDHashEntryHdr* aHeader,
+                                     PRUint32 aNumber, void* aData);
+};
+
+PRLock* nsJavaCallStats::ThreadStats::sLock = nullptr;
+nsJavaCallStats::ThreadStats* nsJavaCallStats::ThreadStats::sFirst = nullptr;
+nsJavaCallStats::ThreadStats* nsJavaCallStats::ThreadStats::sRetired = nullptr;
+
+// Thread-private index holding each thread's table
+static PRUintn sThreadIndex;
+static PRCallOnceType sGlobalsOnce;
+
+nsJavaCallStats::ThreadStats::ThreadStats()
+  : mNext(nullptr)
+  , mPendingBytes(0)
+{
+  mTable = PL_NewDHashTable(PL_DHashGetStubOps(), sizeof(Entry), 16);
+}
+
+nsJavaCallStats::ThreadStats::~ThreadStats()
+{
+  if (mTable) {
+    PL_DHashTableEnumerate(mTable, DestroyEntry, nullptr);
+    PL_DHashTableDestroy(mTable);
+  }
+}
+
+PRStatus PR_CALLBACK
+nsJavaCallStats::ThreadStats::CreateGlobals()
+{
+  sLock = nsAutoLock::NewLock("nsJavaCallStats::sLock");
+  if (!sLock)
+    return PR_FAILURE;
+
+  sRetired = new ThreadStats();
+  if (!sRetired->mTable)
+    return PR_FAILURE;
+
+  return PR_NewThreadPrivateIndex(&sThreadIndex, DestroyForThread);
+}
+
+PRBool
+nsJavaCallStats::ThreadStats::InitGlobals()
+{
+  return PR_CallOnce(&sGlobalsOnce, CreateGlobals) == PR_SUCCESS;
+}
+
+void PR_CALLBACK
+nsJavaCallStats::ThreadStats::DestroyForThread(void* aData)
+{
+  ThreadStats* stats = static_cast<ThreadStats*>(aData);
+
+  // Keep the counts of the exiting thread
+  nsAutoLock lock(sLock);
+  ThreadStats** link = &sFirst;
+  while (*link != stats) {
+    link = &(*link)->mNext;
+  }
+  *link = stats->mNext;
+
+  sRetired->MergeFrom(stats);
+  delete stats;
+}
+
+nsJavaCallStats::ThreadStats*
+nsJavaCallStats::ThreadStats::Get(PRBool aCreate)
+{
+  if (!InitGlobals())
+    return nullptr;
+
+  ThreadStats* stats =
+    static_cast<ThreadStats*>(PR_GetThreadPrivate(sThreadIndex));
+  if (!stats && aCreate) {
+    stats = new ThreadStats();
+    if (!stats->mTable ||
+        PR_SetThreadPrivate(sThreadIndex, stats) != PR_SUCCESS) {
+      delete stats;
+      return nullptr;
+    }
+
+    nsAutoLock lock(sLock);
+    stats->mNext = sFirst;
+    sFirst = stats;
+  }
+  return stats;
+}
+
+nsJavaCallStats::Counters*
+nsJavaCallStats::ThreadStats::Find(Direction aDirection,
+                                   nsIInterfaceInfo* aIInfo,
+                                   PRUint16 aMethodIndex)
+{
+  Entry* e = static_cast<Entry*>(PL_DHashTableSearch(mTable, aIInfo));
+  if (!e || !e->counters[aDirection] || aMethodIndex >= e->methodCount)
+    return nullptr;
+
+  return &e->counters[aDirection][aMethodIndex];
+}
+
+nsJavaCallStats::Counters*
+nsJavaCallStats::ThreadStats::Add(Direction aDirection,
+                                  nsIInterfaceInfo* aIInfo,
+                                  PRUint16 aMethodIndex)
+{
+  Entry* e = static_cast<Entry*>(PL_DHashTableAdd(mTable, aIInfo));
+  if (!e)
+    return nullptr;
+
+  if (!e->key) {
+    PRUint16 methodCount;
+    nsresult rv = aIInfo->GetMethodCount(&methodCount);
+    if (NS_FAILED(rv)) {
+      PL_DHashTableRawRemove(mTable, e);
+      return nullptr;
+    }
+
+    e->methodCount = methodCount;
+    for (int i = 0; i < kDirectionCount; i++) {
+      e->counters[i] = nullptr;
+    }
+    e->key = aIInfo;
+    NS_ADDREF(aIInfo);
+  }
+
+  if (aMethodIndex >= e->methodCount)
+    return nullptr;
+
+  if (!e->counters[aDirection]) {
+    e->counters[aDirection] = new Counters[e->methodCount];
+  }
+  return &e->counters[aDirection][aMethodIndex];
+}
+
+PLDHashOperator
+nsJavaCallStats::ThreadStats::DestroyEntry(PLDHashTable* aTable,
+                                           PLDHashEntryHdr* aHeader,
+                                           PRUint32 aNumber, void* aData)
+{
+  Entry* entry = static_cast<Entry*>(aHeader);
+  for (int i = 0; i < kDirectionCount; i++) {
+    delete [] entry->counters[i];
+  }
+  NS_IF_RELEASE(entry->key);
+
+  return PL_DHASH_REMOVE;
+}
+
+PLDHashOperator
+nsJavaCallStats::ThreadStats::MergeEntry(PLDHashTable* aTable,
+                                         PLDHashEntryHdr* aHeader,
+                                         PRUint32 aNumber, void* aData)
+{
+  ThreadStats* target = static_cast<ThreadStats*>(aData);
+  Entry* entry = static_cast<Entry*>(aHeader);
+
+  for (int i = 0; i < kDirectionCount; i++) {
+    if (!entry->counters[i])
+      continue;
+
+    for (PRUint16 j = 0; j < entry->methodCount; j++) {
+      const Counters& source = entry->counters[i][j];
+      if (!source.Get(kCalls))
+        continue;
+
+      Counters* dest = target->Add(Direction(i), entry->key, j);
+      if (!dest)
+        return PL_DHASH_STOP;
+
+      for (int k = 0; k < kCounterCount; k++) {
+        Bump(dest->value[k], source.Get(k));
+      }
+    }
+  }
+
+  return PL_DHASH_NEXT;
+}
+
+void
+nsJavaCallStats::ThreadStats::MergeFrom(ThreadStats* aOther)
+{
+  PL_DHashTableEnumerate(aOther->mTable, MergeEntry, this);
+}
+
+PLDHashOperator
+nsJavaCallStats::ThreadStats::ResetEntry(PLDHashTable* aTable,
+                                         PLDHashEntryHdr* aHeader,
+                                         PRUint32 aNumber, void* aData)
+{
+  Entry* entry = static_cast<Entry*>(aHeader);
+
+  for (int i = 0; i < kDirectionCount; i++) {
+    if (!entry->counters[i])
+      continue;
+
+    for (PRUint16 j = 0; j < entry->methodCount; j++) {
+      Counters& counters = entry->counters[i][j];
+      for (int k = 0; k < kCounterCount; k++) {
+        counters.base[k] = counters.value[k];
+      }
+    }
+  }
+
+  return PL_DHASH_NEXT;
+}
+
+void
+nsJavaCallStats::ThreadStats::Reset()
+{
+  PL_DHashTableEnumerate(mTable, ResetEntry, nullptr);
+}
+
+PLDHashOperator
+nsJavaCallStats::ThreadStats::ReportEntry(PLDHashTable* aTable,
+                                          PLDHashEntryHdr* aHeader,
+                                          PRUint32 aNumber, void* aData)
+{
+  ReportClosure* closure = static_cast<ReportClosure*>(aData);
+  Entry* entry = static_cast<Entry*>(aHeader);
+
+  const char* ifaceName;
+  if (NS_FAILED(entry->key->GetNameShared(&ifaceName)))
+    return PL_DHASH_NEXT;
+
+  for (int i = 0; i < kDirectionCount; i++) {
+    if (!entry->counters[i])
+      continue;
+
+    for (PRUint16 j = 0; j < entry->methodCount; j++) {
+      const Counters& counters = entry->counters[i][j];
+      if (!counters.Get(kCalls))
+        continue;
+
+      const nsXPTMethodInfo* methodInfo;
+      if (NS_FAILED(entry->key->GetMethodInfo(j, &methodInfo)))
+        continue;
+
+      char* line;
+      if (closure->json) {
+        line = PR_smprintf("%s{\"interface\":\"%s\",\"method\":\"%s\","
+                           "\"direction\":\"%s\",\"calls\":%llu,"
+                           "\"marshalNs\":%llu,\"invokeNs\":%llu,"
+                           "\"bytes\":%llu}",
+                           closure->result->IsEmpty() ? "" : ",",
+                           ifaceName, methodInfo->GetName(),
+                           kDirectionNames[i], counters.Get(kCalls),
+                           counters.Get(kMarshalTime),
+                           counters.Get(kInvokeTime), counters.Get(kBytes));
+      } else {
+        line = PR_smprintf("%s::%s (%s): calls=%llu marshal=%lluns "
+                           "invoke=%lluns bytes=%llu\n",
+                           ifaceName, methodInfo->GetName(),
+                           kDirectionNames[i], counters.Get(kCalls),
+                           counters.Get(kMarshalTime),
+                           counters.Get(kInvokeTime), counters.Get(kBytes));
+      }
+      if (!line)
+        return PL_DHASH_STOP;
+
+      closure->result->Append(line);
+      PR_smprintf_free(line);
+    }
+  }
+
+  return PL_DHASH_NEXT;
+}
+
+void
+nsJavaCallStats::ThreadStats::AppendReport(PRBool aJSON, nsACString& aResult)
+{
+  ReportClosure closure = { aJSON, &aResult };
+  PL_DHashTableEnumerate(mTable, ReportEntry, &closure);
+}
+
+void
+nsJavaCallStats::SetEnabled(PRBool aEnabled)
+{
+  sEnabled = !!aEnabled;
+}
+
+void
+nsJavaCallStats::AddBytesInternal(PRUint64 aBytes)
+{
+  ThreadStats* stats = ThreadStats::Get(PR_FALSE);
+  if (stats) {
+    stats->mPendingBytes += aBytes;
+  }
+}
+
+void
+nsJavaCallStats::Reset()
+{
+  if (!ThreadStats::InitGlobals())
+    return;
+
+  nsAutoLock lock(ThreadStats::sLock);
+  for (ThreadStats* stats = ThreadStats::sFirst; stats; stats = stats->mNext) {
+    stats->Reset();
+  }
+  ThreadStats::sRetired->Reset();
+}
+
+nsresult
+nsJavaCallStats::GetReport(PRBool aJSON, nsACString& aResult)
+{
+  aResult.Truncate();
+  if (!ThreadStats::InitGlobals())
+    return NS_ERROR_FAILURE;
+
+  // Merge all tables into one, so that each method is reported once
+  ThreadStats merged;
+  if (!merged.mTable)
+    return NS_ERROR_OUT_OF_MEMORY;
+
+  {
+    nsAutoLock lock(ThreadStats::sLock);
+    for (ThreadStats* stats = ThreadStats::sFirst; stats;
+         stats = stats->mNext) {
+      merged.MergeFrom(stats);
+    }
+    merged.MergeFrom(ThreadStats::sRetired);
+  }
+
+  if (!aJSON) {
+    merged.AppendReport(PR_FALSE, aResult);
+    return NS_OK;
+  }
+
+  nsCString methods;
+  merged.AppendReport(PR_TRUE, methods);
+  aResult.AppendLiteral("{\"enabled\":");
+  aResult.AppendLiteral(sEnabled ? "true" : "false");
+  aResult.AppendLiteral(",\"methods\":[");
+  aResult.Append(methods);
+  aResult.AppendLiteral("]}");
+  return NS_OK;
+}
+
+void
+nsJavaCallStats::AutoCall::Start(Direction aDirection,
+                                 nsIInterfaceInfo* aIInfo,
+                                 PRUint16 aMethodIndex)
+{
+  ThreadStats* stats = ThreadStats::Get(PR_TRUE);
+  if (!stats)
+    return;
+
+  Counters* counters = stats->Find(aDirection, aIInfo, aMethodIndex);
+  if (!counters) {
+    nsAutoLock lock(ThreadStats::sLock);
+    counters = stats->Add(aDirection, aIInfo, aMethodIndex);
+    if (!counters)
+      return;
+  }
+
+  mCounters = counters;
+  mThread = stats;
+  mBytesBefore = stats->mPendingBytes;
+  mStart = mozilla::TimeStamp::Now();
+}
+
+void
+nsJavaCallStats::AutoCall::Finish()
+{
+  PRUint64 total = ToNanoseconds(mozilla::TimeStamp::Now() - mStart);
+  PRUint64 invoke = ToNanoseconds(mInvokeTime);
+
+  Bump(mCounters->value[kCalls], 1);
+  Bump(mCounters->value[kMarshalTime], total > invoke ? total - invoke : 0);
+  Bump(mCounters->value[kInvokeTime], invoke);
+  Bump(mCounters->value[kBytes], mThread->mPendingBytes - mBytesBefore);
+
+  // Bytes converted by this call are not counted again by an enclosing one
+  mThread->mPendingBytes = mBytesBefore;
+}
@@ -0,0 +1,168 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef _nsJavaCallStats_h_
+#define _nsJavaCallStats_h_
+
+#include "nscore.h"
+#include "mozilla/Atomics.h"
+#include "mozilla/TimeStamp.h"
+
+class nsACString;
+class nsIInterfaceInfo;
+
+
+/**
+ * Optional per-method statistics for calls across the bridge, in both
+ * directions: the number of calls, the time spent converting params, the
+ * time spent in the called method itself, and the number of bytes of string
+ * and array data converted.
+ *
+ * Collection is off by default, in which case a call pays for a single test
+ * of a flag.  When on, each thread counts into its own table, so that calls
+ * never contend for a lock; the tables are only merged when a report is
+ * asked for.  Nested calls (Java -> XPCOM -> Java ...) are each counted
+ * under their own method; the invoke time of the outer call includes the
+ * inner one, but bytes converted by the inner call are not counted again.
+ */
+class nsJavaCallStats
+{
+  struct Counters;
+  class ThreadStats;
+
+public:
+  enum Direction {
+    kJavaToXPCOM,   // Java calling an XPCOM method through a proxy
+    kXPCOMToJava,   // XPCOM calling a Java object through an nsJavaXPTCStub
+    kDirectionCount
+  };
+
+  static PRBool IsEnabled()
+  {
+    return sEnabled;
+  }
+
+  /**
+   * Turns collection on or off.  Counts gathered so far are kept.
+   */
+  static void SetEnabled(PRBool aEnabled);
+
+  /**
+   * Adds to the bytes converted by the innermost call running on this thread.
+   * Does nothing if collection is off.
+   */
+  static void AddBytes(PRUint64 aBytes)
+  {
+    if (sEnabled) {
+      AddBytesInternal(aBytes);
+    }
+  }
+
+  /**
+   * Starts all counts, on all threads, over from zero.
+   */
+  static void Reset();
+
+  /**
+   * Merges the counts of all threads into a report, with one line (or JSON
+   * object) per method that has been called since the last reset.  Times
+   * are given in nanoseconds.
+   *
+   * @param aJSON     if true, the report is a JSON object; otherwise it is
+   *                  plain text
+   * @param aResult   receives the report
+   */
+  static nsresult GetReport(PRBool aJSON, nsACString& aResult);
+
+  /**
+   * Counts a single call for as long as it is in scope.  Call BeginInvoke()
+   * and EndInvoke() around the call to the target method; any other time is
+   * counted as marshalling.
+   */
+  class AutoCall
+  {
+  public:
+    AutoCall(Direction aDirection, nsIInterfaceInfo* aIInfo,
+             PRUint16 aMethodIndex)
+      : mCounters(nullptr)
+    {
+      if (sEnabled) {
+        Start(aDirection, aIInfo, aMethodIndex);
+      }
+    }
+
+    ~AutoCall()
+    {
+      if (mCounters) {
+        Finish();
+      }
+    }
+
+    void BeginInvoke()
+    {
+      if (mCounters) {
+        mInvokeStart = mozilla::TimeStamp::Now();
+      }
+    }
+
+    void EndInvoke()
+    {
+      if (mCounters) {
+        mInvokeTime = mozilla::TimeStamp::Now() - mInvokeStart;
+      }
+    }
+
+  private:
+    void Start(Direction aDirection, nsIInterfaceInfo* aIInfo,
+               PRUint16 aMethodIndex);
+    void Finish();
+
+    Counters*             mCounters;   // null if this call is not counted
+    ThreadStats*          mThread;
+    PRUint64              mBytesBefore;
+    mozilla::TimeStamp    mStart;
+    mozilla::TimeStamp    mInvokeStart;
+    mozilla::TimeDuration mInvokeTime;
+  };
+
+private:
+  static void AddBytesInternal(PRUint64 aBytes);
+
+  static mozilla::Atomic<bool, mozilla::Relaxed> sEnabled;
+};
+
+#endif // _nsJavaCallStats_h_
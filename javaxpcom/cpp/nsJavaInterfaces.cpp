@@ -41,6 +41,7 @@
 #include "nsJavaWrapper.h"
 #include "nsJavaXPCOMBindingUtils.h"
 #include "nsJavaXPTCStub.h"
+#include "nsJavaCallStats.h"
 #include "nsIComponentRegistrar.h"
 #include "nsStringAPI.h"
 #include "nsISimpleEnumerator.h"
@@ -432,3 +433,28 @@ JXUTILS_NATIVE(wrapXPCOMObject) (JNIEnv* env, jobject, jlong aXPCOMObject,
   }
   return javaObject;
 }
+
+extern "C" NS_EXPORT void JNICALL
+JXUTILS_NATIVE(setCallStatsEnabled) (JNIEnv* env, jobject, jboolean aEnabled)
+{
+  nsJavaCallStats::SetEnabled(aEnabled == JNI_TRUE);
+}
+
+extern "C" NS_EXPORT jstring JNICALL
+JXUTILS_NATIVE(getCallStats) (JNIEnv* env, jobject)
+{
+  nsCString report;
+  nsresult rv = nsJavaCallStats::GetReport(PR_TRUE, report);
+  if (NS_FAILED(rv)) {
+    ThrowException(env, rv, "Failed to get call statistics");
+    return nullptr;
+  }
+
+  return UTF8_to_jstring(env, report.get(), report.Length());
+}
+
+extern "C" NS_EXPORT void JNICALL
+JXUTILS_NATIVE(resetCallStats) (JNIEnv* env, jobject)
+{
+  nsJavaCallStats::Reset();
+}
@@ -45,7 +45,17 @@
 #define XPCOM_NATIVE(func) Java_org_mozilla_xpcom_internal_XPCOMImpl_##func
 #define JAVAPROXY_NATIVE(func) \
           Java_org_mozilla_xpcom_internal_XPCOMJavaProxy_##func
+#define JAVABINDING_NATIVE(func) \
+          Java_org_mozilla_xpcom_internal_XPCOMJavaBinding_##func
 #define LOCKPROXY_NATIVE(func) Java_org_mozilla_xpcom_ProfileLock_##func
+#define DIRECTBUFFER_NATIVE(func) \
+          Java_org_mozilla_xpcom_internal_XPCOMDirectBuffer_##func
+#define INTERFACELIST_NATIVE(func) \
+          Java_org_mozilla_xpcom_internal_XPCOMInterfaceList_##func
+#define ASYNCQUEUE_NATIVE(func) \
+          Java_org_mozilla_xpcom_internal_XPCOMAsyncQueue_##func
+#define JAVABATCH_NATIVE(func) \
+          Java_org_mozilla_xpcom_internal_XPCOMBatch_##func
 #define JXUTILS_NATIVE(func) \
           Java_org_mozilla_xpcom_internal_JavaXPCOMMethods_##func
 
@@ -88,10 +98,23 @@ XPCOM_NATIVE(getServiceManager) (JNIEnv *env, jobject);
 
 extern "C" NS_EXPORT jobject JNICALL
 JAVAPROXY_NATIVE(callXPCOMMethod) (JNIEnv *env, jclass that, jobject aJavaProxy,
-                                   jstring aMethodName, jobjectArray aParams);
+                                   jobject aMethod, jobjectArray aParams);
+
+extern "C" NS_EXPORT jobject JNICALL
+JAVABINDING_NATIVE(callXPCOMMethod) (JNIEnv *env, jobject that,
+                                     jint aMethodIndex,
+                                     jlongArray aPrimParams,
+                                     jobjectArray aParams);
+
+extern "C" NS_EXPORT jlong JNICALL
+JAVABINDING_NATIVE(callXPCOMMethodRaw) (JNIEnv *env, jobject that,
+                                        jint aMethodIndex,
+                                        jlongArray aPrimParams,
+                                        jobjectArray aParams);
 
 extern "C" NS_EXPORT void JNICALL
-JAVAPROXY_NATIVE(finalizeProxy) (JNIEnv *env, jclass that, jobject aJavaProxy);
+JAVAPROXY_NATIVE(releaseInstances) (JNIEnv *env, jclass that,
+                                    jlongArray aXPCOMInstances);
 
 extern "C" NS_EXPORT jboolean JNICALL
 JAVAPROXY_NATIVE(isSameXPCOMObject) (JNIEnv *env, jclass that, jobject aProxy1,
@@ -100,6 +123,28 @@ JAVAPROXY_NATIVE(isSameXPCOMObject) (JNIEnv *env, jclass that, jobject aProxy1,
 extern "C" NS_EXPORT void JNICALL
 LOCKPROXY_NATIVE(release) (JNIEnv *env, jclass that, jlong aLockObject);
 
+extern "C" NS_EXPORT void JNICALL
+DIRECTBUFFER_NATIVE(freeBuffer) (JNIEnv *env, jclass that, jlong aAddress);
+
+extern "C" NS_EXPORT jobject JNICALL
+INTERFACELIST_NATIVE(wrapElement) (JNIEnv *env, jclass that, jlong aArray,
+                                   jint aIndex);
+
+extern "C" NS_EXPORT void JNICALL
+INTERFACELIST_NATIVE(releaseArray) (JNIEnv *env, jclass that, jlong aArray);
+
+extern "C" NS_EXPORT jboolean JNICALL
+ASYNCQUEUE_NATIVE(scheduleDrain) (JNIEnv *env, jclass that);
+
+extern "C" NS_EXPORT jint JNICALL
+JAVABATCH_NATIVE(invoke) (JNIEnv *env, jclass that, jobject aCalls,
+                          jint aCallCount, jobjectArray aArgs,
+                          jobject aResults, jobjectArray aResultObjects);
+
+extern "C" NS_EXPORT jint JNICALL
+JAVABATCH_NATIVE(resolveMethod) (JNIEnv *env, jclass that,
+                                 jlong aXPCOMInstance, jobject aMethod);
+
 extern "C" NS_EXPORT jlong JNICALL
 MOZILLA_NATIVE(getNativeHandleFromAWT) (JNIEnv* env, jobject, jobject widget);
 
@@ -111,4 +156,13 @@ extern "C" NS_EXPORT jobject JNICALL
 JXUTILS_NATIVE(wrapXPCOMObject) (JNIEnv* env, jobject, jlong aXPCOMObject,
                                  jstring aIID);
 
+extern "C" NS_EXPORT void JNICALL
+JXUTILS_NATIVE(setCallStatsEnabled) (JNIEnv* env, jobject, jboolean aEnabled);
+
+extern "C" NS_EXPORT jstring JNICALL
+JXUTILS_NATIVE(getCallStats) (JNIEnv* env, jobject);
+
+extern "C" NS_EXPORT void JNICALL
+JXUTILS_NATIVE(resetCallStats) (JNIEnv* env, jobject);
+
 #endif // _nsJavaInterfaces_h_
@@ -0,0 +1,216 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include "mozilla/Atomics.h"
+#include "nsJavaReleaseQueue.h"
+#include "nsThreadUtils.h"
+#include "prinrval.h"
+
+
+// Maximum number of objects released by one run of the drainer, before it
+// yields to other events on the main thread.
+static const PRUint32 kReleaseSliceSize = 500;
+
+struct ReleaseNode
+{
+  ReleaseNode(nsISupports* aObject)
+    : object(aObject)
+    , next(nullptr)
+  { }
+
+  nsISupports*  object;
+  ReleaseNode*  next;
+};
+
+// Objects pushed by any thread, most recent first.
+static mozilla::Atomic<ReleaseNode*> sHead;
+
+// Objects taken by the drainer but not released yet, oldest first.  Only used
+// on the main thread.
+static ReleaseNode* sPending = nullptr;
+static ReleaseNode* sPendingTail = nullptr;
+
+static mozilla::Atomic<PRUint32> sDrainScheduled;
+static mozilla::Atomic<PRUint32> sDrainScheduledAt;
+
+static mozilla::Atomic<PRUint32> sQueueDepth;
+static mozilla::Atomic<PRUint32> sMaxQueueDepth;
+static mozilla::Atomic<PRUint32> sReleaseCount;
+static mozilla::Atomic<PRUint32> sDrainCount;
+static mozilla::Atomic<PRUint32> sLastDrainLatency;
+static mozilla::Atomic<PRUint32> sMaxDrainLatency;
+
+
+// Moves the objects pushed so far to the end of the pending list.
+static void
+TakePending()
+{
+  ReleaseNode* list = sHead.exchange(nullptr);
+
+  // The pushed list is in reverse order, so reverse it before appending it.
+  ReleaseNode* reversed = nullptr;
+  ReleaseNode* tail = list;
+  while (list) {
+    ReleaseNode* next = list->next;
+    list->next = reversed;
+    reversed = list;
+    list = next;
+  }
+
+  if (!reversed)
+    return;
+  if (sPendingTail) {
+    sPendingTail->next = reversed;
+  } else {
+    sPending = reversed;
+  }
+  sPendingTail = tail;
+}
+
+// Releases up to |aCount| objects from the pending list.
+static void
+ReleasePending(PRUint32 aCount)
+{
+  PRUint32 released = 0;
+  while (sPending && released < aCount) {
+    ReleaseNode* node = sPending;
+    sPending = node->next;
+    NS_RELEASE(node->object);
+    delete node;
+    released++;
+  }
+  if (!sPending)
+    sPendingTail = nullptr;
+
+  sQueueDepth -= released;
+  sReleaseCount += released;
+}
+
+class ReleaseQueueDrainer : public nsRunnable
+{
+public:
+  NS_IMETHOD Run();
+};
+
+// Dispatches a drainer to the main thread, unless one is already pending.
+static void
+ScheduleDrain()
+{
+  if (sDrainScheduled.exchange(1))
+    return;
+
+  sDrainScheduledAt = PR_IntervalNow();
+  nsCOMPtr<nsIRunnable> drainer = new ReleaseQueueDrainer();
+  nsresult rv = NS_DispatchToMainThread(drainer);
+  if (NS_FAILED(rv)) {
+    sDrainScheduled = 0;
+    NS_WARNING("Failed to dispatch release queue drainer");
+  }
+}
+
+NS_IMETHODIMP
+ReleaseQueueDrainer::Run()
+{
+  PRUint32 latency = PR_IntervalToMicroseconds(PR_IntervalNow() -
+                                               sDrainScheduledAt);
+  sLastDrainLatency = latency;
+  if (latency > sMaxDrainLatency)
+    sMaxDrainLatency = latency;
+  sDrainCount++;
+
+  // Clear the flag before taking the list, so that an object pushed after
+  // that point schedules another drain.
+  sDrainScheduled = 0;
+  TakePending();
+  ReleasePending(kReleaseSliceSize);
+
+  if (sPending)
+    ScheduleDrain();
+  return NS_OK;
+}
+
+nsresult
+nsJavaReleaseQueue::Release(nsISupports* aObject)
+{
+  if (!aObject)
+    return NS_OK;
+
+  if (NS_IsMainThread()) {
+    NS_RELEASE(aObject);
+    return NS_OK;
+  }
+
+  ReleaseNode* node = new ReleaseNode(aObject);
+  if (!node)
+    return NS_ERROR_OUT_OF_MEMORY;
+
+  // Count the node before publishing it, so that a drain can't release it
+  // (and decrement the depth) before it has been counted.
+  PRUint32 depth = ++sQueueDepth;
+  PRUint32 maxDepth;
+  while (depth > (maxDepth = sMaxQueueDepth) &&
+         !sMaxQueueDepth.compareExchange(maxDepth, depth));
+
+  ReleaseNode* head;
+  do {
+    head = sHead;
+    node->next = head;
+  } while (!sHead.compareExchange(head, node));
+
+  ScheduleDrain();
+  return NS_OK;
+}
+
+void
+nsJavaReleaseQueue::Flush()
+{
+  NS_ASSERTION(NS_IsMainThread(), "Flush() must be called on main thread");
+
+  TakePending();
+  ReleasePending(PR_UINT32_MAX);
+}
+
+void
+nsJavaReleaseQueue::GetStats(nsJavaReleaseQueueStats* aStats)
+{
+  aStats->queueDepth = sQueueDepth;
+  aStats->maxQueueDepth = sMaxQueueDepth;
+  aStats->releaseCount = sReleaseCount;
+  aStats->drainCount = sDrainCount;
+  aStats->lastDrainLatency = sLastDrainLatency;
+  aStats->maxDrainLatency = sMaxDrainLatency;
+}
@@ -0,0 +1,89 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef _nsJavaReleaseQueue_h_
+#define _nsJavaReleaseQueue_h_
+
+#include "nscore.h"
+#include "nsISupports.h"
+
+
+/**
+ * Counters reported by nsJavaReleaseQueue::GetStats().
+ */
+struct nsJavaReleaseQueueStats
+{
+  PRUint32 queueDepth;        // objects waiting to be released
+  PRUint32 maxQueueDepth;     // highest queueDepth seen so far
+  PRUint32 releaseCount;      // objects released through the queue
+  PRUint32 drainCount;        // number of times the main thread drained it
+  PRUint32 lastDrainLatency;  // usecs between scheduling a drain and its start
+  PRUint32 maxDrainLatency;   // highest lastDrainLatency seen so far
+};
+
+/**
+ * Releases XPCOM objects on the main thread.
+ *
+ * Objects released from other threads (such as the thread that reclaims Java
+ * proxies) are pushed onto a lock-free list.  A single runnable on the main
+ * thread takes the whole list and releases the objects in slices of bounded
+ * size, dispatching itself again if more remain, so that a burst of releases
+ * neither floods the main event loop with runnables nor blocks it for long.
+ */
+class nsJavaReleaseQueue
+{
+public:
+  /**
+   * Releases the given object on the main thread.  If called on the main
+   * thread, the object is released immediately.
+   *
+   * @param aObject   object to release; may be null
+   */
+  static nsresult Release(nsISupports* aObject);
+
+  /**
+   * Releases all objects in the queue.  Must be called on the main thread.
+   */
+  static void Flush();
+
+  /**
+   * @param aStats  receives the current counters
+   */
+  static void GetStats(nsJavaReleaseQueueStats* aStats);
+};
+
+#endif // _nsJavaReleaseQueue_h_
@@ -0,0 +1,287 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#include "nsJavaUTF8.h"
+
+// The vector paths are chosen at compile time.  SSE2 is part of every x86-64
+// target; AVX2 is only used when the build asks for it (e.g. -mavx2).
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define JAVAXPCOM_UTF8_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JAVAXPCOM_UTF8_SSE2
+#endif
+
+
+static const jchar kReplacementChar = 0xFFFD;
+
+static inline PRBool
+IsHighSurrogate(PRUint32 aChar)
+{
+  return (aChar & 0xFC00) == 0xD800;
+}
+
+static inline PRBool
+IsLowSurrogate(PRUint32 aChar)
+{
+  return (aChar & 0xFC00) == 0xDC00;
+}
+
+/**
+ * Copies the leading run of ASCII chars from aSrc to aDest, narrowing each to
+ * a byte.  If aDest is null, the run is only measured.
+ *
+ * @return  number of leading chars that are ASCII
+ */
+static PRUint32
+CopyASCIIFromUTF16(const jchar* aSrc, PRUint32 aLength, char* aDest)
+{
+  PRUint32 i = 0;
+
+#ifdef JAVAXPCOM_UTF8_AVX2
+  const __m256i nonASCII256 = _mm256_set1_epi16((short) 0xFF80);
+  for (; i + 32 <= aLength; i += 32) {
+    __m256i a = _mm256_loadu_si256((const __m256i*) (aSrc + i));
+    __m256i b = _mm256_loadu_si256((const __m256i*) (aSrc + i + 16));
+    if (!_mm256_testz_si256(_mm256_or_si256(a, b), nonASCII256))
+      break;
+    if (aDest) {
+      // packus works within each 128-bit lane, so restore the quadword order
+      __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b),
+                                               0xD8);
+      _mm256_storeu_si256((__m256i*) (aDest + i), bytes);
+    }
+  }
+#endif
+
+#ifdef JAVAXPCOM_UTF8_SSE2
+  const __m128i nonASCII = _mm_set1_epi16((short) 0xFF80);
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= aLength; i += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i*) (aSrc + i));
+    __m128i b = _mm_loadu_si128((const __m128i*) (aSrc + i + 8));
+    __m128i high = _mm_and_si128(_mm_or_si128(a, b), nonASCII);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF)
+      break;
+    if (aDest) {
+      _mm_storeu_si128((__m128i*) (aDest + i), _mm_packus_epi16(a, b));
+    }
+  }
+#endif
+
+  for (; i < aLength && aSrc[i] < 0x80; i++) {
+    if (aDest)
+      aDest[i] = (char) aSrc[i];
+  }
+  return i;
+}
+
+/**
+ * Copies the leading run of ASCII bytes from aSrc to aDest, widening each to
+ * a jchar.
+ *
+ * @return  number of leading bytes that are ASCII
+ */
+static PRUint32
+CopyASCIIToUTF16(const char* aSrc, PRUint32 aLength, jchar* aDest)
+{
+  PRUint32 i = 0;
+
+#ifdef JAVAXPCOM_UTF8_AVX2
+  for (; i + 32 <= aLength; i += 32) {
+    __m256i bytes = _mm256_loadu_si256((const __m256i*) (aSrc + i));
+    if (_mm256_movemask_epi8(bytes))
+      break;
+    _mm256_storeu_si256((__m256i*) (aDest + i),
+                        _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes)));
+    _mm256_storeu_si256((__m256i*) (aDest + i + 16),
+                        _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes,
+                                                                      1)));
+  }
+#endif
+
+#ifdef JAVAXPCOM_UTF8_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= aLength; i += 16) {
+    __m128i bytes = _mm_loadu_si128((const __m128i*) (aSrc + i));
+    if (_mm_movemask_epi8(bytes))
+      break;
+    _mm_storeu_si128((__m128i*) (aDest + i), _mm_unpacklo_epi8(bytes, zero));
+    _mm_storeu_si128((__m128i*) (aDest + i + 8),
+                     _mm_unpackhi_epi8(bytes, zero));
+  }
+#endif
+
+  for (; i < aLength && !(aSrc[i] & 0x80); i++) {
+    aDest[i] = (jchar) aSrc[i];
+  }
+  return i;
+}
+
+PRUint32
+UTF16ToUTF8Length(const jchar* aSrc, PRUint32 aLength)
+{
+  PRUint32 length = 0;
+  PRUint32 i = 0;
+
+  while (i < aLength) {
+    PRUint32 ascii = CopyASCIIFromUTF16(aSrc + i, aLength - i, nullptr);
+    i += ascii;
+    length += ascii;
+
+    for (; i < aLength && aSrc[i] >= 0x80; i++) {
+      jchar c = aSrc[i];
+      if (c < 0x800) {
+        length += 2;
+      } else if (IsHighSurrogate(c) && i + 1 < aLength &&
+                 IsLowSurrogate(aSrc[i + 1])) {
+        length += 4;
+        i++;
+      } else {
+        length += 3;  // BMP char, or U+FFFD for an unpaired surrogate
+      }
+    }
+  }
+
+  return length;
+}
+
+PRUint32
+ConvertUTF16ToUTF8(const jchar* aSrc, PRUint32 aLength, char* aDest)
+{
+  char* out = aDest;
+  PRUint32 i = 0;
+
+  while (i < aLength) {
+    PRUint32 ascii = CopyASCIIFromUTF16(aSrc + i, aLength - i, out);
+    i += ascii;
+    out += ascii;
+
+    for (; i < aLength && aSrc[i] >= 0x80; i++) {
+      PRUint32 c = aSrc[i];
+      if (c < 0x800) {
+        *out++ = (char) (0xC0 | (c >> 6));
+        *out++ = (char) (0x80 | (c & 0x3F));
+        continue;
+      }
+
+      if (IsHighSurrogate(c) && i + 1 < aLength &&
+          IsLowSurrogate(aSrc[i + 1])) {
+        c = 0x10000 + ((c - 0xD800) << 10) + (aSrc[++i] - 0xDC00);
+        *out++ = (char) (0xF0 | (c >> 18));
+        *out++ = (char) (0x80 | ((c >> 12) & 0x3F));
+        *out++ = (char) (0x80 | ((c >> 6) & 0x3F));
+        *out++ = (char) (0x80 | (c & 0x3F));
+        continue;
+      }
+
+      if (IsHighSurrogate(c) || IsLowSurrogate(c)) {
+        c = kReplacementChar;
+      }
+      *out++ = (char) (0xE0 | (c >> 12));
+      *out++ = (char) (0x80 | ((c >> 6) & 0x3F));
+      *out++ = (char) (0x80 | (c & 0x3F));
+    }
+  }
+
+  return out - aDest;
+}
+
+PRUint32
+ConvertUTF8ToUTF16(const char* aSrc, PRUint32 aLength, jchar* aDest)
+{
+  const unsigned char* src = reinterpret_cast<const unsigned char*>(aSrc);
+  jchar* out = aDest;
+  PRUint32 i = 0;
+
+  while (i < aLength) {
+    PRUint32 ascii = CopyASCIIToUTF16(aSrc + i, aLength - i, out);
+    i += ascii;
+    out += ascii;
+
+    while (i < aLength && src[i] >= 0x80) {
+      PRUint32 c = src[i];
+      PRUint32 trail;
+      PRUint32 minimum;
+      if (c >= 0xC2 && c <= 0xDF) {
+        trail = 1;
+        minimum = 0x80;
+        c &= 0x1F;
+      } else if (c >= 0xE0 && c <= 0xEF) {
+        trail = 2;
+        minimum = 0x800;
+        c &= 0x0F;
+      } else if (c >= 0xF0 && c <= 0xF4) {
+        trail = 3;
+        minimum = 0x10000;
+        c &= 0x07;
+      } else {
+        // stray continuation byte, or a lead byte that is never valid
+        *out++ = kReplacementChar;
+        i++;
+        continue;
+      }
+
+      PRUint32 j = 1;
+      if (aLength - i > trail) {
+        for (; j <= trail && (src[i + j] & 0xC0) == 0x80; j++) {
+          c = (c << 6) | (src[i + j] & 0x3F);
+        }
+      }
+      if (j <= trail || c < minimum || c > 0x10FFFF ||
+          (c >= 0xD800 && c <= 0xDFFF)) {
+        *out++ = kReplacementChar;
+        i++;
+        continue;
+      }
+      i += trail + 1;
+
+      if (c >= 0x10000) {
+        c -= 0x10000;
+        *out++ = (jchar) (0xD800 + (c >> 10));
+        *out++ = (jchar) (0xDC00 + (c & 0x3FF));
+      } else {
+        *out++ = (jchar) c;
+      }
+    }
+  }
+
+  return out - aDest;
+}
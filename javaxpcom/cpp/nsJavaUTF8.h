@@ -0,0 +1,92 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef _nsJavaUTF8_h_
+#define _nsJavaUTF8_h_
+
+#include "nscore.h"
+#include "jni.h"
+
+
+/**
+ * Conversions between Java's UTF-16 strings and standard UTF-8.
+ *
+ * JNI's own UTF functions (GetStringUTFChars(), NewStringUTF()) use a
+ * "modified" UTF-8, which encodes U+0000 as two bytes and supplementary
+ * characters as two 3-byte surrogates, and which requires a NUL terminator on
+ * input.  XPCOM's AUTF8String and ACString expect standard UTF-8, so the
+ * bindings convert the chars themselves.  All lengths are explicit, and
+ * runs of ASCII are copied with SSE2/AVX2 where the compiler targets them.
+ */
+
+/**
+ * Returns the number of bytes needed to encode the given chars as UTF-8.
+ * Unpaired surrogates count as U+FFFD.
+ *
+ * @param aSrc      UTF-16 chars
+ * @param aLength   number of chars in aSrc
+ */
+PRUint32 UTF16ToUTF8Length(const jchar* aSrc, PRUint32 aLength);
+
+/**
+ * Encodes UTF-16 chars as UTF-8.  Unpaired surrogates are written as U+FFFD.
+ *
+ * @param aSrc      UTF-16 chars
+ * @param aLength   number of chars in aSrc
+ * @param aDest     receives the UTF-8 bytes; must have room for
+ *                  UTF16ToUTF8Length(aSrc, aLength) bytes
+ *
+ * @return  number of bytes written
+ */
+PRUint32 ConvertUTF16ToUTF8(const jchar* aSrc, PRUint32 aLength, char* aDest);
+
+/**
+ * Decodes UTF-8 bytes to UTF-16.  Each byte that does not start a valid
+ * sequence (including overlong forms, surrogates and values above U+10FFFF)
+ * is written as U+FFFD.  Embedded NULs are preserved.
+ *
+ * @param aSrc      UTF-8 bytes
+ * @param aLength   number of bytes in aSrc
+ * @param aDest     receives the UTF-16 chars; must have room for aLength
+ *                  chars, since UTF-8 never takes fewer bytes than UTF-16
+ *                  takes chars
+ *
+ * @return  number of chars written
+ */
+PRUint32 ConvertUTF8ToUTF16(const char* aSrc, PRUint32 aLength, jchar* aDest);
+
+#endif // _nsJavaUTF8_h_
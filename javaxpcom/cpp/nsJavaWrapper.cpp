@@ -41,6 +41,10 @@
 #include "nsJavaWrapper.h"
 #include "nsJavaXPTCStub.h"
 #include "nsJavaXPCOMBindingUtils.h"
+#include "nsJavaUTF8.h"
+#include "nsJavaCallArena.h"
+#include "nsJavaCallStats.h"
+#include "nsJavaReleaseQueue.h"
 #include "jni.h"
 #include "xptcall.h"
 #include "nsIInterfaceInfoManager.h"
@@ -50,6 +54,7 @@
 #include "nsServiceManagerUtils.h"
 #include "nsThreadUtils.h"
 #include "nsProxyRelease.h"
+#include <new>
 
 static nsID nullID = {0, 0, 0, {0, 0, 0, 0, 0, 0, 0, 0}};
 
@@ -112,32 +117,14 @@ CreateJavaArray(JNIEnv* env, PRUint8 aType, PRUint32 aSize, const nsID& aIID,
     case nsXPTType::T_INTERFACE:
     case nsXPTType::T_INTERFACE_IS:
     {
-      nsCOMPtr<nsIInterfaceInfoManager>
-        iim(do_GetService(NS_INTERFACEINFOMANAGER_SERVICE_CONTRACTID));
-      NS_ASSERTION(iim, "Failed to get InterfaceInfoManager");
-      if (!iim)
-        return NS_ERROR_FAILURE;
-
-      // Get interface info for given IID
-      nsCOMPtr<nsIInterfaceInfo> info;
-      nsresult rv = iim->GetInfoForIID(&aIID, getter_AddRefs(info));
+      jclass ifaceClass;
+      nsresult rv = gJavaInterfaceClassMap->GetClass(env, aIID, nullptr,
+                                                     &ifaceClass);
       if (NS_FAILED(rv))
         return rv;
 
-      // Get interface name
-      const char* iface_name;
-      rv = info->GetNameShared(&iface_name);
-      if (NS_FAILED(rv))
-        return rv;
-
-      // Create proper Java interface name
-      nsEmbedCString class_name("org/mozilla/interfaces/");
-      class_name.AppendASCII(iface_name);
-      jclass ifaceClass = env->FindClass(class_name.get());
-      if (!ifaceClass)
-        return NS_ERROR_FAILURE;
-
       array = env->NewObjectArray(aSize, ifaceClass, nullptr);
+      env->DeleteLocalRef(ifaceClass);
       break;
     }
 
@@ -242,51 +229,45 @@ GetNativeArrayElement(PRUint8 aType, void* aArray, PRUint32 aIndex,
   return NS_OK;
 }
 
-nsresult
-CreateNativeArray(PRUint8 aType, PRUint32 aSize, void** aResult)
+/**
+ * Returns the size of an element of a native array of type aType, or 0 if the
+ * type is unknown.
+ */
+static size_t
+GetArrayElementSize(PRUint8 aType)
 {
-  void* array = nullptr;
   switch (aType)
   {
     case nsXPTType::T_I8:
     case nsXPTType::T_U8:
-      array = PR_Malloc(aSize * sizeof(PRUint8));
-      break;
+      return sizeof(PRUint8);
 
     case nsXPTType::T_I16:
     case nsXPTType::T_U16:
-      array = PR_Malloc(aSize * sizeof(PRUint16));
-      break;
+      return sizeof(PRUint16);
 
     case nsXPTType::T_I32:
     case nsXPTType::T_U32:
-      array = PR_Malloc(aSize * sizeof(PRUint32));
-      break;
+      return sizeof(PRUint32);
 
     case nsXPTType::T_I64:
     case nsXPTType::T_U64:
-      array = PR_Malloc(aSize * sizeof(PRUint64));
-      break;
+      return sizeof(PRUint64);
 
     case nsXPTType::T_FLOAT:
-      array = PR_Malloc(aSize * sizeof(float));
-      break;
+      return sizeof(float);
 
     case nsXPTType::T_DOUBLE:
-      array = PR_Malloc(aSize * sizeof(double));
-      break;
+      return sizeof(double);
 
     case nsXPTType::T_BOOL:
-      array = PR_Malloc(aSize * sizeof(PRBool));
-      break;
+      return sizeof(PRBool);
 
     case nsXPTType::T_CHAR:
-      array = PR_Malloc(aSize * sizeof(char));
-      break;
+      return sizeof(char);
 
     case nsXPTType::T_WCHAR:
-      array = PR_Malloc(aSize * sizeof(PRUnichar));
-      break;
+      return sizeof(PRUnichar);
 
     case nsXPTType::T_CHAR_STR:
     case nsXPTType::T_WCHAR_STR:
@@ -297,18 +278,36 @@ CreateNativeArray(PRUint8 aType, PRUint32 aSize, void** aResult)
     case nsXPTType::T_CSTRING:
     case nsXPTType::T_INTERFACE:
     case nsXPTType::T_INTERFACE_IS:
-      array = PR_Malloc(aSize * sizeof(void*));
-      break;
+      return sizeof(void*);
 
     case nsXPTType::T_VOID:
-      array = PR_Malloc(aSize * sizeof(void*));
-      break;
+      return sizeof(void*);
 
     default:
       NS_WARNING("unknown type");
-      return NS_ERROR_FAILURE;
+      return 0;
   }
+}
 
+/**
+ * Allocates a native array of aSize elements of type aType.  The array comes
+ * from aArena if given; otherwise it is allocated with PR_Malloc(), and the
+ * caller must free it with PR_Free().
+ */
+nsresult
+CreateNativeArray(PRUint8 aType, PRUint32 aSize, nsJavaCallArena* aArena,
+                  void** aResult)
+{
+  size_t elementSize = GetArrayElementSize(aType);
+  if (!elementSize)
+    return NS_ERROR_FAILURE;
+
+  void* array;
+  if (aArena) {
+    array = aArena->Allocate(aSize * elementSize);
+  } else {
+    array = PR_Malloc(aSize * elementSize);
+  }
   if (!array)
     return NS_ERROR_OUT_OF_MEMORY;
 
@@ -316,6 +315,562 @@ CreateNativeArray(PRUint8 aType, PRUint32 aSize, void** aResult)
   return NS_OK;
 }
 
+/**
+ * Returns true if arrays of the given type are passed to Java as arrays of
+ * a Java primitive type, and can therefore be copied in bulk.
+ */
+static PRBool
+IsPrimitiveArrayType(PRUint8 aType)
+{
+  switch (aType)
+  {
+    case nsXPTType::T_I8:
+    case nsXPTType::T_I16:
+    case nsXPTType::T_I32:
+    case nsXPTType::T_I64:
+    case nsXPTType::T_U8:
+    case nsXPTType::T_U16:
+    case nsXPTType::T_U32:
+    case nsXPTType::T_U64:
+    case nsXPTType::T_FLOAT:
+    case nsXPTType::T_DOUBLE:
+    case nsXPTType::T_BOOL:
+    case nsXPTType::T_CHAR:
+    case nsXPTType::T_WCHAR:
+    case nsXPTType::T_VOID:
+      return PR_TRUE;
+
+    default:
+      return PR_FALSE;
+  }
+}
+
+/**
+ * Returns true if arrays of the given type hold XPCOM interface pointers,
+ * which are converted by NativeInterfacesToJavaObjects().
+ */
+static PRBool
+IsInterfaceArrayType(PRUint8 aType)
+{
+  return aType == nsXPTType::T_INTERFACE || aType == nsXPTType::T_INTERFACE_IS;
+}
+
+/**
+ * Drops the references held by the elements of a native interface array.
+ * The array itself isn't freed.
+ */
+static void
+ReleaseInterfaceArray(nsISupports** aArray, PRUint32 aSize)
+{
+  for (PRUint32 i = 0; i < aSize; i++) {
+    NS_IF_RELEASE(aArray[i]);
+  }
+}
+
+// Element conversion kernels for arrays whose Java and native element types
+// differ in width.  These are kept as simple loops over contiguous memory so
+// that the compiler can vectorize them.
+template <class FromType, class ToType>
+static inline void
+ConvertArrayElements(const FromType* aSource, ToType* aDest, PRUint32 aSize)
+{
+  for (PRUint32 i = 0; i < aSize; i++)
+    aDest[i] = static_cast<ToType>(aSource[i]);
+}
+
+static inline void
+ConvertArrayElements(const jlong* aSource, void** aDest, PRUint32 aSize)
+{
+  for (PRUint32 i = 0; i < aSize; i++)
+    aDest[i] = reinterpret_cast<void*>(aSource[i]);
+}
+
+static inline void
+ConvertArrayElements(void* const* aSource, jlong* aDest, PRUint32 aSize)
+{
+  for (PRUint32 i = 0; i < aSize; i++)
+    aDest[i] = reinterpret_cast<jlong>(aSource[i]);
+}
+
+/**
+ * Copies the first aSize elements of a Java primitive array, whose elements
+ * are of type JType, into the native array aDest.
+ */
+template <class JType, class NativeType>
+static nsresult
+CopyFromJavaArray(JNIEnv* env, jarray aJavaArray, PRUint32 aSize,
+                  NativeType* aDest)
+{
+  JType* source =
+    static_cast<JType*>(env->GetPrimitiveArrayCritical(aJavaArray, nullptr));
+  if (!source)
+    return NS_ERROR_OUT_OF_MEMORY;
+
+  ConvertArrayElements(source, aDest, aSize);
+  env->ReleasePrimitiveArrayCritical(aJavaArray, source, JNI_ABORT);
+  return NS_OK;
+}
+
+/**
+ * Copies aSize elements from the native array aSource into a Java primitive
+ * array whose elements are of type JType.
+ */
+template <class JType, class NativeType>
+static nsresult
+CopyToJavaArray(JNIEnv* env, const NativeType* aSource, PRUint32 aSize,
+                jarray aJavaArray)
+{
+  JType* dest =
+    static_cast<JType*>(env->GetPrimitiveArrayCritical(aJavaArray, nullptr));
+  if (!dest)
+    return NS_ERROR_OUT_OF_MEMORY;
+
+  ConvertArrayElements(aSource, dest, aSize);
+  env->ReleasePrimitiveArrayCritical(aJavaArray, dest, 0);
+  return NS_OK;
+}
+
+/**
+ * Fills the native array aNativeArray (as allocated by CreateNativeArray) with
+ * the first aSize elements of the given Java primitive array.  Where the Java
+ * and native element types have the same layout, this is a single
+ * Get<Type>ArrayRegion call; otherwise the elements are converted directly
+ * from the pinned Java array.
+ */
+static nsresult
+SetupPrimitiveArray(JNIEnv* env, jarray aJavaArray, PRUint8 aType,
+                    PRUint32 aSize, void* aNativeArray)
+{
+  if (env->GetArrayLength(aJavaArray) < (jsize) aSize)
+    return NS_ERROR_ILLEGAL_VALUE;
+
+  nsJavaCallStats::AddBytes(aSize * GetArrayElementSize(aType));
+
+  nsresult rv = NS_OK;
+  switch (aType)
+  {
+    case nsXPTType::T_I8:
+      env->GetByteArrayRegion((jbyteArray) aJavaArray, 0, aSize,
+                              static_cast<jbyte*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_I16:
+      env->GetShortArrayRegion((jshortArray) aJavaArray, 0, aSize,
+                               static_cast<jshort*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_I32:
+      env->GetIntArrayRegion((jintArray) aJavaArray, 0, aSize,
+                             static_cast<jint*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_I64:
+      env->GetLongArrayRegion((jlongArray) aJavaArray, 0, aSize,
+                              static_cast<jlong*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_FLOAT:
+      env->GetFloatArrayRegion((jfloatArray) aJavaArray, 0, aSize,
+                               static_cast<jfloat*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_DOUBLE:
+      env->GetDoubleArrayRegion((jdoubleArray) aJavaArray, 0, aSize,
+                                static_cast<jdouble*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_WCHAR:
+      env->GetCharArrayRegion((jcharArray) aJavaArray, 0, aSize,
+                              static_cast<jchar*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_U8:
+      rv = CopyFromJavaArray<jshort>(env, aJavaArray, aSize,
+                                     static_cast<PRUint8*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_U16:
+      rv = CopyFromJavaArray<jint>(env, aJavaArray, aSize,
+                                   static_cast<PRUint16*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_U32:
+      rv = CopyFromJavaArray<jlong>(env, aJavaArray, aSize,
+                                    static_cast<PRUint32*>(aNativeArray));
+      break;
+
+    // XXX how do we handle unsigned 64-bit values?
+    case nsXPTType::T_U64:
+      rv = CopyFromJavaArray<jdouble>(env, aJavaArray, aSize,
+                                      static_cast<PRUint64*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_BOOL:
+      rv = CopyFromJavaArray<jboolean>(env, aJavaArray, aSize,
+                                       static_cast<PRBool*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_CHAR:
+      rv = CopyFromJavaArray<jchar>(env, aJavaArray, aSize,
+                                    static_cast<char*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_VOID:
+      rv = CopyFromJavaArray<jlong>(env, aJavaArray, aSize,
+                                    static_cast<void**>(aNativeArray));
+      break;
+
+    default:
+      NS_WARNING("not a primitive array type");
+      return NS_ERROR_UNEXPECTED;
+  }
+
+  if (NS_SUCCEEDED(rv) && env->ExceptionCheck())
+    rv = NS_ERROR_FAILURE;
+  return rv;
+}
+
+/**
+ * Copies aSize elements of the given native array into the Java primitive
+ * array aJavaArray (as created by CreateJavaArray).  The counterpart of
+ * SetupPrimitiveArray.
+ */
+static nsresult
+FinalizePrimitiveArray(JNIEnv* env, const void* aNativeArray, PRUint8 aType,
+                       PRUint32 aSize, jarray aJavaArray)
+{
+  nsJavaCallStats::AddBytes(aSize * GetArrayElementSize(aType));
+
+  nsresult rv = NS_OK;
+  switch (aType)
+  {
+    case nsXPTType::T_I8:
+      env->SetByteArrayRegion((jbyteArray) aJavaArray, 0, aSize,
+                              static_cast<const jbyte*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_I16:
+      env->SetShortArrayRegion((jshortArray) aJavaArray, 0, aSize,
+                               static_cast<const jshort*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_I32:
+      env->SetIntArrayRegion((jintArray) aJavaArray, 0, aSize,
+                             static_cast<const jint*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_I64:
+      env->SetLongArrayRegion((jlongArray) aJavaArray, 0, aSize,
+                              static_cast<const jlong*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_FLOAT:
+      env->SetFloatArrayRegion((jfloatArray) aJavaArray, 0, aSize,
+                               static_cast<const jfloat*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_DOUBLE:
+      env->SetDoubleArrayRegion((jdoubleArray) aJavaArray, 0, aSize,
+                                static_cast<const jdouble*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_WCHAR:
+      env->SetCharArrayRegion((jcharArray) aJavaArray, 0, aSize,
+                              static_cast<const jchar*>(aNativeArray));
+      break;
+
+    case nsXPTType::T_U8:
+      rv = CopyToJavaArray<jshort>(env,
+                                   static_cast<const PRUint8*>(aNativeArray),
+                                   aSize, aJavaArray);
+      break;
+
+    case nsXPTType::T_U16:
+      rv = CopyToJavaArray<jint>(env,
+                                 static_cast<const PRUint16*>(aNativeArray),
+                                 aSize, aJavaArray);
+      break;
+
+    case nsXPTType::T_U32:
+      rv = CopyToJavaArray<jlong>(env,
+                                  static_cast<const PRUint32*>(aNativeArray),
+                                  aSize, aJavaArray);
+      break;
+
+    // XXX how do we handle unsigned 64-bit values?
+    case nsXPTType::T_U64:
+      rv = CopyToJavaArray<jdouble>(env,
+                                    static_cast<const PRUint64*>(aNativeArray),
+                                    aSize, aJavaArray);
+      break;
+
+    case nsXPTType::T_BOOL:
+      rv = CopyToJavaArray<jboolean>(env,
+                                     static_cast<const PRBool*>(aNativeArray),
+                                     aSize, aJavaArray);
+      break;
+
+    case nsXPTType::T_CHAR:
+      rv = CopyToJavaArray<jchar>(env,
+                                  static_cast<const char*>(aNativeArray),
+                                  aSize, aJavaArray);
+      break;
+
+    case nsXPTType::T_VOID:
+      rv = CopyToJavaArray<jlong>(env,
+                                  static_cast<void* const*>(aNativeArray),
+                                  aSize, aJavaArray);
+      break;
+
+    default:
+      NS_WARNING("not a primitive array type");
+      return NS_ERROR_UNEXPECTED;
+  }
+
+  if (NS_SUCCEEDED(rv) && env->ExceptionCheck())
+    rv = NS_ERROR_FAILURE;
+  return rv;
+}
+
+/**
+ * Returns true for the param types that may be passed as a direct
+ * java.nio.ByteBuffer instead of a Java array or string: octet arrays and
+ * sized strings.
+ */
+static PRBool
+IsDirectBufferType(PRUint8 aType, PRUint8 aArrayType)
+{
+  return aType == nsXPTType::T_PSTRING_SIZE_IS ||
+         (aType == nsXPTType::T_ARRAY &&
+          (aArrayType == nsXPTType::T_U8 || aArrayType == nsXPTType::T_I8));
+}
+
+/**
+ * Gets the memory backing the given direct ByteBuffer.
+ *
+ * @param aSize  number of bytes the buffer must hold
+ * @return  NS_ERROR_ILLEGAL_VALUE if the buffer isn't direct or is too small
+ */
+static nsresult
+GetDirectBufferData(JNIEnv* env, jobject aBuffer, PRUint32 aSize,
+                    void** aResult)
+{
+  void* data = env->GetDirectBufferAddress(aBuffer);
+  if (!data) {
+    NS_WARNING("ByteBuffer is not a direct buffer");
+    return NS_ERROR_ILLEGAL_VALUE;
+  }
+  if (env->GetDirectBufferCapacity(aBuffer) < (jlong) aSize) {
+    NS_WARNING("ByteBuffer is too small");
+    return NS_ERROR_ILLEGAL_VALUE;
+  }
+
+  *aResult = data;
+  return NS_OK;
+}
+
+/**
+ * Returns true if aData is the memory of the direct ByteBuffer aObject, in
+ * which case it is owned by Java and must not be freed.
+ */
+static PRBool
+IsDirectBufferData(JNIEnv* env, jobject aObject, void* aData)
+{
+  return aObject && aData && env->IsInstanceOf(aObject, byteBufferClass) &&
+         env->GetDirectBufferAddress(aObject) == aData;
+}
+
+/**
+ * Hands an octet array or sized string returned by an XPCOM method to Java as
+ * a direct ByteBuffer, without copying.  The buffer takes ownership of the
+ * memory, which is freed by XPCOMDirectBuffer once the buffer is collected.
+ * The memory comes from the XPCOM allocator, whether it was returned by the
+ * callee or is the copy made by SetupParams() for an 'inout' param, so it is
+ * always freed with moz_free().
+ *
+ * @param aHolder  ByteBuffer[] that receives the buffer
+ * @param aResult  if not null, also receives the buffer ('retval' params)
+ */
+static nsresult
+FinalizeDirectBuffer(JNIEnv* env, nsXPTCVariant &aVariant, PRUint32 aSize,
+                     nsresult aInvokeResult, jobjectArray aHolder,
+                     jobject* aResult)
+{
+  void* data = aVariant.val.p;
+  if (NS_FAILED(aInvokeResult)) {
+    if (data)
+      moz_free(data);
+    return NS_OK;
+  }
+
+  jobject buffer = nullptr;
+  if (data) {
+    buffer = env->NewDirectByteBuffer(data, aSize);
+    if (!buffer) {
+      moz_free(data);
+      return NS_ERROR_OUT_OF_MEMORY;
+    }
+    env->CallStaticVoidMethod(xpcomDirectBufferClass, trackDirectBufferMID,
+                              buffer, reinterpret_cast<jlong>(data));
+    if (env->ExceptionCheck()) {
+      moz_free(data);
+      return NS_ERROR_FAILURE;
+    }
+  }
+
+  env->SetObjectArrayElement(aHolder, 0, buffer);
+  if (aResult)
+    *aResult = buffer;
+  return env->ExceptionCheck() ? NS_ERROR_FAILURE : NS_OK;
+}
+
+/**
+ * Native side of an XPCOMInterfaceList: the interface array returned by the
+ * XPCOM method, along with the IID of its elements, which is only parsed
+ * once, when the list is created.
+ */
+struct InterfaceListArray
+{
+  nsID            iid;
+  PRUint32        size;
+  nsISupports**   elements;
+};
+
+/**
+ * Hands an interface array returned by an XPCOM method to Java as a
+ * java.util.List that only creates the Java proxy of an element when that
+ * element is first read.  The list takes ownership of the array and of the
+ * references held by its elements; XPCOMInterfaceList releases them once
+ * the list is collected, or when JavaXPCOM is shut down.
+ *
+ * @param aIID     IID of the array elements
+ * @param aHolder  List[] that receives the list
+ * @param aResult  if not null, also receives the list ('retval' params)
+ */
+static nsresult
+FinalizeInterfaceList(JNIEnv* env, nsXPTCVariant &aVariant, PRUint32 aSize,
+                      const nsID& aIID, nsresult aInvokeResult,
+                      jobjectArray aHolder, jobject* aResult)
+{
+  nsISupports** elements = static_cast<nsISupports**>(aVariant.val.p);
+  if (NS_FAILED(aInvokeResult)) {
+    if (elements) {
+      ReleaseInterfaceArray(elements, aSize);
+      PR_Free(elements);
+    }
+    return NS_OK;
+  }
+
+  jobject list = nullptr;
+  if (elements) {
+    InterfaceListArray* array = new InterfaceListArray;
+    if (!array) {
+      ReleaseInterfaceArray(elements, aSize);
+      PR_Free(elements);
+      return NS_ERROR_OUT_OF_MEMORY;
+    }
+    array->iid = aIID;
+    array->size = aSize;
+    array->elements = elements;
+
+    list = env->NewObject(xpcomInterfaceListClass, interfaceListInitMID,
+                          reinterpret_cast<jlong>(array), (jint) aSize);
+    if (!list || env->ExceptionCheck()) {
+      ReleaseInterfaceArray(elements, aSize);
+      PR_Free(elements);
+      delete array;
+      return NS_ERROR_FAILURE;
+    }
+  }
+
+  env->SetObjectArrayElement(aHolder, 0, list);
+  if (aResult)
+    *aResult = list;
+  return env->ExceptionCheck() ? NS_ERROR_FAILURE : NS_OK;
+}
+
+/**
+ * Creates the string passed to an 'in' AString or DOMString param.  Since the
+ * callee can't modify it, there is no need for an nsString with a buffer of its
+ * own: the Java chars are copied once, with an explicit length, into the same
+ * call arena allocation as a dependent string that wraps them.  Destroy the
+ * result with DestroyDependentString().
+ *
+ * @param aString  Java string; if null, a void string is returned
+ *
+ * @return  new string
+ */
+static nsAString*
+NewDependentString(JNIEnv* env, jstring aString)
+{
+  jsize length = aString ? env->GetStringLength(aString) : 0;
+  void* mem = nsJavaCallArena::Get()->Allocate(sizeof(nsDependentSubstring) +
+                                               length * sizeof(jchar));
+  nsJavaCallStats::AddBytes(length * sizeof(jchar));
+
+  jchar* chars = reinterpret_cast<jchar*>(static_cast<char*>(mem) +
+                                          sizeof(nsDependentSubstring));
+  if (length) {
+    env->GetStringRegion(aString, 0, length, chars);
+  }
+
+  nsDependentSubstring* str =
+    new (mem) nsDependentSubstring(reinterpret_cast<PRUnichar*>(chars), length);
+  if (!aString) {
+    str->SetIsVoid(PR_TRUE);
+  }
+  return str;
+}
+
+static void
+DestroyDependentString(nsAString* aString)
+{
+  static_cast<nsDependentSubstring*>(aString)->~nsDependentSubstring();
+}
+
+/**
+ * Creates the string passed to XPCOM for an 'in' AUTF8String or ACString
+ * param.  Like NewDependentString(), the string object and its UTF-8 bytes
+ * share a single call arena allocation.  Must be destroyed with
+ * DestroyDependentCString().
+ */
+static nsACString*
+NewDependentCString(JNIEnv* env, jstring aString)
+{
+  jsize length = 0;
+  const jchar* chars = nullptr;
+  PRUint32 utf8Length = 0;
+  if (aString) {
+    length = env->GetStringLength(aString);
+    chars = env->GetStringCritical(aString, nullptr);
+    if (!chars)
+      return nullptr;
+    utf8Length = UTF16ToUTF8Length(chars, length);
+  }
+
+  void* mem = nsJavaCallArena::Get()->Allocate(sizeof(nsDependentCSubstring) +
+                                               utf8Length);
+  nsJavaCallStats::AddBytes(utf8Length);
+  char* bytes = static_cast<char*>(mem) + sizeof(nsDependentCSubstring);
+  if (chars) {
+    ConvertUTF16ToUTF8(chars, length, bytes);
+    env->ReleaseStringCritical(aString, chars);
+  }
+
+  nsDependentCSubstring* str = new (mem) nsDependentCSubstring(bytes,
+                                                               utf8Length);
+  if (!aString) {
+    str->SetIsVoid(PR_TRUE);
+  }
+  return str;
+}
+
+static void
+DestroyDependentCString(nsACString* aString)
+{
+  static_cast<nsDependentCSubstring*>(aString)->~nsDependentCSubstring();
+}
+
 // TODO: Is this the correct way to emulate the old behaviour? 
 // TODO: I should probably be setting the aVariant.type all the time maybe?
 void setValIsInterface(nsXPTCVariant &aVariant)
@@ -343,6 +898,41 @@ void setValIsUTF8String(nsXPTCVariant &aVariant)
   aVariant.SetValNeedsCleanup();
 }
 
+/**
+ * Creates the empty string that receives the result of a 'dipper' string param
+ * (such as the value of an AString attribute).  The string object lives in
+ * the call arena; FinalizeParams() runs its destructor.
+ */
+static nsresult
+SetupDipperParam(nsJavaCallArena* aArena, PRUint8 aType,
+                 nsXPTCVariant &aVariant)
+{
+  switch (aType)
+  {
+    case nsXPTType::T_ASTRING:
+    case nsXPTType::T_DOMSTRING:
+      aVariant.val.p = new (aArena->Allocate(sizeof(nsString))) nsString();
+      setValIsDOMString(aVariant);
+      break;
+
+    case nsXPTType::T_UTF8STRING:
+      aVariant.val.p = new (aArena->Allocate(sizeof(nsCString))) nsCString();
+      setValIsUTF8String(aVariant);
+      break;
+
+    case nsXPTType::T_CSTRING:
+      aVariant.val.p = new (aArena->Allocate(sizeof(nsCString))) nsCString();
+      setValIsCString(aVariant);
+      break;
+
+    default:
+      NS_WARNING("unexpected dipper type");
+      return NS_ERROR_UNEXPECTED;
+  }
+
+  return aVariant.val.p ? NS_OK : NS_ERROR_OUT_OF_MEMORY;
+}
+
 /**
  * Handle 'in' and 'inout' params.
  */
@@ -723,7 +1313,14 @@ SetupParams(JNIEnv *env, const jobject aParam, PRUint8 aType, PRBool aIsOut,
                                                     aIndex);
       }
 
-      nsID* iid = new nsID;
+      // An 'inout' IID may be freed by the callee, and array elements are
+      // deleted by FinalizeParams(), so only plain 'in' IIDs use the arena.
+      nsID* iid;
+      if (!aIsOut && !aIsArrayElement) {
+        iid = new (nsJavaCallArena::Get()->Allocate(sizeof(nsID))) nsID;
+      } else {
+        iid = new nsID;
+      }
       if (!iid) {
         rv = NS_ERROR_OUT_OF_MEMORY;
         break;
@@ -841,7 +1438,7 @@ SetupParams(JNIEnv *env, const jobject aParam, PRUint8 aType, PRBool aIsOut,
       }
 
       jstring jstr = static_cast<jstring>(aParam);
-      nsString* str = jstring_to_nsString(env, jstr);
+      nsAString* str = NewDependentString(env, jstr);
       if (!str) {
         rv = NS_ERROR_OUT_OF_MEMORY;
         break;
@@ -865,7 +1462,7 @@ SetupParams(JNIEnv *env, const jobject aParam, PRUint8 aType, PRBool aIsOut,
       }
 
       jstring jstr = static_cast<jstring>(aParam);
-      nsCString* str = jstring_to_nsCString(env, jstr);
+      nsACString* str = NewDependentCString(env, jstr);
       if (!str) {
         rv = NS_ERROR_OUT_OF_MEMORY;
         break;
@@ -922,8 +1519,50 @@ SetupParams(JNIEnv *env, const jobject aParam, PRUint8 aType, PRBool aIsOut,
         sourceArray = env->GetObjectArrayElement(array, 0);
       }
 
+      // An 'inout' buffer is only passed through if the result is also
+      // returned as a buffer, i.e. if FinalizeDirectBuffer() takes ownership
+      // of whatever the callee leaves in the param.
+      if (sourceArray && IsDirectBufferType(aType, aArrayType) &&
+          env->IsInstanceOf(sourceArray, byteBufferClass) &&
+          (!aIsOut || env->IsInstanceOf(aParam, byteBufferArrayClass))) {
+        void* data;
+        rv = GetDirectBufferData(env, sourceArray, aArraySize, &data);
+        if (NS_SUCCEEDED(rv)) {
+          if (!aIsOut) {  // 'in': let the callee use the buffer's memory
+            aVariant.val.p = data;
+          } else {  // 'inout': the callee may free the array, so pass a copy
+            // Allocated like the data returned by the callee, since either
+            // one ends up freed with moz_free() by FinalizeDirectBuffer() or
+            // XPCOMDirectBuffer.
+            aVariant.val.p = moz_xmalloc(aArraySize);
+            if (aVariant.val.p) {
+              memcpy(aVariant.val.p, data, aArraySize);
+            } else {
+              rv = NS_ERROR_OUT_OF_MEMORY;
+            }
+          }
+        }
+        if (aIsOut) {
+          aVariant.SetIndirect();
+        }
+        break;
+      }
+
       if (sourceArray) {
-        rv = CreateNativeArray(aArrayType, aArraySize, &aVariant.val.p);
+        // The callee may free or replace an 'inout' array, so only 'in'
+        // arrays can use the call arena.
+        rv = CreateNativeArray(aArrayType, aArraySize,
+                               aIsOut ? nullptr : nsJavaCallArena::Get(),
+                               &aVariant.val.p);
+
+        if (NS_SUCCEEDED(rv) && IsPrimitiveArrayType(aArrayType)) {
+          rv = SetupPrimitiveArray(env, static_cast<jarray>(sourceArray),
+                                   aArrayType, aArraySize, aVariant.val.p);
+          if (aIsOut) {
+            aVariant.SetIndirect();
+          }
+          break;
+        }
 
         for (PRUint32 i = 0; i < aArraySize && NS_SUCCEEDED(rv); i++) {
           rv = SetupParams(env, sourceArray, aArrayType, PR_FALSE, aIID, 0, 0,
@@ -953,6 +1592,29 @@ SetupParams(JNIEnv *env, const jobject aParam, PRUint8 aType, PRBool aIsOut,
                                                     aIndex);
       }
 
+      if (data && aType == nsXPTType::T_PSTRING_SIZE_IS &&
+          env->IsInstanceOf(data, byteBufferClass)) {
+        void* bufData;
+        rv = GetDirectBufferData(env, data, aArraySize, &bufData);
+        if (NS_FAILED(rv))
+          break;
+
+        if (!aIsOut) {  // 'in': let the callee use the buffer's memory
+          aVariant.val.p = bufData;
+        } else {  // 'inout': the callee may free the string, so pass a copy
+          char* buf = (char*) moz_xmalloc(aArraySize + 1);
+          if (!buf) {
+            rv = NS_ERROR_OUT_OF_MEMORY;
+            break;
+          }
+          memcpy(buf, bufData, aArraySize);
+          buf[aArraySize] = '\0';
+          aVariant.val.p = buf;
+          aVariant.SetIndirect();
+        }
+        break;
+      }
+
       PRUint32 length = 0;
       if (data) {
         if (aType == nsXPTType::T_PSTRING_SIZE_IS) {
@@ -1254,13 +1916,23 @@ FinalizeParams(JNIEnv *env, const nsXPTParamInfo &aParamInfo, PRUint8 aType,
         break;
       }
 
+      if (!aParamInfo.IsDipper()) {
+        // 'in' strings are created by NewDependentString()
+        if (aVariant.val.p) {
+          DestroyDependentString(static_cast<nsAString*>(aVariant.val.p));
+        }
+        break;
+      }
+
       nsString* str = static_cast<nsString*>(aVariant.val.p);
-      if (NS_SUCCEEDED(aInvokeResult) && aParamInfo.IsDipper()) {
+      if (NS_SUCCEEDED(aInvokeResult)) {
         // Create Java string from returned nsString
         jstring jstr = nullptr;
         if (str && !str->IsVoid()) {
+          nsJavaCallStats::AddBytes(str->Length() * sizeof(jchar));
           jstr = env->NewString((const jchar*) str->get(), str->Length());
           if (!jstr) {
+            str->~nsString();
             rv = NS_ERROR_OUT_OF_MEMORY;
             break;
           }
@@ -1271,7 +1943,7 @@ FinalizeParams(JNIEnv *env, const nsXPTParamInfo &aParamInfo, PRUint8 aType,
 
       // cleanup
       if (str) {
-        delete str;
+        str->~nsString();
       }
       break;
     }
@@ -1285,13 +1957,22 @@ FinalizeParams(JNIEnv *env, const nsXPTParamInfo &aParamInfo, PRUint8 aType,
         break;
       }
 
+      if (!aParamInfo.IsDipper()) {
+        // 'in' strings are created by NewDependentCString()
+        if (aVariant.val.p) {
+          DestroyDependentCString(static_cast<nsACString*>(aVariant.val.p));
+        }
+        break;
+      }
+
       nsCString* str = static_cast<nsCString*>(aVariant.val.p);
-      if (NS_SUCCEEDED(aInvokeResult) && aParamInfo.IsDipper()) {
-        // Create Java string from returned nsString
+      if (NS_SUCCEEDED(aInvokeResult)) {
+        // Create Java string from returned nsCString
         jstring jstr = nullptr;
         if (str && !str->IsVoid()) {
-          jstr = env->NewStringUTF((const char*) str->get());
+          jstr = UTF8_to_jstring(env, str->get(), str->Length());
           if (!jstr) {
+            str->~nsCString();
             rv = NS_ERROR_OUT_OF_MEMORY;
             break;
           }
@@ -1302,7 +1983,7 @@ FinalizeParams(JNIEnv *env, const nsXPTParamInfo &aParamInfo, PRUint8 aType,
 
       // cleanup
       if (str) {
-        delete str;
+        str->~nsCString();
       }
       break;
     }
@@ -1324,34 +2005,48 @@ FinalizeParams(JNIEnv *env, const nsXPTParamInfo &aParamInfo, PRUint8 aType,
     {
       if (aParamInfo.IsOut() && NS_SUCCEEDED(aInvokeResult)) {
         // Create Java array from returned native array
-        jobject jarray = nullptr;
+        jobject javaArray = nullptr;
         if (aVariant.val.p) {
-          rv = CreateJavaArray(env, aArrayType, aArraySize, aIID, &jarray);
+          rv = CreateJavaArray(env, aArrayType, aArraySize, aIID, &javaArray);
           if (NS_FAILED(rv))
             break;
 
-          nsXPTCVariant var;
-          for (PRUint32 i = 0; i < aArraySize && NS_SUCCEEDED(rv); i++) {
-            rv = GetNativeArrayElement(aArrayType, aVariant.val.p, i, &var);
-            if (NS_SUCCEEDED(rv)) {
-              rv = FinalizeParams(env, aParamInfo, aArrayType, var, aIID,
-                                  PR_TRUE, 0, 0, i, aInvokeResult, &jarray);
+          if (IsPrimitiveArrayType(aArrayType)) {
+            rv = FinalizePrimitiveArray(env, aVariant.val.p, aArrayType,
+                                        aArraySize,
+                                        static_cast<jarray>(javaArray));
+          } else if (IsInterfaceArrayType(aArrayType)) {
+            nsISupports** elements = static_cast<nsISupports**>(aVariant.val.p);
+            rv = NativeInterfacesToJavaObjects(env, elements, aArraySize, aIID,
+                                               nullptr,
+                                               (jobjectArray) javaArray);
+            ReleaseInterfaceArray(elements, aArraySize);
+          } else {
+            nsXPTCVariant var;
+            for (PRUint32 i = 0; i < aArraySize && NS_SUCCEEDED(rv); i++) {
+              rv = GetNativeArrayElement(aArrayType, aVariant.val.p, i, &var);
+              if (NS_SUCCEEDED(rv)) {
+                rv = FinalizeParams(env, aParamInfo, aArrayType, var, aIID,
+                                    PR_TRUE, 0, 0, i, aInvokeResult, &javaArray);
+              }
             }
           }
         }
 
         if (aParamInfo.IsRetval()) {
-          *aParam = jarray;
+          *aParam = javaArray;
         } else if (*aParam) {
           // put new Java array into output array
-          env->SetObjectArrayElement((jobjectArray) *aParam, 0, jarray);
+          env->SetObjectArrayElement((jobjectArray) *aParam, 0, javaArray);
         }
       }
 
       // cleanup
       // If this is not an out param or if the invokeResult is a failure case,
       // then the array elements have not been cleaned up.  Do so now.
-      if (!aParamInfo.IsOut() || (NS_FAILED(aInvokeResult) && aVariant.val.p)) {
+      // Elements of primitive arrays don't need any cleanup.
+      if (!IsPrimitiveArrayType(aArrayType) &&
+          (!aParamInfo.IsOut() || (NS_FAILED(aInvokeResult) && aVariant.val.p))) {
         nsXPTCVariant var;
         for (PRUint32 i = 0; i < aArraySize; i++) {
           rv = GetNativeArrayElement(aArrayType, aVariant.val.p, i, &var);
@@ -1361,7 +2056,11 @@ FinalizeParams(JNIEnv *env, const nsXPTParamInfo &aParamInfo, PRUint8 aType,
           }
         }
       }
-      PR_Free(aVariant.val.p);
+      // 'in' arrays are either owned by Java (when passed as a direct
+      // ByteBuffer) or live in the call arena
+      if (aParamInfo.IsOut()) {
+        PR_Free(aVariant.val.p);
+      }
       break;
     }
 
@@ -1402,8 +2101,12 @@ FinalizeParams(JNIEnv *env, const nsXPTParamInfo &aParamInfo, PRUint8 aType,
       }
 
       // cleanup
-      if (aVariant.val.p)
+      // 'in' strings passed as a direct ByteBuffer are owned by Java
+      if (aVariant.val.p && (aParamInfo.IsOut() || !aParam ||
+                             !IsDirectBufferData(env, *aParam,
+                                                 aVariant.val.p))) {
         moz_free(aVariant.val.p);
+      }
       break;
     }
 
@@ -1516,258 +2219,358 @@ QueryMethodInfo(nsIInterfaceInfo* aIInfo, const char* aMethodName,
 }
 
 /**
- *  org.mozilla.xpcom.XPCOMJavaProxy.internal.callXPCOMMethod
+ * XPCOMJavaBinding passes 'in' params and results of primitive types as raw
+ * 64-bit values, so they don't need to be boxed.  Integral types and chars
+ * are passed by value, booleans as 0 or 1, and floats and doubles as their
+ * raw IEEE 754 bits (see Float.floatToRawIntBits() and
+ * Double.doubleToRawLongBits()).
  */
-extern "C" NS_EXPORT jobject JNICALL
-JAVAPROXY_NATIVE(callXPCOMMethod) (JNIEnv *env, jclass that, jobject aJavaProxy,
-                                   jstring aMethodName, jobjectArray aParams)
+union RawFloatBits
 {
-  nsresult rv;
+  jint    i;
+  jfloat  f;
+};
 
-  // Get native XPCOM instance
-  void* xpcom_obj;
-  rv = GetXPCOMInstFromProxy(env, aJavaProxy, &xpcom_obj);
-  if (NS_FAILED(rv)) {
-    ThrowException(env, rv, "Failed to get matching XPCOM object");
-    return nullptr;
+union RawDoubleBits
+{
+  jlong   j;
+  jdouble d;
+};
+
+static void
+SetupRawParam(PRUint8 aType, jlong aValue, nsXPTCVariant &aVariant)
+{
+  switch (aType)
+  {
+    case nsXPTType::T_I8:
+      aVariant.val.i8 = (jbyte) aValue;
+      break;
+    case nsXPTType::T_I16:
+      aVariant.val.i16 = (jshort) aValue;
+      break;
+    case nsXPTType::T_U8:
+      aVariant.val.u8 = (jshort) aValue;
+      break;
+    case nsXPTType::T_I32:
+      aVariant.val.i32 = (jint) aValue;
+      break;
+    case nsXPTType::T_U16:
+      aVariant.val.u16 = (jint) aValue;
+      break;
+    case nsXPTType::T_I64:
+      aVariant.val.i64 = aValue;
+      break;
+    case nsXPTType::T_U32:
+      aVariant.val.u32 = aValue;
+      break;
+    case nsXPTType::T_FLOAT:
+    {
+      RawFloatBits bits;
+      bits.i = (jint) aValue;
+      aVariant.val.f = bits.f;
+      break;
+    }
+    case nsXPTType::T_DOUBLE:
+    case nsXPTType::T_U64:
+    {
+      RawDoubleBits bits;
+      bits.j = aValue;
+      if (aType == nsXPTType::T_DOUBLE)
+        aVariant.val.d = bits.d;
+      else
+        aVariant.val.u64 = static_cast<PRUint64>(bits.d);
+      break;
+    }
+    case nsXPTType::T_BOOL:
+      aVariant.val.b = (aValue != 0);
+      break;
+    case nsXPTType::T_CHAR:
+      aVariant.val.c = (jchar) aValue;
+      break;
+    case nsXPTType::T_WCHAR:
+      aVariant.val.wc = (jchar) aValue;
+      break;
+    case nsXPTType::T_VOID:
+      aVariant.val.p = reinterpret_cast<void*>(aValue);
+      break;
+    default:
+      NS_WARNING("unexpected raw parameter type");
+      break;
+  }
+}
+
+static jlong
+GetRawResult(PRUint8 aType, const nsXPTCVariant &aVariant)
+{
+  switch (aType)
+  {
+    case nsXPTType::T_I8:
+      return aVariant.val.i8;
+    case nsXPTType::T_I16:
+      return aVariant.val.i16;
+    case nsXPTType::T_U8:
+      return aVariant.val.u8;
+    case nsXPTType::T_I32:
+      return aVariant.val.i32;
+    case nsXPTType::T_U16:
+      return aVariant.val.u16;
+    case nsXPTType::T_I64:
+      return aVariant.val.i64;
+    case nsXPTType::T_U32:
+      return aVariant.val.u32;
+    case nsXPTType::T_FLOAT:
+    {
+      RawFloatBits bits;
+      bits.f = aVariant.val.f;
+      return bits.i;
+    }
+    case nsXPTType::T_DOUBLE:
+    case nsXPTType::T_U64:
+    {
+      RawDoubleBits bits;
+      if (aType == nsXPTType::T_DOUBLE)
+        bits.d = aVariant.val.d;
+      else
+        bits.d = (jdouble) aVariant.val.u64;
+      return bits.j;
+    }
+    case nsXPTType::T_BOOL:
+      return aVariant.val.b ? 1 : 0;
+    case nsXPTType::T_CHAR:
+      return (jchar) aVariant.val.c;
+    case nsXPTType::T_WCHAR:
+      return (jchar) aVariant.val.wc;
+    case nsXPTType::T_VOID:
+      return reinterpret_cast<jlong>(aVariant.val.p);
+    default:
+      NS_WARNING("unexpected raw result type");
+      return 0;
   }
-  JavaXPCOMInstance* inst = static_cast<JavaXPCOMInstance*>(xpcom_obj);
-
-  // Get method info
-  PRUint16 methodIndex;
-  const nsXPTMethodInfo* methodInfo;
-  nsIInterfaceInfo* iinfo = inst->InterfaceInfo();
-  const char* methodName = env->GetStringUTFChars(aMethodName, nullptr);
-  rv = QueryMethodInfo(iinfo, methodName, &methodIndex, &methodInfo);
-  env->ReleaseStringUTFChars(aMethodName, methodName);
+}
 
-  if (NS_FAILED(rv)) {
-    ThrowException(env, rv, "GetMethodInfoForName failed");
-    return nullptr;
-  }
+/**
+ * Converts the given Java params, calls the XPCOM method described by
+ * <code>aPlan</code> on <code>aInst</code>, and converts any 'out' params and
+ * the result back to Java.  On failure, a Java exception is thrown, unless
+ * <code>aStatus</code> is given.
+ *
+ * @param aPrimParams   if not null, holds the raw values of all 'in' params
+ *                      of primitive types, indexed by param index; the
+ *                      matching elements of <code>aParams</code> are ignored
+ * @param aPrimCount    number of values in <code>aPrimParams</code>
+ * @param aParams       Java params, indexed by param index; can be null if
+ *                      all params are passed in <code>aPrimParams</code>
+ * @param aRawResult    if not null and the method returns a primitive type,
+ *                      holds the raw result on return, and no Java object is
+ *                      created for it
+ * @param aStatus       if not null, holds the result of the call on return,
+ *                      and no Java exception is thrown for a failed call
+ *
+ * @return  the Java result of the method call, or null
+ */
+static jobject
+InvokeXPCOMMethod(JNIEnv* env, JavaXPCOMInstance* inst,
+                  const JavaXPCOMMethodPlan* plan, const jlong* aPrimParams,
+                  PRUint32 aPrimCount, jobjectArray aParams,
+                  jlong* aRawResult, nsresult* aStatus)
+{
+  nsresult rv = NS_OK;
+  PRUint16 methodIndex = plan->MethodIndex();
+  const nsXPTMethodInfo* methodInfo = plan->MethodInfo();
 
 #ifdef DEBUG_JAVAXPCOM
   const char* ifaceName;
-  iinfo->GetNameShared(&ifaceName);
+  inst->InterfaceInfo()->GetNameShared(&ifaceName);
   LOG(("===> (XPCOM) %s::%s()\n", ifaceName, methodInfo->GetName()));
 #endif
 
+  nsJavaCallStats::AutoCall callStats(nsJavaCallStats::kJavaToXPCOM,
+                                      inst->InterfaceInfo(), methodIndex);
+
+  // All call-scoped temporaries come from this thread's arena, and are
+  // reclaimed together when 'mark' goes out of scope.
+  nsJavaCallArena* arena = nsJavaCallArena::Get();
+  nsJavaCallArena::Mark mark(arena);
+
   // Convert the Java params
-  PRUint8 paramCount = methodInfo->GetParamCount();
+  PRUint8 paramCount = plan->ParamCount();
   nsXPTCVariant* params = nullptr;
   if (paramCount)
   {
-    params = new nsXPTCVariant[paramCount];
-    if (!params) {
-      ThrowException(env, NS_ERROR_OUT_OF_MEMORY, "Can't create params array");
-      return nullptr;
-    }
-    memset(params, 0, paramCount * sizeof(nsXPTCVariant));
+    // Value-initialize each variant, so that 'val', 'ptr' and 'flags' start
+    // out zeroed as the conversion code below expects.
+    params = static_cast<nsXPTCVariant*>(
+               arena->Allocate(paramCount * sizeof(nsXPTCVariant)));
+    for (PRUint8 i = 0; i < paramCount; i++)
+      new (&params[i]) nsXPTCVariant();
 
-    PRBool foundDependentParam = PR_FALSE;
     for (PRUint8 i = 0; i < paramCount && NS_SUCCEEDED(rv); i++)
     {
       LOG(("\t Param %d: ", i));
-      const nsXPTParamInfo &paramInfo = methodInfo->GetParam(i);
-      params[i].type = paramInfo.GetType();
+      const JavaXPCOMParamPlan& paramPlan = plan->Param(i);
+      params[i].type = paramPlan.paramInfo->GetType();
 
-      if (params[i].type.IsDependent() && paramInfo.IsIn()) {
-        foundDependentParam = PR_TRUE;
+      // Dependent params are handled in a second pass, below
+      if (paramPlan.isDependent && paramPlan.isIn)
         continue;
-      }
-      
-      if (paramInfo.IsIn()) {
-        PRUint8 type = params[i].type.TagPart();
 
-        // get IID for interface params
-        nsID iid;
-        if (type == nsXPTType::T_INTERFACE) {
-          rv = GetIIDForMethodParam(iinfo, methodInfo, paramInfo, type,
-                                    methodIndex, params, PR_TRUE, iid);
+      if (paramPlan.isIn && paramPlan.isPrimitive && !paramPlan.isOut &&
+          aPrimParams) {
+        if (i >= aPrimCount) {
+          rv = NS_ERROR_ILLEGAL_VALUE;
+          break;
         }
-
-        if (NS_SUCCEEDED(rv)) {
-          jobject param = nullptr;
-          if (aParams && !paramInfo.IsRetval()) {
-            param = env->GetObjectArrayElement(aParams, i);
-          }
-          rv = SetupParams(env, param, type, paramInfo.IsOut(), iid, 0, 0,
-                           PR_FALSE, 0, params[i]);
+        SetupRawParam(paramPlan.type, aPrimParams[i], params[i]);
+      } else if (paramPlan.isDipper) {
+        rv = SetupDipperParam(arena, paramPlan.type, params[i]);
+      } else if (paramPlan.isIn) {
+        jobject param = nullptr;
+        if (aParams && !paramPlan.isRetval) {
+          param = env->GetObjectArrayElement(aParams, i);
         }
+        rv = SetupParams(env, param, paramPlan.type, paramPlan.isOut,
+                         paramPlan.iid, 0, 0, PR_FALSE, 0, params[i]);
       } else {
         LOG(("out/retval\n"));
-		params[i].SetIndirect();
-        //params[i].ptr = &(params[i].val);
-        //params[i].SetPtrIsData();
+        params[i].SetIndirect();
       }
     }
-    
+
     // Handle any dependent params by doing a second pass
-    if (foundDependentParam) {
-      
+    if (plan->HasDependentParams()) {
+
       for (PRUint8 j = 0; j < paramCount && NS_SUCCEEDED(rv); j++) {
-        
-        const nsXPTParamInfo &paramInfo = methodInfo->GetParam(j);
-        params[j].type = paramInfo.GetType();
 
-        if (!params[j].type.IsDependent())
+        const JavaXPCOMParamPlan& paramPlan = plan->Param(j);
+        if (!paramPlan.isDependent || !paramPlan.isIn)
           continue;
 
-        if (paramInfo.IsIn()) {
-          PRUint8 type = params[j].type.TagPart();
-
-          // is paramater an array or sized string?
-          PRUint8 arrayType = 0;
-          PRUint32 arraySize = 0;
-          PRBool isArray = params[j].type.IsArray();
-          PRBool isSizedString = isArray ? PR_FALSE :
-                   type == nsXPTType::T_PSTRING_SIZE_IS ||
-                   type == nsXPTType::T_PWSTRING_SIZE_IS;
-
-          if (isArray) {
-            // get array type
-            nsXPTType xpttype;
-            rv = iinfo->GetTypeForParam(methodIndex, &paramInfo, 1, &xpttype);
-            if (NS_FAILED(rv))
-              break;
-            arrayType = xpttype.TagPart();
-            // IDL 'octet' arrays are not 'promoted' to short, but kept as 'byte';
-            // therefore, treat as a signed 8bit value
-            if (arrayType == nsXPTType::T_U8)
-              arrayType = nsXPTType::T_I8;
-          }
-
-          if (isArray || isSizedString) {
-            // get size of array or string
-            PRUint8 argnum;
-            rv = iinfo->GetSizeIsArgNumberForParam(methodIndex, &paramInfo, 0,
-                                                   &argnum);
-            if (NS_FAILED(rv))
-              break;
-            arraySize = params[argnum].val.u32;
-          }
+        PRUint32 arraySize = plan->GetArraySize(j, params);
 
-          // get IID for interface params
-          nsID iid;
-          if (type == nsXPTType::T_INTERFACE_IS ||
-              type == nsXPTType::T_ARRAY &&
-                (arrayType == nsXPTType::T_INTERFACE ||
-                 arrayType == nsXPTType::T_INTERFACE_IS))
-          {
-            PRUint8 paramType = type == nsXPTType::T_ARRAY ? arrayType : type;
-            rv = GetIIDForMethodParam(iinfo, methodInfo, paramInfo, paramType,
-                                      methodIndex, params, PR_TRUE, iid);
-          }
+        // get IID for interface params
+        nsID iid;
+        if (paramPlan.isInterface) {
+          rv = plan->GetIID(j, params, iid);
+          if (NS_FAILED(rv))
+            break;
+        }
 
-          if (NS_SUCCEEDED(rv)) {
-            jobject param = nullptr;
-            if (aParams && !paramInfo.IsRetval()) {
-              param = env->GetObjectArrayElement(aParams, j);
-            }
-            rv = SetupParams(env, param, type, paramInfo.IsOut(), iid, arrayType,
-                             arraySize, PR_FALSE, 0, params[j]);
-          }
+        jobject param = nullptr;
+        if (aParams && !paramPlan.isRetval) {
+          param = env->GetObjectArrayElement(aParams, j);
         }
+        rv = SetupParams(env, param, paramPlan.type, paramPlan.isOut, iid,
+                         paramPlan.arrayType, arraySize, PR_FALSE, 0,
+                         params[j]);
       }
     }
-    
+
     if (NS_FAILED(rv)) {
-      ThrowException(env, rv, "SetupParams failed");
+      if (aStatus)
+        *aStatus = rv;
+      else
+        ThrowException(env, rv, "SetupParams failed");
       return nullptr;
     }
   }
 
-  // Call the XPCOM method
-  const nsIID* iid;
-  iinfo->GetIIDShared(&iid);
-  nsISupports* realObject;
-  rv = inst->GetInstance()->QueryInterface(*iid, (void**) &realObject);
-  if (NS_FAILED(rv)) {
-    ThrowException(env, rv, "Failed to get real XPCOM object");
-    return nullptr;
-  }
-  nsresult invokeResult = NS_InvokeByIndex(realObject, methodIndex,
+  // Call the XPCOM method.  The instance holds a reference to the interface
+  // pointer, which keeps it alive for the duration of the call.
+  callStats.BeginInvoke();
+  nsresult invokeResult = NS_InvokeByIndex(inst->GetInterface(), methodIndex,
                                            paramCount, params);
-  NS_RELEASE(realObject);
+  callStats.EndInvoke();
 
   // Clean up params
   jobject result = nullptr;
   for (PRUint8 i = 0; i < paramCount && NS_SUCCEEDED(rv); i++)
   {
-    const nsXPTParamInfo &paramInfo = methodInfo->GetParam(i);
-    PRUint8 type = paramInfo.GetType().TagPart();
-
-    // is paramater an array or sized string?
-    PRUint8 arrayType = 0;
-    PRUint32 arraySize = 0;
-    PRBool isArray = params[i].type.IsArray();
-    PRBool isSizedString = isArray ? PR_FALSE :
-             type == nsXPTType::T_PSTRING_SIZE_IS ||
-             type == nsXPTType::T_PWSTRING_SIZE_IS;
-
-    if (isArray) {
-      // get array type
-      nsXPTType array_xpttype;
-      rv = iinfo->GetTypeForParam(methodIndex, &paramInfo, 1, &array_xpttype);
-      if (NS_FAILED(rv))
-        break;
-      arrayType = array_xpttype.TagPart();
-      // IDL 'octet' arrays are not 'promoted' to short, but kept as 'byte';
-      // therefore, treat as a signed 8bit value
-      if (arrayType == nsXPTType::T_U8)
-        arrayType = nsXPTType::T_I8;
-    }
-
-    if (isArray || isSizedString) {
-      // get size of array
-      PRUint8 argnum;
-      rv = iinfo->GetSizeIsArgNumberForParam(methodIndex, &paramInfo, 0,
-                                             &argnum);
-      if (NS_FAILED(rv))
-        break;
-      arraySize = params[argnum].val.u32;
-    }
+    const JavaXPCOMParamPlan& paramPlan = plan->Param(i);
+    PRUint32 arraySize = plan->GetArraySize(i, params);
 
     // get IID for interface params
     nsID iid;
-    if (type == nsXPTType::T_INTERFACE || type == nsXPTType::T_INTERFACE_IS ||
-        type == nsXPTType::T_ARRAY && (arrayType == nsXPTType::T_INTERFACE ||
-                                       arrayType == nsXPTType::T_INTERFACE_IS))
-    {
-      PRUint8 paramType = type == nsXPTType::T_ARRAY ? arrayType : type;
-      rv = GetIIDForMethodParam(iinfo, methodInfo, paramInfo, paramType,
-                                methodIndex, params, PR_TRUE, iid);
+    if (paramPlan.isInterface) {
+      rv = plan->GetIID(i, params, iid);
       if (NS_FAILED(rv))
         break;
     }
 
+    // Nothing to do for raw 'in' params; raw results are returned directly
+    if (paramPlan.isPrimitive) {
+      if (paramPlan.isRetval && aRawResult) {
+        if (NS_SUCCEEDED(invokeResult))
+          *aRawResult = GetRawResult(paramPlan.type, params[i]);
+        continue;
+      }
+      if (!paramPlan.isOut && aPrimParams)
+        continue;
+    }
+
+    jobject element = nullptr;
     jobject* javaElement;
-    if (!paramInfo.IsRetval()) {
-      jobject element = env->GetObjectArrayElement(aParams, i);
+    if (!paramPlan.isRetval) {
+      if (aParams)
+        element = env->GetObjectArrayElement(aParams, i);
       javaElement = &element;
     } else {
       javaElement = &result;
     }
-    rv = FinalizeParams(env, paramInfo, type, params[i], iid, PR_FALSE,
-                        arrayType, arraySize, 0, invokeResult, javaElement);
+
+    // An octet array or sized string is returned as a direct ByteBuffer if
+    // the caller passed a ByteBuffer[] holder in its slot of aParams.  For
+    // 'retval' params, that slot is otherwise unused.
+    if (paramPlan.isOut && aParams &&
+        IsDirectBufferType(paramPlan.type, paramPlan.arrayType)) {
+      jobject holder = element;
+      if (paramPlan.isRetval && i < env->GetArrayLength(aParams))
+        holder = env->GetObjectArrayElement(aParams, i);
+      if (holder && env->IsInstanceOf(holder, byteBufferArrayClass)) {
+        rv = FinalizeDirectBuffer(env, params[i], arraySize, invokeResult,
+                                  static_cast<jobjectArray>(holder),
+                                  paramPlan.isRetval ? &result : nullptr);
+        continue;
+      }
+    }
+
+    // Likewise, an interface array is returned as a lazily converted
+    // java.util.List if the caller passed a List[] holder.
+    if (paramPlan.isOut && aParams && paramPlan.type == nsXPTType::T_ARRAY &&
+        IsInterfaceArrayType(paramPlan.arrayType)) {
+      jobject holder = element;
+      if (paramPlan.isRetval && i < env->GetArrayLength(aParams))
+        holder = env->GetObjectArrayElement(aParams, i);
+      if (holder && env->IsInstanceOf(holder, listArrayClass)) {
+        rv = FinalizeInterfaceList(env, params[i], arraySize, iid,
+                                   invokeResult,
+                                   static_cast<jobjectArray>(holder),
+                                   paramPlan.isRetval ? &result : nullptr);
+        continue;
+      }
+    }
+
+    rv = FinalizeParams(env, *paramPlan.paramInfo, paramPlan.type, params[i],
+                        iid, PR_FALSE, paramPlan.arrayType, arraySize, 0,
+                        invokeResult, javaElement);
   }
 
   // Normally, we would delete any created nsID object in the above loop.
-  // However, GetIIDForMethodParam may need some of the nsID params when it's
-  // looking for the IID of an INTERFACE_IS.  Therefore, we can't delete it
-  // until we've gone through the 'Finalize' loop once and created the result.
+  // However, an INTERFACE_IS param may need some of the nsID params to get
+  // its IID.  Therefore, we can't delete it until we've gone through the
+  // 'Finalize' loop once and created the result.  'in' IIDs live in the call
+  // arena and need no cleanup.
   for (PRUint8 j = 0; j < paramCount; j++)
   {
-    const nsXPTParamInfo &paramInfo = methodInfo->GetParam(j);
-    const nsXPTType &type = paramInfo.GetType();
-    if (type.TagPart() == nsXPTType::T_IID) {
+    const JavaXPCOMParamPlan& paramPlan = plan->Param(j);
+    if (paramPlan.type == nsXPTType::T_IID && paramPlan.isOut) {
       nsID* iid = (nsID*) params[j].val.p;
       delete iid;
     }
   }
 
-  if (params) {
-    delete params;
+  if (aStatus) {
+    *aStatus = NS_FAILED(invokeResult) ? invokeResult : rv;
+    return NS_SUCCEEDED(rv) ? result : nullptr;
   }
 
   // If the XPCOM method invocation failed, we don't immediately throw an
@@ -1787,6 +2590,259 @@ JAVAPROXY_NATIVE(callXPCOMMethod) (JNIEnv *env, jclass that, jobject aJavaProxy,
   return result;
 }
 
+/**
+ * Returns the call plan for the given Java method of a proxy for
+ * <code>inst</code>.  On failure, a Java exception is thrown and null is
+ * returned.
+ */
+static const JavaXPCOMMethodPlan*
+GetProxyMethodPlan(JNIEnv* env, JavaXPCOMInstance* inst, jobject aMethod)
+{
+  nsIInterfaceInfo* iinfo = inst->InterfaceInfo();
+  jmethodID methodID = env->FromReflectedMethod(aMethod);
+  const JavaXPCOMMethodPlan* plan = nullptr;
+  if (methodID)
+    plan = gJavaMethodInfoMap->Find(methodID, iinfo);
+  if (plan)
+    return plan;
+
+  // First call of this method on this interface; look it up by name.
+  PRUint16 methodIndex;
+  const nsXPTMethodInfo* methodInfo;
+  nsresult rv = NS_ERROR_FAILURE;
+  jstring methodNameStr = (jstring) env->CallObjectMethod(aMethod,
+                                                          methodGetNameMID);
+  const char* methodName = nullptr;
+  if (methodNameStr)
+    methodName = env->GetStringUTFChars(methodNameStr, nullptr);
+  if (methodName) {
+    rv = QueryMethodInfo(iinfo, methodName, &methodIndex, &methodInfo);
+    env->ReleaseStringUTFChars(methodNameStr, methodName);
+  }
+
+  if (NS_FAILED(rv)) {
+    ThrowException(env, rv, "GetMethodInfoForName failed");
+    return nullptr;
+  }
+
+  rv = gJavaMethodPlanMap->GetPlan(iinfo, methodIndex, &plan);
+  if (NS_SUCCEEDED(rv) && methodID) {
+    rv = gJavaMethodInfoMap->Add(methodID, iinfo, plan);
+  }
+  if (NS_FAILED(rv)) {
+    ThrowException(env, rv, "Failed to create call plan");
+    return nullptr;
+  }
+  return plan;
+}
+
+/**
+ *  org.mozilla.xpcom.XPCOMJavaProxy.internal.callXPCOMMethod
+ */
+extern "C" NS_EXPORT jobject JNICALL
+JAVAPROXY_NATIVE(callXPCOMMethod) (JNIEnv *env, jclass that, jobject aJavaProxy,
+                                   jobject aMethod, jobjectArray aParams)
+{
+  nsresult rv;
+
+  // Get native XPCOM instance
+  void* xpcom_obj;
+  rv = GetXPCOMInstFromProxy(env, aJavaProxy, &xpcom_obj);
+  if (NS_FAILED(rv)) {
+    ThrowException(env, rv, "Failed to get matching XPCOM object");
+    return nullptr;
+  }
+  JavaXPCOMInstance* inst = static_cast<JavaXPCOMInstance*>(xpcom_obj);
+
+  // Get the call plan for this method
+  const JavaXPCOMMethodPlan* plan = GetProxyMethodPlan(env, inst, aMethod);
+  if (!plan)
+    return nullptr;
+
+  return InvokeXPCOMMethod(env, inst, plan, nullptr, 0, aParams, nullptr,
+                           nullptr);
+}
+
+/**
+ * Returns the call plan for a method called through an XPCOMJavaBinding.  On
+ * failure, a Java exception is thrown and null is returned.
+ */
+static const JavaXPCOMMethodPlan*
+GetBindingMethodPlan(JNIEnv* env, JavaXPCOMInstance* inst, jint aMethodIndex)
+{
+  if (!inst || aMethodIndex < 0 || aMethodIndex > (jint) PR_UINT16_MAX) {
+    ThrowException(env, NS_ERROR_ILLEGAL_VALUE, "Invalid XPCOM method call");
+    return nullptr;
+  }
+
+  const JavaXPCOMMethodPlan* plan;
+  nsresult rv = gJavaMethodPlanMap->GetPlan(inst->InterfaceInfo(),
+                                            (PRUint16) aMethodIndex, &plan);
+  if (NS_FAILED(rv)) {
+    ThrowException(env, rv, "Failed to create call plan");
+    return nullptr;
+  }
+  return plan;
+}
+
+/**
+ * Calls a method through an XPCOMJavaBinding.  The raw params are copied out
+ * of <code>aPrimParams</code> in one go, rather than one at a time.
+ *
+ * The instance is read from the binding here, rather than being passed in by
+ * Java, so that the binding stays reachable (and its instance isn't released)
+ * until the call returns.
+ */
+static jobject
+InvokeBindingMethod(JNIEnv* env, jobject aBinding, jint aMethodIndex,
+                    jlongArray aPrimParams, jobjectArray aParams,
+                    jlong* aRawResult)
+{
+  JavaXPCOMInstance* inst = reinterpret_cast<JavaXPCOMInstance*>(
+               env->GetLongField(aBinding, xpcomJavaBindingNativePtrFID));
+  const JavaXPCOMMethodPlan* plan = GetBindingMethodPlan(env, inst,
+                                                         aMethodIndex);
+  if (!plan)
+    return nullptr;
+
+  nsJavaCallArena* arena = nsJavaCallArena::Get();
+  nsJavaCallArena::Mark mark(arena);
+
+  jlong* primParams = nullptr;
+  PRUint32 primCount = 0;
+  if (aPrimParams) {
+    primCount = env->GetArrayLength(aPrimParams);
+    primParams = static_cast<jlong*>(arena->Allocate(primCount * sizeof(jlong)));
+    env->GetLongArrayRegion(aPrimParams, 0, primCount, primParams);
+  }
+
+  return InvokeXPCOMMethod(env, inst, plan, primParams, primCount, aParams,
+                           aRawResult, nullptr);
+}
+
+/**
+ *  org.mozilla.xpcom.internal.XPCOMJavaBinding.callXPCOMMethod
+ */
+extern "C" NS_EXPORT jobject JNICALL
+JAVABINDING_NATIVE(callXPCOMMethod) (JNIEnv *env, jobject that,
+                                     jint aMethodIndex,
+                                     jlongArray aPrimParams,
+                                     jobjectArray aParams)
+{
+  return InvokeBindingMethod(env, that, aMethodIndex, aPrimParams, aParams,
+                             nullptr);
+}
+
+/**
+ *  org.mozilla.xpcom.internal.XPCOMJavaBinding.callXPCOMMethodRaw
+ */
+extern "C" NS_EXPORT jlong JNICALL
+JAVABINDING_NATIVE(callXPCOMMethodRaw) (JNIEnv *env, jobject that,
+                                        jint aMethodIndex,
+                                        jlongArray aPrimParams,
+                                        jobjectArray aParams)
+{
+  jlong result = 0;
+  InvokeBindingMethod(env, that, aMethodIndex, aPrimParams, aParams, &result);
+  return result;
+}
+
+/**
+ * An XPCOMBatch call starts with two slots: the native instance of the
+ * proxy, and the method index with the number of argument slots that follow
+ * in bits 16-23.  Each argument slot holds the raw value of a primitive
+ * 'in' param; all other params are taken from the call's Object[].
+ */
+#define BATCH_CALL_HEADER_SLOTS   2
+#define BATCH_RESULT_SLOTS        2
+
+/**
+ *  org.mozilla.xpcom.internal.XPCOMBatch.invoke
+ */
+extern "C" NS_EXPORT jint JNICALL
+JAVABATCH_NATIVE(invoke) (JNIEnv *env, jclass that, jobject aCalls,
+                          jint aCallCount, jobjectArray aArgs,
+                          jobject aResults, jobjectArray aResultObjects)
+{
+  const jlong* calls = static_cast<const jlong*>(
+                         env->GetDirectBufferAddress(aCalls));
+  jlong* results = static_cast<jlong*>(env->GetDirectBufferAddress(aResults));
+  jlong callSlots = env->GetDirectBufferCapacity(aCalls) / sizeof(jlong);
+  jlong resultSlots = env->GetDirectBufferCapacity(aResults) / sizeof(jlong);
+  if (!calls || !results || aCallCount < 0 ||
+      resultSlots < (jlong) aCallCount * BATCH_RESULT_SLOTS) {
+    ThrowException(env, NS_ERROR_ILLEGAL_VALUE, "Invalid XPCOM call batch");
+    return 0;
+  }
+
+  jlong pos = 0;
+  jint c;
+  for (c = 0; c < aCallCount; c++) {
+    if (pos + BATCH_CALL_HEADER_SLOTS > callSlots)
+      break;
+    JavaXPCOMInstance* inst = reinterpret_cast<JavaXPCOMInstance*>(calls[pos]);
+    PRUint16 methodIndex = (PRUint16) (calls[pos + 1] & 0xffff);
+    PRUint32 argCount = (PRUint32) ((calls[pos + 1] >> 16) & 0xff);
+    pos += BATCH_CALL_HEADER_SLOTS;
+    if (pos + argCount > callSlots)
+      break;
+    const jlong* primParams = calls + pos;
+    pos += argCount;
+
+    // A bad call fails on its own, without stopping the rest of the batch
+    nsresult status = NS_ERROR_ILLEGAL_VALUE;
+    jlong rawResult = 0;
+    const JavaXPCOMMethodPlan* plan = nullptr;
+    if (inst) {
+      status = gJavaMethodPlanMap->GetPlan(inst->InterfaceInfo(), methodIndex,
+                                           &plan);
+    }
+
+    if (NS_SUCCEEDED(status)) {
+      if (env->PushLocalFrame(4) < 0)
+        break;
+      jobjectArray args = (jobjectArray) env->GetObjectArrayElement(aArgs, c);
+      jobject result = InvokeXPCOMMethod(env, inst, plan, primParams, argCount,
+                                         args, &rawResult, &status);
+      if (result)
+        env->SetObjectArrayElement(aResultObjects, c, result);
+      env->PopLocalFrame(nullptr);
+    }
+
+    results[c * BATCH_RESULT_SLOTS] = (jlong) (PRUint32) status;
+    results[c * BATCH_RESULT_SLOTS + 1] = rawResult;
+
+    // Calls can't go on with a Java exception pending; it is thrown to the
+    // caller of execute() instead.
+    if (env->ExceptionCheck())
+      return c + 1;
+  }
+
+  if (c < aCallCount) {
+    ThrowException(env, NS_ERROR_ILLEGAL_VALUE, "Invalid XPCOM call batch");
+  }
+  return c;
+}
+
+/**
+ *  org.mozilla.xpcom.internal.XPCOMBatch.resolveMethod
+ */
+extern "C" NS_EXPORT jint JNICALL
+JAVABATCH_NATIVE(resolveMethod) (JNIEnv *env, jclass that,
+                                 jlong aXPCOMInstance, jobject aMethod)
+{
+  JavaXPCOMInstance* inst = reinterpret_cast<JavaXPCOMInstance*>(aXPCOMInstance);
+  if (!inst || !aMethod) {
+    ThrowException(env, NS_ERROR_ILLEGAL_VALUE, "Invalid XPCOM method");
+    return -1;
+  }
+
+  const JavaXPCOMMethodPlan* plan = GetProxyMethodPlan(env, inst, aMethod);
+  if (!plan)
+    return -1;
+  return plan->MethodIndex();
+}
+
 nsresult
 GetNewOrUsedJavaWrapper(JNIEnv* env, nsISupports* aXPCOMObject,
                         const nsIID& aIID, jobject aObjectLoader,
@@ -1810,62 +2866,56 @@ GetNewOrUsedJavaWrapper(JNIEnv* env, nsISupports* aXPCOMObject,
   // No Java object is associated with the given XPCOM object, so we
   // create a Java proxy.
 
-  nsCOMPtr<nsIInterfaceInfoManager>
-    iim(do_GetService(NS_INTERFACEINFOMANAGER_SERVICE_CONTRACTID));
-  NS_ASSERTION(iim, "Failed to get InterfaceInfoManager");
-  if (!iim)
-    return NS_ERROR_FAILURE;
-
-  // Get interface info for class
+  // Get interface info and Java interface for class
   nsCOMPtr<nsIInterfaceInfo> info;
-  rv = iim->GetInfoForIID(&aIID, getter_AddRefs(info));
+  jclass ifaceClass;
+  rv = gJavaInterfaceClassMap->GetClass(env, aIID, aObjectLoader, &ifaceClass,
+                                        getter_AddRefs(info));
   if (NS_FAILED(rv))
     return rv;
 
-  // Wrap XPCOM object (addrefs rootObject)
-  JavaXPCOMInstance* inst = new JavaXPCOMInstance(rootObject, info);
-  if (!inst)
-    return NS_ERROR_OUT_OF_MEMORY;
+  // Get the pointer for the requested interface once, rather than on every
+  // method call
+  nsCOMPtr<nsISupports> ifaceObject;
+  rv = rootObject->QueryInterface(aIID, getter_AddRefs(ifaceObject));
+  if (NS_FAILED(rv)) {
+    env->DeleteLocalRef(ifaceClass);
+    return rv;
+  }
 
-  // Get interface name
-  const char* iface_name;
-  rv = info->GetNameShared(&iface_name);
+  // Wrap XPCOM object (addrefs rootObject and ifaceObject)
+  JavaXPCOMInstance* inst = new JavaXPCOMInstance(rootObject, ifaceObject,
+                                                  info);
+  if (!inst) {
+    env->DeleteLocalRef(ifaceClass);
+    return NS_ERROR_OUT_OF_MEMORY;
+  }
 
-  if (NS_SUCCEEDED(rv)) {
-    jobject java_obj = nullptr;
-
-    // Create proper Java interface name
-    nsEmbedCString class_name("org.mozilla.interfaces.");
-    class_name.AppendASCII(iface_name);
-    jclass ifaceClass = FindClassInLoader(env, aObjectLoader, class_name.get());
-
-    if (ifaceClass) {
-      java_obj = env->CallStaticObjectMethod(xpcomJavaProxyClass,
-                                             createProxyMID, ifaceClass,
-                                             reinterpret_cast<jlong>(inst));
-      if (env->ExceptionCheck())
-        java_obj = nullptr;
-    }
+  jobject java_obj = env->CallStaticObjectMethod(xpcomJavaProxyClass,
+                                                 createProxyMID, ifaceClass,
+                                                 reinterpret_cast<jlong>(inst));
+  if (env->ExceptionCheck())
+    java_obj = nullptr;
+  env->DeleteLocalRef(ifaceClass);
 
-    if (java_obj) {
+  if (java_obj) {
 #ifdef DEBUG_JAVAXPCOM
-      char* iid_str = aIID.ToString();
-      LOG(("+ CreateJavaProxy (Java=%08x | XPCOM=%08x | IID=%s)\n",
-           (PRUint32) env->CallStaticIntMethod(systemClass, hashCodeMID,
-                                               java_obj),
-           (PRUint32) rootObject.get(), iid_str));
-      NS_Free(iid_str);
+    char* iid_str = aIID.ToString();
+    LOG(("+ CreateJavaProxy (Java=%08x | XPCOM=%08x | IID=%s)\n",
+         (PRUint32) env->CallStaticIntMethod(systemClass, hashCodeMID,
+                                             java_obj),
+         (PRUint32) rootObject.get(), iid_str));
+    NS_Free(iid_str);
 #endif
 
-      // Associate XPCOM object with Java proxy
-      rv = gNativeToJavaProxyMap->Add(env, rootObject, aIID, java_obj);
-      if (NS_SUCCEEDED(rv)) {
-        *aResult = java_obj;
-        return NS_OK;
-      }
-    } else {
-      rv = NS_ERROR_FAILURE;
+    // Associate XPCOM object with Java proxy
+    rv = gNativeToJavaProxyMap->Add(env, inst, aIID, java_obj);
+    if (NS_SUCCEEDED(rv)) {
+      *aResult = java_obj;
+      return NS_OK;
     }
+  } else {
+    rv = NS_ERROR_FAILURE;
   }
 
   // If there was an error, clean up.
@@ -1880,8 +2930,25 @@ GetXPCOMInstFromProxy(JNIEnv* env, jobject aJavaObject, void** aResult)
   if (!aResult)
     return NS_ERROR_NULL_POINTER;
 
-  jlong xpcom_obj = env->CallStaticLongMethod(xpcomJavaProxyClass,
-                                            getNativeXPCOMInstMID, aJavaObject);
+  if (!aJavaObject)
+    return NS_ERROR_FAILURE;
+
+  // Read the pointer straight out of the binding, or out of the proxy's
+  // invocation handler, rather than calling back into Java for it.
+  jlong xpcom_obj = 0;
+  if (env->IsInstanceOf(aJavaObject, xpcomJavaBindingClass)) {
+    xpcom_obj = env->GetLongField(aJavaObject, xpcomJavaBindingNativePtrFID);
+  } else if (!proxyHandlerFID) {
+    xpcom_obj = env->CallStaticLongMethod(xpcomJavaProxyClass,
+                                          getNativeXPCOMInstMID, aJavaObject);
+  } else if (env->IsInstanceOf(aJavaObject, proxyClass)) {
+    jobject handler = env->GetObjectField(aJavaObject, proxyHandlerFID);
+    if (handler && env->IsInstanceOf(handler, xpcomJavaProxyClass)) {
+      xpcom_obj = env->GetLongField(handler, xpcomJavaProxyNativePtrFID);
+    }
+    if (handler)
+      env->DeleteLocalRef(handler);
+  }
 
   if (!xpcom_obj || env->ExceptionCheck()) {
     return NS_ERROR_FAILURE;
@@ -1904,18 +2971,30 @@ GetXPCOMInstFromProxy(JNIEnv* env, jobject aJavaObject, void** aResult)
 }
 
 /**
- *  org.mozilla.xpcom.internal.XPCOMJavaProxy.finalizeProxy
+ *  org.mozilla.xpcom.internal.XPCOMJavaProxy.releaseInstances
  */
 extern "C" NS_EXPORT void JNICALL
-JAVAPROXY_NATIVE(finalizeProxy) (JNIEnv *env, jclass that, jobject aJavaProxy)
+JAVAPROXY_NATIVE(releaseInstances) (JNIEnv *env, jclass that,
+                                    jlongArray aXPCOMInstances)
 {
-#ifdef DEBUG_JAVAXPCOM
-  PRUint32 xpcom_addr = 0;
-#endif
-
-  // Due to Java's garbage collection, this finalize statement may get called
-  // after FreeJavaGlobals().  So check to make sure that everything is still
+  jsize count = env->GetArrayLength(aXPCOMInstances);
+  jlong* instances = env->GetLongArrayElements(aXPCOMInstances, nullptr);
+  if (!instances)
+    return;
+
+  // Entries are unlinked from the proxy map while holding gJavaXPCOMLock,
+  // but their weak references are only cleared once it has been released.
+  nsJavaCallArena* arena = nsJavaCallArena::Get();
+  nsJavaCallArena::Mark mark(arena);
+  NativeToJavaProxyMap::ProxyList** removed =
+    static_cast<NativeToJavaProxyMap::ProxyList**>(
+      arena->Allocate(count * sizeof(NativeToJavaProxyMap::ProxyList*)));
+  memset(removed, 0, count * sizeof(NativeToJavaProxyMap::ProxyList*));
+
+  // Due to Java's garbage collection, this may get called after
+  // FreeJavaGlobals().  So check to make sure that everything is still
   // initialized.
+  PRBool initialized = PR_FALSE;
   if (gJavaXPCOMLock) {
     nsAutoLock lock(gJavaXPCOMLock);
 
@@ -1924,35 +3003,28 @@ JAVAPROXY_NATIVE(finalizeProxy) (JNIEnv *env, jclass that, jobject aJavaProxy)
     // FreeGlobals releases its lock.  At that point, we resume this thread
     // here, but JavaXPCOM may no longer be initialized.  So we need to check
     // that everything is legit after acquiring the lock.
-    if (gJavaXPCOMInitialized) {
-      // Get native XPCOM instance
-      void* xpcom_obj;
-      nsresult rv = GetXPCOMInstFromProxy(env, aJavaProxy, &xpcom_obj);
-      if (NS_SUCCEEDED(rv)) {
-        JavaXPCOMInstance* inst = static_cast<JavaXPCOMInstance*>(xpcom_obj);
-#ifdef DEBUG_JAVAXPCOM
-        xpcom_addr = reinterpret_cast<PRUint32>(inst->GetInstance());
-#endif
-        nsIID* iid;
-        rv = inst->InterfaceInfo()->GetInterfaceIID(&iid);
-        if (NS_SUCCEEDED(rv)) {
-          rv = gNativeToJavaProxyMap->Remove(env, inst->GetInstance(), *iid);
-          moz_free(iid);
-        }
-        NS_ASSERTION(NS_SUCCEEDED(rv), "Failed to RemoveJavaProxy");
-        // Release gJavaXPCOMLock before deleting inst (see bug 340022)
-        lock.unlock();
-        delete inst;
-      }
+    initialized = gJavaXPCOMInitialized;
+    for (jsize i = 0; initialized && i < count; i++) {
+      JavaXPCOMInstance* inst =
+                      reinterpret_cast<JavaXPCOMInstance*>(instances[i]);
+      nsresult rv = gNativeToJavaProxyMap->Remove(inst, &removed[i]);
+      NS_ASSERTION(NS_SUCCEEDED(rv), "Failed to RemoveJavaProxy");
     }
   }
 
+  // Release gJavaXPCOMLock before deleting the instances (see bug 340022)
+  for (jsize i = 0; initialized && i < count; i++) {
+    if (removed[i])
+      NativeToJavaProxyMap::ReleaseRemoved(env, removed[i]);
+
+    JavaXPCOMInstance* inst = reinterpret_cast<JavaXPCOMInstance*>(instances[i]);
 #ifdef DEBUG_JAVAXPCOM
-  LOG(("- Finalize (Java=%08x | XPCOM=%08x)\n",
-       (PRUint32) env->CallStaticIntMethod(systemClass, hashCodeMID,
-                                           aJavaProxy),
-       xpcom_addr));
+    LOG(("- Release (XPCOM=%08x)\n", (PRUint32) inst->GetInstance()));
 #endif
+    delete inst;
+  }
+
+  env->ReleaseLongArrayElements(aXPCOMInstances, instances, JNI_ABORT);
 }
 
 /**
@@ -1992,3 +3064,98 @@ LOCKPROXY_NATIVE(release) (JNIEnv *env, jclass that, jlong aLockObject)
   }
   NS_ASSERTION(NS_SUCCEEDED(rv), "Failed to release using NS_ProxyRelease");
 }
+
+/**
+ *  org.mozilla.xpcom.internal.XPCOMDirectBuffer.freeBuffer
+ */
+extern "C" NS_EXPORT void JNICALL
+DIRECTBUFFER_NATIVE(freeBuffer) (JNIEnv *env, jclass that, jlong aAddress)
+{
+  moz_free(reinterpret_cast<void*>(aAddress));
+}
+
+/**
+ *  org.mozilla.xpcom.internal.XPCOMInterfaceList.wrapElement
+ */
+extern "C" NS_EXPORT jobject JNICALL
+INTERFACELIST_NATIVE(wrapElement) (JNIEnv *env, jclass that, jlong aArray,
+                                   jint aIndex)
+{
+  // The proxy map is gone once JavaXPCOM has been shut down
+  if (!gJavaXPCOMInitialized) {
+    ThrowException(env, NS_ERROR_NOT_INITIALIZED,
+                   "JavaXPCOM has been shut down");
+    return nullptr;
+  }
+
+  InterfaceListArray* array = reinterpret_cast<InterfaceListArray*>(aArray);
+  nsISupports* xpcom_obj = array->elements[aIndex];
+  if (!xpcom_obj)
+    return nullptr;
+
+  jobject java_obj = nullptr;
+  nsresult rv = NativeInterfaceToJavaObject(env, xpcom_obj, array->iid,
+                                            nullptr, &java_obj);
+  if (NS_FAILED(rv)) {
+    ThrowException(env, rv, "Failed to create Java object for array element");
+    return nullptr;
+  }
+  return java_obj;
+}
+
+/**
+ *  org.mozilla.xpcom.internal.XPCOMInterfaceList.releaseArray
+ */
+extern "C" NS_EXPORT void JNICALL
+INTERFACELIST_NATIVE(releaseArray) (JNIEnv *env, jclass that, jlong aArray)
+{
+  InterfaceListArray* array = reinterpret_cast<InterfaceListArray*>(aArray);
+
+  // The elements may only be released on the main thread.  This is also
+  // called during shutdown, for the lists that are still alive, so it
+  // doesn't depend on gJavaXPCOMInitialized.
+  for (PRUint32 i = 0; i < array->size; i++) {
+    nsJavaReleaseQueue::Release(array->elements[i]);
+  }
+  PR_Free(array->elements);
+  delete array;
+}
+
+// Runs the calls queued by XPCOMAsyncQueue on the main thread
+class AsyncQueueDrainer : public nsRunnable
+{
+public:
+  NS_IMETHOD Run();
+};
+
+NS_IMETHODIMP
+AsyncQueueDrainer::Run()
+{
+  if (!gJavaXPCOMInitialized)
+    return NS_OK;
+
+  JNIEnv* env = GetJNIEnv();
+  env->CallStaticVoidMethod(xpcomAsyncQueueClass, drainAsyncQueueMID);
+
+  // Exceptions thrown by the calls complete their futures; anything else
+  // has nowhere to go.
+  if (env->ExceptionCheck()) {
+    NS_WARNING("XPCOMAsyncQueue.drain() threw an exception");
+    env->ExceptionClear();
+  }
+  return NS_OK;
+}
+
+/**
+ *  org.mozilla.xpcom.internal.XPCOMAsyncQueue.scheduleDrain
+ */
+extern "C" NS_EXPORT jboolean JNICALL
+ASYNCQUEUE_NATIVE(scheduleDrain) (JNIEnv *env, jclass that)
+{
+  if (!gJavaXPCOMInitialized)
+    return JNI_FALSE;
+
+  nsCOMPtr<nsIRunnable> drainer = new AsyncQueueDrainer();
+  nsresult rv = NS_DispatchToMainThread(drainer);
+  return NS_SUCCEEDED(rv) ? JNI_TRUE : JNI_FALSE;
+}
@@ -45,13 +45,30 @@
 #include "nsIInterfaceInfoManager.h"
 #include "nsILocalFile.h"
 #include "nsThreadUtils.h"
-#include "nsProxyRelease.h"
+#include "nsJavaReleaseQueue.h"
+#include "nsJavaCallArena.h"
+#include "nsJavaCallStats.h"
+#include "nsJavaUTF8.h"
+#include "prenv.h"
 
 
 /* Java JNI globals */
 
 JavaVM* gCachedJVM = nullptr;
 
+// Thread-private index holding a JNIThreadState for each thread that has
+// called GetJNIEnv().
+static PRUintn gJNIEnvIndex = 0;
+static PRBool gJNIEnvIndexCreated = PR_FALSE;
+
+struct JNIThreadState
+{
+  JNIEnv* env;
+  PRBool  attached;   // PR_TRUE if GetJNIEnv() attached this thread
+};
+
+static void PR_CALLBACK ReleaseJNIThreadState(void* aData);
+
 jclass systemClass = nullptr;
 jclass booleanClass = nullptr;
 jclass charClass = nullptr;
@@ -64,9 +81,20 @@ jclass doubleClass = nullptr;
 jclass stringClass = nullptr;
 jclass nsISupportsClass = nullptr;
 jclass xpcomExceptionClass = nullptr;
+jclass outOfMemoryErrorClass = nullptr;
+jclass fileClass = nullptr;
 jclass xpcomJavaProxyClass = nullptr;
+jclass xpcomJavaBindingClass = nullptr;
+jclass proxyClass = nullptr;
 jclass weakReferenceClass = nullptr;
 jclass javaXPCOMUtilsClass = nullptr;
+jclass byteBufferClass = nullptr;
+jclass byteBufferArrayClass = nullptr;
+jclass xpcomDirectBufferClass = nullptr;
+jclass xpcomProxyReferenceClass = nullptr;
+jclass listArrayClass = nullptr;
+jclass xpcomInterfaceListClass = nullptr;
+jclass xpcomAsyncQueueClass = nullptr;
 
 jmethodID hashCodeMID = nullptr;
 jmethodID booleanValueMID = nullptr;
@@ -92,6 +120,22 @@ jmethodID weakReferenceConstructorMID = nullptr;
 jmethodID getReferentMID = nullptr;
 jmethodID clearReferentMID = nullptr;
 jmethodID findClassInLoaderMID = nullptr;
+jmethodID getClassLoaderMID = nullptr;
+jmethodID methodGetNameMID = nullptr;
+jmethodID trackDirectBufferMID = nullptr;
+jmethodID clearProxyReferencesMID = nullptr;
+jmethodID interfaceListInitMID = nullptr;
+jmethodID releaseInterfaceListsMID = nullptr;
+jmethodID drainAsyncQueueMID = nullptr;
+jmethodID shutdownAsyncQueueMID = nullptr;
+jmethodID xpcomExceptionInitMID = nullptr;
+jmethodID xpcomExceptionInitWithMessageMID = nullptr;
+jmethodID fileGetCanonicalPathMID = nullptr;
+
+jfieldID xpcomExceptionErrorcodeFID = nullptr;
+jfieldID xpcomJavaProxyNativePtrFID = nullptr;
+jfieldID xpcomJavaBindingNativePtrFID = nullptr;
+jfieldID proxyHandlerFID = nullptr;
 
 #ifdef DEBUG_JAVAXPCOM
 jmethodID getNameMID = nullptr;
@@ -100,6 +144,10 @@ jmethodID proxyToStringMID = nullptr;
 
 NativeToJavaProxyMap* gNativeToJavaProxyMap = nullptr;
 JavaToXPTCStubMap* gJavaToXPTCStubMap = nullptr;
+JavaStubClassMap* gJavaStubClassMap = nullptr;
+JavaMethodPlanMap* gJavaMethodPlanMap = nullptr;
+JavaMethodInfoMap* gJavaMethodInfoMap = nullptr;
+JavaInterfaceClassMap* gJavaInterfaceClassMap = nullptr;
 
 PRBool gJavaXPCOMInitialized = PR_FALSE;
 PRLock* gJavaXPCOMLock = nullptr;
@@ -149,6 +197,16 @@ InitializeJavaGlobals(JNIEnv *env)
     goto init_error;
   }
 
+  // Thread-private indices can't be freed, so only create this one once.
+  if (!gJNIEnvIndexCreated) {
+    if (PR_NewThreadPrivateIndex(&gJNIEnvIndex, ReleaseJNIThreadState)
+          != PR_SUCCESS) {
+      NS_WARNING("Failed to create JNIEnv thread-private index");
+      goto init_error;
+    }
+    gJNIEnvIndexCreated = PR_TRUE;
+  }
+
   jclass clazz;
   if (!(clazz = env->FindClass("java/lang/System")) ||
       !(systemClass = (jclass) env->NewGlobalRef(clazz)) ||
@@ -246,12 +304,32 @@ InitializeJavaGlobals(JNIEnv *env)
   }
 
   if (!(clazz = env->FindClass("org/mozilla/xpcom/XPCOMException")) ||
-      !(xpcomExceptionClass = (jclass) env->NewGlobalRef(clazz)))
+      !(xpcomExceptionClass = (jclass) env->NewGlobalRef(clazz)) ||
+      !(xpcomExceptionInitMID = env->GetMethodID(clazz, "<init>", "(J)V")) ||
+      !(xpcomExceptionInitWithMessageMID = env->GetMethodID(clazz, "<init>",
+                                               "(JLjava/lang/String;)V")) ||
+      !(xpcomExceptionErrorcodeFID = env->GetFieldID(clazz, "errorcode", "J")))
   {
     NS_WARNING("Problem creating org.mozilla.xpcom.XPCOMException globals");
     goto init_error;
   }
 
+  if (!(clazz = env->FindClass("java/lang/OutOfMemoryError")) ||
+      !(outOfMemoryErrorClass = (jclass) env->NewGlobalRef(clazz)))
+  {
+    NS_WARNING("Problem creating java.lang.OutOfMemoryError globals");
+    goto init_error;
+  }
+
+  if (!(clazz = env->FindClass("java/io/File")) ||
+      !(fileClass = (jclass) env->NewGlobalRef(clazz)) ||
+      !(fileGetCanonicalPathMID = env->GetMethodID(clazz, "getCanonicalPath",
+                                                   "()Ljava/lang/String;")))
+  {
+    NS_WARNING("Problem creating java.io.File globals");
+    goto init_error;
+  }
+
   if (!(clazz = env->FindClass("org/mozilla/xpcom/internal/XPCOMJavaProxy")) ||
       !(xpcomJavaProxyClass = (jclass) env->NewGlobalRef(clazz)) ||
       !(createProxyMID = env->GetStaticMethodID(clazz, "createProxy",
@@ -260,12 +338,39 @@ InitializeJavaGlobals(JNIEnv *env)
                                                     "(Ljava/lang/Object;)Z")) ||
       !(getNativeXPCOMInstMID = env->GetStaticMethodID(xpcomJavaProxyClass,
                                                        "getNativeXPCOMInstance",
-                                                       "(Ljava/lang/Object;)J")))
+                                                       "(Ljava/lang/Object;)J")) ||
+      !(xpcomJavaProxyNativePtrFID = env->GetFieldID(clazz, "nativeXPCOMPtr",
+                                                     "J")))
   {
     NS_WARNING("Problem creating org.mozilla.xpcom.internal.XPCOMJavaProxy globals");
     goto init_error;
   }
 
+  if (!(clazz = env->FindClass("org/mozilla/xpcom/internal/XPCOMJavaBinding")) ||
+      !(xpcomJavaBindingClass = (jclass) env->NewGlobalRef(clazz)) ||
+      !(xpcomJavaBindingNativePtrFID = env->GetFieldID(clazz, "nativeXPCOMPtr",
+                                                       "J")))
+  {
+    NS_WARNING("Problem creating org.mozilla.xpcom.internal.XPCOMJavaBinding globals");
+    goto init_error;
+  }
+
+  if (!(clazz = env->FindClass("java/lang/reflect/Proxy")) ||
+      !(proxyClass = (jclass) env->NewGlobalRef(clazz)))
+  {
+    NS_WARNING("Problem creating java.lang.reflect.Proxy globals");
+    goto init_error;
+  }
+
+  // The invocation handler of a Proxy is kept in its 'h' field.  That field
+  // is not part of the public API, so if it can't be found, proxies fall back
+  // to calling XPCOMJavaProxy.getNativeXPCOMInstance().
+  proxyHandlerFID = env->GetFieldID(proxyClass, "h",
+                                    "Ljava/lang/reflect/InvocationHandler;");
+  if (!proxyHandlerFID) {
+    env->ExceptionClear();
+  }
+
   if (!(clazz = env->FindClass("java/lang/ref/WeakReference")) ||
       !(weakReferenceClass = (jclass) env->NewGlobalRef(clazz)) ||
       !(weakReferenceConstructorMID = env->GetMethodID(weakReferenceClass, 
@@ -289,6 +394,75 @@ InitializeJavaGlobals(JNIEnv *env)
     goto init_error;
   }
 
+  if (!(clazz = env->FindClass("java/lang/reflect/Method")) ||
+      !(methodGetNameMID = env->GetMethodID(clazz, "getName",
+                                            "()Ljava/lang/String;")))
+  {
+    NS_WARNING("Problem creating java.lang.reflect.Method globals");
+    goto init_error;
+  }
+
+  if (!(clazz = env->FindClass("java/nio/ByteBuffer")) ||
+      !(byteBufferClass = (jclass) env->NewGlobalRef(clazz)) ||
+      !(clazz = env->FindClass("[Ljava/nio/ByteBuffer;")) ||
+      !(byteBufferArrayClass = (jclass) env->NewGlobalRef(clazz)))
+  {
+    NS_WARNING("Problem creating java.nio.ByteBuffer globals");
+    goto init_error;
+  }
+
+  if (!(clazz = env->FindClass("org/mozilla/xpcom/internal/XPCOMDirectBuffer")) ||
+      !(xpcomDirectBufferClass = (jclass) env->NewGlobalRef(clazz)) ||
+      !(trackDirectBufferMID = env->GetStaticMethodID(clazz, "track",
+                                                 "(Ljava/nio/ByteBuffer;J)V")))
+  {
+    NS_WARNING("Problem creating org.mozilla.xpcom.internal.XPCOMDirectBuffer globals");
+    goto init_error;
+  }
+
+  if (!(clazz = env->FindClass("org/mozilla/xpcom/internal/XPCOMProxyReference")) ||
+      !(xpcomProxyReferenceClass = (jclass) env->NewGlobalRef(clazz)) ||
+      !(clearProxyReferencesMID = env->GetStaticMethodID(clazz, "clear", "()V")))
+  {
+    NS_WARNING("Problem creating org.mozilla.xpcom.internal.XPCOMProxyReference globals");
+    goto init_error;
+  }
+
+  if (!(clazz = env->FindClass("[Ljava/util/List;")) ||
+      !(listArrayClass = (jclass) env->NewGlobalRef(clazz)))
+  {
+    NS_WARNING("Problem creating java.util.List globals");
+    goto init_error;
+  }
+
+  if (!(clazz = env->FindClass("org/mozilla/xpcom/internal/XPCOMInterfaceList")) ||
+      !(xpcomInterfaceListClass = (jclass) env->NewGlobalRef(clazz)) ||
+      !(interfaceListInitMID = env->GetMethodID(clazz, "<init>", "(JI)V")) ||
+      !(releaseInterfaceListsMID = env->GetStaticMethodID(clazz, "releaseAll",
+                                                          "()V")))
+  {
+    NS_WARNING("Problem creating org.mozilla.xpcom.internal.XPCOMInterfaceList globals");
+    goto init_error;
+  }
+
+  if (!(clazz = env->FindClass("org/mozilla/xpcom/internal/XPCOMAsyncQueue")) ||
+      !(xpcomAsyncQueueClass = (jclass) env->NewGlobalRef(clazz)) ||
+      !(drainAsyncQueueMID = env->GetStaticMethodID(clazz, "drain", "()V")) ||
+      !(shutdownAsyncQueueMID = env->GetStaticMethodID(clazz, "shutdown",
+                                                       "()V")))
+  {
+    NS_WARNING("Problem creating org.mozilla.xpcom.internal.XPCOMAsyncQueue globals");
+    goto init_error;
+  }
+
+  if (!(clazz = env->FindClass("java/lang/Class")) ||
+      !(getClassLoaderMID = env->GetMethodID(clazz, "getClassLoader",
+                                             "()Ljava/lang/ClassLoader;")))
+  {
+    NS_WARNING("Problem creating java.lang.Class globals");
+    goto init_error;
+  }
+
 #ifdef DEBUG_JAVAXPCOM
   if (!(clazz = env->FindClass("java/lang/Class")) ||
       !(getNameMID = env->GetMethodID(clazz, "getName","()Ljava/lang/String;")))
@@ -316,6 +490,26 @@ InitializeJavaGlobals(JNIEnv *env)
     NS_WARNING("Problem creating JavaToXPTCStubMap");
     goto init_error;
   }
+  gJavaStubClassMap = new JavaStubClassMap();
+  if (!gJavaStubClassMap || NS_FAILED(gJavaStubClassMap->Init())) {
+    NS_WARNING("Problem creating JavaStubClassMap");
+    goto init_error;
+  }
+  gJavaMethodPlanMap = new JavaMethodPlanMap();
+  if (!gJavaMethodPlanMap || NS_FAILED(gJavaMethodPlanMap->Init())) {
+    NS_WARNING("Problem creating JavaMethodPlanMap");
+    goto init_error;
+  }
+  gJavaMethodInfoMap = new JavaMethodInfoMap();
+  if (!gJavaMethodInfoMap || NS_FAILED(gJavaMethodInfoMap->Init())) {
+    NS_WARNING("Problem creating JavaMethodInfoMap");
+    goto init_error;
+  }
+  gJavaInterfaceClassMap = new JavaInterfaceClassMap();
+  if (!gJavaInterfaceClassMap || NS_FAILED(gJavaInterfaceClassMap->Init())) {
+    NS_WARNING("Problem creating JavaInterfaceClassMap");
+    goto init_error;
+  }
 
   {
     nsresult rv = NS_OK;
@@ -336,6 +530,12 @@ InitializeJavaGlobals(JNIEnv *env)
     }
   }
 
+  // Call statistics can also be turned on from the environment, in which
+  // case they are written to stderr at shutdown.
+  if (PR_GetEnv("JAVAXPCOM_CALL_STATS")) {
+    nsJavaCallStats::SetEnabled(PR_TRUE);
+  }
+
   gJavaXPCOMLock = nsAutoLock::NewLock("gJavaXPCOMLock");
   gJavaXPCOMInitialized = PR_TRUE;
   return PR_TRUE;
@@ -364,6 +564,26 @@ FreeJavaGlobals(JNIEnv* env)
 
   gJavaXPCOMInitialized = PR_FALSE;
 
+  // The native instances of any live proxies are deleted below, so stop
+  // tracking them for release.
+  if (xpcomProxyReferenceClass) {
+    env->CallStaticVoidMethod(xpcomProxyReferenceClass,
+                              clearProxyReferencesMID);
+  }
+
+  // Likewise, release the arrays of the interface lists that are still alive,
+  // while XPCOM is still around to take the references.
+  if (xpcomInterfaceListClass && releaseInterfaceListsMID) {
+    env->CallStaticVoidMethod(xpcomInterfaceListClass,
+                              releaseInterfaceListsMID);
+  }
+
+  // A drain that is already dispatched won't run the queued calls now, so
+  // fail them, and let the next call schedule a new drain.
+  if (xpcomAsyncQueueClass && shutdownAsyncQueueMID) {
+    env->CallStaticVoidMethod(xpcomAsyncQueueClass, shutdownAsyncQueueMID);
+  }
+
   // Free the mappings first, since that process depends on some of the Java
   // globals that are freed later.
   if (gNativeToJavaProxyMap) {
@@ -376,6 +596,50 @@ FreeJavaGlobals(JNIEnv* env)
     delete gJavaToXPTCStubMap;
     gJavaToXPTCStubMap = nullptr;
   }
+  if (gJavaStubClassMap) {
+    gJavaStubClassMap->Destroy(env);
+    delete gJavaStubClassMap;
+    gJavaStubClassMap = nullptr;
+  }
+  if (gJavaMethodInfoMap) {
+    gJavaMethodInfoMap->Destroy();
+    delete gJavaMethodInfoMap;
+    gJavaMethodInfoMap = nullptr;
+  }
+  if (gJavaMethodPlanMap) {
+    gJavaMethodPlanMap->Destroy();
+    delete gJavaMethodPlanMap;
+    gJavaMethodPlanMap = nullptr;
+  }
+  if (gJavaInterfaceClassMap) {
+    gJavaInterfaceClassMap->Destroy(env);
+    delete gJavaInterfaceClassMap;
+    gJavaInterfaceClassMap = nullptr;
+  }
+
+  // Release any XPCOM objects still queued by the Java proxies, while XPCOM
+  // is still around.
+  if (NS_IsMainThread()) {
+    nsJavaReleaseQueue::Flush();
+  }
+#ifdef DEBUG_JAVAXPCOM
+  nsJavaReleaseQueueStats stats;
+  nsJavaReleaseQueue::GetStats(&stats);
+  LOG(("nsJavaReleaseQueue: released=%u drains=%u maxDepth=%u "
+       "maxLatency=%uus\n", stats.releaseCount, stats.drainCount,
+       stats.maxQueueDepth, stats.maxDrainLatency));
+  nsJavaCallArenaStats arenaStats;
+  nsJavaCallArena::GetStats(&arenaStats);
+  LOG(("nsJavaCallArena: highWater=%u chunks=%u large=%u\n",
+       arenaStats.highWater, arenaStats.chunkAllocations,
+       arenaStats.largeAllocations));
+#endif
+  if (PR_GetEnv("JAVAXPCOM_CALL_STATS")) {
+    nsCString report;
+    if (NS_SUCCEEDED(nsJavaCallStats::GetReport(PR_FALSE, report))) {
+      fprintf(stderr, "JavaXPCOM call statistics:\n%s", report.get());
+    }
+  }
 
   // Free remaining Java globals
   if (systemClass) {
@@ -426,14 +690,58 @@ FreeJavaGlobals(JNIEnv* env)
     env->DeleteGlobalRef(xpcomExceptionClass);
     xpcomExceptionClass = nullptr;
   }
+  if (outOfMemoryErrorClass) {
+    env->DeleteGlobalRef(outOfMemoryErrorClass);
+    outOfMemoryErrorClass = nullptr;
+  }
+  if (fileClass) {
+    env->DeleteGlobalRef(fileClass);
+    fileClass = nullptr;
+  }
   if (xpcomJavaProxyClass) {
     env->DeleteGlobalRef(xpcomJavaProxyClass);
     xpcomJavaProxyClass = nullptr;
   }
+  if (xpcomJavaBindingClass) {
+    env->DeleteGlobalRef(xpcomJavaBindingClass);
+    xpcomJavaBindingClass = nullptr;
+  }
+  if (proxyClass) {
+    env->DeleteGlobalRef(proxyClass);
+    proxyClass = nullptr;
+  }
   if (weakReferenceClass) {
     env->DeleteGlobalRef(weakReferenceClass);
     weakReferenceClass = nullptr;
   }
+  if (byteBufferClass) {
+    env->DeleteGlobalRef(byteBufferClass);
+    byteBufferClass = nullptr;
+  }
+  if (byteBufferArrayClass) {
+    env->DeleteGlobalRef(byteBufferArrayClass);
+    byteBufferArrayClass = nullptr;
+  }
+  if (xpcomDirectBufferClass) {
+    env->DeleteGlobalRef(xpcomDirectBufferClass);
+    xpcomDirectBufferClass = nullptr;
+  }
+  if (xpcomProxyReferenceClass) {
+    env->DeleteGlobalRef(xpcomProxyReferenceClass);
+    xpcomProxyReferenceClass = nullptr;
+  }
+  if (listArrayClass) {
+    env->DeleteGlobalRef(listArrayClass);
+    listArrayClass = nullptr;
+  }
+  if (xpcomInterfaceListClass) {
+    env->DeleteGlobalRef(xpcomInterfaceListClass);
+    xpcomInterfaceListClass = nullptr;
+  }
+  if (xpcomAsyncQueueClass) {
+    env->DeleteGlobalRef(xpcomAsyncQueueClass);
+    xpcomAsyncQueueClass = nullptr;
+  }
 
   if (gJavaKeywords) {
     delete gJavaKeywords;
@@ -460,13 +768,28 @@ FreeJavaGlobals(JNIEnv* env)
 nsresult
 NativeToJavaProxyMap::Init()
 {
-  mHashTable = PL_NewDHashTable(PL_DHashGetStubOps(), 
-                                sizeof(Entry), 16);
-  if (!mHashTable)
-    return NS_ERROR_OUT_OF_MEMORY;
+  for (PRUint32 i = 0; i < kShardCount; i++) {
+    mShards[i].hashTable = PL_NewDHashTable(PL_DHashGetStubOps(),
+                                            sizeof(Entry), 16);
+    if (!mShards[i].hashTable)
+      return NS_ERROR_OUT_OF_MEMORY;
+
+    mShards[i].lock = nsAutoLock::NewLock("NativeToJavaProxyMap shard");
+    if (!mShards[i].lock)
+      return NS_ERROR_OUT_OF_MEMORY;
+  }
   return NS_OK;
 }
 
+void
+NativeToJavaProxyMap::ReleaseItem(JNIEnv* env, ProxyList* aItem)
+{
+  if (PR_AtomicDecrement(&aItem->refCount) == 0) {
+    env->DeleteGlobalRef(aItem->javaObject);
+    delete aItem;
+  }
+}
+
 PLDHashOperator
 DestroyJavaProxyMappingEnum(PLDHashTable* aTable, PLDHashEntryHdr* aHeader,
                             PRUint32 aNumber, void* aData)
@@ -499,8 +822,7 @@ DestroyJavaProxyMappingEnum(PLDHashTable* aTable, PLDHashEntryHdr* aHeader,
 
     NativeToJavaProxyMap::ProxyList* next = item->next;
     env->CallVoidMethod(item->javaObject, clearReferentMID);
-    env->DeleteGlobalRef(item->javaObject);
-    delete item;
+    NativeToJavaProxyMap::ReleaseItem(env, item);
     item = next;
   }
 
@@ -513,23 +835,36 @@ NativeToJavaProxyMap::Destroy(JNIEnv* env)
   // This is only called from FreeGlobals(), which already holds the lock.
   //  nsAutoLock lock(gJavaXPCOMLock);
 
-  PL_DHashTableEnumerate(mHashTable, DestroyJavaProxyMappingEnum, env);
-  PL_DHashTableDestroy(mHashTable);
-  mHashTable = nullptr;
+  for (PRUint32 i = 0; i < kShardCount; i++) {
+    Shard& shard = mShards[i];
+
+    // Detach the hash table from the shard, so we don't make any JNI calls
+    // while holding the shard lock.
+    PLDHashTable* hashTable = nullptr;
+    if (shard.lock) {
+      nsAutoLock lock(shard.lock);
+      hashTable = shard.hashTable;
+      shard.hashTable = nullptr;
+    }
+
+    if (hashTable) {
+      PL_DHashTableEnumerate(hashTable, DestroyJavaProxyMappingEnum, env);
+      PL_DHashTableDestroy(hashTable);
+    }
+    if (shard.lock) {
+      nsAutoLock::DestroyLock(shard.lock);
+      shard.lock = nullptr;
+    }
+  }
 
   return NS_OK;
 }
 
 nsresult
-NativeToJavaProxyMap::Add(JNIEnv* env, nsISupports* aXPCOMObject,
+NativeToJavaProxyMap::Add(JNIEnv* env, JavaXPCOMInstance* aInst,
                           const nsIID& aIID, jobject aProxy)
 {
-  nsAutoLock lock(gJavaXPCOMLock);
-
-  Entry* e = static_cast<Entry*>(PL_DHashTableAdd(mHashTable, aXPCOMObject));
-  if (!e)
-    return NS_ERROR_FAILURE;
-
+  nsISupports* aXPCOMObject = aInst->GetInstance();
   jobject ref = nullptr;
   jobject weakRefObj = env->NewObject(weakReferenceClass,
                                       weakReferenceConstructorMID, aProxy);
@@ -538,10 +873,25 @@ NativeToJavaProxyMap::Add(JNIEnv* env, nsISupports* aXPCOMObject,
   if (!ref)
     return NS_ERROR_OUT_OF_MEMORY;
 
-  // Add Java proxy weak reference ref to start of list
-  ProxyList* item = new ProxyList(ref, aIID, e->list);
-  e->key = aXPCOMObject;
-  e->list = item;
+  Shard& shard = GetShard(aXPCOMObject);
+  {
+    nsAutoLock lock(shard.lock);
+
+    Entry* e = static_cast<Entry*>(PL_DHashTableAdd(shard.hashTable,
+                                                    aXPCOMObject));
+    if (e) {
+      // Add Java proxy weak reference ref to start of list
+      ProxyList* item = new ProxyList(ref, aInst, aIID, e->list);
+      e->key = aXPCOMObject;
+      e->list = item;
+      ref = nullptr;
+    }
+  }
+
+  if (ref) {
+    env->DeleteGlobalRef(ref);
+    return NS_ERROR_FAILURE;
+  }
 
 #ifdef DEBUG_JAVAXPCOM
   char* iid_str = aIID.ToString();
@@ -561,19 +911,46 @@ NativeToJavaProxyMap::Find(JNIEnv* env, nsISupports* aNativeObject,
   if (!aResult)
     return NS_ERROR_FAILURE;
 
-  nsAutoLock lock(gJavaXPCOMLock);
-
   *aResult = nullptr;
-  Entry* e = static_cast<Entry*>(PL_DHashTableSearch(mHashTable,
-                                                         aNativeObject));
 
-  if (!e)
-    return NS_OK;
+  // Under the shard lock, just take a reference to each item matching the
+  // given IID.  There is usually only one, but proxies that have been
+  // collected and not yet released may come first.
+  nsJavaCallArena* arena = nsJavaCallArena::Get();
+  nsJavaCallArena::Mark mark(arena);
+  ProxyList** matches = nullptr;
+  PRUint32 matchCount = 0;
+  Shard& shard = GetShard(aNativeObject);
+  {
+    nsAutoLock lock(shard.lock);
 
-  ProxyList* item = e->list;
-  while (item != nullptr && *aResult == nullptr) {
-    if (item->iid.Equals(aIID)) {
-      jobject referentObj = env->CallObjectMethod(item->javaObject,
+    Entry* e = static_cast<Entry*>(PL_DHashTableSearch(shard.hashTable,
+                                                       aNativeObject));
+    if (!e)
+      return NS_OK;
+
+    for (ProxyList* item = e->list; item != nullptr; item = item->next) {
+      if (item->iid.Equals(aIID))
+        matchCount++;
+    }
+    if (!matchCount)
+      return NS_OK;
+
+    matches = static_cast<ProxyList**>(
+                arena->Allocate(matchCount * sizeof(ProxyList*)));
+    PRUint32 i = 0;
+    for (ProxyList* item = e->list; item != nullptr; item = item->next) {
+      if (item->iid.Equals(aIID)) {
+        PR_AtomicIncrement(&item->refCount);
+        matches[i++] = item;
+      }
+    }
+  }
+
+  // Now get the Java proxy from the first weak reference that is still set
+  for (PRUint32 i = 0; i < matchCount; i++) {
+    if (*aResult == nullptr) {
+      jobject referentObj = env->CallObjectMethod(matches[i]->javaObject,
                                                   getReferentMID);
       if (!env->IsSameObject(referentObj, NULL)) {
         *aResult = referentObj;
@@ -585,24 +962,106 @@ NativeToJavaProxyMap::Find(JNIEnv* env, nsISupports* aNativeObject,
              (PRUint32) aNativeObject, iid_str));
         NS_Free(iid_str);
 #endif
+      } else if (referentObj) {
+        env->DeleteLocalRef(referentObj);
       }
     }
-    item = item->next;
+    ReleaseItem(env, matches[i]);
   }
 
   return NS_OK;
 }
 
 nsresult
-NativeToJavaProxyMap::Remove(JNIEnv* env, nsISupports* aNativeObject,
-                             const nsIID& aIID)
+NativeToJavaProxyMap::FindAll(JNIEnv* env, nsISupports* const* aNativeObjects,
+                              PRUint32 aCount, const nsIID& aIID,
+                              jobject* aResults)
 {
-  // This is only called from finalizeProxy(), which already holds the lock.
-  //  nsAutoLock lock(gJavaXPCOMLock);
+  NS_PRECONDITION(aResults != nullptr, "null ptr");
+  if (!aResults)
+    return NS_ERROR_FAILURE;
+
+  memset(aResults, 0, aCount * sizeof(jobject));
+  if (!aCount)
+    return NS_OK;
+
+  // Each found proxy is returned as a local ref, which may be more than the
+  // JVM guarantees by default.
+  if (env->EnsureLocalCapacity((jint) aCount) < 0)
+    return NS_ERROR_OUT_OF_MEMORY;
+
+  nsJavaCallArena* arena = nsJavaCallArena::Get();
+  nsJavaCallArena::Mark mark(arena);
+
+  // Group the objects by shard, so that each shard lock is only taken once.
+  PRUint8* shardOf = static_cast<PRUint8*>(arena->Allocate(aCount));
+  PRUint32 usedShards = 0;
+  for (PRUint32 i = 0; i < aCount; i++) {
+    if (aNativeObjects[i]) {
+      shardOf[i] = GetShardIndex(aNativeObjects[i]);
+      usedShards |= 1 << shardOf[i];
+    }
+  }
+
+  // As in Find(), only take a reference to the first matching item of each
+  // object while holding the lock.
+  ProxyList** matches = static_cast<ProxyList**>(
+                          arena->Allocate(aCount * sizeof(ProxyList*)));
+  memset(matches, 0, aCount * sizeof(ProxyList*));
+  for (PRUint32 s = 0; s < kShardCount; s++) {
+    if (!(usedShards & (1 << s)))
+      continue;
+
+    Shard& shard = mShards[s];
+    nsAutoLock lock(shard.lock);
+
+    for (PRUint32 i = 0; i < aCount; i++) {
+      if (!aNativeObjects[i] || shardOf[i] != s)
+        continue;
+
+      Entry* e = static_cast<Entry*>(PL_DHashTableSearch(shard.hashTable,
+                                                         aNativeObjects[i]));
+      if (!e)
+        continue;
+
+      for (ProxyList* item = e->list; item != nullptr; item = item->next) {
+        if (item->iid.Equals(aIID)) {
+          PR_AtomicIncrement(&item->refCount);
+          matches[i] = item;
+          break;
+        }
+      }
+    }
+  }
+
+  // Now get the Java proxies from the weak references
+  for (PRUint32 i = 0; i < aCount; i++) {
+    if (!matches[i])
+      continue;
+
+    jobject referentObj = env->CallObjectMethod(matches[i]->javaObject,
+                                                getReferentMID);
+    if (!env->IsSameObject(referentObj, NULL)) {
+      aResults[i] = referentObj;
+    }
+    ReleaseItem(env, matches[i]);
+  }
+
+  return NS_OK;
+}
 
-  Entry* e = static_cast<Entry*>(PL_DHashTableSearch(mHashTable,
-                                                         aNativeObject));
+nsresult
+NativeToJavaProxyMap::Remove(JavaXPCOMInstance* aInst, ProxyList** aRemoved)
+{
+  NS_PRECONDITION(aRemoved != nullptr, "null ptr");
+  *aRemoved = nullptr;
 
+  nsISupports* aNativeObject = aInst->GetInstance();
+  Shard& shard = GetShard(aNativeObject);
+  nsAutoLock lock(shard.lock);
+
+  Entry* e = static_cast<Entry*>(PL_DHashTableSearch(shard.hashTable,
+                                                     aNativeObject));
   if (!e) {
     NS_WARNING("XPCOM object not found in hash table");
     return NS_ERROR_FAILURE;
@@ -611,27 +1070,15 @@ NativeToJavaProxyMap::Remove(JNIEnv* env, nsISupports* aNativeObject,
   ProxyList* item = e->list;
   ProxyList* last = e->list;
   while (item != nullptr) {
-    if (item->iid.Equals(aIID)) {
-#ifdef DEBUG_JAVAXPCOM
-      char* iid_str = aIID.ToString();
-      LOG(("- NativeToJavaProxyMap (Java=%08x | XPCOM=%08x | IID=%s)\n",
-           (PRUint32) env->CallStaticIntMethod(systemClass, hashCodeMID,
-                                               item->javaObject),
-           (PRUint32) aNativeObject, iid_str));
-      NS_Free(iid_str);
-#endif
-
-      env->CallVoidMethod(item->javaObject, clearReferentMID);
-      env->DeleteGlobalRef(item->javaObject);
+    if (item->instance == aInst) {
       if (item == e->list) {
         e->list = item->next;
         if (e->list == nullptr)
-          PL_DHashTableRemove(mHashTable, aNativeObject);
+          PL_DHashTableRemove(shard.hashTable, aNativeObject);
       } else {
         last->next = item->next;
       }
-
-      delete item;
+      *aRemoved = item;
       return NS_OK;
     }
 
@@ -639,10 +1086,26 @@ NativeToJavaProxyMap::Remove(JNIEnv* env, nsISupports* aNativeObject,
     item = item->next;
   }
 
-  NS_WARNING("Java proxy matching given IID not found");
+  NS_WARNING("Java proxy matching given instance not found");
   return NS_ERROR_FAILURE;
 }
 
+void
+NativeToJavaProxyMap::ReleaseRemoved(JNIEnv* env, ProxyList* aRemoved)
+{
+#ifdef DEBUG_JAVAXPCOM
+  char* iid_str = aRemoved->iid.ToString();
+  LOG(("- NativeToJavaProxyMap (Java=%08x | XPCOM=%08x | IID=%s)\n",
+       (PRUint32) env->CallStaticIntMethod(systemClass, hashCodeMID,
+                                           aRemoved->javaObject),
+       (PRUint32) aRemoved->instance->GetInstance(), iid_str));
+  NS_Free(iid_str);
+#endif
+
+  env->CallVoidMethod(aRemoved->javaObject, clearReferentMID);
+  ReleaseItem(env, aRemoved);
+}
+
 nsresult
 JavaToXPTCStubMap::Init()
 {
@@ -650,6 +1113,10 @@ JavaToXPTCStubMap::Init()
                                 sizeof(Entry), 16);
   if (!mHashTable)
     return NS_ERROR_OUT_OF_MEMORY;
+
+  mLock = nsAutoLock::NewLock("JavaToXPTCStubMap::mLock");
+  if (!mLock)
+    return NS_ERROR_OUT_OF_MEMORY;
   return NS_OK;
 }
 
@@ -664,7 +1131,14 @@ DestroyXPTCMappingEnum(PLDHashTable* aTable, PLDHashEntryHdr* aHeader,
   // The XPTC stub will be released by the XPCOM side, if it hasn't been
   // already.  We just need to delete the Java global ref held by the XPTC stub,
   // so the Java garbage collector can handle the Java object when necessary.
-  entry->xptcstub->DeleteStrongRef();
+  JavaToXPTCStubMap::StubList* item = entry->list;
+  while (item != nullptr) {
+    item->xptcstub->DeleteStrongRef();
+
+    JavaToXPTCStubMap::StubList* next = item->next;
+    delete item;
+    item = next;
+  }
 
   return PL_DHASH_REMOVE;
 }
@@ -679,13 +1153,18 @@ JavaToXPTCStubMap::Destroy()
   PL_DHashTableDestroy(mHashTable);
   mHashTable = nullptr;
 
+  if (mLock) {
+    nsAutoLock::DestroyLock(mLock);
+    mLock = nullptr;
+  }
+
   return NS_OK;
 }
 
 nsresult
 JavaToXPTCStubMap::Add(jint aJavaObjectHashCode, nsJavaXPTCStub* aProxy)
 {
-  nsAutoLock lock(gJavaXPCOMLock);
+  nsAutoLock lock(mLock);
 
   Entry* e = static_cast<Entry*>
                         (PL_DHashTableAdd(mHashTable,
@@ -693,10 +1172,10 @@ JavaToXPTCStubMap::Add(jint aJavaObjectHashCode, nsJavaXPTCStub* aProxy)
   if (!e)
     return NS_ERROR_FAILURE;
 
-  NS_ASSERTION(e->key == nullptr,
-               "XPTCStub for given Java object already exists in hash table");
+  // Other Java objects with the same identity hash code may already be in the
+  // list, so just add this stub to the start of it.
   e->key = aJavaObjectHashCode;
-  e->xptcstub = aProxy;
+  e->list = new StubList(aProxy, e->list);
 
 #ifdef DEBUG_JAVAXPCOM
   nsIInterfaceInfo* iface_info;
@@ -714,14 +1193,15 @@ JavaToXPTCStubMap::Add(jint aJavaObjectHashCode, nsJavaXPTCStub* aProxy)
 }
 
 nsresult
-JavaToXPTCStubMap::Find(jint aJavaObjectHashCode, const nsIID& aIID,
+JavaToXPTCStubMap::Find(JNIEnv* env, jobject aJavaObject,
+                        jint aJavaObjectHashCode, const nsIID& aIID,
                         nsJavaXPTCStub** aResult)
 {
   NS_PRECONDITION(aResult != nullptr, "null ptr");
   if (!aResult)
     return NS_ERROR_FAILURE;
 
-  nsAutoLock lock(gJavaXPCOMLock);
+  nsAutoLock lock(mLock);
 
   *aResult = nullptr;
   Entry* e = static_cast<Entry*>
@@ -731,7 +1211,14 @@ JavaToXPTCStubMap::Find(jint aJavaObjectHashCode, const nsIID& aIID,
   if (!e)
     return NS_OK;
 
-  nsresult rv = e->xptcstub->QueryInterface(aIID, (void**) aResult);
+  StubList* item = e->list;
+  while (item != nullptr && !item->xptcstub->IsJavaObject(env, aJavaObject)) {
+    item = item->next;
+  }
+  if (!item)
+    return NS_OK;
+
+  nsresult rv = item->xptcstub->QueryInterface(aIID, (void**) aResult);
 
 #ifdef DEBUG_JAVAXPCOM
   if (NS_SUCCEEDED(rv)) {
@@ -749,63 +1236,724 @@ JavaToXPTCStubMap::Find(jint aJavaObjectHashCode, const nsIID& aIID,
 }
 
 nsresult
-JavaToXPTCStubMap::Remove(jint aJavaObjectHashCode)
+JavaToXPTCStubMap::Remove(jint aJavaObjectHashCode, nsJavaXPTCStub* aProxy)
 {
-  PL_DHashTableRemove(mHashTable, NS_INT32_TO_PTR(aJavaObjectHashCode));
+  nsAutoLock lock(mLock);
+
+  Entry* e = static_cast<Entry*>
+                        (PL_DHashTableSearch(mHashTable,
+                                           NS_INT32_TO_PTR(aJavaObjectHashCode)));
+  if (!e) {
+    NS_WARNING("Java object not found in hash table");
+    return NS_ERROR_FAILURE;
+  }
+
+  StubList* item = e->list;
+  StubList* last = e->list;
+  while (item != nullptr) {
+    if (item->xptcstub == aProxy) {
+      if (item == e->list) {
+        e->list = item->next;
+        if (e->list == nullptr)
+          PL_DHashTableRemove(mHashTable, NS_INT32_TO_PTR(aJavaObjectHashCode));
+      } else {
+        last->next = item->next;
+      }
+      delete item;
 
 #ifdef DEBUG_JAVAXPCOM
-  LOG(("- JavaToXPTCStubMap (Java=%08x)\n", (PRUint32) aJavaObjectHashCode));
+      LOG(("- JavaToXPTCStubMap (Java=%08x)\n", (PRUint32) aJavaObjectHashCode));
 #endif
+      return NS_OK;
+    }
 
-  return NS_OK;
+    last = item;
+    item = item->next;
+  }
+
+  NS_WARNING("XPTCStub not found in hash table");
+  return NS_ERROR_FAILURE;
 }
 
+// JavaStubClassMap: there is usually only one item per class, and few classes
+// implement XPCOM interfaces, so a small fixed number of buckets is enough.
 
-/**********************************************************
- *    JavaXPCOMInstance
- *********************************************************/
-JavaXPCOMInstance::JavaXPCOMInstance(nsISupports* aInstance,
-                                     nsIInterfaceInfo* aIInfo)
-    : mInstance(aInstance)
-    , mIInfo(aIInfo)
+nsresult
+JavaStubClassMap::Init()
 {
-  NS_ADDREF(mInstance);
-  NS_ADDREF(mIInfo);
+  mLock = nsAutoLock::NewLock("JavaStubClassMap::mLock");
+  if (!mLock)
+    return NS_ERROR_OUT_OF_MEMORY;
+  return NS_OK;
 }
 
-JavaXPCOMInstance::~JavaXPCOMInstance()
+nsresult
+JavaStubClassMap::Destroy(JNIEnv* env)
 {
-  nsresult rv = NS_OK;
-  nsresult rv2 = NS_OK;
-
-  // Need to release these objects on the main thread.
-  nsCOMPtr<nsIThread> thread = do_GetMainThread();
-  if (thread) {
-    rv = NS_ProxyRelease(thread, mInstance);
-    rv2 = NS_ProxyRelease(thread, mIInfo);
+  // Stubs that are still alive keep their own reference to their item.
+  for (PRUint32 i = 0; i < kBucketCount; i++) {
+    JavaStubClassInfo* item = mBuckets[i];
+    mBuckets[i] = nullptr;
+    while (item != nullptr) {
+      JavaStubClassInfo* next = item->next;
+      Release(env, item);
+      item = next;
+    }
+  }
+  if (mLock) {
+    nsAutoLock::DestroyLock(mLock);
+    mLock = nullptr;
   }
-  NS_ASSERTION(NS_SUCCEEDED(rv) && NS_SUCCEEDED(rv2), "Failed to release using NS_ProxyRelease");
-}
-
 
-/*******************************
- *  Helper functions
- *******************************/
+  return NS_OK;
+}
 
 nsresult
-NativeInterfaceToJavaObject(JNIEnv* env, nsISupports* aXPCOMObject,
-                            const nsIID& aIID, jobject aObjectLoader,
-                            jobject* aResult)
+JavaStubClassMap::Get(JNIEnv* env, jobject aJavaObject,
+                      nsIInterfaceInfo* aIInfo, JavaStubClassInfo** aResult)
 {
   NS_PRECONDITION(aResult != nullptr, "null ptr");
-  if (!aResult)
-    return NS_ERROR_NULL_POINTER;
+  *aResult = nullptr;
 
-  // If the object is an nsJavaXPTCStub, then get the Java object directly
-  nsJavaXPTCStub* stub = nullptr;
-  aXPCOMObject->QueryInterface(NS_GET_IID(nsJavaXPTCStub), (void**) &stub);
-  if (stub) {
-    *aResult = stub->GetJavaObject();
+  jclass clazz = env->GetObjectClass(aJavaObject);
+  if (!clazz)
+    return NS_ERROR_FAILURE;
+  jint hash = env->CallStaticIntMethod(systemClass, hashCodeMID, clazz);
+  if (env->ExceptionCheck()) {
+    env->DeleteLocalRef(clazz);
+    return NS_ERROR_FAILURE;
+  }
+  JavaStubClassInfo** bucket = &mBuckets[hash & (kBucketCount - 1)];
+
+  nsJavaCallArena* arena = nsJavaCallArena::Get();
+  nsJavaCallArena::Mark mark(arena);
+
+  // Take a reference to every item of the bucket, so that they can be
+  // compared with the class, and checked for unloaded classes, without
+  // holding the lock.
+  PRUint32 count = 0;
+  JavaStubClassInfo** items = nullptr;
+  PRUint8* stale = nullptr;
+  {
+    nsAutoLock lock(mLock);
+    for (JavaStubClassInfo* item = *bucket; item != nullptr;
+         item = item->next) {
+      count++;
+    }
+    if (count) {
+      items = static_cast<JavaStubClassInfo**>(
+                arena->Allocate(count * sizeof(JavaStubClassInfo*)));
+      stale = static_cast<PRUint8*>(arena->Allocate(count));
+      memset(stale, 0, count);
+      PRUint32 i = 0;
+      for (JavaStubClassInfo* item = *bucket; item != nullptr;
+           item = item->next) {
+        PR_AtomicIncrement(&item->refCount);
+        items[i++] = item;
+      }
+    }
+  }
+
+  JavaStubClassInfo* result = nullptr;
+  PRBool foundStale = PR_FALSE;
+  for (PRUint32 i = 0; i < count; i++) {
+    JavaStubClassInfo* item = items[i];
+    if (!result && item->hashCode == hash && item->iinfo == aIInfo &&
+        env->IsSameObject(item->clazz, clazz)) {
+      result = item;      // keep the reference for the caller
+      items[i] = nullptr;
+    } else if (env->IsSameObject(item->clazz, NULL)) {
+      stale[i] = 1;
+      foundStale = PR_TRUE;
+    }
+  }
+
+  // Unlink the items of unloaded classes, unless another thread already did.
+  // Since we still hold a reference, they are deleted below, after the lock
+  // has been released.
+  if (foundStale) {
+    nsAutoLock lock(mLock);
+    for (PRUint32 i = 0; i < count; i++) {
+      if (!stale[i])
+        continue;
+      JavaStubClassInfo** link = bucket;
+      while (*link != nullptr && *link != items[i])
+        link = &(*link)->next;
+      if (*link) {
+        *link = items[i]->next;
+        PR_AtomicDecrement(&items[i]->refCount);  // the map's reference
+      }
+    }
+  }
+  for (PRUint32 i = 0; i < count; i++) {
+    if (items[i])
+      Release(env, items[i]);
+  }
+
+  if (!result) {
+    PRUint16 methodCount;
+    nsresult rv = aIInfo->GetMethodCount(&methodCount);
+    if (NS_FAILED(rv)) {
+      env->DeleteLocalRef(clazz);
+      return rv;
+    }
+
+    JavaStubClassInfo::MethodSlot* methods =
+                               new JavaStubClassInfo::MethodSlot[methodCount];
+    jweak weakClass = methods ? env->NewWeakGlobalRef(clazz) : nullptr;
+    if (weakClass) {
+      result = new JavaStubClassInfo(weakClass, hash, aIInfo, methodCount,
+                                     methods);
+    }
+    if (!result) {
+      if (weakClass)
+        env->DeleteWeakGlobalRef(weakClass);
+      delete [] methods;
+      env->DeleteLocalRef(clazz);
+      return NS_ERROR_OUT_OF_MEMORY;
+    }
+
+    // One reference for the map, one for the caller.  If another thread
+    // added an item for the same class in the meantime, both are kept; they
+    // only differ in which methods have been resolved.
+    PR_AtomicIncrement(&result->refCount);
+    nsAutoLock lock(mLock);
+    result->next = *bucket;
+    *bucket = result;
+  }
+
+  env->DeleteLocalRef(clazz);
+  *aResult = result;
+  return NS_OK;
+}
+
+/* static */ void
+JavaStubClassMap::Release(JNIEnv* env, JavaStubClassInfo* aItem)
+{
+  if (PR_AtomicDecrement(&aItem->refCount) == 0) {
+    env->DeleteWeakGlobalRef(aItem->clazz);
+    delete aItem;
+  }
+}
+
+// JavaMethodPlanMap: the plan array of each interface is allocated the first
+// time any of its methods is called, and filled in lazily.  Interfaces are
+// hashed by the address of their interface info into a fixed number of
+// buckets; only interfaces that are actually called through Java get an
+// entry, so the bucket lists stay short.
+
+nsresult
+JavaMethodPlanMap::Init()
+{
+  mLock = nsAutoLock::NewLock("JavaMethodPlanMap::mLock");
+  if (!mLock)
+    return NS_ERROR_OUT_OF_MEMORY;
+  return NS_OK;
+}
+
+nsresult
+JavaMethodPlanMap::Destroy()
+{
+  for (PRUint32 i = 0; i < kBucketCount; i++) {
+    Entry* e = mBuckets[i];
+    mBuckets[i] = nullptr;
+    while (e != nullptr) {
+      Entry* next = e->next;
+      delete e;  // deletes plans and releases interface info
+      e = next;
+    }
+  }
+  if (mLock) {
+    nsAutoLock::DestroyLock(mLock);
+    mLock = nullptr;
+  }
+
+  return NS_OK;
+}
+
+nsresult
+JavaMethodPlanMap::CreatePlan(nsIInterfaceInfo* aIInfo, PRUint16 aMethodIndex,
+                              const JavaXPCOMMethodPlan** aResult)
+{
+  nsAutoLock lock(mLock);
+
+  // Another thread may have created the entry or the plan in the meantime.
+  Entry* e = FindEntry(aIInfo);
+  if (!e) {
+    PRUint16 methodCount;
+    nsresult rv = aIInfo->GetMethodCount(&methodCount);
+    NS_ENSURE_SUCCESS(rv, rv);
+
+    PlanSlot* plans = new PlanSlot[methodCount];
+    if (!plans)
+      return NS_ERROR_OUT_OF_MEMORY;
+
+    PRUint32 index = GetBucketIndex(aIInfo);
+    e = new Entry(aIInfo, methodCount, plans, mBuckets[index]);
+    if (!e) {
+      delete [] plans;
+      return NS_ERROR_OUT_OF_MEMORY;
+    }
+    mBuckets[index] = e;
+  }
+
+  if (aMethodIndex >= e->methodCount)
+    return NS_ERROR_ILLEGAL_VALUE;
+
+  JavaXPCOMMethodPlan* plan = e->plans[aMethodIndex];
+  if (!plan) {
+    const nsXPTMethodInfo* methodInfo;
+    nsresult rv = aIInfo->GetMethodInfo(aMethodIndex, &methodInfo);
+    NS_ENSURE_SUCCESS(rv, rv);
+    rv = JavaXPCOMMethodPlan::Create(aIInfo, aMethodIndex, methodInfo, &plan);
+    NS_ENSURE_SUCCESS(rv, rv);
+    e->plans[aMethodIndex] = plan;
+
+    LOG(("+ JavaMethodPlanMap (index=%d | name=%s)\n", aMethodIndex,
+         methodInfo->GetName()));
+  }
+
+  *aResult = plan;
+  return NS_OK;
+}
+
+// JavaMethodInfoMap: Java methods are hashed by their jmethodID into a fixed
+// number of buckets.  Almost all Java methods are only ever called through
+// proxies of a single interface, and the number of methods called through
+// proxies is small, so the bucket lists stay short.
+
+nsresult
+JavaMethodInfoMap::Init()
+{
+  mLock = nsAutoLock::NewLock("JavaMethodInfoMap::mLock");
+  if (!mLock)
+    return NS_ERROR_OUT_OF_MEMORY;
+  return NS_OK;
+}
+
+nsresult
+JavaMethodInfoMap::Destroy()
+{
+  for (PRUint32 i = 0; i < kBucketCount; i++) {
+    MethodList* item = mBuckets[i];
+    mBuckets[i] = nullptr;
+    while (item != nullptr) {
+      MethodList* next = item->next;
+      delete item;  // releases interface info
+      item = next;
+    }
+  }
+  if (mLock) {
+    nsAutoLock::DestroyLock(mLock);
+    mLock = nullptr;
+  }
+
+  return NS_OK;
+}
+
+nsresult
+JavaMethodInfoMap::Add(jmethodID aMethodID, nsIInterfaceInfo* aIInfo,
+                       const JavaXPCOMMethodPlan* aPlan)
+{
+  nsAutoLock lock(mLock);
+
+  // Another thread may have resolved the same method in the meantime.
+  if (Find(aMethodID, aIInfo))
+    return NS_OK;
+
+  PRUint32 index = GetBucketIndex(aMethodID);
+  MethodList* item = new MethodList(aMethodID, aIInfo, aPlan, mBuckets[index]);
+  if (!item)
+    return NS_ERROR_OUT_OF_MEMORY;
+  mBuckets[index] = item;
+
+  LOG(("+ JavaMethodInfoMap (Method=%p | index=%d | name=%s)\n",
+       (void*) aMethodID, aPlan->MethodIndex(),
+       aPlan->MethodInfo()->GetName()));
+  return NS_OK;
+}
+
+// JavaInterfaceClassMap: IIDs are hashed by their first word, which is
+// already random enough; the rare collisions are resolved by comparing the
+// whole IID.  Most interfaces are only ever loaded without a class loader, or
+// through a single one, so the list of loader classes is usually short.
+
+nsresult
+JavaInterfaceClassMap::Init()
+{
+  mHashTable = PL_NewDHashTable(PL_DHashGetStubOps(),
+                                sizeof(Entry), 32);
+  if (!mHashTable)
+    return NS_ERROR_OUT_OF_MEMORY;
+
+  mLock = nsAutoLock::NewLock("JavaInterfaceClassMap::mLock");
+  if (!mLock)
+    return NS_ERROR_OUT_OF_MEMORY;
+  return NS_OK;
+}
+
+PLDHashOperator
+DestroyInterfaceClassMappingEnum(PLDHashTable* aTable, PLDHashEntryHdr* aHeader,
+                                 PRUint32 aNumber, void* aData)
+{
+  JNIEnv* env = static_cast<JNIEnv*>(aData);
+  JavaInterfaceClassMap::Entry* entry =
+                          static_cast<JavaInterfaceClassMap::Entry*>(aHeader);
+
+  JavaInterfaceClassMap::InterfaceList* item = entry->list;
+  while (item != nullptr) {
+    JavaInterfaceClassMap::LoaderClass* loaderClass = item->loaderClasses;
+    while (loaderClass != nullptr) {
+      JavaInterfaceClassMap::LoaderClass* next = loaderClass->next;
+      JavaInterfaceClassMap::ReleaseLoaderClass(env, loaderClass);
+      loaderClass = next;
+    }
+    if (item->clazz)
+      env->DeleteGlobalRef(item->clazz);
+
+    JavaInterfaceClassMap::InterfaceList* next = item->next;
+    delete item;  // releases interface info
+    item = next;
+  }
+
+  return PL_DHASH_REMOVE;
+}
+
+nsresult
+JavaInterfaceClassMap::Destroy(JNIEnv* env)
+{
+  if (mHashTable) {
+    PL_DHashTableEnumerate(mHashTable, DestroyInterfaceClassMappingEnum, env);
+    PL_DHashTableDestroy(mHashTable);
+    mHashTable = nullptr;
+  }
+  if (mLock) {
+    nsAutoLock::DestroyLock(mLock);
+    mLock = nullptr;
+  }
+
+  return NS_OK;
+}
+
+nsresult
+JavaInterfaceClassMap::GetEntry(const nsIID& aIID, InterfaceList** aResult)
+{
+  void* key = reinterpret_cast<void*>(static_cast<PRUword>(aIID.m0));
+  {
+    nsAutoLock lock(mLock);
+
+    Entry* e = static_cast<Entry*>(PL_DHashTableSearch(mHashTable, key));
+    if (e) {
+      for (InterfaceList* item = e->list; item != nullptr; item = item->next) {
+        if (item->iid.Equals(aIID)) {
+          *aResult = item;
+          return NS_OK;
+        }
+      }
+    }
+  }
+
+  // Not cached yet.  Don't hold the lock while asking the
+  // InterfaceInfoManager, which takes locks of its own.
+  nsCOMPtr<nsIInterfaceInfoManager>
+    iim(do_GetService(NS_INTERFACEINFOMANAGER_SERVICE_CONTRACTID));
+  NS_ASSERTION(iim, "Failed to get InterfaceInfoManager");
+  if (!iim)
+    return NS_ERROR_FAILURE;
+
+  nsCOMPtr<nsIInterfaceInfo> info;
+  nsresult rv = iim->GetInfoForIID(&aIID, getter_AddRefs(info));
+  if (NS_FAILED(rv))
+    return rv;
+
+  nsAutoLock lock(mLock);
+
+  Entry* e = static_cast<Entry*>(PL_DHashTableAdd(mHashTable, key));
+  if (!e)
+    return NS_ERROR_FAILURE;
+
+  // Another thread may have added the same interface in the meantime.
+  InterfaceList* item;
+  for (item = e->list; item != nullptr; item = item->next) {
+    if (item->iid.Equals(aIID))
+      break;
+  }
+
+  if (!item) {
+    item = new InterfaceList(aIID, info, e->list);
+    e->key = static_cast<PRUword>(aIID.m0);
+    e->list = item;
+
+#ifdef DEBUG_JAVAXPCOM
+    const char* iface_name;
+    info->GetNameShared(&iface_name);
+    LOG(("+ JavaInterfaceClassMap (name=%s)\n", iface_name));
+#endif
+  }
+
+  *aResult = item;
+  return NS_OK;
+}
+
+nsresult
+JavaInterfaceClassMap::GetInterfaceInfo(const nsIID& aIID,
+                                        nsIInterfaceInfo** aResult)
+{
+  NS_PRECONDITION(aResult != nullptr, "null ptr");
+  if (!aResult)
+    return NS_ERROR_NULL_POINTER;
+
+  InterfaceList* item;
+  nsresult rv = GetEntry(aIID, &item);
+  NS_ENSURE_SUCCESS(rv, rv);
+
+  NS_ADDREF(*aResult = item->iinfo);
+  return NS_OK;
+}
+
+nsresult
+JavaInterfaceClassMap::GetClass(JNIEnv* env, const nsIID& aIID,
+                                jobject aObjectLoader, jclass* aResult,
+                                nsIInterfaceInfo** aIInfo)
+{
+  NS_PRECONDITION(aResult != nullptr, "null ptr");
+  if (!aResult)
+    return NS_ERROR_NULL_POINTER;
+
+  InterfaceList* item;
+  nsresult rv = GetEntry(aIID, &item);
+  NS_ENSURE_SUCCESS(rv, rv);
+
+  // Classes loaded through a class loader are cached per class loader, which
+  // several classes may share.
+  jobject loader = nullptr;
+  if (aObjectLoader) {
+    jclass objectClass = env->GetObjectClass(aObjectLoader);
+    if (!objectClass)
+      return NS_ERROR_FAILURE;
+    loader = env->CallObjectMethod(objectClass, getClassLoaderMID);
+    env->DeleteLocalRef(objectClass);
+    if (env->ExceptionCheck())
+      return NS_ERROR_FAILURE;
+  }
+
+  jclass clazz = nullptr;
+  if (!aObjectLoader) {
+    // 'item->clazz' is never changed once set, until Destroy()
+    jclass cached;
+    {
+      nsAutoLock lock(mLock);
+      cached = item->clazz;
+    }
+    if (cached)
+      clazz = (jclass) env->NewLocalRef(cached);
+  } else if (loader) {
+    rv = GetLoaderClass(env, item, loader, &clazz);
+  }
+
+  if (NS_SUCCEEDED(rv) && !clazz) {
+    const char* iface_name;
+    rv = item->iinfo->GetNameShared(&iface_name);
+    if (NS_SUCCEEDED(rv)) {
+      nsEmbedCString class_name("org.mozilla.interfaces.");
+      class_name.AppendASCII(iface_name);
+      clazz = FindClassInLoader(env, aObjectLoader, class_name.get());
+      if (!clazz || env->ExceptionCheck())
+        rv = NS_ERROR_FAILURE;
+    }
+
+    if (NS_SUCCEEDED(rv)) {
+      if (!aObjectLoader) {
+        // Another thread may have loaded the same class in the meantime, in
+        // which case either class will do.
+        jclass classRef = (jclass) env->NewGlobalRef(clazz);
+        if (classRef) {
+          {
+            nsAutoLock lock(mLock);
+            if (!item->clazz) {
+              item->clazz = classRef;
+              classRef = nullptr;
+            }
+          }
+          if (classRef)
+            env->DeleteGlobalRef(classRef);
+        }
+      } else if (loader) {
+        AddLoaderClass(env, item, loader, clazz);
+      }
+    }
+  }
+
+  if (loader)
+    env->DeleteLocalRef(loader);
+
+  if (NS_FAILED(rv)) {
+    if (clazz)
+      env->DeleteLocalRef(clazz);
+    return rv;
+  }
+
+  *aResult = clazz;
+  if (aIInfo) {
+    NS_ADDREF(*aIInfo = item->iinfo);
+  }
+  return NS_OK;
+}
+
+nsresult
+JavaInterfaceClassMap::GetLoaderClass(JNIEnv* env, InterfaceList* aItem,
+                                      jobject aLoader, jclass* aResult)
+{
+  *aResult = nullptr;
+
+  nsJavaCallArena* arena = nsJavaCallArena::Get();
+  nsJavaCallArena::Mark mark(arena);
+
+  // Take a reference to every loader class of the interface, so that they
+  // can be compared with the class loader, and checked for unloaded class
+  // loaders, without holding the lock.
+  PRUint32 count = 0;
+  LoaderClass** items = nullptr;
+  PRUint8* stale = nullptr;
+  {
+    nsAutoLock lock(mLock);
+    for (LoaderClass* loaderClass = aItem->loaderClasses;
+         loaderClass != nullptr; loaderClass = loaderClass->next) {
+      count++;
+    }
+    if (count) {
+      items = static_cast<LoaderClass**>(
+                arena->Allocate(count * sizeof(LoaderClass*)));
+      stale = static_cast<PRUint8*>(arena->Allocate(count));
+      memset(stale, 0, count);
+      PRUint32 i = 0;
+      for (LoaderClass* loaderClass = aItem->loaderClasses;
+           loaderClass != nullptr; loaderClass = loaderClass->next) {
+        PR_AtomicIncrement(&loaderClass->refCount);
+        items[i++] = loaderClass;
+      }
+    }
+  }
+
+  jclass clazz = nullptr;
+  PRBool foundStale = PR_FALSE;
+  for (PRUint32 i = 0; i < count; i++) {
+    LoaderClass* loaderClass = items[i];
+    if (!clazz && env->IsSameObject(loaderClass->loader, aLoader)) {
+      clazz = (jclass) env->NewLocalRef(loaderClass->clazz);
+    } else if (env->IsSameObject(loaderClass->loader, NULL)) {
+      stale[i] = 1;
+      foundStale = PR_TRUE;
+    }
+  }
+
+  // Unlink the loader classes of unloaded class loaders, unless another
+  // thread already did.  Since we still hold a reference, they are deleted
+  // below, after the lock has been released.
+  if (foundStale) {
+    nsAutoLock lock(mLock);
+    for (PRUint32 i = 0; i < count; i++) {
+      if (!stale[i])
+        continue;
+      LoaderClass** link = &aItem->loaderClasses;
+      while (*link != nullptr && *link != items[i])
+        link = &(*link)->next;
+      if (*link) {
+        *link = items[i]->next;
+        PR_AtomicDecrement(&items[i]->refCount);  // the map's reference
+      }
+    }
+  }
+  for (PRUint32 i = 0; i < count; i++)
+    ReleaseLoaderClass(env, items[i]);
+
+  *aResult = clazz;
+  return NS_OK;
+}
+
+void
+JavaInterfaceClassMap::AddLoaderClass(JNIEnv* env, InterfaceList* aItem,
+                                      jobject aLoader, jclass aClass)
+{
+  // Create the refs before taking the lock.  If another thread added the same
+  // class loader in the meantime, both items are kept; either class will do.
+  jweak loaderRef = env->NewWeakGlobalRef(aLoader);
+  jweak classRef = loaderRef ? env->NewWeakGlobalRef(aClass) : nullptr;
+  LoaderClass* loaderClass = nullptr;
+  if (classRef)
+    loaderClass = new LoaderClass(loaderRef, classRef, nullptr);
+  if (loaderClass) {
+    nsAutoLock lock(mLock);
+    loaderClass->next = aItem->loaderClasses;
+    aItem->loaderClasses = loaderClass;
+  }
+
+  if (!loaderClass) {
+    if (classRef)
+      env->DeleteWeakGlobalRef(classRef);
+    if (loaderRef)
+      env->DeleteWeakGlobalRef(loaderRef);
+  }
+}
+
+/* static */ void
+JavaInterfaceClassMap::ReleaseLoaderClass(JNIEnv* env,
+                                          LoaderClass* aLoaderClass)
+{
+  if (PR_AtomicDecrement(&aLoaderClass->refCount) == 0) {
+    env->DeleteWeakGlobalRef(aLoaderClass->loader);
+    env->DeleteWeakGlobalRef(aLoaderClass->clazz);
+    delete aLoaderClass;
+  }
+}
+
+
+/**********************************************************
+ *    JavaXPCOMInstance
+ *********************************************************/
+JavaXPCOMInstance::JavaXPCOMInstance(nsISupports* aInstance,
+                                     nsISupports* aInterface,
+                                     nsIInterfaceInfo* aIInfo)
+    : mInstance(aInstance)
+    , mInterface(aInterface)
+    , mIInfo(aIInfo)
+{
+  NS_ADDREF(mInstance);
+  NS_ADDREF(mInterface);
+  NS_ADDREF(mIInfo);
+}
+
+JavaXPCOMInstance::~JavaXPCOMInstance()
+{
+  // Need to release these objects on the main thread.  Proxies are reclaimed
+  // in large numbers after a GC, so the releases are queued and handled
+  // together rather than each posting its own runnable.
+  nsresult rv = nsJavaReleaseQueue::Release(mInterface);
+  nsresult rv2 = nsJavaReleaseQueue::Release(mInstance);
+  nsresult rv3 = nsJavaReleaseQueue::Release(mIInfo);
+  NS_ASSERTION(NS_SUCCEEDED(rv) && NS_SUCCEEDED(rv2) && NS_SUCCEEDED(rv3),
+               "Failed to release using nsJavaReleaseQueue");
+}
+
+
+/*******************************
+ *  Helper functions
+ *******************************/
+
+nsresult
+NativeInterfaceToJavaObject(JNIEnv* env, nsISupports* aXPCOMObject,
+                            const nsIID& aIID, jobject aObjectLoader,
+                            jobject* aResult)
+{
+  NS_PRECONDITION(aResult != nullptr, "null ptr");
+  if (!aResult)
+    return NS_ERROR_NULL_POINTER;
+
+  // If the object is an nsJavaXPTCStub, then get the Java object directly
+  nsJavaXPTCStub* stub = nullptr;
+  aXPCOMObject->QueryInterface(NS_GET_IID(nsJavaXPTCStub), (void**) &stub);
+  if (stub) {
+    *aResult = stub->GetJavaObject();
     NS_ASSERTION(*aResult != nullptr, "nsJavaXPTCStub w/o matching Java object");
     NS_RELEASE(stub);
     return NS_OK;
@@ -816,6 +1964,79 @@ NativeInterfaceToJavaObject(JNIEnv* env, nsISupports* aXPCOMObject,
                                  aResult);
 }
 
+nsresult
+NativeInterfacesToJavaObjects(JNIEnv* env, nsISupports* const* aXPCOMObjects,
+                              PRUint32 aCount, const nsIID& aIID,
+                              jobject aObjectLoader, jobjectArray aResult)
+{
+  NS_PRECONDITION(aResult != nullptr, "null ptr");
+  if (!aResult)
+    return NS_ERROR_NULL_POINTER;
+  if (!aCount)
+    return NS_OK;
+
+  nsJavaCallArena* arena = nsJavaCallArena::Get();
+  nsJavaCallArena::Mark mark(arena);
+
+  jobject* javaObjects = static_cast<jobject*>(
+                           arena->Allocate(aCount * sizeof(jobject)));
+  nsISupports** roots = static_cast<nsISupports**>(
+                          arena->Allocate(aCount * sizeof(nsISupports*)));
+  memset(javaObjects, 0, aCount * sizeof(jobject));
+  memset(roots, 0, aCount * sizeof(nsISupports*));
+
+  // Java objects passed to XPCOM are their own wrappers.  For the others, the
+  // proxy map is keyed by the root nsISupports.
+  nsresult rv = NS_OK;
+  for (PRUint32 i = 0; i < aCount && NS_SUCCEEDED(rv); i++) {
+    nsISupports* xpcom_obj = aXPCOMObjects[i];
+    if (!xpcom_obj)
+      continue;
+
+    nsJavaXPTCStub* stub = nullptr;
+    xpcom_obj->QueryInterface(NS_GET_IID(nsJavaXPTCStub), (void**) &stub);
+    if (stub) {
+      javaObjects[i] = stub->GetJavaObject();
+      NS_ASSERTION(javaObjects[i] != nullptr,
+                   "nsJavaXPTCStub w/o matching Java object");
+      NS_RELEASE(stub);
+    } else {
+      rv = xpcom_obj->QueryInterface(NS_GET_IID(nsISupports),
+                                     (void**) &roots[i]);
+    }
+  }
+
+  jobject* proxies = nullptr;
+  if (NS_SUCCEEDED(rv)) {
+    proxies = static_cast<jobject*>(arena->Allocate(aCount * sizeof(jobject)));
+    rv = gNativeToJavaProxyMap->FindAll(env, roots, aCount, aIID, proxies);
+  }
+
+  // Objects that don't have a proxy yet need a new one.  Every element is
+  // visited, even after a failure, so that all refs are dropped.
+  for (PRUint32 i = 0; i < aCount; i++) {
+    jobject java_obj = javaObjects[i];
+    if (roots[i]) {
+      java_obj = proxies ? proxies[i] : nullptr;
+      if (!java_obj && NS_SUCCEEDED(rv)) {
+        rv = GetNewOrUsedJavaWrapper(env, roots[i], aIID, aObjectLoader,
+                                     &java_obj);
+      }
+      NS_RELEASE(roots[i]);
+    }
+
+    if (java_obj) {
+      if (NS_SUCCEEDED(rv))
+        env->SetObjectArrayElement(aResult, i, java_obj);
+      env->DeleteLocalRef(java_obj);
+    }
+  }
+
+  if (NS_SUCCEEDED(rv) && env->ExceptionCheck())
+    rv = NS_ERROR_FAILURE;
+  return rv;
+}
+
 nsresult
 JavaObjectToNativeInterface(JNIEnv* env, jobject aJavaObject, const nsIID& aIID,
                             void** aResult)
@@ -903,18 +2124,173 @@ GetIIDForMethodParam(nsIInterfaceInfo *iinfo,
   return rv;
 }
 
+nsresult
+JavaXPCOMMethodPlan::Create(nsIInterfaceInfo* aIInfo, PRUint16 aMethodIndex,
+                            const nsXPTMethodInfo* aMethodInfo,
+                            JavaXPCOMMethodPlan** aResult)
+{
+  NS_PRECONDITION(aResult != nullptr, "null ptr");
+  if (!aResult)
+    return NS_ERROR_NULL_POINTER;
+
+  JavaXPCOMMethodPlan* plan = new JavaXPCOMMethodPlan(aMethodIndex,
+                                                      aMethodInfo);
+  if (!plan)
+    return NS_ERROR_OUT_OF_MEMORY;
+
+  PRUint8 paramCount = aMethodInfo->GetParamCount();
+  if (paramCount) {
+    plan->mParams = new JavaXPCOMParamPlan[paramCount];
+    if (!plan->mParams) {
+      delete plan;
+      return NS_ERROR_OUT_OF_MEMORY;
+    }
+    memset(plan->mParams, 0, paramCount * sizeof(JavaXPCOMParamPlan));
+  }
+  plan->mParamCount = paramCount;
+
+  nsresult rv = NS_OK;
+  for (PRUint8 i = 0; i < paramCount && NS_SUCCEEDED(rv); i++) {
+    const nsXPTParamInfo &paramInfo = aMethodInfo->GetParam(i);
+    const nsXPTType &xpttype = paramInfo.GetType();
+    JavaXPCOMParamPlan& param = plan->mParams[i];
+
+    param.paramInfo = &paramInfo;
+    param.type = xpttype.TagPart();
+    param.sizeIsArg = JavaXPCOMParamPlan::kNoArg;
+    param.iidIsArg = JavaXPCOMParamPlan::kNoArg;
+    param.isIn = paramInfo.IsIn();
+    param.isOut = paramInfo.IsOut();
+    param.isRetval = paramInfo.IsRetval();
+    param.isDipper = paramInfo.IsDipper();
+    param.isDependent = xpttype.IsDependent();
+    if (param.isDependent && param.isIn)
+      plan->mHasDependentParams = PR_TRUE;
+
+    switch (param.type) {
+      case nsXPTType::T_I8:
+      case nsXPTType::T_I16:
+      case nsXPTType::T_I32:
+      case nsXPTType::T_I64:
+      case nsXPTType::T_U8:
+      case nsXPTType::T_U16:
+      case nsXPTType::T_U32:
+      case nsXPTType::T_U64:
+      case nsXPTType::T_FLOAT:
+      case nsXPTType::T_DOUBLE:
+      case nsXPTType::T_BOOL:
+      case nsXPTType::T_CHAR:
+      case nsXPTType::T_WCHAR:
+      case nsXPTType::T_VOID:
+        param.isPrimitive = PR_TRUE;
+        break;
+      default:
+        break;
+    }
+
+    if (param.type == nsXPTType::T_ARRAY) {
+      nsXPTType elementType;
+      rv = aIInfo->GetTypeForParam(aMethodIndex, &paramInfo, 1, &elementType);
+      if (NS_FAILED(rv))
+        break;
+      param.arrayType = elementType.TagPart();
+      // IDL 'octet' arrays are not 'promoted' to short, but kept as 'byte';
+      // therefore, treat as a signed 8bit value
+      if (param.arrayType == nsXPTType::T_U8)
+        param.arrayType = nsXPTType::T_I8;
+    }
+
+    if (param.type == nsXPTType::T_ARRAY ||
+        param.type == nsXPTType::T_PSTRING_SIZE_IS ||
+        param.type == nsXPTType::T_PWSTRING_SIZE_IS)
+    {
+      rv = aIInfo->GetSizeIsArgNumberForParam(aMethodIndex, &paramInfo, 0,
+                                              &param.sizeIsArg);
+      if (NS_FAILED(rv))
+        break;
+    }
+
+    PRUint8 ifaceType = param.type == nsXPTType::T_ARRAY ? param.arrayType
+                                                         : param.type;
+    if (ifaceType == nsXPTType::T_INTERFACE) {
+      param.isInterface = PR_TRUE;
+      rv = aIInfo->GetIIDForParamNoAlloc(aMethodIndex, &paramInfo, &param.iid);
+    } else if (ifaceType == nsXPTType::T_INTERFACE_IS) {
+      param.isInterface = PR_TRUE;
+      rv = aIInfo->GetInterfaceIsArgNumberForParam(aMethodIndex, &paramInfo,
+                                                   &param.iidIsArg);
+      if (NS_FAILED(rv))
+        break;
+
+      // The xpidl compiler ensures this. We reaffirm it for safety.
+      const nsXPTType& argType = aMethodInfo->GetParam(param.iidIsArg).GetType();
+      if (!argType.deprecated_IsPointer() ||
+          argType.TagPart() != nsXPTType::T_IID)
+        rv = NS_ERROR_UNEXPECTED;
+    }
+  }
+
+  if (NS_FAILED(rv)) {
+    delete plan;
+    return rv;
+  }
+
+  *aResult = plan;
+  return NS_OK;
+}
+
 
 /*******************************
  *  JNI helper functions
  *******************************/
 
+static void PR_CALLBACK
+ReleaseJNIThreadState(void* aData)
+{
+  // Called by NSPR on the exiting thread.
+  JNIThreadState* state = static_cast<JNIThreadState*>(aData);
+  if (state->attached && gCachedJVM) {
+    gCachedJVM->DetachCurrentThread();
+  }
+  delete state;
+}
+
 JNIEnv*
 GetJNIEnv()
 {
-  JNIEnv* env;
+  JNIThreadState* state =
+          static_cast<JNIThreadState*>(PR_GetThreadPrivate(gJNIEnvIndex));
+  if (state)
+    return state->env;
+
+  JNIEnv* env = nullptr;
+  PRBool attached = PR_FALSE;
   jint rc = gCachedJVM->GetEnv((void**) &env, JNI_VERSION_1_2);
-  NS_ASSERTION(rc == JNI_OK && env != nullptr,
-               "Current thread not attached to given JVM instance");
+  if (rc == JNI_EDETACHED) {
+    // A native XPCOM thread calling into Java.  Attach it as a daemon thread,
+    // so that it doesn't keep the JVM from exiting; it is detached when the
+    // thread exits (see ReleaseJNIThreadState).
+    JavaVMAttachArgs args;
+    args.version = JNI_VERSION_1_2;
+    args.name = const_cast<char*>(PR_GetThreadName(PR_GetCurrentThread()));
+    args.group = nullptr;
+    rc = gCachedJVM->AttachCurrentThreadAsDaemon((void**) &env, &args);
+    attached = PR_TRUE;
+  }
+  // None of the callers can do without a JNIEnv, and many of them (such as
+  // destructors) have no way to report an error, so this is fatal.
+  if (rc != JNI_OK || env == nullptr) {
+    NS_RUNTIMEABORT("Failed to attach current thread to JVM");
+  }
+
+  state = new JNIThreadState();
+  if (state) {
+    state->env = env;
+    state->attached = attached;
+    if (PR_SetThreadPrivate(gJNIEnvIndex, state) != PR_SUCCESS) {
+      delete state;
+    }
+  }
   return env;
 }
 
@@ -929,49 +2305,53 @@ ThrowException(JNIEnv* env, const nsresult aErrorCode, const char* aMessage)
   // If the error code we get is for an Out Of Memory error, try to throw an
   // OutOfMemoryError.  The JVM may have enough memory to create this error.
   if (aErrorCode == NS_ERROR_OUT_OF_MEMORY) {
-    jclass clazz = env->FindClass("java/lang/OutOfMemoryError");
+    jclass clazz = outOfMemoryErrorClass;
+    if (!clazz) {
+      clazz = env->FindClass("java/lang/OutOfMemoryError");
+    }
     if (clazz) {
       env->ThrowNew(clazz, aMessage);
     }
-    env->DeleteLocalRef(clazz);
+    if (clazz != outOfMemoryErrorClass) {
+      env->DeleteLocalRef(clazz);
+    }
     return;
   }
 
   // If the error was not handled above, then create an XPCOMException with the
   // given error code and message.
 
-  // Create parameters and method signature. Max of 2 params.  The error code
-  // comes before the message string.
+  // Create parameters. Max of 2 params.  The error code comes before the
+  // message string.
   PRInt64 errorCode = static_cast<uint32_t>(static_cast<uint32_t>(aErrorCode) ? aErrorCode : NS_ERROR_FAILURE);
-  nsEmbedCString methodSig("(J");
   jstring message = nullptr;
   if (aMessage) {
     message = env->NewStringUTF(aMessage);
     if (!message) {
       return;
     }
-    methodSig.AppendLiteral("Ljava/lang/String;");
   }
-  methodSig.AppendLiteral(")V");
 
   // In some instances (such as in shutdownXPCOM() and termEmbedding()), we
   // will need to throw an exception when JavaXPCOM has already been
-  // terminated.  In such a case, 'xpcomExceptionClass' will be null.  So we
-  // reset it temporarily in order to throw the appropriate exception.
-  if (xpcomExceptionClass == nullptr) {
-    xpcomExceptionClass = env->FindClass("org/mozilla/xpcom/XPCOMException");
-    if (!xpcomExceptionClass) {
+  // terminated.  In such a case, the cached class and constructors will be
+  // null.  So we look them up for this one exception.
+  jclass clazz = xpcomExceptionClass;
+  jmethodID mid = message ? xpcomExceptionInitWithMessageMID
+                          : xpcomExceptionInitMID;
+  if (clazz == nullptr) {
+    clazz = env->FindClass("org/mozilla/xpcom/XPCOMException");
+    if (!clazz) {
       return;
     }
+    mid = env->GetMethodID(clazz, "<init>",
+                           message ? "(JLjava/lang/String;)V" : "(J)V");
   }
 
   // create exception object
   jthrowable throwObj = nullptr;
-  jmethodID mid = env->GetMethodID(xpcomExceptionClass, "<init>",
-                                   methodSig.get());
   if (mid) {
-    throwObj = (jthrowable) env->NewObject(xpcomExceptionClass, mid, errorCode,
-                                           message);
+    throwObj = (jthrowable) env->NewObject(clazz, mid, errorCode, message);
   }
   NS_ASSERTION(throwObj, "Failed to create XPCOMException object");
 
@@ -984,44 +2364,91 @@ ThrowException(JNIEnv* env, const nsresult aErrorCode, const char* aMessage)
 nsString*
 jstring_to_nsString(JNIEnv* env, jstring aString)
 {
-  const jchar* buf = nullptr;
-  if (aString) {
-    buf = env->GetStringChars(aString, nullptr);
-    if (!buf)
-      return nullptr;  // exception already thrown
-  }
-
-  nsString* str = new nsString((PRUnichar *)buf);
+  nsString* str = new nsString();
+  if (!str)
+    return nullptr;
 
   if (aString) {
-    env->ReleaseStringChars(aString, buf);
+    // Java strings are not null-terminated, so copy them by length.
+    jsize length = env->GetStringLength(aString);
+    str->SetLength(length);
+    if (str->Length() != (PRUint32) length) {
+      delete str;
+      return nullptr;
+    }
+    env->GetStringRegion(aString, 0, length,
+                         reinterpret_cast<jchar*>(str->BeginWriting()));
   } else {
     str->SetIsVoid(PR_TRUE);
   }
 
-  // returns string, or nullptr if 'new' failed
   return str;
 }
 
-nsCString*
-jstring_to_nsCString(JNIEnv* env, jstring aString)
+nsresult
+jstring_to_UTF8(JNIEnv* env, jstring aString, nsACString& aResult)
 {
-  const char* buf = nullptr;
-  if (aString) {
-    buf = env->GetStringUTFChars(aString, nullptr);
-    if (!buf)
-      return nullptr;  // exception already thrown
+  if (!aString) {
+    aResult.SetIsVoid(PR_TRUE);
+    return NS_OK;
   }
 
-  nsCString* str = new nsCString(buf);
+  jsize length = env->GetStringLength(aString);
+  const jchar* chars = env->GetStringCritical(aString, nullptr);
+  if (!chars)
+    return NS_ERROR_OUT_OF_MEMORY;
 
-  if (aString) {
-    env->ReleaseStringUTFChars(aString, buf);
+  // No JNI calls are made until the chars are released; only the destination
+  // buffer is allocated.
+  nsresult rv = NS_OK;
+  PRUint32 utf8Length = UTF16ToUTF8Length(chars, length);
+  nsJavaCallStats::AddBytes(utf8Length);
+  aResult.SetLength(utf8Length);
+  if (aResult.Length() == utf8Length) {
+    ConvertUTF16ToUTF8(chars, length, aResult.BeginWriting());
   } else {
-    str->SetIsVoid(PR_TRUE);
+    rv = NS_ERROR_OUT_OF_MEMORY;
+  }
+
+  env->ReleaseStringCritical(aString, chars);
+  return rv;
+}
+
+jstring
+UTF8_to_jstring(JNIEnv* env, const char* aBytes, PRUint32 aLength)
+{
+  // UTF-8 never needs fewer bytes than UTF-16 needs chars, so aLength chars
+  // is always enough.  Short strings are converted on the stack.
+  jchar stackBuf[256];
+  jchar* buf = stackBuf;
+  if (aLength > sizeof(stackBuf) / sizeof(jchar)) {
+    buf = static_cast<jchar*>(moz_malloc(aLength * sizeof(jchar)));
+    if (!buf)
+      return nullptr;
+  }
+
+  PRUint32 length = ConvertUTF8ToUTF16(aBytes, aLength, buf);
+  nsJavaCallStats::AddBytes(aLength);
+  jstring str = env->NewString(buf, length);
+
+  if (buf != stackBuf) {
+    moz_free(buf);
+  }
+  return str;
+}
+
+nsCString*
+jstring_to_nsCString(JNIEnv* env, jstring aString)
+{
+  nsCString* str = new nsCString();
+  if (!str)
+    return nullptr;
+
+  if (NS_FAILED(jstring_to_UTF8(env, aString, *str))) {
+    delete str;
+    return nullptr;
   }
 
-  // returns string, or nullptr if 'new' failed
   return str;
 }
 
@@ -1030,16 +2457,22 @@ File_to_nsILocalFile(JNIEnv* env, jobject aFile, nsIFile** aLocalFile)
 {
   nsresult rv = NS_ERROR_FAILURE;
   jstring pathName = nullptr;
-  jclass clazz = env->FindClass("java/io/File");
-  if (clazz) {
-    jmethodID pathMID = env->GetMethodID(clazz, "getCanonicalPath",
-                                         "()Ljava/lang/String;");
-    if (pathMID) {
-      pathName = (jstring) env->CallObjectMethod(aFile, pathMID);
-      if (pathName != nullptr && !env->ExceptionCheck())
-        rv = NS_OK;
+
+  // The directory service provider may still be asked for files after
+  // FreeJavaGlobals(), so look up the method if it is no longer cached.
+  jmethodID pathMID = fileGetCanonicalPathMID;
+  if (!pathMID) {
+    jclass clazz = env->FindClass("java/io/File");
+    if (clazz) {
+      pathMID = env->GetMethodID(clazz, "getCanonicalPath",
+                                 "()Ljava/lang/String;");
     }
   }
+  if (pathMID) {
+    pathName = (jstring) env->CallObjectMethod(aFile, pathMID);
+    if (pathName != nullptr && !env->ExceptionCheck())
+      rv = NS_OK;
+  }
 
   if (NS_SUCCEEDED(rv)) {
     nsString* path = jstring_to_nsString(env, pathName);
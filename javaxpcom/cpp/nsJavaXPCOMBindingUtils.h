@@ -47,6 +47,7 @@
 #include "nsAutoLock.h"
 #include "nsTHashtable.h"
 #include "nsHashKeys.h"
+#include "mozilla/Atomics.h"
 
 //#define DEBUG_JAVAXPCOM
 //#define DEBUG_JAVAXPCOM_REFCNT
@@ -74,9 +75,20 @@ extern jclass doubleClass;
 extern jclass stringClass;
 extern jclass nsISupportsClass;
 extern jclass xpcomExceptionClass;
+extern jclass outOfMemoryErrorClass;
+extern jclass fileClass;
 extern jclass xpcomJavaProxyClass;
+extern jclass xpcomJavaBindingClass;
+extern jclass proxyClass;
 extern jclass weakReferenceClass;
 extern jclass javaXPCOMUtilsClass;
+extern jclass byteBufferClass;
+extern jclass byteBufferArrayClass;
+extern jclass xpcomDirectBufferClass;
+extern jclass xpcomProxyReferenceClass;
+extern jclass listArrayClass;
+extern jclass xpcomInterfaceListClass;
+extern jclass xpcomAsyncQueueClass;
 
 extern jmethodID hashCodeMID;
 extern jmethodID booleanValueMID;
@@ -102,6 +114,22 @@ extern jmethodID weakReferenceConstructorMID;
 extern jmethodID getReferentMID;
 extern jmethodID clearReferentMID;
 extern jmethodID findClassInLoaderMID;
+extern jmethodID getClassLoaderMID;
+extern jmethodID methodGetNameMID;
+extern jmethodID trackDirectBufferMID;
+extern jmethodID clearProxyReferencesMID;
+extern jmethodID interfaceListInitMID;
+extern jmethodID releaseInterfaceListsMID;
+extern jmethodID drainAsyncQueueMID;
+extern jmethodID shutdownAsyncQueueMID;
+extern jmethodID xpcomExceptionInitMID;
+extern jmethodID xpcomExceptionInitWithMessageMID;
+extern jmethodID fileGetCanonicalPathMID;
+
+extern jfieldID xpcomExceptionErrorcodeFID;
+extern jfieldID xpcomJavaProxyNativePtrFID;
+extern jfieldID xpcomJavaBindingNativePtrFID;
+extern jfieldID proxyHandlerFID;
 
 #ifdef DEBUG_JAVAXPCOM
 extern jmethodID getNameMID;
@@ -112,12 +140,20 @@ class NativeToJavaProxyMap;
 extern NativeToJavaProxyMap* gNativeToJavaProxyMap;
 class JavaToXPTCStubMap;
 extern JavaToXPTCStubMap* gJavaToXPTCStubMap;
+class JavaStubClassMap;
+extern JavaStubClassMap* gJavaStubClassMap;
+class JavaMethodPlanMap;
+extern JavaMethodPlanMap* gJavaMethodPlanMap;
+class JavaMethodInfoMap;
+extern JavaMethodInfoMap* gJavaMethodInfoMap;
+class JavaInterfaceClassMap;
+extern JavaInterfaceClassMap* gJavaInterfaceClassMap;
 
 extern nsTHashtable<nsDepCharHashKey>* gJavaKeywords;
 
-// The Java garbage collector runs in a separate thread.  Since it calls the
-// finalizeProxy() function in nsJavaWrapper.cpp, we need to make sure that
-// all the structures touched by finalizeProxy() are multithread aware.
+// Collected Java proxies are released on a separate thread.  Since it calls
+// the releaseInstances() function in nsJavaWrapper.cpp, we need to make sure
+// that all the structures touched by releaseInstances() are multithread aware.
 extern PRLock* gJavaXPCOMLock;
 
 extern PRBool gJavaXPCOMInitialized;
@@ -140,17 +176,31 @@ void FreeJavaGlobals(JNIEnv* env);
  *  JavaXPCOMInstance
  *************************/
 
+/**
+ * The native side of a Java proxy.  Holds the root nsISupports of the XPCOM
+ * object, which gives the object's identity, as well as the object's pointer
+ * for the proxied interface, so that method calls can be made on it without
+ * a QueryInterface() each time.
+ */
 class JavaXPCOMInstance
 {
 public:
-  JavaXPCOMInstance(nsISupports* aInstance, nsIInterfaceInfo* aIInfo);
+  /**
+   * @param aInstance   root nsISupports of the XPCOM object
+   * @param aInterface  aInstance QI'd to the interface described by aIInfo
+   * @param aIInfo      info for the proxied interface
+   */
+  JavaXPCOMInstance(nsISupports* aInstance, nsISupports* aInterface,
+                    nsIInterfaceInfo* aIInfo);
   ~JavaXPCOMInstance();
 
   nsISupports* GetInstance()  { return mInstance; }
+  nsISupports* GetInterface() { return mInterface; }
   nsIInterfaceInfo* InterfaceInfo() { return mIInfo; }
 
 private:
   nsISupports*        mInstance;
+  nsISupports*        mInterface;
   nsIInterfaceInfo*   mIInfo;
 };
 
@@ -161,6 +211,13 @@ private:
 
 /**
  * Maps native XPCOM objects to their associated Java proxy object.
+ *
+ * The map is split into shards, selected by the address of the XPCOM object,
+ * each with its own hash table and lock.  The shard locks are only held while
+ * the hash tables are accessed; any JNI calls are made after the lock has been
+ * released.  To allow this, list items are refcounted, so that an item found
+ * by Find() stays valid while its Java proxy is retrieved, even if the item is
+ * removed by another thread in the meantime.
  */
 class NativeToJavaProxyMap
 {
@@ -169,34 +226,50 @@ class NativeToJavaProxyMap
                                                      PRUint32 aNumber,
                                                      void* aData);
 
-protected:
+public:
   struct ProxyList
   {
-    ProxyList(const jobject aRef, const nsIID& aIID, ProxyList* aList)
+    ProxyList(const jobject aRef, JavaXPCOMInstance* aInst, const nsIID& aIID,
+              ProxyList* aList)
       : javaObject(aRef)
+      , instance(aInst)
       , iid(aIID)
       , next(aList)
+      , refCount(1)
     { }
 
-    const jobject   javaObject;
-    const nsIID     iid;
+    const jobject             javaObject;
+    JavaXPCOMInstance* const  instance;   // native side of the Java proxy
+    const nsIID               iid;
     ProxyList*      next;
+    PRInt32         refCount;
   };
 
+protected:
   struct Entry : public PLDHashEntryHdr
   {
     nsISupports*  key;
     ProxyList*    list;
   };
 
+  struct Shard
+  {
+    PRLock*       lock;
+    PLDHashTable* hashTable;
+  };
+
+  // Must be a power of 2
+  enum { kShardCount = 16 };
+
 public:
   NativeToJavaProxyMap()
-    : mHashTable(nullptr)
-  { }
+  {
+    memset(mShards, 0, sizeof(mShards));
+  }
 
   ~NativeToJavaProxyMap()
   {
-    NS_ASSERTION(mHashTable == nullptr,
+    NS_ASSERTION(mShards[0].hashTable == nullptr,
                  "MUST call Destroy() before deleting object");
   }
 
@@ -204,20 +277,69 @@ public:
 
   nsresult Destroy(JNIEnv* env);
 
-  nsresult Add(JNIEnv* env, nsISupports* aXPCOMObject, const nsIID& aIID,
+  nsresult Add(JNIEnv* env, JavaXPCOMInstance* aInst, const nsIID& aIID,
                jobject aProxy);
 
   nsresult Find(JNIEnv* env, nsISupports* aNativeObject, const nsIID& aIID,
                 jobject* aResult);
 
-  nsresult Remove(JNIEnv* env, nsISupports* aNativeObject, const nsIID& aIID);
+  /**
+   * Looks up the Java proxies of several XPCOM objects at once, taking the
+   * lock of each shard at most once.
+   *
+   * @param aNativeObjects  root nsISupports of the XPCOM objects; may contain
+   *                        null entries
+   * @param aCount          number of objects
+   * @param aIID            interface IID of the requested proxies
+   * @param aResults        receives a local ref to the Java proxy of each
+   *                        object, or null if it doesn't have one
+   */
+  nsresult FindAll(JNIEnv* env, nsISupports* const* aNativeObjects,
+                   PRUint32 aCount, const nsIID& aIID, jobject* aResults);
+
+  /**
+   * Removes the entry of the Java proxy whose native side is
+   * <code>aInst</code>.  Other proxies for the same object and IID, such as
+   * one created after the proxy of <code>aInst</code> was collected, are kept.
+   *
+   * Makes no JNI calls, so that it can be called while holding a lock.  The
+   * removed entry is returned in <code>aRemoved</code>, and must be passed to
+   * ReleaseRemoved() once the lock is released.
+   */
+  nsresult Remove(JavaXPCOMInstance* aInst, ProxyList** aRemoved);
+
+  /**
+   * Clears the weak reference of an entry returned by Remove(), and frees it.
+   */
+  static void ReleaseRemoved(JNIEnv* env, ProxyList* aRemoved);
 
 protected:
-  PLDHashTable* mHashTable;
+  static PRUint32 GetShardIndex(nsISupports* aNativeObject)
+  {
+    // Objects are at least 8-byte aligned, so skip the low bits
+    PRUword bits = reinterpret_cast<PRUword>(aNativeObject);
+    return ((bits >> 3) ^ (bits >> 9)) & (kShardCount - 1);
+  }
+
+  Shard& GetShard(nsISupports* aNativeObject)
+  {
+    return mShards[GetShardIndex(aNativeObject)];
+  }
+
+  // Drops a reference to the given item, deleting it (and its global ref) if
+  // it was the last one.  Must be called without holding the shard lock.
+  static void ReleaseItem(JNIEnv* env, ProxyList* aItem);
+
+  Shard mShards[kShardCount];
 };
 
 /**
  * Maps Java objects to their associated nsJavaXPTCStub.
+ *
+ * Stubs are hashed by the identity hash code of their Java object.  Since
+ * different Java objects may have the same identity hash code, each entry
+ * holds a list of stubs, and the right one is picked by comparing the Java
+ * objects themselves (see nsJavaXPTCStub::IsJavaObject).
  */
 class JavaToXPTCStubMap
 {
@@ -226,15 +348,27 @@ class JavaToXPTCStubMap
                                                 PRUint32 aNumber, void* aData);
 
 protected:
+  struct StubList
+  {
+    StubList(nsJavaXPTCStub* aStub, StubList* aList)
+      : xptcstub(aStub)
+      , next(aList)
+    { }
+
+    nsJavaXPTCStub* const xptcstub;
+    StubList*             next;
+  };
+
   struct Entry : public PLDHashEntryHdr
   {
     jint              key;
-    nsJavaXPTCStub*   xptcstub;
+    StubList*         list;
   };
 
 public:
   JavaToXPTCStubMap()
     : mHashTable(nullptr)
+    , mLock(nullptr)
   { }
 
   ~JavaToXPTCStubMap()
@@ -249,13 +383,557 @@ public:
 
   nsresult Add(jint aJavaObjectHashCode, nsJavaXPTCStub* aProxy);
 
-  nsresult Find(jint aJavaObjectHashCode, const nsIID& aIID,
-                nsJavaXPTCStub** aResult);
+  nsresult Find(JNIEnv* env, jobject aJavaObject, jint aJavaObjectHashCode,
+                const nsIID& aIID, nsJavaXPTCStub** aResult);
+
+  nsresult Remove(jint aJavaObjectHashCode, nsJavaXPTCStub* aProxy);
+
+protected:
+  PLDHashTable* mHashTable;
+  PRLock*       mLock;
+};
+
+/**
+ * The Java methods that implement the methods of an XPCOM interface, for a
+ * given Java class.  Shared by the stubs of all the objects of that class
+ * for that interface.
+ *
+ * The methods are resolved lazily, and each slot is filled at most once with
+ * a compare-and-swap, so that stubs can read them without taking a lock.
+ */
+struct JavaStubClassInfo
+{
+  typedef mozilla::Atomic<JavaStubMethod*, mozilla::ReleaseAcquire>
+          MethodSlot;
+
+  JavaStubClassInfo(jweak aClass, jint aHashCode, nsIInterfaceInfo* aIInfo,
+                    PRUint16 aMethodCount, MethodSlot* aMethods)
+    : clazz(aClass)
+    , hashCode(aHashCode)
+    , iinfo(aIInfo)
+    , methodCount(aMethodCount)
+    , methods(aMethods)
+    , refCount(1)
+    , next(nullptr)
+  {
+    NS_ADDREF(iinfo);
+  }
+
+  // The weak ref is deleted by JavaStubClassMap::Release(), which has a
+  // JNIEnv.
+  ~JavaStubClassInfo()
+  {
+    for (PRUint16 i = 0; i < methodCount; i++) {
+      delete static_cast<JavaStubMethod*>(methods[i]);
+    }
+    delete [] methods;
+    NS_RELEASE(iinfo);
+  }
+
+  const jweak         clazz;
+  const jint          hashCode;     // identity hash code of the class
+  nsIInterfaceInfo*   iinfo;        // strong reference
+  const PRUint16      methodCount;
+  MethodSlot* const   methods;      // indexed by method index
+  PRInt32             refCount;
+  JavaStubClassInfo*  next;         // guarded by the lock of the map
+};
+
+/**
+ * Caches the Java methods that implement XPCOM interfaces, keyed by Java
+ * class and interface, so that the stubs of new Java objects of a class
+ * that has been seen before don't need to resolve them again.
+ *
+ * Items are hashed by the identity hash code of their class.  They are only
+ * held through weak refs, so that the cache doesn't keep classes from being
+ * unloaded; items whose class has been unloaded are dropped when next looked
+ * at.  Items are refcounted, so that the JNI calls of Get() can be made
+ * without holding the lock, and so that each stub keeps its item alive.
+ */
+class JavaStubClassMap
+{
+  // Must be a power of 2
+  enum { kBucketCount = 64 };
+
+public:
+  JavaStubClassMap()
+    : mLock(nullptr)
+  {
+    memset(mBuckets, 0, sizeof(mBuckets));
+  }
+
+  ~JavaStubClassMap()
+  {
+    NS_ASSERTION(mLock == nullptr,
+                 "MUST call Destroy() before deleting object");
+  }
+
+  nsresult Init();
+
+  nsresult Destroy(JNIEnv* env);
+
+  /**
+   * Returns the item for the class of the given Java object and the given
+   * interface, creating it if necessary.
+   *
+   * @param aJavaObject   Java object implementing the interface
+   * @param aIInfo        interface info of the implemented interface
+   * @param aResult       on success, holds a reference to the item, which
+   *                      must be dropped with Release()
+   */
+  nsresult Get(JNIEnv* env, jobject aJavaObject, nsIInterfaceInfo* aIInfo,
+               JavaStubClassInfo** aResult);
+
+  // Drops a reference to the given item, deleting it (and its weak ref) if
+  // it was the last one.  Must be called without holding the lock.
+  static void Release(JNIEnv* env, JavaStubClassInfo* aItem);
+
+protected:
+  JavaStubClassInfo*  mBuckets[kBucketCount];
+  PRLock*             mLock;
+};
+
+/**
+ * Conversion info for a single parameter of an XPCOM method.  See
+ * JavaXPCOMMethodPlan.
+ */
+struct JavaXPCOMParamPlan
+{
+  enum { kNoArg = 0xff };
+
+  const nsXPTParamInfo* paramInfo;
+  PRUint8   type;         // type tag of the param
+  PRUint8   arrayType;    // type tag of array elements, if type is T_ARRAY;
+                          // 'octet' arrays are treated as T_I8
+  PRUint8   sizeIsArg;    // param holding array/string size, or kNoArg
+  PRUint8   iidIsArg;     // param holding IID for 'iid_is' types, or kNoArg
+  PRBool    isIn;
+  PRBool    isOut;
+  PRBool    isRetval;
+  PRBool    isDipper;     // 'in' string param that receives a result
+  PRBool    isDependent;  // depends on the value of another param
+  PRBool    isInterface;  // param (or array element) is an interface
+  PRBool    isPrimitive;  // maps to a Java primitive type; such params can be
+                          // passed raw by XPCOMJavaBinding
+  nsID      iid;          // IID of interface params, if iidIsArg is kNoArg
+};
+
+/**
+ * Everything callXPCOMMethod() needs to know about the params of an XPCOM
+ * method, computed once from the interface info.  Plans are immutable after
+ * Create(), so they can be shared between threads.
+ */
+class JavaXPCOMMethodPlan
+{
+public:
+  /**
+   * Builds the plan for the given method.
+   *
+   * @param aIInfo        interface info of interface that declares method
+   * @param aMethodIndex  index of method in interface
+   * @param aMethodInfo   method info of method
+   * @param aResult       on success, holds newly allocated plan
+   *
+   * @return  NS_OK if succeeded; all other return values are error codes.
+   */
+  static nsresult Create(nsIInterfaceInfo* aIInfo, PRUint16 aMethodIndex,
+                         const nsXPTMethodInfo* aMethodInfo,
+                         JavaXPCOMMethodPlan** aResult);
+
+  ~JavaXPCOMMethodPlan()
+  {
+    delete [] mParams;
+  }
+
+  PRUint16 MethodIndex() const                { return mMethodIndex; }
+  const nsXPTMethodInfo* MethodInfo() const   { return mMethodInfo; }
+  PRUint8 ParamCount() const                  { return mParamCount; }
+  PRBool HasDependentParams() const           { return mHasDependentParams; }
+  const JavaXPCOMParamPlan& Param(PRUint8 aIndex) const
+  {
+    return mParams[aIndex];
+  }
+
+  /**
+   * Returns the IID of the given interface param.  For 'iid_is' params, the
+   * IID is read from the (already converted) native params.
+   */
+  nsresult GetIID(PRUint8 aIndex, const nsXPTCVariant* aParams,
+                  nsID& aResult) const
+  {
+    const JavaXPCOMParamPlan& param = mParams[aIndex];
+    if (param.iidIsArg == JavaXPCOMParamPlan::kNoArg) {
+      aResult = param.iid;
+      return NS_OK;
+    }
+    const nsID* iid = static_cast<const nsID*>(aParams[param.iidIsArg].val.p);
+    if (!iid)
+      return NS_ERROR_UNEXPECTED;
+    aResult = *iid;
+    return NS_OK;
+  }
+
+  /**
+   * Returns the size of the given array or sized string param, as passed in
+   * its 'size_is' param.
+   */
+  PRUint32 GetArraySize(PRUint8 aIndex, const nsXPTCVariant* aParams) const
+  {
+    const JavaXPCOMParamPlan& param = mParams[aIndex];
+    if (param.sizeIsArg == JavaXPCOMParamPlan::kNoArg)
+      return 0;
+    return aParams[param.sizeIsArg].val.u32;
+  }
+
+private:
+  JavaXPCOMMethodPlan(PRUint16 aMethodIndex,
+                      const nsXPTMethodInfo* aMethodInfo)
+    : mMethodIndex(aMethodIndex)
+    , mMethodInfo(aMethodInfo)
+    , mParamCount(0)
+    , mHasDependentParams(PR_FALSE)
+    , mParams(nullptr)
+  { }
+
+  PRUint16                mMethodIndex;
+  const nsXPTMethodInfo*  mMethodInfo;
+  PRUint8                 mParamCount;
+  PRBool                  mHasDependentParams;
+  JavaXPCOMParamPlan*     mParams;
+};
+
+/**
+ * Holds the call plans of the methods of each interface, indexed by method
+ * index.  Plans are created the first time a method is called, and are owned
+ * by this map.
+ *
+ * GetPlan() is called for every generated-binding and batched call, so once
+ * a plan exists it is found without taking a lock: the entry of each
+ * interface is never changed once added, apart from its plan slots, and both
+ * entries and plans are published with release/acquire ordering.  The lock
+ * is only taken to create an entry or a plan.
+ *
+ * Entries are never removed before Destroy(), so the returned plans stay
+ * valid for as long as JavaXPCOM is initialized.
+ */
+class JavaMethodPlanMap
+{
+protected:
+  typedef mozilla::Atomic<JavaXPCOMMethodPlan*, mozilla::ReleaseAcquire>
+          PlanSlot;
+
+  struct Entry
+  {
+    Entry(nsIInterfaceInfo* aIInfo, PRUint16 aMethodCount, PlanSlot* aPlans,
+          Entry* aNext)
+      : key(aIInfo)
+      , methodCount(aMethodCount)
+      , plans(aPlans)
+      , next(aNext)
+    {
+      NS_ADDREF(key);
+    }
+
+    ~Entry()
+    {
+      for (PRUint16 i = 0; i < methodCount; i++) {
+        delete static_cast<JavaXPCOMMethodPlan*>(plans[i]);
+      }
+      delete [] plans;
+      NS_RELEASE(key);
+    }
+
+    nsIInterfaceInfo*     key;            // strong reference
+    const PRUint16        methodCount;
+    PlanSlot* const       plans;
+    Entry* const          next;
+  };
+
+  enum { kBucketCount = 64 };
+
+public:
+  JavaMethodPlanMap()
+    : mLock(nullptr)
+  { }
+
+  ~JavaMethodPlanMap()
+  {
+    NS_ASSERTION(mLock == nullptr,
+                 "MUST call Destroy() before deleting object");
+  }
+
+  nsresult Init();
+
+  nsresult Destroy();
+
+  /**
+   * Returns the call plan for the given method, creating it if necessary.
+   *
+   * @param aIInfo        interface info of the called interface
+   * @param aMethodIndex  index of method in interface
+   * @param aResult       on success, holds plan for method
+   *
+   * @return  NS_OK if succeeded; NS_ERROR_ILLEGAL_VALUE if the method index is
+   *          out of range; all other return values are error codes.
+   */
+  nsresult GetPlan(nsIInterfaceInfo* aIInfo, PRUint16 aMethodIndex,
+                   const JavaXPCOMMethodPlan** aResult)
+  {
+    Entry* e = FindEntry(aIInfo);
+    if (e && aMethodIndex < e->methodCount) {
+      JavaXPCOMMethodPlan* plan = e->plans[aMethodIndex];
+      if (plan) {
+        *aResult = plan;
+        return NS_OK;
+      }
+    }
+    return CreatePlan(aIInfo, aMethodIndex, aResult);
+  }
+
+protected:
+  static PRUint32 GetBucketIndex(nsIInterfaceInfo* aIInfo)
+  {
+    PRUword bits = reinterpret_cast<PRUword>(aIInfo);
+    return ((bits >> 3) ^ (bits >> 9)) & (kBucketCount - 1);
+  }
+
+  Entry* FindEntry(nsIInterfaceInfo* aIInfo)
+  {
+    for (Entry* e = mBuckets[GetBucketIndex(aIInfo)]; e != nullptr;
+         e = e->next) {
+      if (e->key == aIInfo)
+        return e;
+    }
+    return nullptr;
+  }
+
+  // Slow path of GetPlan(), called with the lock not held.
+  nsresult CreatePlan(nsIInterfaceInfo* aIInfo, PRUint16 aMethodIndex,
+                      const JavaXPCOMMethodPlan** aResult);
 
-  nsresult Remove(jint aJavaObjectHashCode);
+  mozilla::Atomic<Entry*, mozilla::ReleaseAcquire> mBuckets[kBucketCount];
+  PRLock* mLock;
+};
 
+/**
+ * Maps a Java interface method (identified by the jmethodID of the
+ * java.lang.reflect.Method passed to XPCOMJavaProxy.invoke()) to the call
+ * plan of the matching XPCOM method.  Looking up a method by name means
+ * several string copies and GetMethodInfoForName() calls, so we only do that
+ * the first time a given method is called on a given interface.
+ *
+ * Find() is called for every proxy call, from any thread, so it doesn't take
+ * a lock: entries are never changed once added, and are published with
+ * release/acquire ordering at the head of the list of their bucket.  Only
+ * Add() takes the lock, so that concurrent adds don't lose entries.
+ *
+ * The plans themselves are owned by gJavaMethodPlanMap, which is destroyed
+ * after this map.
+ */
+class JavaMethodInfoMap
+{
 protected:
+  // The same Java method may be called through proxies for different
+  // interfaces (i.e. methods inherited from a parent interface), so there
+  // may be several items for the same jmethodID.
+  struct MethodList
+  {
+    MethodList(jmethodID aMethodID, nsIInterfaceInfo* aIInfo,
+               const JavaXPCOMMethodPlan* aPlan, MethodList* aList)
+      : methodID(aMethodID)
+      , iinfo(aIInfo)
+      , plan(aPlan)
+      , next(aList)
+    {
+      NS_ADDREF(iinfo);
+    }
+
+    ~MethodList()
+    {
+      NS_RELEASE(iinfo);
+    }
+
+    const jmethodID                   methodID;
+    nsIInterfaceInfo*                 iinfo;
+    const JavaXPCOMMethodPlan* const  plan;
+    MethodList* const                 next;
+  };
+
+  enum { kBucketCount = 256 };
+
+public:
+  JavaMethodInfoMap()
+    : mLock(nullptr)
+  { }
+
+  ~JavaMethodInfoMap()
+  {
+    NS_ASSERTION(mLock == nullptr,
+                 "MUST call Destroy() before deleting object");
+  }
+
+  nsresult Init();
+
+  nsresult Destroy();
+
+  /**
+   * Associates the given method and interface with a plan obtained from
+   * gJavaMethodPlanMap.  Adding the same method twice is harmless.
+   */
+  nsresult Add(jmethodID aMethodID, nsIInterfaceInfo* aIInfo,
+               const JavaXPCOMMethodPlan* aPlan);
+
+  /**
+   * @return  the plan for the given method and interface, or null if the
+   *          method hasn't been resolved yet.
+   */
+  const JavaXPCOMMethodPlan* Find(jmethodID aMethodID,
+                                  nsIInterfaceInfo* aIInfo)
+  {
+    for (MethodList* item = mBuckets[GetBucketIndex(aMethodID)];
+         item != nullptr; item = item->next) {
+      if (item->methodID == aMethodID && item->iinfo == aIInfo)
+        return item->plan;
+    }
+    return nullptr;
+  }
+
+protected:
+  static PRUint32 GetBucketIndex(jmethodID aMethodID)
+  {
+    PRUword bits = reinterpret_cast<PRUword>(aMethodID);
+    return ((bits >> 3) ^ (bits >> 11)) & (kBucketCount - 1);
+  }
+
+  mozilla::Atomic<MethodList*, mozilla::ReleaseAcquire> mBuckets[kBucketCount];
+  PRLock* mLock;
+};
+
+/**
+ * Caches, for each interface IID, the interface info and the Java interface
+ * generated for it (i.e. org.mozilla.interfaces.nsIFoo), so that wrapping an
+ * object of an interface type that has been seen before doesn't need an
+ * InterfaceInfoManager lookup or a class lookup through Java.
+ *
+ * The Java interface may be loaded through the class loader of a given
+ * object (see FindClassInLoader).  Such classes are cached per class loader,
+ * and both are only held through weak refs, so that the cache doesn't keep a
+ * class loader from being unloaded; entries whose class loader has been
+ * unloaded are dropped when next looked at.  Classes loaded through the
+ * bootstrap class loader aren't cached.
+ *
+ * IIDs are hashed by their first word.  Entries for an IID are never removed
+ * before Destroy().
+ */
+class JavaInterfaceClassMap
+{
+  friend PLDHashOperator DestroyInterfaceClassMappingEnum(PLDHashTable* aTable,
+                                                       PLDHashEntryHdr* aHeader,
+                                                       PRUint32 aNumber,
+                                                       void* aData);
+
+protected:
+  // Java interface loaded through class loader 'loader'.  Items are
+  // refcounted, so that they can be compared with a class loader without
+  // holding the lock.
+  struct LoaderClass
+  {
+    LoaderClass(jweak aLoader, jweak aClass, LoaderClass* aList)
+      : loader(aLoader)
+      , clazz(aClass)
+      , refCount(1)
+      , next(aList)
+    { }
+
+    const jweak   loader;
+    const jweak   clazz;
+    PRInt32       refCount;   // one reference held by the map
+    LoaderClass*  next;
+  };
+
+  struct InterfaceList
+  {
+    InterfaceList(const nsIID& aIID, nsIInterfaceInfo* aIInfo,
+                  InterfaceList* aList)
+      : iid(aIID)
+      , iinfo(aIInfo)
+      , clazz(nullptr)
+      , loaderClasses(nullptr)
+      , next(aList)
+    {
+      NS_ADDREF(iinfo);
+    }
+
+    ~InterfaceList()
+    {
+      NS_RELEASE(iinfo);
+    }
+
+    const nsIID         iid;
+    nsIInterfaceInfo*   iinfo;
+    jclass              clazz;          // global ref; loaded without a given
+                                        // class loader, or null
+    LoaderClass*        loaderClasses;
+    InterfaceList*      next;
+  };
+
+  struct Entry : public PLDHashEntryHdr
+  {
+    PRUword         key;
+    InterfaceList*  list;
+  };
+
+public:
+  JavaInterfaceClassMap()
+    : mHashTable(nullptr)
+    , mLock(nullptr)
+  { }
+
+  ~JavaInterfaceClassMap()
+  {
+    NS_ASSERTION(mHashTable == nullptr,
+                 "MUST call Destroy() before deleting object");
+  }
+
+  nsresult Init();
+
+  nsresult Destroy(JNIEnv* env);
+
+  /**
+   * Returns the interface info for the given IID.
+   *
+   * @param aIID    IID of an XPCOM interface
+   * @param aResult on success, holds AddRef'd interface info
+   */
+  nsresult GetInterfaceInfo(const nsIID& aIID, nsIInterfaceInfo** aResult);
+
+  /**
+   * Returns the Java interface for the given IID, loading it the first time
+   * it is asked for.
+   *
+   * @param aIID          IID of an XPCOM interface
+   * @param aObjectLoader Java object whose class loader is used to load the
+   *                      interface; can be null
+   * @param aResult       on success, holds a local ref to the class
+   * @param aIInfo        if not null, on success holds AddRef'd interface
+   *                      info
+   */
+  nsresult GetClass(JNIEnv* env, const nsIID& aIID, jobject aObjectLoader,
+                    jclass* aResult, nsIInterfaceInfo** aIInfo = nullptr);
+
+protected:
+  nsresult GetEntry(const nsIID& aIID, InterfaceList** aResult);
+
+  nsresult GetLoaderClass(JNIEnv* env, InterfaceList* aItem, jobject aLoader,
+                          jclass* aResult);
+
+  void AddLoaderClass(JNIEnv* env, InterfaceList* aItem, jobject aLoader,
+                      jclass aClass);
+
+  static void ReleaseLoaderClass(JNIEnv* env, LoaderClass* aLoaderClass);
+
   PLDHashTable* mHashTable;
+  PRLock*       mLock;
 };
 
 
@@ -279,6 +957,28 @@ nsresult NativeInterfaceToJavaObject(JNIEnv* env, nsISupports* aXPCOMObject,
                                      const nsIID& aIID, jobject aObjectLoader,
                                      jobject* aResult);
 
+/**
+ * Convert an array of native nsISupports to Java objects.  This is the same as
+ * calling NativeInterfaceToJavaObject() for each element, except that the
+ * existing Java proxies of all elements are looked up together.
+ *
+ * @param env           Java environment pointer
+ * @param aXPCOMObjects XPCOM objects to convert; may contain null entries
+ * @param aCount        number of objects
+ * @param aIID          desired interface IID for Java objects
+ * @param aObjectLoader Java object whose class loader we use for finding
+ *                      classes; can be null
+ * @param aResult       Java array, at least aCount long, that receives the
+ *                      Java objects
+ *
+ * @return  NS_OK if succeeded; all other return values are error codes.
+ */
+nsresult NativeInterfacesToJavaObjects(JNIEnv* env,
+                                       nsISupports* const* aXPCOMObjects,
+                                       PRUint32 aCount, const nsIID& aIID,
+                                       jobject aObjectLoader,
+                                       jobjectArray aResult);
+
 /**
  * Convert a Java object to a native nsISupports object.
  *
@@ -339,7 +1039,12 @@ FindClassInLoader(JNIEnv* env, jobject aObjectLoader, const char* aClassName)
  * useful in callbacks or other functions that are not called directly from
  * Java and therefore do not have the JNIEnv structure passed in.
  *
- * @return  pointer to JNIEnv structure for current thread
+ * The JNIEnv is cached per thread.  If the current thread is not attached to
+ * the JVM (such as a Gecko worker thread calling a Java-implemented XPCOM
+ * object), it is attached as a daemon thread, and detached when it exits.
+ * If the thread can't be attached, the process is aborted.
+ *
+ * @return  pointer to JNIEnv structure for current thread; never null
  */
 JNIEnv* GetJNIEnv();
 
@@ -376,6 +1081,30 @@ void ThrowException(JNIEnv* env, const nsresult aErrorCode,
 nsString* jstring_to_nsString(JNIEnv* env, jstring aString);
 nsCString* jstring_to_nsCString(JNIEnv* env, jstring aString);
 
+/**
+ * Helper functions for converting between java.lang.String and standard
+ * UTF-8 (as used by AUTF8String and ACString).  Unlike JNI's
+ * GetStringUTFChars() and NewStringUTF(), these handle supplementary
+ * characters and embedded NULs, and never rely on a NUL terminator.
+ *
+ * @param env       Java environment pointer
+ * @param aString   Java string to convert; if <code>null</code>, aResult is
+ *                  made 'void'
+ * @param aResult   receives the UTF-8 bytes
+ *
+ * @return  NS_OK for success; NS_ERROR_OUT_OF_MEMORY otherwise
+ */
+nsresult jstring_to_UTF8(JNIEnv* env, jstring aString, nsACString& aResult);
+
+/**
+ * @param env       Java environment pointer
+ * @param aBytes    UTF-8 bytes to convert
+ * @param aLength   number of bytes in aBytes
+ *
+ * @return  new Java string, or <code>nullptr</code> if out of memory
+ */
+jstring UTF8_to_jstring(JNIEnv* env, const char* aBytes, PRUint32 aLength);
+
 /**
  * Helper function for converting from java.io.File to nsILocalFile.
  *
@@ -41,6 +41,8 @@
 #include "nsJavaXPTCStub.h"
 #include "nsJavaWrapper.h"
 #include "nsJavaXPCOMBindingUtils.h"
+#include "nsJavaCallArena.h"
+#include "nsJavaCallStats.h"
 #include "prmem.h"
 #include "nsIInterfaceInfoManager.h"
 #include "nsStringAPI.h"
@@ -51,7 +53,9 @@
 nsJavaXPTCStub::nsJavaXPTCStub(jobject aJavaObject, nsIInterfaceInfo *aIInfo,
                                nsresult *rv)
   : mJavaStrongRef(nullptr)
+  , mJavaIdentityRef(nullptr)
   , mIInfo(aIInfo)
+  , mMethods(nullptr)
   , mMaster(nullptr)
   , mWeakRefCnt(0)
 {
@@ -63,10 +67,17 @@ nsJavaXPTCStub::nsJavaXPTCStub(jobject aJavaObject, nsIInterfaceInfo *aIInfo,
   if (NS_FAILED(*rv))
     return;
 
+  // The resolved Java methods are shared with the stubs of other objects of
+  // the same class.
   JNIEnv* env = GetJNIEnv();
+  *rv = gJavaStubClassMap->Get(env, aJavaObject, aIInfo, &mMethods);
+  if (NS_FAILED(*rv))
+    return;
+
   jobject weakref = env->NewObject(weakReferenceClass,
                                    weakReferenceConstructorMID, aJavaObject);
   mJavaWeakRef = env->NewGlobalRef(weakref);
+  mJavaIdentityRef = env->NewWeakGlobalRef(aJavaObject);
   mJavaRefHashCode = env->CallStaticIntMethod(systemClass, hashCodeMID,
                                               aJavaObject);
 
@@ -80,6 +91,10 @@ nsJavaXPTCStub::nsJavaXPTCStub(jobject aJavaObject, nsIInterfaceInfo *aIInfo,
 
 nsJavaXPTCStub::~nsJavaXPTCStub()
 {
+  if (mJavaIdentityRef)
+    GetJNIEnv()->DeleteWeakGlobalRef(mJavaIdentityRef);
+  if (mMethods)
+    JavaStubClassMap::Release(GetJNIEnv(), mMethods);
 }
 
 NS_IMETHODIMP_(MozExternalRefCountType)
@@ -187,7 +202,7 @@ nsJavaXPTCStub::Destroy()
     // It is possible for mJavaStrongRef to be NULL here.  That is why we
     // store the hash code value earlier.
     if (gJavaXPCOMInitialized) {
-      gJavaToXPTCStubMap->Remove(mJavaRefHashCode);
+      gJavaToXPTCStubMap->Remove(mJavaRefHashCode, this);
     }
   }
 
@@ -307,12 +322,8 @@ nsJavaXPTCStub::QueryInterface(const nsID &aIID, void **aInstancePtr)
     return NS_NOINTERFACE;
 
   // Get interface info for new java object
-  nsCOMPtr<nsIInterfaceInfoManager>
-    iim(do_GetService(NS_INTERFACEINFOMANAGER_SERVICE_CONTRACTID, &rv));
-  NS_ENSURE_SUCCESS(rv, rv);
-
   nsCOMPtr<nsIInterfaceInfo> iinfo;
-  rv = iim->GetInfoForIID(&aIID, getter_AddRefs(iinfo));
+  rv = gJavaInterfaceClassMap->GetInterfaceInfo(aIID, getter_AddRefs(iinfo));
   if (NS_FAILED(rv))
     return rv;
 
@@ -403,141 +414,97 @@ nsJavaXPTCStub::CallMethod(PRUint16 aMethodIndex,
 
   nsresult rv = NS_OK;
   JNIEnv* env = GetJNIEnv();
-  jobject javaObject = env->CallObjectMethod(mJavaWeakRef, getReferentMID);
+  jobject javaObject = env->NewLocalRef(mJavaIdentityRef);
 
-  nsEmbedCString methodSig("(");
+  nsJavaCallStats::AutoCall callStats(nsJavaCallStats::kXPCOMToJava, mIInfo,
+                                      aMethodIndex);
+
+  // Get Java method to call
+  const JavaStubMethod* method = nullptr;
+  rv = GetJavaMethod(env, javaObject, aMethodIndex, aMethodInfo, aParams,
+                     &method);
+
+  // The jvalue array only lives for this call, so take it from the thread's
+  // call arena.
+  nsJavaCallArena* arena = nsJavaCallArena::Get();
+  nsJavaCallArena::Mark mark(arena);
 
   // Create jvalue array to hold Java params
   PRUint8 paramCount = aMethodInfo->num_args;
   jvalue* java_params = nullptr;
-  const nsXPTParamInfo* retvalInfo = nullptr;
-  if (paramCount) {
-    java_params = new jvalue[paramCount];
-    if (!java_params)
-      return NS_ERROR_OUT_OF_MEMORY;
+  if (paramCount && NS_SUCCEEDED(rv)) {
+    java_params = static_cast<jvalue*>(
+                    arena->Allocate(paramCount * sizeof(jvalue)));
 
     for (PRUint8 i = 0; i < paramCount && NS_SUCCEEDED(rv); i++)
     {
       const nsXPTParamInfo &paramInfo = aMethodInfo->params[i];
       if (!paramInfo.IsRetval()) {
-        rv = SetupJavaParams(paramInfo, aMethodInfo, aMethodIndex, aParams,
-                             aParams[i], java_params[i], methodSig);
-      } else {
-        retvalInfo = &paramInfo;
+        rv = SetupJavaParams(env, javaObject, method->params[i], paramInfo,
+                             aMethodInfo, aMethodIndex, aParams, aParams[i],
+                             java_params[i]);
       }
     }
     NS_ASSERTION(NS_SUCCEEDED(rv), "SetupJavaParams failed");
   }
 
-  // Finish method signature
-  if (NS_SUCCEEDED(rv)) {
-    methodSig.Append(')');
-    if (retvalInfo) {
-      nsEmbedCString retvalSig;
-      rv = GetRetvalSig(retvalInfo, aMethodInfo, aMethodIndex, aParams,
-                        retvalSig);
-      methodSig.Append(retvalSig);
-    } else {
-      methodSig.Append('V');
-    }
-    NS_ASSERTION(NS_SUCCEEDED(rv), "GetRetvalSig failed");
-  }
-
-  // Get Java method to call
-  jmethodID mid = nullptr;
-  if (NS_SUCCEEDED(rv)) {
-    nsEmbedCString methodName;
-    if (XPT_MD_IS_GETTER(aMethodInfo->flags) ||
-        XPT_MD_IS_SETTER(aMethodInfo->flags)) {
-      if (XPT_MD_IS_GETTER(aMethodInfo->flags))
-        methodName.AppendLiteral("get");
-      else
-        methodName.AppendLiteral("set");
-      methodName.AppendASCII(aMethodInfo->name);
-      methodName.SetCharAt(toupper(methodName[3]), 3);
-    } else {
-      methodName.AppendASCII(aMethodInfo->name);
-      methodName.SetCharAt(tolower(methodName[0]), 0);
-    }
-    // If it's a Java keyword, then prepend an underscore
-    if (gJavaKeywords->GetEntry(methodName.get())) {
-      methodName.Insert('_', 0);
-    }
-
-    jclass clazz = env->GetObjectClass(javaObject);
-    if (clazz)
-      mid = env->GetMethodID(clazz, methodName.get(), methodSig.get());
-    NS_ASSERTION(mid, "Failed to get requested method for Java object");
-    if (!mid)
-      rv = NS_ERROR_FAILURE;
-  }
-
   // Call method
   jvalue retval;
   if (NS_SUCCEEDED(rv)) {
-    if (!retvalInfo) {
-      env->CallVoidMethodA(javaObject, mid, java_params);
-    } else {
-      switch (retvalInfo->GetType().TagPart())
-      {
-        case nsXPTType::T_I8:
-          retval.b = env->CallByteMethodA(javaObject, mid, java_params);
-          break;
+    jmethodID mid = method->methodID;
+    callStats.BeginInvoke();
+    switch (method->retvalKind)
+    {
+      case kStubValueNone:
+        env->CallVoidMethodA(javaObject, mid, java_params);
+        break;
 
-        case nsXPTType::T_I16:
-        case nsXPTType::T_U8:
-          retval.s = env->CallShortMethodA(javaObject, mid, java_params);
-          break;
+      case kStubValueByte:
+        retval.b = env->CallByteMethodA(javaObject, mid, java_params);
+        break;
 
-        case nsXPTType::T_I32:
-        case nsXPTType::T_U16:
-          retval.i = env->CallIntMethodA(javaObject, mid, java_params);
-          break;
+      case kStubValueShort:
+        retval.s = env->CallShortMethodA(javaObject, mid, java_params);
+        break;
 
-        case nsXPTType::T_I64:
-        case nsXPTType::T_U32:
-          retval.j = env->CallLongMethodA(javaObject, mid, java_params);
-          break;
+      case kStubValueInt:
+        retval.i = env->CallIntMethodA(javaObject, mid, java_params);
+        break;
 
-        case nsXPTType::T_FLOAT:
-          retval.f = env->CallFloatMethodA(javaObject, mid, java_params);
-          break;
+      case kStubValueLong:
+      case kStubValueVoidPtr:
+        retval.j = env->CallLongMethodA(javaObject, mid, java_params);
+        break;
 
-        case nsXPTType::T_U64:
-        case nsXPTType::T_DOUBLE:
-          retval.d = env->CallDoubleMethodA(javaObject, mid, java_params);
-          break;
+      case kStubValueFloat:
+        retval.f = env->CallFloatMethodA(javaObject, mid, java_params);
+        break;
 
-        case nsXPTType::T_BOOL:
-          retval.z = env->CallBooleanMethodA(javaObject, mid, java_params);
-          break;
+      case kStubValueDouble:
+        retval.d = env->CallDoubleMethodA(javaObject, mid, java_params);
+        break;
 
-        case nsXPTType::T_CHAR:
-        case nsXPTType::T_WCHAR:
-          retval.c = env->CallCharMethodA(javaObject, mid, java_params);
-          break;
+      case kStubValueBoolean:
+        retval.z = env->CallBooleanMethodA(javaObject, mid, java_params);
+        break;
 
-        case nsXPTType::T_CHAR_STR:
-        case nsXPTType::T_WCHAR_STR:
-        case nsXPTType::T_IID:
-        case nsXPTType::T_ASTRING:
-        case nsXPTType::T_DOMSTRING:
-        case nsXPTType::T_UTF8STRING:
-        case nsXPTType::T_CSTRING:
-        case nsXPTType::T_INTERFACE:
-        case nsXPTType::T_INTERFACE_IS:
-          retval.l = env->CallObjectMethodA(javaObject, mid, java_params);
-          break;
+      case kStubValueChar:
+        retval.c = env->CallCharMethodA(javaObject, mid, java_params);
+        break;
 
-        case nsXPTType::T_VOID:
-          retval.j = env->CallLongMethodA(javaObject, mid, java_params);
-          break;
+      case kStubValueString:
+      case kStubValueIID:
+      case kStubValueInterface:
+      case kStubValueAString:
+      case kStubValueCString:
+        retval.l = env->CallObjectMethodA(javaObject, mid, java_params);
+        break;
 
-        default:
-          NS_WARNING("Unhandled retval type");
-          break;
-      }
+      default:
+        NS_WARNING("Unhandled retval type");
+        break;
     }
+    callStats.EndInvoke();
 
     // Check for exception from called Java function
     jthrowable exp = env->ExceptionOccurred();
@@ -546,14 +513,8 @@ nsJavaXPTCStub::CallMethod(PRUint16 aMethodIndex,
       // nsresult from the exception instance.  Else, default to
       // NS_ERROR_FAILURE.
       if (env->IsInstanceOf(exp, xpcomExceptionClass)) {
-        jfieldID fid;
-        fid = env->GetFieldID(xpcomExceptionClass, "errorcode", "J");
-        if (fid) {
-          rv = static_cast<nsresult>(env->GetLongField(exp, fid));
-        } else {
-          rv = NS_ERROR_FAILURE;
-        }
-        NS_ASSERTION(fid, "Couldn't get 'errorcode' field of XPCOMException");
+        rv = static_cast<nsresult>(env->GetLongField(exp,
+                                                  xpcomExceptionErrorcodeFID));
       } else {
         rv = NS_ERROR_FAILURE;
       }
@@ -573,19 +534,16 @@ nsJavaXPTCStub::CallMethod(PRUint16 aMethodIndex,
         continue;
 
       if (!paramInfo.IsRetval()) {
-        rv = FinalizeJavaParams(paramInfo, aMethodInfo, aMethodIndex, aParams,
-                                aParams[i], java_params[i]);
+        rv = FinalizeJavaParams(env, paramInfo, aMethodInfo, aMethodIndex,
+                                aParams, aParams[i], java_params[i]);
       } else {
-        rv = FinalizeJavaParams(paramInfo, aMethodInfo, aMethodIndex, aParams,
-                                aParams[i], retval);
+        rv = FinalizeJavaParams(env, paramInfo, aMethodInfo, aMethodIndex,
+                                aParams, aParams[i], retval);
       }
     }
     NS_ASSERTION(NS_SUCCEEDED(rv), "FinalizeJavaParams/SetXPCOMRetval failed");
   }
 
-  if (java_params)
-    delete [] java_params;
-
 #ifdef DEBUG
   if (env->ExceptionCheck())
     env->ExceptionDescribe();
@@ -602,25 +560,23 @@ nsJavaXPTCStub::CallMethod(PRUint16 aMethodIndex,
  * Handle 'in', 'inout', and 'out' params
  */
 nsresult
-nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
+nsJavaXPTCStub::SetupJavaParams(JNIEnv* env, jobject aJavaObject,
+                const JavaStubParam &aParam,
+                const nsXPTParamInfo &aParamInfo,
                 const XPTMethodDescriptor* aMethodInfo,
                 PRUint16 aMethodIndex,
                 nsXPTCMiniVariant* aDispatchParams,
-                nsXPTCMiniVariant &aVariant, jvalue &aJValue,
-                nsACString &aMethodSig)
+                nsXPTCMiniVariant &aVariant, jvalue &aJValue)
 {
   nsresult rv = NS_OK;
-  JNIEnv* env = GetJNIEnv();
-  const nsXPTType &type = aParamInfo.GetType();
 
-  PRUint8 tag = type.TagPart();
-  switch (tag)
+  PRUint8 tag = aParam.tag;
+  switch (aParam.kind)
   {
-    case nsXPTType::T_I8:
+    case kStubValueByte:
     {
       if (!aParamInfo.IsOut()) {  // 'in'
         aJValue.b = aVariant.val.i8;
-        aMethodSig.Append('B');
       } else {  // 'inout' & 'out'
         if (aVariant.val.p) {
           jbyteArray array = env->NewByteArray(1);
@@ -634,18 +590,15 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
         } else {
           aJValue.l = nullptr;
         }
-        aMethodSig.AppendLiteral("[B");
       }
     }
     break;
 
-    case nsXPTType::T_I16:
-    case nsXPTType::T_U8:
+    case kStubValueShort:
     {
       if (!aParamInfo.IsOut()) {  // 'in'
         aJValue.s = (tag == nsXPTType::T_I16) ? aVariant.val.i16 :
                                                 aVariant.val.u8;
-        aMethodSig.Append('S');
       } else {  // 'inout' & 'out'
         if (aVariant.val.p) {
           jshortArray array = env->NewShortArray(1);
@@ -659,18 +612,15 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
         } else {
           aJValue.l = nullptr;
         }
-        aMethodSig.AppendLiteral("[S");
       }
     }
     break;
 
-    case nsXPTType::T_I32:
-    case nsXPTType::T_U16:
+    case kStubValueInt:
     {
       if (!aParamInfo.IsOut()) {  // 'in'
         aJValue.i = (tag == nsXPTType::T_I32) ? aVariant.val.i32 :
                                                 aVariant.val.u16;
-        aMethodSig.Append('I');
       } else {  // 'inout' & 'out'
         if (aVariant.val.p) {
           jintArray array = env->NewIntArray(1);
@@ -684,18 +634,15 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
         } else {
           aJValue.l = nullptr;
         }
-        aMethodSig.AppendLiteral("[I");
       }
     }
     break;
 
-    case nsXPTType::T_I64:
-    case nsXPTType::T_U32:
+    case kStubValueLong:
     {
       if (!aParamInfo.IsOut()) {  // 'in'
         aJValue.j = (tag == nsXPTType::T_I64) ? aVariant.val.i64 :
                                                 aVariant.val.u32;
-        aMethodSig.Append('J');
       } else {  // 'inout' & 'out'
         if (aVariant.val.p) {
           jlongArray array = env->NewLongArray(1);
@@ -709,16 +656,14 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
         } else {
           aJValue.l = nullptr;
         }
-        aMethodSig.AppendLiteral("[J");
       }
     }
     break;
 
-    case nsXPTType::T_FLOAT:
+    case kStubValueFloat:
     {
       if (!aParamInfo.IsOut()) {  // 'in'
         aJValue.f = aVariant.val.f;
-        aMethodSig.Append('F');
       } else {  // 'inout' & 'out'
         if (aVariant.val.p) {
           jfloatArray array = env->NewFloatArray(1);
@@ -732,19 +677,16 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
         } else {
           aJValue.l = nullptr;
         }
-        aMethodSig.AppendLiteral("[F");
       }
     }
     break;
 
     // XXX how do we handle unsigned 64-bit values?
-    case nsXPTType::T_U64:
-    case nsXPTType::T_DOUBLE:
+    case kStubValueDouble:
     {
       if (!aParamInfo.IsOut()) {  // 'in'
         aJValue.d = (tag == nsXPTType::T_DOUBLE) ? aVariant.val.d :
                                                    aVariant.val.u64;
-        aMethodSig.Append('D');
       } else {  // 'inout' & 'out'
         if (aVariant.val.p) {
           jdoubleArray array = env->NewDoubleArray(1);
@@ -758,16 +700,14 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
         } else {
           aJValue.l = nullptr;
         }
-        aMethodSig.AppendLiteral("[D");
       }
     }
     break;
 
-    case nsXPTType::T_BOOL:
+    case kStubValueBoolean:
     {
       if (!aParamInfo.IsOut()) {  // 'in'
         aJValue.z = aVariant.val.b;
-        aMethodSig.Append('Z');
       } else {  // 'inout' & 'out'
         if (aVariant.val.p) {
           jbooleanArray array = env->NewBooleanArray(1);
@@ -781,20 +721,17 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
         } else {
           aJValue.l = nullptr;
         }
-        aMethodSig.AppendLiteral("[Z");
       }
     }
     break;
 
-    case nsXPTType::T_CHAR:
-    case nsXPTType::T_WCHAR:
+    case kStubValueChar:
     {
       if (!aParamInfo.IsOut()) {  // 'in'
         if (tag == nsXPTType::T_CHAR)
           aJValue.c = aVariant.val.c;
         else
           aJValue.c = aVariant.val.wc;
-        aMethodSig.Append('C');
       } else {  // 'inout' & 'out'
         if (aVariant.val.p) {
           jcharArray array = env->NewCharArray(1);
@@ -808,13 +745,11 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
         } else {
           aJValue.l = nullptr;
         }
-        aMethodSig.AppendLiteral("[C");
       }
     }
     break;
 
-    case nsXPTType::T_CHAR_STR:
-    case nsXPTType::T_WCHAR_STR:
+    case kStubValueString:
     {
       void* ptr = nullptr;
       if (!aParamInfo.IsOut()) {  // 'in'
@@ -842,7 +777,6 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
 
       if (!aParamInfo.IsOut()) {  // 'in'
         aJValue.l = str;
-        aMethodSig.AppendLiteral("Ljava/lang/String;");
       } else {  // 'inout' & 'out'
         if (aVariant.val.p) {
           aJValue.l = env->NewObjectArray(1, stringClass, str);
@@ -853,12 +787,11 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
         } else {
           aJValue.l = nullptr;
         }
-        aMethodSig.AppendLiteral("[Ljava/lang/String;");
       }
     }
     break;
 
-    case nsXPTType::T_IID:
+    case kStubValueIID:
     {
       nsID* iid = nullptr;
       if (!aParamInfo.IsOut()) {  // 'in'
@@ -881,7 +814,6 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
 
       if (!aParamInfo.IsOut()) {  // 'in'
         aJValue.l = str;
-        aMethodSig.AppendLiteral("Ljava/lang/String;");
       } else {  // 'inout' & 'out'
         if (aVariant.val.p) {
           aJValue.l = env->NewObjectArray(1, stringClass, str);
@@ -892,13 +824,11 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
         } else {
           aJValue.l = nullptr;
         }
-        aMethodSig.AppendLiteral("[Ljava/lang/String;");
       }
     }
     break;
 
-    case nsXPTType::T_INTERFACE:
-    case nsXPTType::T_INTERFACE_IS:
+    case kStubValueInterface:
     {
       nsISupports* xpcom_obj = nullptr;
       if (!aParamInfo.IsOut()) {  // 'in'
@@ -909,28 +839,15 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
       }
 
       nsID iid;
-      rv = GetIIDForMethodParam(mIInfo, aMethodInfo, aParamInfo,
-                                aParamInfo.GetType().TagPart(), aMethodIndex,
-                                aDispatchParams, PR_FALSE, iid);
+      rv = GetIIDForMethodParam(mIInfo, aMethodInfo, aParamInfo, tag,
+                                aMethodIndex, aDispatchParams, PR_FALSE, iid);
       if (NS_FAILED(rv))
         break;
 
-      // get name of interface
-      char* iface_name = nullptr;
-      nsCOMPtr<nsIInterfaceInfoManager>
-        iim(do_GetService(NS_INTERFACEINFOMANAGER_SERVICE_CONTRACTID, &rv));
-      if (NS_FAILED(rv))
-        break;
-
-      rv = iim->GetNameForIID(&iid, &iface_name);
-      if (NS_FAILED(rv) || !iface_name)
-        break;
-
       jobject java_stub = nullptr;
       if (xpcom_obj) {
         // Get matching Java object for given xpcom object
-        jobject objLoader = env->CallObjectMethod(mJavaWeakRef, getReferentMID);
-        rv = NativeInterfaceToJavaObject(env, xpcom_obj, iid, objLoader,
+        rv = NativeInterfaceToJavaObject(env, xpcom_obj, iid, aJavaObject,
                                          &java_stub);
         if (NS_FAILED(rv))
           break;
@@ -948,23 +865,11 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
         } else {
           aJValue.l = nullptr;
         }
-        aMethodSig.Append('[');
       }
-
-      if (tag != nsXPTType::T_INTERFACE_IS) {
-        aMethodSig.AppendLiteral("Lorg/mozilla/interfaces/");
-        aMethodSig.AppendASCII(iface_name);
-        aMethodSig.Append(';');
-      } else {
-        aMethodSig.AppendLiteral("Lorg/mozilla/interfaces/nsISupports;");
-      }
-
-      free(iface_name);
     }
     break;
 
-    case nsXPTType::T_ASTRING:
-    case nsXPTType::T_DOMSTRING:
+    case kStubValueAString:
     {
       // This only handle 'in' or 'in dipper' params.  In XPIDL, the 'out'
       // descriptor is mapped to 'in dipper'.
@@ -982,6 +887,7 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
 
       jstring jstr = nullptr;
       if (!str->IsVoid()) {
+        nsJavaCallStats::AddBytes(str->Length() * sizeof(jchar));
         jstr = env->NewString((const jchar *)str->get(), str->Length());
         if (!jstr) {
           rv = NS_ERROR_OUT_OF_MEMORY;
@@ -990,12 +896,10 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
       }
 
       aJValue.l = jstr;
-      aMethodSig.AppendLiteral("Ljava/lang/String;");
     }
     break;
 
-    case nsXPTType::T_UTF8STRING:
-    case nsXPTType::T_CSTRING:
+    case kStubValueCString:
     {
       // This only handle 'in' or 'in dipper' params.  In XPIDL, the 'out'
       // descriptor is mapped to 'in dipper'.
@@ -1005,7 +909,7 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
         break;
       }
 
-      nsCString* str = static_cast<nsCString*>(aVariant.val.p);
+      const nsACString* str = static_cast<const nsACString*>(aVariant.val.p);
       if (!str) {
         rv = NS_ERROR_FAILURE;
         break;
@@ -1013,7 +917,7 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
 
       jstring jstr = nullptr;
       if (!str->IsVoid()) {
-        jstr = env->NewStringUTF(str->get());
+        jstr = UTF8_to_jstring(env, str->BeginReading(), str->Length());
         if (!jstr) {
           rv = NS_ERROR_OUT_OF_MEMORY;
           break;
@@ -1021,16 +925,14 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
       }
 
       aJValue.l = jstr;
-      aMethodSig.AppendLiteral("Ljava/lang/String;");
     }
     break;
 
     // Pass the 'void*' address as a long
-    case nsXPTType::T_VOID:
+    case kStubValueVoidPtr:
     {
       if (!aParamInfo.IsOut()) {  // 'in'
         aJValue.j = reinterpret_cast<jlong>(aVariant.val.p);
-        aMethodSig.Append('J');
       } else {  // 'inout' & 'out'
         if (aVariant.val.p) {
           jlongArray array = env->NewLongArray(1);
@@ -1044,18 +946,10 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
         } else {
           aJValue.l = nullptr;
         }
-        aMethodSig.AppendLiteral("[J");
       }
     }
     break;
 
-    case nsXPTType::T_ARRAY:
-      NS_WARNING("array types are not yet supported");
-      return NS_ERROR_NOT_IMPLEMENTED;
-      break;
-
-    case nsXPTType::T_PSTRING_SIZE_IS:
-    case nsXPTType::T_PWSTRING_SIZE_IS:
     default:
       NS_WARNING("unexpected parameter type");
       return NS_ERROR_UNEXPECTED;
@@ -1064,51 +958,205 @@ nsJavaXPTCStub::SetupJavaParams(const nsXPTParamInfo &aParamInfo,
   return rv;
 }
 
+/**
+ * Returns how values of the given XPT type are passed to or from Java, or
+ * kStubValueNone if the type isn't supported.
+ */
+static PRUint8
+GetStubValueKind(PRUint8 aTag)
+{
+  switch (aTag)
+  {
+    case nsXPTType::T_I8:
+      return kStubValueByte;
+    case nsXPTType::T_I16:
+    case nsXPTType::T_U8:
+      return kStubValueShort;
+    case nsXPTType::T_I32:
+    case nsXPTType::T_U16:
+      return kStubValueInt;
+    case nsXPTType::T_I64:
+    case nsXPTType::T_U32:
+      return kStubValueLong;
+    case nsXPTType::T_FLOAT:
+      return kStubValueFloat;
+    case nsXPTType::T_U64:
+    case nsXPTType::T_DOUBLE:
+      return kStubValueDouble;
+    case nsXPTType::T_BOOL:
+      return kStubValueBoolean;
+    case nsXPTType::T_CHAR:
+    case nsXPTType::T_WCHAR:
+      return kStubValueChar;
+    case nsXPTType::T_CHAR_STR:
+    case nsXPTType::T_WCHAR_STR:
+      return kStubValueString;
+    case nsXPTType::T_IID:
+      return kStubValueIID;
+    case nsXPTType::T_INTERFACE:
+    case nsXPTType::T_INTERFACE_IS:
+      return kStubValueInterface;
+    case nsXPTType::T_ASTRING:
+    case nsXPTType::T_DOMSTRING:
+      return kStubValueAString;
+    case nsXPTType::T_UTF8STRING:
+    case nsXPTType::T_CSTRING:
+      return kStubValueCString;
+    case nsXPTType::T_VOID:
+      return kStubValueVoidPtr;
+    default:
+      return kStubValueNone;
+  }
+}
+
 nsresult
-nsJavaXPTCStub::GetRetvalSig(const nsXPTParamInfo* aParamInfo,
-                             const XPTMethodDescriptor* aMethodInfo,
-                             PRUint16 aMethodIndex,
-                             nsXPTCMiniVariant* aDispatchParams,
-                             nsACString &aRetvalSig)
+nsJavaXPTCStub::GetJavaMethod(JNIEnv* env, jobject aJavaObject,
+                              PRUint16 aMethodIndex,
+                              const XPTMethodDescriptor* aMethodInfo,
+                              nsXPTCMiniVariant* aDispatchParams,
+                              const JavaStubMethod** aResult)
 {
+  NS_PRECONDITION(aMethodIndex < mMethods->methodCount,
+                  "method index out of range");
+
+  JavaStubClassInfo::MethodSlot& slot = mMethods->methods[aMethodIndex];
+  const JavaStubMethod* method = slot;
+  if (method) {
+    *aResult = method;
+    return NS_OK;
+  }
+
+  // Build method signature
+  nsresult rv = NS_OK;
+  nsEmbedCString methodSig("(");
+  const nsXPTParamInfo* retvalInfo = nullptr;
+  for (PRUint8 i = 0; i < aMethodInfo->num_args && NS_SUCCEEDED(rv); i++)
+  {
+    const nsXPTParamInfo &paramInfo = aMethodInfo->params[i];
+    if (!paramInfo.IsRetval()) {
+      rv = GetParamSig(&paramInfo, aMethodInfo, aMethodIndex, aDispatchParams,
+                       methodSig);
+    } else {
+      retvalInfo = &paramInfo;
+    }
+  }
+  if (NS_SUCCEEDED(rv)) {
+    methodSig.Append(')');
+    if (retvalInfo) {
+      rv = GetParamSig(retvalInfo, aMethodInfo, aMethodIndex, aDispatchParams,
+                       methodSig);
+    } else {
+      methodSig.Append('V');
+    }
+  }
+  NS_ASSERTION(NS_SUCCEEDED(rv), "GetParamSig failed");
+  if (NS_FAILED(rv))
+    return rv;
+
+  // Build method name
+  nsEmbedCString methodName;
+  if (XPT_MD_IS_GETTER(aMethodInfo->flags) ||
+      XPT_MD_IS_SETTER(aMethodInfo->flags)) {
+    if (XPT_MD_IS_GETTER(aMethodInfo->flags))
+      methodName.AppendLiteral("get");
+    else
+      methodName.AppendLiteral("set");
+    methodName.AppendASCII(aMethodInfo->name);
+    methodName.SetCharAt(toupper(methodName[3]), 3);
+  } else {
+    methodName.AppendASCII(aMethodInfo->name);
+    methodName.SetCharAt(tolower(methodName[0]), 0);
+  }
+  // If it's a Java keyword, then prepend an underscore
+  if (gJavaKeywords->GetEntry(methodName.get())) {
+    methodName.Insert('_', 0);
+  }
+
+  jmethodID mid = nullptr;
+  jclass clazz = env->GetObjectClass(aJavaObject);
+  if (clazz) {
+    mid = env->GetMethodID(clazz, methodName.get(), methodSig.get());
+    env->DeleteLocalRef(clazz);
+  }
+  NS_ASSERTION(mid, "Failed to get requested method for Java object");
+  if (!mid)
+    return NS_ERROR_FAILURE;
+
+  // GetParamSig() has already rejected the types that aren't supported.
+  PRUint8 paramCount = aMethodInfo->num_args;
+  JavaStubMethod* newMethod = new JavaStubMethod(mid, paramCount);
+  if (!newMethod || (paramCount && !newMethod->params)) {
+    delete newMethod;
+    return NS_ERROR_OUT_OF_MEMORY;
+  }
+  for (PRUint8 i = 0; i < paramCount; i++) {
+    const nsXPTParamInfo &paramInfo = aMethodInfo->params[i];
+    PRUint8 tag = paramInfo.GetType().TagPart();
+    newMethod->params[i].tag = tag;
+    newMethod->params[i].kind = GetStubValueKind(tag);
+  }
+  if (retvalInfo) {
+    newMethod->retvalKind = GetStubValueKind(retvalInfo->GetType().TagPart());
+  }
+
+  // Another thread may have resolved the same method in the meantime, in
+  // which case its result is used.
+  if (!slot.compareExchange(nullptr, newMethod)) {
+    delete newMethod;
+  }
+  *aResult = slot;
+  return NS_OK;
+}
+
+nsresult
+nsJavaXPTCStub::GetParamSig(const nsXPTParamInfo* aParamInfo,
+                            const XPTMethodDescriptor* aMethodInfo,
+                            PRUint16 aMethodIndex,
+                            nsXPTCMiniVariant* aDispatchParams,
+                            nsACString &aSig)
+{
+  // 'inout' and 'out' params are passed to Java as single element arrays
+  if (aParamInfo->IsOut() && !aParamInfo->IsRetval())
+    aSig.Append('[');
+
   PRUint8 type = aParamInfo->GetType().TagPart();
   switch (type)
   {
     case nsXPTType::T_I8:
-      aRetvalSig.Append('B');
+      aSig.Append('B');
       break;
 
     case nsXPTType::T_I16:
     case nsXPTType::T_U8:
-      aRetvalSig.Append('S');
+      aSig.Append('S');
       break;
 
     case nsXPTType::T_I32:
     case nsXPTType::T_U16:
-      aRetvalSig.Append('I');
+      aSig.Append('I');
       break;
 
     case nsXPTType::T_I64:
     case nsXPTType::T_U32:
-      aRetvalSig.Append('J');
+      aSig.Append('J');
       break;
 
     case nsXPTType::T_FLOAT:
-      aRetvalSig.Append('F');
+      aSig.Append('F');
       break;
 
     case nsXPTType::T_U64:
     case nsXPTType::T_DOUBLE:
-      aRetvalSig.Append('D');
+      aSig.Append('D');
       break;
 
     case nsXPTType::T_BOOL:
-      aRetvalSig.Append('Z');
+      aSig.Append('Z');
       break;
 
     case nsXPTType::T_CHAR:
     case nsXPTType::T_WCHAR:
-      aRetvalSig.Append('C');
+      aSig.Append('C');
       break;
 
     case nsXPTType::T_CHAR_STR:
@@ -1118,7 +1166,7 @@ nsJavaXPTCStub::GetRetvalSig(const nsXPTParamInfo* aParamInfo,
     case nsXPTType::T_DOMSTRING:
     case nsXPTType::T_UTF8STRING:
     case nsXPTType::T_CSTRING:
-      aRetvalSig.AppendLiteral("Ljava/lang/String;");
+      aSig.AppendLiteral("Ljava/lang/String;");
       break;
 
     case nsXPTType::T_INTERFACE:
@@ -1131,29 +1179,28 @@ nsJavaXPTCStub::GetRetvalSig(const nsXPTParamInfo* aParamInfo,
         break;
 
       // get name of interface
-      char* iface_name = nullptr;
-      nsCOMPtr<nsIInterfaceInfoManager>
-        iim(do_GetService(NS_INTERFACEINFOMANAGER_SERVICE_CONTRACTID, &rv));
+      nsCOMPtr<nsIInterfaceInfo> info;
+      rv = gJavaInterfaceClassMap->GetInterfaceInfo(iid, getter_AddRefs(info));
       if (NS_FAILED(rv))
         break;
 
-      rv = iim->GetNameForIID(&iid, &iface_name);
-      if (NS_FAILED(rv) || !iface_name)
+      const char* iface_name;
+      rv = info->GetNameShared(&iface_name);
+      if (NS_FAILED(rv))
         break;
 
-      aRetvalSig.AppendLiteral("Lorg/mozilla/interfaces/");
-      aRetvalSig.AppendASCII(iface_name);
-      aRetvalSig.Append(';');
-      free(iface_name);
+      aSig.AppendLiteral("Lorg/mozilla/interfaces/");
+      aSig.AppendASCII(iface_name);
+      aSig.Append(';');
       break;
     }
 
     case nsXPTType::T_INTERFACE_IS:
-      aRetvalSig.AppendLiteral("Lorg/mozilla/interfaces/nsISupports;");
+      aSig.AppendLiteral("Lorg/mozilla/interfaces/nsISupports;");
       break;
 
     case nsXPTType::T_VOID:
-      aRetvalSig.Append('J');
+      aSig.Append('J');
       break;
 
     case nsXPTType::T_ARRAY:
@@ -1175,14 +1222,14 @@ nsJavaXPTCStub::GetRetvalSig(const nsXPTParamInfo* aParamInfo,
  * Handle 'inout', 'out', and 'retval' params
  */
 nsresult
-nsJavaXPTCStub::FinalizeJavaParams(const nsXPTParamInfo &aParamInfo,
+nsJavaXPTCStub::FinalizeJavaParams(JNIEnv* env,
+                                 const nsXPTParamInfo &aParamInfo,
                                  const XPTMethodDescriptor *aMethodInfo,
                                  PRUint16 aMethodIndex,
                                  nsXPTCMiniVariant* aDispatchParams,
                                  nsXPTCMiniVariant &aVariant, jvalue &aJValue)
 {
   nsresult rv = NS_OK;
-  JNIEnv* env = GetJNIEnv();
   const nsXPTType &type = aParamInfo.GetType();
 
   PRUint8 tag = type.TagPart();
@@ -1554,17 +1601,16 @@ nsJavaXPTCStub::FinalizeJavaParams(const nsXPTParamInfo &aParamInfo,
       nsString* variant = static_cast<nsString*>(aVariant.val.p);
       
       if (jstr) {
-        // Get string buffer
-        const jchar* wchar_ptr = env->GetStringChars(jstr, nullptr);
-        if (!wchar_ptr) {
+        // Copy the chars straight into the result.  Java strings are not
+        // null-terminated, so copy them by length.
+        jsize length = env->GetStringLength(jstr);
+        variant->SetLength(length);
+        if (variant->Length() != (PRUint32) length) {
           rv = NS_ERROR_OUT_OF_MEMORY;
           break;
         }
-
-        variant->Assign((char16_t *)wchar_ptr);
-
-        // release String buffer
-        env->ReleaseStringChars(jstr, wchar_ptr);
+        env->GetStringRegion(jstr, 0, length,
+                             reinterpret_cast<jchar*>(variant->BeginWriting()));
       } else {
         variant->SetIsVoid(PR_TRUE);
       }
@@ -1581,23 +1627,8 @@ nsJavaXPTCStub::FinalizeJavaParams(const nsXPTParamInfo &aParamInfo,
       }
 
       jstring jstr = (jstring) aJValue.l;
-      nsCString* variant = static_cast<nsCString*>(aVariant.val.p);
-      
-      if (jstr) {
-        // Get string buffer
-        const char* char_ptr = env->GetStringUTFChars(jstr, nullptr);
-        if (!char_ptr) {
-          rv = NS_ERROR_OUT_OF_MEMORY;
-          break;
-        }
-
-        variant->Assign(char_ptr);
-
-        // release String buffer
-        env->ReleaseStringUTFChars(jstr, char_ptr);
-      } else {
-        variant->SetIsVoid(PR_TRUE);
-      }
+      nsACString* variant = static_cast<nsACString*>(aVariant.val.p);
+      rv = jstring_to_UTF8(env, jstr, *variant);
     }
     break;
 
@@ -1671,7 +1702,7 @@ nsJavaXPTCStub::GetNewOrUsed(JNIEnv* env, jobject aJavaObject,
 {
   nsJavaXPTCStub* stub;
   jint hash = env->CallStaticIntMethod(systemClass, hashCodeMID, aJavaObject);
-  nsresult rv = gJavaToXPTCStubMap->Find(hash, aIID, &stub);
+  nsresult rv = gJavaToXPTCStubMap->Find(env, aJavaObject, hash, aIID, &stub);
   NS_ENSURE_SUCCESS(rv, rv);
   if (stub) {
     // stub is already AddRef'd and QI'd
@@ -1685,12 +1716,8 @@ nsJavaXPTCStub::GetNewOrUsed(JNIEnv* env, jobject aJavaObject,
   // create an XPCOM stub, that can route any method calls to the class.
 
   // Get interface info for class
-  nsCOMPtr<nsIInterfaceInfoManager>
-    iim(do_GetService(NS_INTERFACEINFOMANAGER_SERVICE_CONTRACTID, &rv));
-  NS_ENSURE_SUCCESS(rv, rv);
-
   nsCOMPtr<nsIInterfaceInfo> iinfo;
-  rv = iim->GetInfoForIID(&aIID, getter_AddRefs(iinfo));
+  rv = gJavaInterfaceClassMap->GetInterfaceInfo(aIID, getter_AddRefs(iinfo));
   NS_ENSURE_SUCCESS(rv, rv);
 
   // Create XPCOM stub
@@ -50,6 +50,62 @@
 #include "nsJavaXPTCStubWeakRef.h"
 
 
+struct JavaStubClassInfo;
+
+// How a param or the return value of an XPCOM method implemented in Java is
+// passed to or from Java.  XPT types that are passed the same way share a
+// kind.
+enum JavaStubValueKind
+{
+  kStubValueNone,         // no return value, or a type that isn't supported
+  kStubValueByte,
+  kStubValueShort,
+  kStubValueInt,
+  kStubValueLong,
+  kStubValueFloat,
+  kStubValueDouble,
+  kStubValueBoolean,
+  kStubValueChar,
+  kStubValueString,       // 'string' and 'wstring'
+  kStubValueIID,
+  kStubValueInterface,
+  kStubValueAString,      // 'AString' and 'DOMString'
+  kStubValueCString,      // 'AUTF8String' and 'ACString'
+  kStubValueVoidPtr       // 'void*', passed as a long
+};
+
+struct JavaStubParam
+{
+  PRUint8   tag;          // XPT type tag
+  PRUint8   kind;         // JavaStubValueKind
+};
+
+/**
+ * The Java method that implements an XPCOM method, along with how each of
+ * its params is passed, so that calls don't need to look at the XPT types
+ * again.  Never changed once built; shared by the stubs of all the Java
+ * objects of the same class (see JavaStubClassMap).
+ */
+struct JavaStubMethod
+{
+  JavaStubMethod(jmethodID aMethodID, PRUint8 aParamCount)
+    : methodID(aMethodID)
+    , retvalKind(kStubValueNone)
+    , paramCount(aParamCount)
+    , params(new JavaStubParam[aParamCount])
+  { }
+
+  ~JavaStubMethod()
+  {
+    delete [] params;
+  }
+
+  const jmethodID   methodID;
+  PRUint8           retvalKind;   // JavaStubValueKind of the 'retval' param
+  const PRUint8     paramCount;
+  JavaStubParam*    params;       // indexed like the XPCOM method params
+};
+
 #define NS_JAVAXPTCSTUB_IID \
 {0x88dd8130, 0xebe6, 0x4431, {0x9d, 0xa7, 0xe6, 0xb7, 0x54, 0x74, 0xfb, 0x21}}
 
@@ -82,6 +138,13 @@ public:
   // collected if necessary.  See DestroyXPTCMappingEnum().
   void DeleteStrongRef();
 
+  // Returns true if this stub was created for the given Java object.  Unlike
+  // GetJavaObject(), this doesn't call into Java.
+  PRBool IsJavaObject(JNIEnv* env, jobject aJavaObject)
+  {
+    return env->IsSameObject(mJavaIdentityRef, aJavaObject);
+  }
+
   /**
    * Finds the associated nsJavaXPTCStub for the given Java object and IID.
    * If no such stub exists, then a new one is created.
@@ -117,18 +180,31 @@ private:
   // returns true if this stub supports the specified interface
   bool SupportsIID(const nsID &aIID);
 
-  nsresult SetupJavaParams(const nsXPTParamInfo &aParamInfo,
+  nsresult SetupJavaParams(JNIEnv* env, jobject aJavaObject,
+                           const JavaStubParam &aParam,
+                           const nsXPTParamInfo &aParamInfo,
                            const XPTMethodDescriptor* aMethodInfo,
                            PRUint16 aMethodIndex,
                            nsXPTCMiniVariant* aDispatchParams,
                            nsXPTCMiniVariant &aVariant,
-                           jvalue &aJValue, nsACString &aMethodSig);
-  nsresult GetRetvalSig(const nsXPTParamInfo* aParamInfo,
-                        const XPTMethodDescriptor* aMethodInfo,
-                        PRUint16 aMethodIndex,
-                        nsXPTCMiniVariant* aDispatchParams,
-                        nsACString &aRetvalSig);
-  nsresult FinalizeJavaParams(const nsXPTParamInfo &aParamInfo,
+                           jvalue &aJValue);
+
+  /**
+   * Returns the Java method that implements the given XPCOM method.  It is
+   * only resolved on the first call of each method by an object of the same
+   * Java class; later calls return the cached method.
+   */
+  nsresult GetJavaMethod(JNIEnv* env, jobject aJavaObject,
+                         PRUint16 aMethodIndex,
+                         const XPTMethodDescriptor* aMethodInfo,
+                         nsXPTCMiniVariant* aDispatchParams,
+                         const JavaStubMethod** aResult);
+  nsresult GetParamSig(const nsXPTParamInfo* aParamInfo,
+                       const XPTMethodDescriptor* aMethodInfo,
+                       PRUint16 aMethodIndex,
+                       nsXPTCMiniVariant* aDispatchParams,
+                       nsACString &aSig);
+  nsresult FinalizeJavaParams(JNIEnv* env, const nsXPTParamInfo &aParamInfo,
                               const XPTMethodDescriptor* aMethodInfo,
                               PRUint16 aMethodIndex,
                               nsXPTCMiniVariant* aDispatchParams,
@@ -138,8 +214,10 @@ private:
 
   jobject                     mJavaWeakRef;
   jobject                     mJavaStrongRef;
+  jweak                       mJavaIdentityRef;  // JNI weak ref, for IsJavaObject
   jint                        mJavaRefHashCode;
   nsCOMPtr<nsIInterfaceInfo>  mIInfo;
+  JavaStubClassInfo*          mMethods;      // strong reference
 
   nsVoidArray     mChildren; // weak references (cleared by the children)
   nsJavaXPTCStub *mMaster;   // strong reference
@@ -36,6 +36,9 @@
 
 package org.mozilla.xpcom;
 
+import java.lang.reflect.Method;
+import java.util.concurrent.CompletableFuture;
+
 public interface IJavaXPCOMUtils {
 
 	/**
@@ -56,4 +59,60 @@ public interface IJavaXPCOMUtils {
 	 */
 	Object wrapXPCOMObject(long aXPCOMObject, String aIID);
 
+	/**
+	 * Calls a method on the main thread, without waiting for the call to
+	 * complete.  XPCOM objects may only be used on the main thread; calls made
+	 * through this method from any number of threads are batched, and run
+	 * together in a single main thread event.
+	 * 
+	 * @param aProxy    object on which to call the method, usually a Java proxy
+	 *                  for an XPCOM object
+	 * @param aMethod   method to call, such as a method of the proxy's
+	 *                  interface
+	 * @param aArgs     arguments of the call
+	 * @return  future that is completed on the main thread with the result of
+	 *          the call, or with the exception thrown by it
+	 */
+	CompletableFuture callAsync(Object aProxy, Method aMethod, Object[] aArgs);
+
+	/**
+	 * Creates an empty batch of XPCOM method calls.  The calls in a batch are
+	 * all run by a single call into native code, which saves the cost of a
+	 * native call per method when making many small calls.
+	 * 
+	 * @return  new batch
+	 */
+	IXPCOMBatch createBatch();
+
+	/**
+	 * Turns collection of per-method call statistics on or off.  Statistics
+	 * are off by default, and may also be turned on by setting the
+	 * <code>JAVAXPCOM_CALL_STATS</code> environment variable, in which case
+	 * they are also written to stderr at shutdown.  Counts gathered so far are
+	 * kept when collection is turned off.
+	 * 
+	 * @param aEnabled  <code>true</code> to collect statistics
+	 */
+	void setCallStatsEnabled(boolean aEnabled);
+
+	/**
+	 * Returns the call statistics gathered since the last reset, as a JSON
+	 * object of the form
+	 * <code>{"enabled":true,"methods":[...]}</code>.  Each element of
+	 * <code>methods</code> describes one method called in one direction
+	 * (<code>"java-to-xpcom"</code> or <code>"xpcom-to-java"</code>), and
+	 * gives the number of calls, the time spent converting params and in the
+	 * called method (<code>marshalNs</code> and <code>invokeNs</code>, in
+	 * nanoseconds), and the number of bytes of string and array data
+	 * converted.
+	 * 
+	 * @return  JSON report of the call statistics
+	 */
+	String getCallStats();
+
+	/**
+	 * Starts all call statistics over from zero.
+	 */
+	void resetCallStats();
+
 }
@@ -0,0 +1,113 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2007
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+
+package org.mozilla.xpcom;
+
+import java.lang.reflect.Method;
+
+/**
+ * A list of XPCOM method calls that are run together, in a single call into
+ * native code.  Making many small calls one at a time, such as reading an
+ * attribute of each of thousands of DOM nodes, costs a transition from Java
+ * to native code per call; a batch pays that cost once.
+ * <p>
+ * Each call fails or succeeds on its own: a failed call doesn't stop the rest
+ * of the batch, and its error is returned by <code>getStatus</code>.  Like
+ * any other use of XPCOM objects, a batch must be executed on the thread that
+ * owns the objects, usually the main thread.
+ * <p>
+ * Batches are created by <code>Mozilla.createBatch()</code>, and are not
+ * safe for use by several threads at once.
+ */
+public interface IXPCOMBatch {
+
+	/**
+	 * Adds a call to the batch.  Arguments are converted when the batch is
+	 * executed, so 'out' params must be passed as arrays in
+	 * <code>aArgs</code>, as they would be to <code>aMethod.invoke</code>,
+	 * and are filled in by <code>execute()</code>.
+	 * 
+	 * @param aProxy    Java proxy for an XPCOM object
+	 * @param aMethod   method of the proxy's interface to call
+	 * @param aArgs     arguments of the call; may be <code>null</code> if the
+	 *                  method takes none
+	 * @return  index of the call in the batch
+	 * 
+	 * @exception XPCOMException if <code>aMethod</code> is not a method of the
+	 *            XPCOM object's interface
+	 */
+	int add(Object aProxy, Method aMethod, Object[] aArgs);
+
+	/**
+	 * Runs all of the calls in the batch, in the order in which they were
+	 * added.  A batch may be executed more than once.
+	 */
+	void execute();
+
+	/**
+	 * Returns the number of calls in the batch.
+	 */
+	int size();
+
+	/**
+	 * Returns the result code of a call, as of the last
+	 * <code>execute()</code>.
+	 * 
+	 * @param aIndex  index of the call, as returned by <code>add</code>
+	 * @return  result code of the call, usually <code>0</code> if it
+	 *          succeeded; error codes have the high bit set
+	 */
+	long getStatus(int aIndex);
+
+	/**
+	 * Returns the result of a call, as of the last <code>execute()</code>.
+	 * Primitive results are boxed.
+	 * 
+	 * @param aIndex  index of the call, as returned by <code>add</code>
+	 * @return  the result of the call, or <code>null</code> if the method
+	 *          returns <code>void</code>
+	 * 
+	 * @exception XPCOMException if the call failed
+	 */
+	Object getResult(int aIndex);
+
+	/**
+	 * Removes all calls and results from the batch.
+	 */
+	void clear();
+
+}
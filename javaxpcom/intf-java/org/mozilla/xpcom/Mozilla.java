@@ -49,6 +49,7 @@ import java.util.ArrayList;
 import java.util.Enumeration;
 import java.util.Iterator;
 import java.util.Properties;
+import java.util.concurrent.CompletableFuture;
 
 import org.mozilla.interfaces.nsIComponentManager;
 import org.mozilla.interfaces.nsIComponentRegistrar;
@@ -1063,4 +1064,50 @@ IXPCOMError {
 		}
 	}
 
+	public CompletableFuture callAsync(Object aProxy, Method aMethod,
+			Object[] aArgs) {
+		try {
+			return jxutils.callAsync(aProxy, aMethod, aArgs);
+		} catch (NullPointerException e) {
+			throw new XPCOMInitializationException("Must call " +
+					"Mozilla.getInstance().initialize() before using this method", e);
+		}
+	}
+
+	public IXPCOMBatch createBatch() {
+		try {
+			return jxutils.createBatch();
+		} catch (NullPointerException e) {
+			throw new XPCOMInitializationException("Must call " +
+					"Mozilla.getInstance().initialize() before using this method", e);
+		}
+	}
+
+	public void setCallStatsEnabled(boolean aEnabled) {
+		try {
+			jxutils.setCallStatsEnabled(aEnabled);
+		} catch (NullPointerException e) {
+			throw new XPCOMInitializationException("Must call " +
+					"Mozilla.getInstance().initialize() before using this method", e);
+		}
+	}
+
+	public String getCallStats() {
+		try {
+			return jxutils.getCallStats();
+		} catch (NullPointerException e) {
+			throw new XPCOMInitializationException("Must call " +
+					"Mozilla.getInstance().initialize() before using this method", e);
+		}
+	}
+
+	public void resetCallStats() {
+		try {
+			jxutils.resetCallStats();
+		} catch (NullPointerException e) {
+			throw new XPCOMInitializationException("Must call " +
+					"Mozilla.getInstance().initialize() before using this method", e);
+		}
+	}
+
 }
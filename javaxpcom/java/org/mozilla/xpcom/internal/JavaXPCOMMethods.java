@@ -37,8 +37,11 @@
 package org.mozilla.xpcom.internal;
 
 import java.io.File;
+import java.lang.reflect.Method;
+import java.util.concurrent.CompletableFuture;
 
 import org.mozilla.xpcom.IJavaXPCOMUtils;
+import org.mozilla.xpcom.IXPCOMBatch;
 
 
 public class JavaXPCOMMethods implements IJavaXPCOMUtils {
@@ -91,5 +94,20 @@ public class JavaXPCOMMethods implements IJavaXPCOMUtils {
 
   public native Object wrapXPCOMObject(long aXPCOMObject, String aIID);
 
+  public CompletableFuture callAsync(Object aProxy, Method aMethod,
+      Object[] aArgs) {
+    return XPCOMAsyncQueue.enqueue(aProxy, aMethod, aArgs);
+  }
+
+  public IXPCOMBatch createBatch() {
+    return new XPCOMBatch();
+  }
+
+  public native void setCallStatsEnabled(boolean aEnabled);
+
+  public native String getCallStats();
+
+  public native void resetCallStats();
+
 }
 
@@ -0,0 +1,172 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2004
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+package org.mozilla.xpcom.internal;
+
+import java.lang.reflect.InvocationTargetException;
+import java.lang.reflect.Method;
+import java.util.ArrayList;
+import java.util.concurrent.CompletableFuture;
+
+import org.mozilla.xpcom.IXPCOMError;
+import org.mozilla.xpcom.XPCOMException;
+
+
+/**
+ * Runs method calls on the main thread on behalf of other Java threads.
+ *
+ * Calls are queued, and a single runnable dispatched to the main thread runs
+ * all of the calls queued by the time it runs.  So a burst of calls from
+ * several threads costs one turn of the main event loop, rather than one
+ * blocking round-trip each.
+ */
+public final class XPCOMAsyncQueue {
+
+  private static final Object lock = new Object();
+
+  /** Calls waiting for the next drain.  Guarded by <code>lock</code>. */
+  private static ArrayList pending = new ArrayList();
+
+  /** Whether a drain has been dispatched.  Guarded by <code>lock</code>. */
+  private static boolean drainScheduled = false;
+
+  private XPCOMAsyncQueue() {
+  }
+
+  /**
+   * Queues a call of the given method, to be run on the main thread.
+   *
+   * @param aTarget  object on which to call the method; usually a Java proxy
+   *                 for an XPCOM object
+   * @param aMethod  method to call
+   * @param aArgs    arguments of the call; may be <code>null</code> if the
+   *                 method takes none
+   * @return  a future that is completed with the result of the call, or with
+   *          the exception it threw
+   */
+  static CompletableFuture enqueue(Object aTarget, Method aMethod,
+      Object[] aArgs) {
+    if (aMethod == null) {
+      throw new NullPointerException("aMethod");
+    }
+
+    Call call = new Call(aTarget, aMethod, aArgs);
+    boolean schedule;
+    synchronized (lock) {
+      pending.add(call);
+      schedule = !drainScheduled;
+      drainScheduled = true;
+    }
+
+    if (schedule && !scheduleDrain()) {
+      XPCOMException e = new XPCOMException(IXPCOMError.NS_ERROR_FAILURE,
+          "Failed to dispatch calls to the main thread");
+      ArrayList calls = takePending();
+      for (int i = 0; i < calls.size(); i++) {
+        ((Call) calls.get(i)).future.completeExceptionally(e);
+      }
+    }
+    return call.future;
+  }
+
+  /**
+   * Runs all queued calls.  Called from native code on the main thread.
+   */
+  static void drain() {
+    ArrayList calls = takePending();
+    for (int i = 0; i < calls.size(); i++) {
+      ((Call) calls.get(i)).run();
+    }
+  }
+
+  /**
+   * Fails all queued calls.  Called from native code when JavaXPCOM shuts
+   * down, since any drain already dispatched to the main thread will not run
+   * them.
+   */
+  static void shutdown() {
+    XPCOMException e = new XPCOMException(IXPCOMError.NS_ERROR_FAILURE,
+        "XPCOM was shut down before the call could run");
+    ArrayList calls = takePending();
+    for (int i = 0; i < calls.size(); i++) {
+      ((Call) calls.get(i)).future.completeExceptionally(e);
+    }
+  }
+
+  private static ArrayList takePending() {
+    synchronized (lock) {
+      // Clear the flag before running the calls, so that a call queued while
+      // they run (even by one of them) schedules another drain.
+      ArrayList calls = pending;
+      pending = new ArrayList();
+      drainScheduled = false;
+      return calls;
+    }
+  }
+
+  /**
+   * Dispatches a runnable that calls <code>drain()</code> to the main thread.
+   *
+   * @return  <code>false</code> if the runnable couldn't be dispatched, such
+   *          as after XPCOM has shut down
+   */
+  private static native boolean scheduleDrain();
+
+  private static final class Call {
+    final Object target;
+    final Method method;
+    final Object[] args;
+    final CompletableFuture future = new CompletableFuture();
+
+    Call(Object aTarget, Method aMethod, Object[] aArgs) {
+      target = aTarget;
+      method = aMethod;
+      args = aArgs;
+    }
+
+    void run() {
+      try {
+        future.complete(method.invoke(target, args));
+      } catch (InvocationTargetException e) {
+        future.completeExceptionally(e.getCause());
+      } catch (Throwable t) {
+        future.completeExceptionally(t);
+      }
+    }
+  }
+
+}
@@ -0,0 +1,283 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2004
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+package org.mozilla.xpcom.internal;
+
+import java.lang.reflect.Method;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.ArrayList;
+import java.util.HashMap;
+
+import org.mozilla.xpcom.IXPCOMBatch;
+import org.mozilla.xpcom.XPCOMException;
+
+
+/**
+ * Implementation of <code>IXPCOMBatch</code>.
+ * <p>
+ * Calls are encoded into a direct buffer of 64-bit slots, which native code
+ * reads without any further calls back into Java.  Each call takes the native
+ * instance of its proxy, then the XPCOM method index with the number of
+ * argument slots in bits 16-23, then one slot per argument.  Arguments of
+ * primitive types are stored raw in their slots, using the encoding of
+ * <code>XPCOMJavaBinding.callXPCOMMethod</code>; all other arguments are
+ * passed in the call's <code>Object[]</code>, as for a reflective proxy.
+ * <p>
+ * Results are returned in a second direct buffer, which holds the result code
+ * and the raw primitive result of each call.  Results of other types are
+ * returned in an <code>Object[]</code>.
+ */
+public final class XPCOMBatch implements IXPCOMBatch {
+
+  private static final int SLOT_SIZE = 8;
+  private static final int HEADER_SLOTS = 2;
+  private static final int RESULT_SLOTS = 2;
+  private static final int MAX_ARGS = 0xff;
+
+  /**
+   * XPCOM method indices, keyed by <code>Method</code>.  Guarded by
+   * <code>methodIndices</code>.
+   */
+  private static final HashMap methodIndices = new HashMap();
+
+  private ByteBuffer calls = allocate(64);
+
+  /** Proxies of the calls, kept alive until the batch is cleared. */
+  private final ArrayList targets = new ArrayList();
+  private final ArrayList methods = new ArrayList();
+  private final ArrayList args = new ArrayList();
+
+  private ByteBuffer results;
+  private Object[] resultObjects;
+
+  /** Number of calls run by the last <code>execute()</code>. */
+  private int executed = 0;
+
+  public int add(Object aProxy, Method aMethod, Object[] aArgs) {
+    if (aProxy == null) {
+      throw new NullPointerException("aProxy");
+    }
+    if (aMethod == null) {
+      throw new NullPointerException("aMethod");
+    }
+
+    // Method indices are cached by method, which is only sound if the method
+    // belongs to the proxy's interface
+    if (!aMethod.getDeclaringClass().isInstance(aProxy)) {
+      throw new IllegalArgumentException(aMethod.getName() +
+          " is not a method of the proxy's interface");
+    }
+
+    Class[] types = aMethod.getParameterTypes();
+    int argCount = (aArgs == null) ? 0 : aArgs.length;
+    if (argCount != types.length || argCount > MAX_ARGS) {
+      throw new IllegalArgumentException("wrong number of arguments for " +
+          aMethod.getName());
+    }
+
+    long instance = XPCOMJavaProxy.getNativeXPCOMInstance(aProxy);
+    int methodIndex = getMethodIndex(instance, aMethod);
+
+    ensureCapacity(HEADER_SLOTS + argCount);
+    calls.putLong(instance);
+    calls.putLong(methodIndex | ((long) argCount << 16));
+    for (int i = 0; i < argCount; i++) {
+      calls.putLong(types[i].isPrimitive() ? encode(types[i], aArgs[i]) : 0);
+    }
+
+    targets.add(aProxy);
+    methods.add(aMethod);
+    args.add(aArgs == null ? null : aArgs.clone());
+    return methods.size() - 1;
+  }
+
+  public void execute() {
+    int count = methods.size();
+    results = allocate(count * RESULT_SLOTS);
+    resultObjects = new Object[count];
+    executed = 0;
+    executed = invoke(calls, count, args.toArray(), results, resultObjects);
+  }
+
+  public int size() {
+    return methods.size();
+  }
+
+  public long getStatus(int aIndex) {
+    checkExecuted(aIndex);
+    return results.getLong(aIndex * RESULT_SLOTS * SLOT_SIZE);
+  }
+
+  public Object getResult(int aIndex) {
+    long status = getStatus(aIndex);
+    Method method = (Method) methods.get(aIndex);
+    if ((status & 0x80000000L) != 0) {
+      throw new XPCOMException(status, "The function \"" + method.getName() +
+          "\" returned an error condition");
+    }
+
+    Class type = method.getReturnType();
+    if (!type.isPrimitive()) {
+      return resultObjects[aIndex];
+    }
+    return decode(type,
+        results.getLong((aIndex * RESULT_SLOTS + 1) * SLOT_SIZE));
+  }
+
+  public void clear() {
+    calls.clear();
+    targets.clear();
+    methods.clear();
+    args.clear();
+    results = null;
+    resultObjects = null;
+    executed = 0;
+  }
+
+  private void checkExecuted(int aIndex) {
+    if (aIndex < 0 || aIndex >= methods.size()) {
+      throw new IndexOutOfBoundsException("no call " + aIndex + " in batch");
+    }
+    if (aIndex >= executed) {
+      throw new IllegalStateException("call " + aIndex + " has not been run");
+    }
+  }
+
+  private void ensureCapacity(int aSlots) {
+    if (calls.remaining() >= aSlots * SLOT_SIZE) {
+      return;
+    }
+    int slots = Math.max(calls.capacity() / SLOT_SIZE * 2,
+        calls.position() / SLOT_SIZE + aSlots);
+    ByteBuffer buffer = allocate(slots);
+    calls.flip();
+    buffer.put(calls);
+    calls = buffer;
+  }
+
+  private static ByteBuffer allocate(int aSlots) {
+    return ByteBuffer.allocateDirect(Math.max(aSlots, 1) * SLOT_SIZE)
+        .order(ByteOrder.nativeOrder());
+  }
+
+  private static int getMethodIndex(long aInstance, Method aMethod) {
+    synchronized (methodIndices) {
+      Integer index = (Integer) methodIndices.get(aMethod);
+      if (index == null) {
+        index = new Integer(resolveMethod(aInstance, aMethod));
+        methodIndices.put(aMethod, index);
+      }
+      return index.intValue();
+    }
+  }
+
+  private static long encode(Class aType, Object aArg) {
+    if (aType == Boolean.TYPE) {
+      return ((Boolean) aArg).booleanValue() ? 1 : 0;
+    }
+    if (aType == Character.TYPE) {
+      return ((Character) aArg).charValue();
+    }
+    if (aArg instanceof Character) {
+      return encode(aType, new Integer(((Character) aArg).charValue()));
+    }
+    Number value = (Number) aArg;
+    if (aType == Float.TYPE) {
+      return Float.floatToRawIntBits(value.floatValue());
+    }
+    if (aType == Double.TYPE) {
+      return Double.doubleToRawLongBits(value.doubleValue());
+    }
+    return value.longValue();
+  }
+
+  private static Object decode(Class aType, long aValue) {
+    if (aType == Void.TYPE) {
+      return null;
+    }
+    if (aType == Boolean.TYPE) {
+      return Boolean.valueOf(aValue != 0);
+    }
+    if (aType == Character.TYPE) {
+      return new Character((char) aValue);
+    }
+    if (aType == Byte.TYPE) {
+      return new Byte((byte) aValue);
+    }
+    if (aType == Short.TYPE) {
+      return new Short((short) aValue);
+    }
+    if (aType == Integer.TYPE) {
+      return new Integer((int) aValue);
+    }
+    if (aType == Float.TYPE) {
+      return new Float(Float.intBitsToFloat((int) aValue));
+    }
+    if (aType == Double.TYPE) {
+      return new Double(Double.longBitsToDouble(aValue));
+    }
+    return new Long(aValue);
+  }
+
+  /**
+   * Runs the calls encoded in <code>aCalls</code>.  A Java exception thrown
+   * while converting params or results stops the batch, and is rethrown.
+   *
+   * @param aCalls          encoded calls
+   * @param aCallCount      number of calls in <code>aCalls</code>
+   * @param aArgs           <code>Object[]</code> arguments of each call
+   * @param aResults        receives the result code and raw result of each
+   *                        call
+   * @param aResultObjects  receives the results of calls that don't return a
+   *                        primitive type
+   *
+   * @return  number of calls run
+   */
+  private static native int invoke(ByteBuffer aCalls, int aCallCount,
+      Object[] aArgs, ByteBuffer aResults, Object[] aResultObjects);
+
+  /**
+   * Returns the XPCOM method index of the given method of the given XPCOM
+   * object's interface.
+   *
+   * @exception XPCOMException if the interface has no such method
+   */
+  private static native int resolveMethod(long aXPCOMInstance,
+      Method aMethod);
+
+}
@@ -0,0 +1,99 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2004
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+package org.mozilla.xpcom.internal;
+
+import java.lang.ref.PhantomReference;
+import java.lang.ref.Reference;
+import java.lang.ref.ReferenceQueue;
+import java.nio.ByteBuffer;
+import java.util.HashSet;
+
+
+/**
+ * Frees the memory of direct <code>ByteBuffer</code>s that wrap octet arrays
+ * or sized strings returned by XPCOM methods.  Such a buffer owns the memory
+ * allocated by the XPCOM method; once the buffer has been garbage collected,
+ * the memory is freed the next time a buffer is tracked or
+ * <code>releaseUnused</code> is called.
+ */
+public final class XPCOMDirectBuffer extends PhantomReference {
+
+  private static final ReferenceQueue queue = new ReferenceQueue();
+
+  /** Keeps the references themselves reachable until they are enqueued. */
+  private static final HashSet references = new HashSet();
+
+  /** Address of the XPCOM memory wrapped by the buffer. */
+  private final long address;
+
+  private XPCOMDirectBuffer(ByteBuffer aBuffer, long aAddress) {
+    super(aBuffer, queue);
+    address = aAddress;
+  }
+
+  /**
+   * Takes ownership of the XPCOM memory wrapped by the given buffer.  Called
+   * from native code.
+   *
+   * @param aBuffer   direct buffer created over <code>aAddress</code>
+   * @param aAddress  address of the memory to free once <code>aBuffer</code>
+   *                  is collected
+   */
+  static void track(ByteBuffer aBuffer, long aAddress) {
+    releaseUnused();
+    synchronized (references) {
+      references.add(new XPCOMDirectBuffer(aBuffer, aAddress));
+    }
+  }
+
+  /**
+   * Frees the memory of any buffers that have been garbage collected.
+   */
+  public static void releaseUnused() {
+    Reference ref;
+    while ((ref = queue.poll()) != null) {
+      synchronized (references) {
+        references.remove(ref);
+      }
+      freeBuffer(((XPCOMDirectBuffer) ref).address);
+    }
+  }
+
+  private static native void freeBuffer(long aAddress);
+
+}
@@ -0,0 +1,192 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2004
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+package org.mozilla.xpcom.internal;
+
+import java.lang.ref.PhantomReference;
+import java.lang.ref.Reference;
+import java.util.AbstractList;
+import java.util.Arrays;
+import java.util.HashSet;
+import java.util.RandomAccess;
+
+import org.mozilla.xpcom.IXPCOMError;
+import org.mozilla.xpcom.XPCOMException;
+
+
+/**
+ * A read-only <code>List</code> view of an array of interfaces returned by an
+ * XPCOM method.  The list holds on to the native array, and only creates the
+ * Java object for an element when that element is first read, so callers
+ * that look at a few elements of a large array don't pay for wrapping all of
+ * them.
+ *
+ * <p>Once the list has been garbage collected, the native array and its
+ * elements are released by the same thread that releases collected proxies
+ * (see <code>XPCOMProxyReference</code>).  The arrays of lists that are still
+ * alive when JavaXPCOM is shut down are released at that point; reading an
+ * element that wasn't wrapped yet then throws an
+ * <code>XPCOMException</code>.</p>
+ */
+public final class XPCOMInterfaceList extends AbstractList
+    implements RandomAccess {
+
+  /** Marks elements whose Java object hasn't been created yet. */
+  private static final Object NOT_WRAPPED = new Object();
+
+  /** Owns the native array of (addref'd) XPCOM objects. */
+  private final Reclaimer array;
+
+  private final Object[] elements;
+
+  /**
+   * Called from native code, which passes ownership of the array to the new
+   * list.
+   *
+   * @param aArray  address of the native array, which also holds the IID of
+   *                its elements
+   * @param aSize   number of elements in the array
+   */
+  XPCOMInterfaceList(long aArray, int aSize) {
+    elements = new Object[aSize];
+    Arrays.fill(elements, NOT_WRAPPED);
+    array = Reclaimer.track(this, aArray);
+  }
+
+  public int size() {
+    return elements.length;
+  }
+
+  public synchronized Object get(int aIndex) {
+    if (aIndex < 0 || aIndex >= elements.length) {
+      throw new IndexOutOfBoundsException("Index: " + aIndex + ", Size: " +
+                                          elements.length);
+    }
+
+    // Holding the lock also keeps this list, and therefore the native array,
+    // alive during the native call.
+    Object element = elements[aIndex];
+    if (element == NOT_WRAPPED) {
+      element = array.wrap(aIndex);
+      elements[aIndex] = element;
+    }
+    return element;
+  }
+
+  /**
+   * Releases the native array of a collected list.  Called by the
+   * reclaimer thread of <code>XPCOMProxyReference</code>.
+   */
+  static void reclaim(Reference aRef) {
+    if (Reclaimer.untrack(aRef)) {
+      ((Reclaimer) aRef).release();
+    }
+  }
+
+  /**
+   * Releases the native arrays of all lists that are still alive.  Called
+   * from native code when JavaXPCOM is shut down.
+   */
+  static void releaseAll() {
+    Reclaimer.releaseAll();
+  }
+
+  private static native Object wrapElement(long aArray, int aIndex);
+
+  private static native void releaseArray(long aArray);
+
+  /**
+   * Releases the native array of a list once the list is collected.
+   */
+  private static final class Reclaimer extends PhantomReference {
+
+    /** Keeps the references themselves reachable until they are enqueued. */
+    private static final HashSet references = new HashSet();
+
+    /**
+     * Address of the native array; 0 once it has been released.  Guarded by
+     * <code>this</code>.
+     */
+    private long array;
+
+    private Reclaimer(XPCOMInterfaceList aList, long aArray) {
+      super(aList, XPCOMProxyReference.getQueue());
+      array = aArray;
+    }
+
+    static Reclaimer track(XPCOMInterfaceList aList, long aArray) {
+      Reclaimer reclaimer = new Reclaimer(aList, aArray);
+      synchronized (references) {
+        references.add(reclaimer);
+      }
+      return reclaimer;
+    }
+
+    static boolean untrack(Reference aRef) {
+      synchronized (references) {
+        return references.remove(aRef);
+      }
+    }
+
+    static void releaseAll() {
+      Object[] remaining;
+      synchronized (references) {
+        remaining = references.toArray();
+        references.clear();
+      }
+      for (int i = 0; i < remaining.length; i++) {
+        ((Reclaimer) remaining[i]).release();
+      }
+    }
+
+    synchronized Object wrap(int aIndex) {
+      if (array == 0) {
+        throw new XPCOMException(IXPCOMError.NS_ERROR_FAILURE,
+            "XPCOM was shut down before the element was read");
+      }
+      return wrapElement(array, aIndex);
+    }
+
+    synchronized void release() {
+      if (array != 0) {
+        releaseArray(array);
+        array = 0;
+      }
+    }
+  }
+
+}
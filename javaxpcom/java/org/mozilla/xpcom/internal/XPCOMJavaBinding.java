@@ -0,0 +1,139 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2004
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+package org.mozilla.xpcom.internal;
+
+
+/**
+ * Base class of the direct-binding classes written by the interface
+ * generator (<code>GenerateJavaInterfaces -b</code>).  A generated binding
+ * implements each method of its interface by calling
+ * <code>callXPCOMMethod</code> (or <code>callXPCOMMethodRaw</code>) with the
+ * precomputed XPCOM method index, so
+ * calls don't go through <code>java.lang.reflect.Proxy</code> and the method
+ * doesn't need to be looked up by name.
+ * <p>
+ * Bindings are created by <code>XPCOMJavaProxy.createProxy</code> when one is
+ * available for the requested interface.  Otherwise, a reflective proxy is
+ * created instead.
+ */
+public abstract class XPCOMJavaBinding {
+
+  /**
+   * Pointer to the native wrapper of the XPCOM object that this binding
+   * represents.  Native code reads this field directly.
+   */
+  protected final long nativeXPCOMPtr;
+
+  /**
+   * Default constructor.
+   *
+   * @param aXPCOMInstance  address of XPCOM object as a long
+   */
+  protected XPCOMJavaBinding(long aXPCOMInstance) {
+    nativeXPCOMPtr = aXPCOMInstance;
+  }
+
+  /**
+   * @see Object#hashCode()
+   */
+  public int hashCode() {
+    return System.identityHashCode(this);
+  }
+
+  /**
+   * Two bindings are equal if they represent the same XPCOM object.
+   *
+   * @see Object#equals(Object)
+   */
+  public boolean equals(Object aOther) {
+    return XPCOMJavaProxy.proxyEquals(this, aOther).booleanValue();
+  }
+
+  /**
+   * @see Object#toString()
+   */
+  public String toString() {
+    return XPCOMJavaProxy.proxyToString(this);
+  }
+
+  /**
+   * Calls the given method of the XPCOM object.  This is an instance method,
+   * so that the binding stays reachable, and its XPCOM object alive, until
+   * the call returns.
+   * <p>
+   * Params are indexed by their position in the XPCOM method.  The values of
+   * 'in' params of primitive types are passed raw in <code>aPrimParams</code>,
+   * so they don't need to be boxed: integral types and <code>char</code> by
+   * value, <code>boolean</code> as 0 or 1, and <code>float</code> and
+   * <code>double</code> as returned by <code>Float.floatToRawIntBits</code>
+   * and <code>Double.doubleToRawLongBits</code>.  All other params are passed
+   * in <code>aParams</code>.
+   * <p>
+   * Octet arrays and sized strings may be passed in <code>aParams</code> as
+   * direct <code>java.nio.ByteBuffer</code>s, whose memory is then used by the
+   * XPCOM method without copying.  Likewise, if the slot of an 'out' or
+   * 'retval' param of one of these types holds a <code>ByteBuffer[]</code>,
+   * the result is stored in it as a direct <code>ByteBuffer</code> over the
+   * memory returned by the XPCOM method (see <code>XPCOMDirectBuffer</code>).
+   *
+   * @param aMethodIndex    index of the method in the XPCOM interface
+   * @param aPrimParams     raw values of primitive 'in' params; may be
+   *                        <code>null</code> if there are none
+   * @param aParams         all other params, including any
+   *                        <code>ByteBuffer[]</code> holder for a 'retval'
+   *                        param; may be <code>null</code> if there are none
+   *
+   * @return  return value as defined by the called method
+   *
+   * @exception XPCOMException if XPCOM method failed.  Values of XPCOMException
+   *            are defined by the method called.
+   */
+  protected final native Object callXPCOMMethod(int aMethodIndex,
+          long[] aPrimParams, Object[] aParams);
+
+  /**
+   * Same as <code>callXPCOMMethod</code>, for methods that return a primitive
+   * type.  The result is returned raw, using the same encoding as
+   * <code>aPrimParams</code>, so that no wrapper object is created.
+   *
+   * @see #callXPCOMMethod(int, long[], Object[])
+   */
+  protected final native long callXPCOMMethodRaw(int aMethodIndex,
+          long[] aPrimParams, Object[] aParams);
+
+}
@@ -37,9 +37,11 @@
 
 package org.mozilla.xpcom.internal;
 
+import java.lang.reflect.Constructor;
 import java.lang.reflect.InvocationHandler;
 import java.lang.reflect.Method;
 import java.lang.reflect.Proxy;
+import java.util.HashMap;
 
 import org.mozilla.xpcom.XPCOMException;
 
@@ -52,10 +54,24 @@ import org.mozilla.xpcom.XPCOMException;
 public class XPCOMJavaProxy implements InvocationHandler {
 
   /**
-   * Pointer to the XPCOM object for which we are a proxy.
+   * Pointer to the XPCOM object for which we are a proxy.  Native code reads
+   * this field directly.
    */
   protected long nativeXPCOMPtr;
 
+  /**
+   * Package of the direct-binding classes written by the interface generator.
+   */
+  private static final String BINDING_PACKAGE =
+          "org.mozilla.interfaces.bindings.";
+
+  /**
+   * Maps an interface class to the constructor of its generated binding, or to
+   * <code>NO_BINDING</code> if there is no binding for that interface.
+   */
+  private static final HashMap bindingConstructors = new HashMap();
+  private static final Object NO_BINDING = new Object();
+
   /**
    * Default constructor.
    *
@@ -66,19 +82,27 @@ public class XPCOMJavaProxy implements InvocationHandler {
   }
 
   /**
-   * Returns the XPCOM object that the given proxy references.
+   * Returns the XPCOM object that the given proxy references.  Native code
+   * reads <code>nativeXPCOMPtr</code> itself, and only calls this method if
+   * it can't get at the invocation handler of a
+   * <code>java.lang.reflect.Proxy</code>.
    *
    * @param aProxy  Proxy created by <code>createProxy</code>
    *
    * @return  address of XPCOM object as a long
    */
   protected static long getNativeXPCOMInstance(Object aProxy) {
+    if (aProxy instanceof XPCOMJavaBinding) {
+      return ((XPCOMJavaBinding) aProxy).nativeXPCOMPtr;
+    }
     XPCOMJavaProxy proxy = (XPCOMJavaProxy) Proxy.getInvocationHandler(aProxy);
     return proxy.nativeXPCOMPtr;
   }
 
   /**
-   * Creates a Proxy for the given XPCOM object.
+   * Creates a Proxy for the given XPCOM object.  If a generated binding class
+   * exists for the given interface, an instance of that class is returned
+   * instead of a <code>java.lang.reflect.Proxy</code>.
    *
    * @param aInterface      interface from which to create Proxy
    * @param aXPCOMInstance  address of XPCOM object as a long
@@ -86,15 +110,58 @@ public class XPCOMJavaProxy implements InvocationHandler {
    * @return  Proxy of given XPCOM object
    */
   protected static Object createProxy(Class aInterface, long aXPCOMInstance) {
-    // XXX We should really get the class loader from |aInterface|.  However,
-    //     that class loader doesn't know about |XPCOMJavaProxyBase|.  So for
-    //     now, we get the class loader that loaded |XPCOMJavaProxy|.  When
-    //     we get rid of the "XPCOMJavaProxyBase.java" class, we can revert
-    //     to the old method below.
-//    return Proxy.newProxyInstance(aInterface.getClassLoader(),
-    return Proxy.newProxyInstance(XPCOMJavaProxy.class.getClassLoader(),
-            new Class[] { aInterface, XPCOMJavaProxyBase.class },
-            new XPCOMJavaProxy(aXPCOMInstance));
+    Object proxy = null;
+    Constructor binding = getBindingConstructor(aInterface);
+    if (binding != null) {
+      try {
+        proxy = binding.newInstance(new Object[] { new Long(aXPCOMInstance) });
+      } catch (Exception e) {
+        // fall back to a reflective proxy
+      }
+    }
+
+    if (proxy == null) {
+      proxy = Proxy.newProxyInstance(aInterface.getClassLoader(),
+              new Class[] { aInterface }, new XPCOMJavaProxy(aXPCOMInstance));
+    }
+
+    // The native instance is released once the proxy has been collected.
+    XPCOMProxyReference.track(proxy, aXPCOMInstance);
+    return proxy;
+  }
+
+  /**
+   * Returns the constructor of the generated binding class for the given
+   * interface, or <code>null</code> if there is none.
+   *
+   * @param aInterface  interface for which to find binding
+   *
+   * @return  constructor taking the XPCOM instance as a long, or
+   *          <code>null</code>
+   */
+  private static Constructor getBindingConstructor(Class aInterface) {
+    synchronized (bindingConstructors) {
+      Object ctor = bindingConstructors.get(aInterface);
+      if (ctor == null) {
+        ctor = NO_BINDING;
+        String ifaceName = aInterface.getName();
+        String name = BINDING_PACKAGE +
+                      ifaceName.substring(ifaceName.lastIndexOf('.') + 1) +
+                      "Binding";
+        try {
+          Class clazz = Class.forName(name, true, aInterface.getClassLoader());
+          if (aInterface.isAssignableFrom(clazz) &&
+              XPCOMJavaBinding.class.isAssignableFrom(clazz)) {
+            ctor = clazz.getConstructor(new Class[] { long.class });
+          }
+        } catch (ClassNotFoundException e) {
+        } catch (LinkageError e) {
+        } catch (NoSuchMethodException e) {
+        }
+        bindingConstructors.put(aInterface, ctor);
+      }
+      return (ctor != NO_BINDING) ? (Constructor) ctor : null;
+    }
   }
 
   /**
@@ -128,19 +195,8 @@ public class XPCOMJavaProxy implements InvocationHandler {
       return null;
     }
 
-    // Handle the 'finalize' method called during garbage collection
-    if (aMethod.getDeclaringClass() == XPCOMJavaProxyBase.class) {
-      if (methodName.equals("finalize")) {
-        finalizeProxy(aProxy);
-      } else {
-        System.err.println("WARNING: Unhandled XPCOMJavaProxyBase method [" +
-                           methodName + "]");
-      }
-      return null;
-    }
-
     // If not already handled, pass method calls to XPCOM object.
-    return callXPCOMMethod(aProxy, methodName, aParams);
+    return callXPCOMMethod(aProxy, aMethod, aParams);
   }
 
   /**
@@ -190,6 +246,9 @@ public class XPCOMJavaProxy implements InvocationHandler {
    *          <code>false</code> otherwise
    */
   protected static boolean isXPCOMJavaProxy(Object aObject) {
+    if (aObject instanceof XPCOMJavaBinding) {
+      return true;
+    }
     if (aObject != null && Proxy.isProxyClass(aObject.getClass())) {
       InvocationHandler h = Proxy.getInvocationHandler(aObject);
       if (h instanceof XPCOMJavaProxy) {
@@ -227,23 +286,21 @@ public class XPCOMJavaProxy implements InvocationHandler {
   }
 
   /**
-   * Called when the proxy is garbage collected by the JVM.  Allows us to clean
-   * up any references to the XPCOM object.
+   * Releases the native instances of proxies that have been garbage collected
+   * by the JVM, along with any references to their XPCOM objects.  Called by
+   * <code>XPCOMProxyReference</code>.
    *
-   * @param aProxy  reference to Proxy that is being garbage collected
+   * @param aXPCOMInstances  addresses of the native instances, as passed to
+   *                         <code>createProxy</code>
    */
-  protected void finalizeProxy(Object aProxy) throws Throwable {
-    finalizeProxyNative(aProxy);
-    super.finalize();
-  }
-
-  protected static native void finalizeProxyNative(Object aProxy);
+  static native void releaseInstances(long[] aXPCOMInstances);
 
   /**
    * Calls the XPCOM object referenced by the proxy with the given method.
    *
    * @param aProxy        Proxy created by <code>createProxy</code>
-   * @param aMethodName   name of method that we want to call
+   * @param aMethod       method that we want to call; the native code caches
+   *                      the XPCOM method info it resolves to
    * @param aParams       array of params passed to method
    *
    * @return  return value as defined by given method
@@ -252,7 +309,7 @@ public class XPCOMJavaProxy implements InvocationHandler {
    *            are defined by the method called.
    */
   protected static native Object callXPCOMMethod(Object aProxy,
-          String aMethodName, Object[] aParams);
+          Method aMethod, Object[] aParams);
 
 }
 
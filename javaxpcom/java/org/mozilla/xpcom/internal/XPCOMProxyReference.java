@@ -0,0 +1,173 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2004
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+package org.mozilla.xpcom.internal;
+
+import java.lang.ref.PhantomReference;
+import java.lang.ref.Reference;
+import java.lang.ref.ReferenceQueue;
+import java.util.HashSet;
+
+
+/**
+ * Releases the native XPCOM instances of proxies and bindings once they have
+ * been garbage collected.  Unlike <code>finalize</code>, a phantom reference
+ * doesn't keep the proxy alive for another GC cycle.  The collected proxies
+ * are handled by a single daemon thread, which releases their native
+ * instances in batches through <code>XPCOMJavaProxy.releaseInstances</code>.
+ * The same thread releases the native arrays of collected
+ * <code>XPCOMInterfaceList</code>s, whose references share the queue.
+ */
+final class XPCOMProxyReference extends PhantomReference {
+
+  /** Maximum number of instances released by one native call. */
+  private static final int BATCH_SIZE = 256;
+
+  private static final ReferenceQueue queue = new ReferenceQueue();
+
+  /** Keeps the references themselves reachable until they are enqueued. */
+  private static final HashSet references = new HashSet();
+
+  private static Thread reclaimer = null;
+
+  /** Address of the native <code>JavaXPCOMInstance</code> of the proxy. */
+  private final long instance;
+
+  private XPCOMProxyReference(Object aProxy, long aXPCOMInstance) {
+    super(aProxy, queue);
+    instance = aXPCOMInstance;
+  }
+
+  /**
+   * Releases the given native instance once the proxy has been garbage
+   * collected.
+   *
+   * @param aProxy          proxy or binding created by
+   *                        <code>XPCOMJavaProxy.createProxy</code>
+   * @param aXPCOMInstance  address of the native instance wrapped by
+   *                        <code>aProxy</code>
+   */
+  static void track(Object aProxy, long aXPCOMInstance) {
+    synchronized (references) {
+      references.add(new XPCOMProxyReference(aProxy, aXPCOMInstance));
+      startReclaimer();
+    }
+  }
+
+  /**
+   * Returns the queue handled by the reclaimer thread, for references of
+   * other types that need releasing once collected.
+   */
+  static ReferenceQueue getQueue() {
+    synchronized (references) {
+      startReclaimer();
+    }
+    return queue;
+  }
+
+  /** Must be called while holding the lock on <code>references</code>. */
+  private static void startReclaimer() {
+    if (reclaimer == null) {
+      reclaimer = new Thread(new Reclaimer(), "XPCOM Proxy Reclaimer");
+      reclaimer.setDaemon(true);
+      reclaimer.start();
+    }
+  }
+
+  /**
+   * Forgets all tracked proxies.  Called from native code when JavaXPCOM is
+   * shut down, since the native instances of any remaining proxies are
+   * deleted at that point.
+   */
+  static void clear() {
+    synchronized (references) {
+      references.clear();
+    }
+  }
+
+  /**
+   * Returns <code>true</code> if the given reference was still tracked.
+   */
+  private static boolean untrack(Reference aRef) {
+    synchronized (references) {
+      return references.remove(aRef);
+    }
+  }
+
+  private static final class Reclaimer implements Runnable {
+
+    public void run() {
+      long[] batch = new long[BATCH_SIZE];
+      while (true) {
+        int count = 0;
+        try {
+          // Wait for the first collected proxy, then take whatever else has
+          // been enqueued along with it.
+          Reference ref = queue.remove();
+          while (ref != null) {
+            if (!(ref instanceof XPCOMProxyReference)) {
+              XPCOMInterfaceList.reclaim(ref);
+            } else if (untrack(ref)) {
+              batch[count++] = ((XPCOMProxyReference) ref).instance;
+              if (count == BATCH_SIZE) {
+                release(batch, count);
+                count = 0;
+              }
+            }
+            ref = queue.poll();
+          }
+        } catch (InterruptedException e) {
+        }
+
+        if (count > 0) {
+          release(batch, count);
+        }
+      }
+    }
+
+    private void release(long[] aBatch, int aCount) {
+      long[] instances = aBatch;
+      if (aCount < aBatch.length) {
+        instances = new long[aCount];
+        System.arraycopy(aBatch, 0, instances, 0, aCount);
+      }
+      XPCOMJavaProxy.releaseInstances(instances);
+    }
+
+  }
+
+}
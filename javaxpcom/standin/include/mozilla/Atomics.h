@@ -0,0 +1,170 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef mozilla_Atomics_h
+#define mozilla_Atomics_h
+
+/*
+ * mozilla::Atomic on top of <atomic>, limited to the operations JavaXPCOM
+ * uses.
+ */
+
+#include <atomic>
+#include <stdint.h>
+
+namespace mozilla {
+
+enum MemoryOrdering {
+  Relaxed,
+  ReleaseAcquire,
+  SequentiallyConsistent
+};
+
+namespace detail {
+
+template<MemoryOrdering Order> struct AtomicOrderConstraints;
+
+template<>
+struct AtomicOrderConstraints<Relaxed>
+{
+  static const std::memory_order Load = std::memory_order_relaxed;
+  static const std::memory_order Store = std::memory_order_relaxed;
+  static const std::memory_order Update = std::memory_order_relaxed;
+};
+
+template<>
+struct AtomicOrderConstraints<ReleaseAcquire>
+{
+  static const std::memory_order Load = std::memory_order_acquire;
+  static const std::memory_order Store = std::memory_order_release;
+  static const std::memory_order Update = std::memory_order_acq_rel;
+};
+
+template<>
+struct AtomicOrderConstraints<SequentiallyConsistent>
+{
+  static const std::memory_order Load = std::memory_order_seq_cst;
+  static const std::memory_order Store = std::memory_order_seq_cst;
+  static const std::memory_order Update = std::memory_order_seq_cst;
+};
+
+template<typename T, MemoryOrdering Order>
+class AtomicBase
+{
+  protected:
+    typedef AtomicOrderConstraints<Order> Constraints;
+    std::atomic<T> mValue;
+
+  public:
+    AtomicBase() : mValue() {}
+    AtomicBase(T aInit) : mValue(aInit) {}
+
+    operator T() const { return mValue.load(Constraints::Load); }
+
+    T operator=(T aValue) {
+      mValue.store(aValue, Constraints::Store);
+      return aValue;
+    }
+
+    T exchange(T aValue) {
+      return mValue.exchange(aValue, Constraints::Update);
+    }
+
+    bool compareExchange(T aOldValue, T aNewValue) {
+      return mValue.compare_exchange_strong(aOldValue, aNewValue,
+                                            Constraints::Update,
+                                            Constraints::Load);
+    }
+
+  private:
+    AtomicBase(const AtomicBase&);
+};
+
+} // namespace detail
+
+template<typename T, MemoryOrdering Order = SequentiallyConsistent>
+class Atomic : public detail::AtomicBase<T, Order>
+{
+    typedef detail::AtomicBase<T, Order> Base;
+    typedef typename Base::Constraints Constraints;
+
+  public:
+    Atomic() : Base() {}
+    Atomic(T aInit) : Base(aInit) {}
+
+    using Base::operator=;
+
+    T operator++(int) { return this->mValue.fetch_add(1, Constraints::Update); }
+    T operator--(int) { return this->mValue.fetch_sub(1, Constraints::Update); }
+    T operator++() { return this->mValue.fetch_add(1, Constraints::Update) + 1; }
+    T operator--() { return this->mValue.fetch_sub(1, Constraints::Update) - 1; }
+
+    T operator+=(T aDelta) {
+      return this->mValue.fetch_add(aDelta, Constraints::Update) + aDelta;
+    }
+    T operator-=(T aDelta) {
+      return this->mValue.fetch_sub(aDelta, Constraints::Update) - aDelta;
+    }
+};
+
+template<typename T, MemoryOrdering Order>
+class Atomic<T*, Order> : public detail::AtomicBase<T*, Order>
+{
+    typedef detail::AtomicBase<T*, Order> Base;
+
+  public:
+    Atomic() : Base(nullptr) {}
+    Atomic(T* aInit) : Base(aInit) {}
+
+    using Base::operator=;
+};
+
+template<MemoryOrdering Order>
+class Atomic<bool, Order> : public detail::AtomicBase<bool, Order>
+{
+    typedef detail::AtomicBase<bool, Order> Base;
+
+  public:
+    Atomic() : Base(false) {}
+    Atomic(bool aInit) : Base(aInit) {}
+
+    using Base::operator=;
+};
+
+} // namespace mozilla
+
+#endif /* mozilla_Atomics_h */
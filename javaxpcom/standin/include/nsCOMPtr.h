@@ -0,0 +1,297 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef nsCOMPtr_h___
+#define nsCOMPtr_h___
+
+/*
+ * A smart pointer that owns a reference to an XPCOM object.  This is a
+ * reduced version of Gecko's nsCOMPtr; it keeps the same spelling for
+ * everything JavaXPCOM uses.
+ */
+
+#include "nsISupports.h"
+#include "nsDebug.h"
+
+template <class T>
+struct already_AddRefed
+{
+  already_AddRefed() : mRawPtr(nullptr) {}
+  explicit already_AddRefed(T* aRawPtr) : mRawPtr(aRawPtr) {}
+
+  T* get() const { return mRawPtr; }
+
+  T* take()
+  {
+    T* rawPtr = mRawPtr;
+    mRawPtr = nullptr;
+    return rawPtr;
+  }
+
+  T* mRawPtr;
+};
+
+template <class T>
+inline const already_AddRefed<T>
+dont_AddRef(T* aRawPtr)
+{
+  return already_AddRefed<T>(aRawPtr);
+}
+
+/**
+ * Base class for the do_QueryInterface/do_GetService style helpers that
+ * produce an interface pointer for a given IID.
+ */
+class nsCOMPtr_helper
+{
+public:
+  virtual nsresult NS_FASTCALL operator()(const nsIID&, void**) const = 0;
+};
+
+class nsQueryInterface : public nsCOMPtr_helper
+{
+public:
+  nsQueryInterface(nsISupports* aRawPtr, nsresult* aErrorPtr)
+    : mRawPtr(aRawPtr), mErrorPtr(aErrorPtr)
+  {
+  }
+
+  virtual nsresult NS_FASTCALL operator()(const nsIID& aIID,
+                                          void** aResult) const;
+
+private:
+  nsISupports* mRawPtr;
+  nsresult* mErrorPtr;
+};
+
+inline const nsQueryInterface
+do_QueryInterface(nsISupports* aRawPtr, nsresult* aErrorPtr = 0)
+{
+  return nsQueryInterface(aRawPtr, aErrorPtr);
+}
+
+template <class DestinationType>
+inline nsresult
+CallQueryInterface(nsISupports* aSource, DestinationType** aDestination)
+{
+  NS_PRECONDITION(aSource, "null parameter");
+  NS_PRECONDITION(aDestination, "null parameter");
+
+  return aSource->QueryInterface(NS_GET_TEMPLATE_IID(DestinationType),
+                                 reinterpret_cast<void**>(aDestination));
+}
+
+template <class T>
+class nsCOMPtr
+{
+public:
+  typedef T element_type;
+
+  nsCOMPtr() : mRawPtr(nullptr) {}
+
+  nsCOMPtr(const nsCOMPtr<T>& aSmartPtr) : mRawPtr(aSmartPtr.mRawPtr)
+  {
+    if (mRawPtr)
+      mRawPtr->AddRef();
+  }
+
+  nsCOMPtr(T* aRawPtr) : mRawPtr(aRawPtr)
+  {
+    if (mRawPtr)
+      mRawPtr->AddRef();
+  }
+
+  nsCOMPtr(const already_AddRefed<T>& aSmartPtr)
+    : mRawPtr(aSmartPtr.mRawPtr)
+  {
+  }
+
+  nsCOMPtr(const nsCOMPtr_helper& aHelper) : mRawPtr(nullptr)
+  {
+    void* newRawPtr;
+    if (NS_FAILED(aHelper(NS_GET_TEMPLATE_IID(T), &newRawPtr)))
+      newRawPtr = nullptr;
+    mRawPtr = static_cast<T*>(newRawPtr);
+  }
+
+  ~nsCOMPtr()
+  {
+    if (mRawPtr)
+      mRawPtr->Release();
+  }
+
+  nsCOMPtr<T>& operator=(const nsCOMPtr<T>& aRhs)
+  {
+    assign_with_AddRef(aRhs.mRawPtr);
+    return *this;
+  }
+
+  nsCOMPtr<T>& operator=(T* aRhs)
+  {
+    assign_with_AddRef(aRhs);
+    return *this;
+  }
+
+  nsCOMPtr<T>& operator=(const already_AddRefed<T>& aRhs)
+  {
+    assign_assuming_AddRef(aRhs.mRawPtr);
+    return *this;
+  }
+
+  nsCOMPtr<T>& operator=(const nsCOMPtr_helper& aRhs)
+  {
+    void* newRawPtr;
+    if (NS_FAILED(aRhs(NS_GET_TEMPLATE_IID(T), &newRawPtr)))
+      newRawPtr = nullptr;
+    assign_assuming_AddRef(static_cast<T*>(newRawPtr));
+    return *this;
+  }
+
+  void swap(nsCOMPtr<T>& aRhs)
+  {
+    T* temp = aRhs.mRawPtr;
+    aRhs.mRawPtr = mRawPtr;
+    mRawPtr = temp;
+  }
+
+  void swap(T*& aRhs)
+  {
+    T* temp = aRhs;
+    aRhs = mRawPtr;
+    mRawPtr = temp;
+  }
+
+  already_AddRefed<T> forget()
+  {
+    T* temp = nullptr;
+    swap(temp);
+    return already_AddRefed<T>(temp);
+  }
+
+  template <typename I>
+  void forget(I** aRhs)
+  {
+    NS_ASSERTION(aRhs, "Null pointer passed to forget!");
+    *aRhs = mRawPtr;
+    mRawPtr = nullptr;
+  }
+
+  T* get() const { return mRawPtr; }
+  operator T*() const { return get(); }
+
+  T* operator->() const
+  {
+    NS_PRECONDITION(mRawPtr != 0,
+                    "You can't dereference a NULL nsCOMPtr with operator->().");
+    return get();
+  }
+
+  T& operator*() const
+  {
+    NS_PRECONDITION(mRawPtr != 0,
+                    "You can't dereference a NULL nsCOMPtr with operator*().");
+    return *get();
+  }
+
+  T** StartAssignment()
+  {
+    assign_assuming_AddRef(nullptr);
+    return &mRawPtr;
+  }
+
+private:
+  void assign_with_AddRef(T* aRawPtr)
+  {
+    if (aRawPtr)
+      aRawPtr->AddRef();
+    assign_assuming_AddRef(aRawPtr);
+  }
+
+  void assign_assuming_AddRef(T* aNewPtr)
+  {
+    T* oldPtr = mRawPtr;
+    mRawPtr = aNewPtr;
+    if (oldPtr)
+      oldPtr->Release();
+  }
+
+  T* mRawPtr;
+};
+
+template <class T>
+class nsGetterAddRefs
+{
+public:
+  explicit nsGetterAddRefs(nsCOMPtr<T>& aSmartPtr)
+    : mTargetSmartPtr(aSmartPtr)
+  {
+  }
+
+  operator void**()
+  {
+    return reinterpret_cast<void**>(mTargetSmartPtr.StartAssignment());
+  }
+
+  operator T**() { return mTargetSmartPtr.StartAssignment(); }
+  T*& operator*() { return *(mTargetSmartPtr.StartAssignment()); }
+
+private:
+  nsCOMPtr<T>& mTargetSmartPtr;
+};
+
+template <class T>
+inline nsGetterAddRefs<T>
+getter_AddRefs(nsCOMPtr<T>& aSmartPtr)
+{
+  return nsGetterAddRefs<T>(aSmartPtr);
+}
+
+template <class T, class U>
+inline bool
+operator==(const nsCOMPtr<T>& aLhs, const U* aRhs)
+{
+  return static_cast<const T*>(aLhs.get()) == aRhs;
+}
+
+template <class T, class U>
+inline bool
+operator!=(const nsCOMPtr<T>& aLhs, const U* aRhs)
+{
+  return !(aLhs == aRhs);
+}
+
+#endif /* nsCOMPtr_h___ */
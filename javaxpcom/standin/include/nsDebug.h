@@ -0,0 +1,124 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef nsDebug_h___
+#define nsDebug_h___
+
+/*
+ * Debugging macros.  As in Gecko, assertions and warnings are only active in
+ * DEBUG builds; assertions print and continue, NS_RUNTIMEABORT always aborts.
+ */
+
+#include "nscore.h"
+#include "nsError.h"
+#include <stdio.h>
+
+PR_BEGIN_EXTERN_C
+
+NS_EXPORT void NS_DebugBreak(PRUint32 aSeverity, const char* aStr,
+                             const char* aExpr, const char* aFile,
+                             PRInt32 aLine);
+
+PR_END_EXTERN_C
+
+enum {
+  NS_DEBUG_WARNING = 0,
+  NS_DEBUG_ASSERTION = 1,
+  NS_DEBUG_BREAK = 2,
+  NS_DEBUG_ABORT = 3
+};
+
+#ifdef DEBUG
+
+#define NS_ASSERTION(expr, str)                                           \
+  do {                                                                    \
+    if (!(expr)) {                                                        \
+      NS_DebugBreak(NS_DEBUG_ASSERTION, str, #expr, __FILE__, __LINE__);  \
+    }                                                                     \
+  } while (0)
+
+#define NS_WARNING(str) \
+  NS_DebugBreak(NS_DEBUG_WARNING, str, nullptr, __FILE__, __LINE__)
+
+#define NS_ERROR(str) \
+  NS_DebugBreak(NS_DEBUG_ASSERTION, str, "Error", __FILE__, __LINE__)
+
+#define NS_NOTREACHED(str) \
+  NS_DebugBreak(NS_DEBUG_ASSERTION, str, "Not Reached", __FILE__, __LINE__)
+
+#else
+
+#define NS_ASSERTION(expr, str)   do { } while (0)
+#define NS_WARNING(str)           do { } while (0)
+#define NS_ERROR(str)             do { } while (0)
+#define NS_NOTREACHED(str)        do { } while (0)
+
+#endif
+
+#define NS_PRECONDITION(expr, str)  NS_ASSERTION(expr, str)
+#define NS_POSTCONDITION(expr, str) NS_ASSERTION(expr, str)
+#define NS_ABORT_IF_FALSE(expr, str) NS_ASSERTION(expr, str)
+
+#define NS_RUNTIMEABORT(msg) \
+  NS_DebugBreak(NS_DEBUG_ABORT, msg, nullptr, __FILE__, __LINE__)
+
+#define NS_ENSURE_TRUE(x, ret)                                  \
+  do {                                                          \
+    if (MOZ_UNLIKELY(!(x))) {                                   \
+      NS_WARNING("NS_ENSURE_TRUE(" #x ") failed");              \
+      return ret;                                               \
+    }                                                           \
+  } while (0)
+
+#define NS_ENSURE_FALSE(x, ret)   NS_ENSURE_TRUE(!(x), ret)
+
+#define NS_ENSURE_SUCCESS(res, ret)                             \
+  do {                                                          \
+    nsresult __rv = res;                                        \
+    if (NS_FAILED(__rv)) {                                      \
+      NS_WARNING("NS_ENSURE_SUCCESS(" #res ", " #ret ") failed"); \
+      return ret;                                               \
+    }                                                           \
+  } while (0)
+
+#define NS_ENSURE_ARG(arg)          NS_ENSURE_TRUE(arg, NS_ERROR_INVALID_ARG)
+#define NS_ENSURE_ARG_POINTER(arg)  NS_ENSURE_TRUE(arg, NS_ERROR_INVALID_POINTER)
+#define NS_ENSURE_STATE(state)      NS_ENSURE_TRUE(state, NS_ERROR_UNEXPECTED)
+#define NS_ENSURE_NO_AGGREGATION(outer) \
+  NS_ENSURE_FALSE(outer, NS_ERROR_NO_AGGREGATION)
+
+#endif /* nsDebug_h___ */
@@ -0,0 +1,93 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef nsError_h__
+#define nsError_h__
+
+#include "nscore.h"
+
+/*
+ * Only the codes JavaXPCOM and the stand-in runtime use are defined here;
+ * the values match Gecko's.
+ */
+
+#define NS_ERROR_SEVERITY_SUCCESS       0
+#define NS_ERROR_SEVERITY_ERROR         1
+#define NS_ERROR_MODULE_BASE_OFFSET     0x45
+#define NS_ERROR_MODULE_XPCOM           1
+#define NS_ERROR_MODULE_BASE            2
+
+#define NS_ERROR_GENERATE(sev, module, code) \
+    ((nsresult)(((PRUint32)(sev) << 31) | \
+                (((PRUint32)(module) + NS_ERROR_MODULE_BASE_OFFSET) << 16) | \
+                ((PRUint32)(code))))
+
+#define NS_ERROR_GENERATE_FAILURE(module, code) \
+    NS_ERROR_GENERATE(NS_ERROR_SEVERITY_ERROR, module, code)
+
+#define NS_FAILED(_nsresult)    ((_nsresult) & 0x80000000)
+#define NS_SUCCEEDED(_nsresult) (!NS_FAILED(_nsresult))
+
+#define NS_OK                            ((nsresult) 0)
+#define NS_ERROR_BASE                    ((nsresult) 0xC1F30000)
+#define NS_ERROR_NOT_INITIALIZED         ((nsresult) (NS_ERROR_BASE + 1))
+#define NS_ERROR_ALREADY_INITIALIZED     ((nsresult) (NS_ERROR_BASE + 2))
+#define NS_ERROR_NOT_IMPLEMENTED         ((nsresult) 0x80004001L)
+#define NS_NOINTERFACE                   ((nsresult) 0x80004002L)
+#define NS_ERROR_NO_INTERFACE            NS_NOINTERFACE
+#define NS_ERROR_INVALID_POINTER         ((nsresult) 0x80004003L)
+#define NS_ERROR_NULL_POINTER            NS_ERROR_INVALID_POINTER
+#define NS_ERROR_ABORT                   ((nsresult) 0x80004004L)
+#define NS_ERROR_FAILURE                 ((nsresult) 0x80004005L)
+#define NS_ERROR_UNEXPECTED              ((nsresult) 0x8000ffffL)
+#define NS_ERROR_OUT_OF_MEMORY           ((nsresult) 0x8007000eL)
+#define NS_ERROR_ILLEGAL_VALUE           ((nsresult) 0x80070057L)
+#define NS_ERROR_INVALID_ARG             NS_ERROR_ILLEGAL_VALUE
+#define NS_ERROR_NO_AGGREGATION          ((nsresult) 0x80040110L)
+#define NS_ERROR_NOT_AVAILABLE           ((nsresult) 0x80040111L)
+#define NS_ERROR_FACTORY_NOT_REGISTERED  ((nsresult) 0x80040154L)
+#define NS_ERROR_ILLEGAL_DURING_SHUTDOWN ((nsresult) (NS_ERROR_BASE + 30))
+#define NS_ERROR_NOT_SAME_THREAD         ((nsresult) 0x80460004L)
+#define NS_ERROR_SERVICE_NOT_AVAILABLE   ((nsresult) 0x80460016L)
+
+#define NS_ERROR_FILE_UNRECOGNIZED_PATH \
+    NS_ERROR_GENERATE_FAILURE(NS_ERROR_MODULE_FILES, 1)
+#define NS_ERROR_FILE_NOT_FOUND \
+    NS_ERROR_GENERATE_FAILURE(NS_ERROR_MODULE_FILES, 18)
+#define NS_ERROR_MODULE_FILES           13
+
+#endif /* nsError_h__ */
@@ -0,0 +1,113 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef nsHashKeys_h__
+#define nsHashKeys_h__
+
+/*
+ * Entry classes for nsTHashtable.  Each has a KeyType, a KeyTypePointer
+ * (passed to the table's callbacks), KeyEquals, KeyToPointer and HashKey.
+ */
+
+#include <string.h>
+#include "nscore.h"
+#include "pldhash.h"
+
+inline PLDHashNumber
+HashString(const char* aStr)
+{
+  PLDHashNumber h = 0;
+  for (const unsigned char* s = reinterpret_cast<const unsigned char*>(aStr);
+       *s; s++) {
+    h = (h >> 28) ^ (h << 4) ^ *s;
+  }
+  return h;
+}
+
+/**
+ * Hashes a const char* by its contents without copying it; the string must
+ * outlive the entry.
+ */
+class nsDepCharHashKey : public PLDHashEntryHdr
+{
+public:
+  typedef const char* KeyType;
+  typedef const char* KeyTypePointer;
+
+  nsDepCharHashKey(const char* aKey) : mKey(aKey) {}
+  nsDepCharHashKey(const nsDepCharHashKey& aToCopy) : mKey(aToCopy.mKey) {}
+  ~nsDepCharHashKey() {}
+
+  const char* GetKey() const { return mKey; }
+  bool KeyEquals(const char* aKey) const { return !strcmp(mKey, aKey); }
+
+  static const char* KeyToPointer(const char* aKey) { return aKey; }
+  static PLDHashNumber HashKey(const char* aKey) { return HashString(aKey); }
+  enum { ALLOW_MEMMOVE = true };
+
+private:
+  const char* mKey;
+};
+
+/**
+ * Hashes a pointer by its value.
+ */
+class nsVoidPtrHashKey : public PLDHashEntryHdr
+{
+public:
+  typedef const void* KeyType;
+  typedef const void* KeyTypePointer;
+
+  nsVoidPtrHashKey(const void* aKey) : mKey(aKey) {}
+  nsVoidPtrHashKey(const nsVoidPtrHashKey& aToCopy) : mKey(aToCopy.mKey) {}
+  ~nsVoidPtrHashKey() {}
+
+  const void* GetKey() const { return mKey; }
+  bool KeyEquals(const void* aKey) const { return aKey == mKey; }
+
+  static const void* KeyToPointer(const void* aKey) { return aKey; }
+  static PLDHashNumber HashKey(const void* aKey)
+  {
+    return PLDHashNumber(uintptr_t(aKey) >> 2);
+  }
+  enum { ALLOW_MEMMOVE = true };
+
+private:
+  const void* mKey;
+};
+
+#endif /* nsHashKeys_h__ */
@@ -0,0 +1,91 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef __gen_nsIComponentManager_h__
+#define __gen_nsIComponentManager_h__
+
+/*
+ * A reduced nsIComponentManager with the four instance-creation methods.
+ */
+
+#include "nsISupports.h"
+
+#define NS_ICOMPONENTMANAGER_IID \
+  {0xa88e5a60, 0x205a, 0x4bb1, \
+    { 0x94, 0xe1, 0x26, 0x28, 0xda, 0xf5, 0x1e, 0xae }}
+
+class nsIComponentManager : public nsISupports
+{
+public:
+  NS_DECLARE_STATIC_IID_ACCESSOR(NS_ICOMPONENTMANAGER_IID)
+
+  /* void getClassObject (in nsCIDRef aClass, in nsIIDRef aIID, [iid_is (aIID), retval] out nsQIResult result); */
+  NS_IMETHOD GetClassObject(const nsCID& aClass, const nsIID& aIID,
+                            void** result) = 0;
+
+  /* void getClassObjectByContractID (in string aContractID, in nsIIDRef aIID, [iid_is (aIID), retval] out nsQIResult result); */
+  NS_IMETHOD GetClassObjectByContractID(const char* aContractID,
+                                        const nsIID& aIID,
+                                        void** result) = 0;
+
+  /* void createInstance (in nsCIDRef aClass, in nsISupports aDelegate, in nsIIDRef aIID, [iid_is (aIID), retval] out nsQIResult result); */
+  NS_IMETHOD CreateInstance(const nsCID& aClass, nsISupports* aDelegate,
+                            const nsIID& aIID, void** result) = 0;
+
+  /* void createInstanceByContractID (in string aContractID, in nsISupports aDelegate, in nsIIDRef aIID, [iid_is (aIID), retval] out nsQIResult result); */
+  NS_IMETHOD CreateInstanceByContractID(const char* aContractID,
+                                        nsISupports* aDelegate,
+                                        const nsIID& aIID,
+                                        void** result) = 0;
+};
+
+NS_DEFINE_STATIC_IID_ACCESSOR(nsIComponentManager, NS_ICOMPONENTMANAGER_IID)
+
+#define NS_DECL_NSICOMPONENTMANAGER \
+  NS_IMETHOD GetClassObject(const nsCID& aClass, const nsIID& aIID, \
+                            void** result); \
+  NS_IMETHOD GetClassObjectByContractID(const char* aContractID, \
+                                        const nsIID& aIID, void** result); \
+  NS_IMETHOD CreateInstance(const nsCID& aClass, nsISupports* aDelegate, \
+                            const nsIID& aIID, void** result); \
+  NS_IMETHOD CreateInstanceByContractID(const char* aContractID, \
+                                        nsISupports* aDelegate, \
+                                        const nsIID& aIID, void** result);
+
+#include "nsXPCOM.h"
+
+#endif /* __gen_nsIComponentManager_h__ */
@@ -0,0 +1,70 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef __gen_nsIComponentRegistrar_h__
+#define __gen_nsIComponentRegistrar_h__
+
+/*
+ * The stand-in's components are built in, so its nsIComponentRegistrar
+ * only answers questions about them.
+ */
+
+#include "nsISupports.h"
+
+#define NS_ICOMPONENTREGISTRAR_IID \
+  {0x2417cbfe, 0x65ad, 0x48a6, \
+    { 0xb4, 0xb6, 0xeb, 0x84, 0xdb, 0x17, 0x43, 0x92 }}
+
+class nsIComponentRegistrar : public nsISupports
+{
+public:
+  NS_DECLARE_STATIC_IID_ACCESSOR(NS_ICOMPONENTREGISTRAR_IID)
+
+  /* boolean isContractIDRegistered (in string aContractID); */
+  NS_IMETHOD IsContractIDRegistered(const char* aContractID,
+                                    bool* _retval) = 0;
+};
+
+NS_DEFINE_STATIC_IID_ACCESSOR(nsIComponentRegistrar,
+                              NS_ICOMPONENTREGISTRAR_IID)
+
+#define NS_DECL_NSICOMPONENTREGISTRAR \
+  NS_IMETHOD IsContractIDRegistered(const char* aContractID, bool* _retval);
+
+#include "nsXPCOM.h"
+
+#endif /* __gen_nsIComponentRegistrar_h__ */
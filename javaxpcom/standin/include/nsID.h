@@ -0,0 +1,120 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef nsID_h__
+#define nsID_h__
+
+#include <string.h>
+#include "nscore.h"
+
+#define NSID_LENGTH 39
+
+/**
+ * A "unique identifier".  This is modeled after OSF DCE UUIDs.
+ */
+struct nsID
+{
+  PRUint32 m0;
+  PRUint16 m1;
+  PRUint16 m2;
+  PRUint8 m3[8];
+
+  inline bool Equals(const nsID& aOther) const {
+    return memcmp(this, &aOther, sizeof(nsID)) == 0;
+  }
+
+  /**
+   * Parses an ID of the form "{xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}"; the
+   * braces are optional.
+   */
+  bool Parse(const char* aIDStr);
+
+  /**
+   * Returns the braced string form of this ID, allocated with
+   * NS_Alloc.  The caller frees it with NS_Free.
+   */
+  char* ToString() const;
+
+  /**
+   * Writes the braced string form of this ID, including the terminating
+   * null, to aDest.
+   */
+  void ToProvidedString(char (&aDest)[NSID_LENGTH]) const;
+};
+
+inline bool operator==(const nsID& aLeft, const nsID& aRight)
+{
+  return aLeft.Equals(aRight);
+}
+
+inline bool operator!=(const nsID& aLeft, const nsID& aRight)
+{
+  return !aLeft.Equals(aRight);
+}
+
+typedef nsID nsIID;
+typedef nsID nsCID;
+
+#define REFNSIID const nsIID&
+#define REFNSCID const nsCID&
+
+#define NS_DEFINE_IID(_name, _iidspec) \
+  const nsIID _name = _iidspec
+#define NS_DEFINE_CID(_name, _cidspec) \
+  const nsCID _name = _cidspec
+
+/**
+ * Interfaces declare their IID with NS_DECLARE_STATIC_IID_ACCESSOR in the
+ * class body and define it with NS_DEFINE_STATIC_IID_ACCESSOR after it.
+ */
+#define NS_DECLARE_STATIC_IID_ACCESSOR(the_iid) \
+  template <class Dummy> \
+  struct COMTypeInfo;
+
+#define NS_DEFINE_STATIC_IID_ACCESSOR(the_interface, the_iid) \
+  template <class Dummy> \
+  struct the_interface::COMTypeInfo \
+  { \
+    static const nsIID kIID; \
+  }; \
+  template <class Dummy> \
+  const nsIID the_interface::COMTypeInfo<Dummy>::kIID = the_iid;
+
+#define NS_GET_IID(T) (T::COMTypeInfo<int>::kIID)
+#define NS_GET_TEMPLATE_IID(T) (T::template COMTypeInfo<int>::kIID)
+
+#endif /* nsID_h__ */
@@ -0,0 +1,90 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef __gen_nsIDirectoryService_h__
+#define __gen_nsIDirectoryService_h__
+
+#include "nsISupports.h"
+
+class nsIFile;
+class nsISimpleEnumerator;
+
+#define NS_IDIRECTORYSERVICEPROVIDER_IID \
+  {0xbbf8cab0, 0xd43a, 0x11d3, \
+    { 0x8c, 0xc2, 0x00, 0x60, 0x97, 0x92, 0x27, 0x8c }}
+
+/**
+ * Supplies the locations of well-known directories and files.  The stand-in
+ * accepts a provider in NS_InitXPCOM2 and keeps a reference to it, but does
+ * not consult it.
+ */
+class nsIDirectoryServiceProvider : public nsISupports
+{
+public:
+  NS_DECLARE_STATIC_IID_ACCESSOR(NS_IDIRECTORYSERVICEPROVIDER_IID)
+
+  /* nsIFile getFile (in string prop, out boolean persistent); */
+  NS_IMETHOD GetFile(const char* prop, bool* persistent,
+                     nsIFile** _retval) = 0;
+};
+
+NS_DEFINE_STATIC_IID_ACCESSOR(nsIDirectoryServiceProvider,
+                              NS_IDIRECTORYSERVICEPROVIDER_IID)
+
+#define NS_DECL_NSIDIRECTORYSERVICEPROVIDER \
+  NS_IMETHOD GetFile(const char* prop, bool* persistent, nsIFile** _retval);
+
+#define NS_IDIRECTORYSERVICEPROVIDER2_IID \
+  {0x2f977d4b, 0x5485, 0x11d4, \
+    { 0x87, 0xe2, 0x00, 0x10, 0xa4, 0xe7, 0x5e, 0xf2 }}
+
+class nsIDirectoryServiceProvider2 : public nsIDirectoryServiceProvider
+{
+public:
+  NS_DECLARE_STATIC_IID_ACCESSOR(NS_IDIRECTORYSERVICEPROVIDER2_IID)
+
+  /* nsISimpleEnumerator getFiles (in string prop); */
+  NS_IMETHOD GetFiles(const char* prop, nsISimpleEnumerator** _retval) = 0;
+};
+
+NS_DEFINE_STATIC_IID_ACCESSOR(nsIDirectoryServiceProvider2,
+                              NS_IDIRECTORYSERVICEPROVIDER2_IID)
+
+#define NS_DECL_NSIDIRECTORYSERVICEPROVIDER2 \
+  NS_IMETHOD GetFiles(const char* prop, nsISimpleEnumerator** _retval);
+
+#endif /* __gen_nsIDirectoryService_h__ */
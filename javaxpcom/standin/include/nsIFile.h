@@ -0,0 +1,111 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef __gen_nsIFile_h__
+#define __gen_nsIFile_h__
+
+/*
+ * A reduced nsIFile: the stand-in declares only the methods below, in this
+ * order, and describes them the same way in its typelib.
+ */
+
+#include "nsISupports.h"
+
+class nsAString;
+class nsACString;
+
+#define NS_IFILE_IID \
+  {0xc8c0a080, 0x0868, 0x11d3, \
+    { 0x91, 0x5f, 0xd9, 0xd8, 0x89, 0xd4, 0x8e, 0x3c }}
+
+class nsIFile : public nsISupports
+{
+public:
+  NS_DECLARE_STATIC_IID_ACCESSOR(NS_IFILE_IID)
+
+  /* void append (in AString node); */
+  NS_IMETHOD Append(const nsAString& node) = 0;
+
+  /* [noscript] void appendNative (in ACString node); */
+  NS_IMETHOD AppendNative(const nsACString& node) = 0;
+
+  /* attribute AString leafName; */
+  NS_IMETHOD GetLeafName(nsAString& aLeafName) = 0;
+  NS_IMETHOD SetLeafName(const nsAString& aLeafName) = 0;
+
+  /* readonly attribute AString path; */
+  NS_IMETHOD GetPath(nsAString& aPath) = 0;
+
+  /* [noscript] readonly attribute ACString nativePath; */
+  NS_IMETHOD GetNativePath(nsACString& aNativePath) = 0;
+
+  /* boolean exists (); */
+  NS_IMETHOD Exists(bool* _retval) = 0;
+
+  /* boolean isDirectory (); */
+  NS_IMETHOD IsDirectory(bool* _retval) = 0;
+
+  /* nsIFile clone (); */
+  NS_IMETHOD Clone(nsIFile** _retval) = 0;
+
+  /* readonly attribute nsIFile parent; */
+  NS_IMETHOD GetParent(nsIFile** aParent) = 0;
+
+  /* void initWithPath (in AString filePath); */
+  NS_IMETHOD InitWithPath(const nsAString& filePath) = 0;
+
+  /* [noscript] void initWithNativePath (in ACString filePath); */
+  NS_IMETHOD InitWithNativePath(const nsACString& filePath) = 0;
+};
+
+NS_DEFINE_STATIC_IID_ACCESSOR(nsIFile, NS_IFILE_IID)
+
+#define NS_DECL_NSIFILE \
+  NS_IMETHOD Append(const nsAString& node); \
+  NS_IMETHOD AppendNative(const nsACString& node); \
+  NS_IMETHOD GetLeafName(nsAString& aLeafName); \
+  NS_IMETHOD SetLeafName(const nsAString& aLeafName); \
+  NS_IMETHOD GetPath(nsAString& aPath); \
+  NS_IMETHOD GetNativePath(nsACString& aNativePath); \
+  NS_IMETHOD Exists(bool* _retval); \
+  NS_IMETHOD IsDirectory(bool* _retval); \
+  NS_IMETHOD Clone(nsIFile** _retval); \
+  NS_IMETHOD GetParent(nsIFile** aParent); \
+  NS_IMETHOD InitWithPath(const nsAString& filePath); \
+  NS_IMETHOD InitWithNativePath(const nsACString& filePath);
+
+#endif /* __gen_nsIFile_h__ */
@@ -0,0 +1,132 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef __gen_nsIInterfaceInfo_h__
+#define __gen_nsIInterfaceInfo_h__
+
+#include "nsISupports.h"
+#include "xptinfo.h"
+
+class nsXPTConstant;
+
+#define NS_IINTERFACEINFO_IID \
+  {0xcd607219, 0x30cd, 0x4df2, \
+    { 0x9d, 0x42, 0xa1, 0xc3, 0x38, 0x98, 0x6f, 0x27 }}
+
+/**
+ * Describes one XPCOM interface: its methods, their parameters and the
+ * interfaces they refer to.  Method indices count from the root of the
+ * inheritance chain, so index 0 is always nsISupports::QueryInterface.
+ */
+class nsIInterfaceInfo : public nsISupports
+{
+public:
+  NS_DECLARE_STATIC_IID_ACCESSOR(NS_IINTERFACEINFO_IID)
+
+  NS_IMETHOD GetName(char** aName) = 0;
+  NS_IMETHOD GetInterfaceIID(nsIID** aIID) = 0;
+  NS_IMETHOD IsScriptable(bool* _retval) = 0;
+  NS_IMETHOD GetParent(nsIInterfaceInfo** aParent) = 0;
+  NS_IMETHOD GetMethodCount(PRUint16* aMethodCount) = 0;
+  NS_IMETHOD GetConstantCount(PRUint16* aConstantCount) = 0;
+  NS_IMETHOD GetMethodInfo(PRUint16 index, const nsXPTMethodInfo** info) = 0;
+  NS_IMETHOD GetMethodInfoForName(const char* methodName, PRUint16* index,
+                                  const nsXPTMethodInfo** info) = 0;
+  NS_IMETHOD GetConstant(PRUint16 index, const nsXPTConstant** constant) = 0;
+  NS_IMETHOD GetInfoForParam(PRUint16 methodIndex,
+                             const nsXPTParamInfo* param,
+                             nsIInterfaceInfo** _retval) = 0;
+  NS_IMETHOD GetIIDForParam(PRUint16 methodIndex,
+                            const nsXPTParamInfo* param,
+                            nsIID** _retval) = 0;
+  NS_IMETHOD GetTypeForParam(PRUint16 methodIndex,
+                             const nsXPTParamInfo* param,
+                             PRUint16 dimension, nsXPTType* _retval) = 0;
+  NS_IMETHOD GetSizeIsArgNumberForParam(PRUint16 methodIndex,
+                                        const nsXPTParamInfo* param,
+                                        PRUint16 dimension,
+                                        PRUint8* _retval) = 0;
+  NS_IMETHOD GetInterfaceIsArgNumberForParam(PRUint16 methodIndex,
+                                             const nsXPTParamInfo* param,
+                                             PRUint8* _retval) = 0;
+  NS_IMETHOD IsIID(const nsIID* IID, bool* _retval) = 0;
+  NS_IMETHOD GetNameShared(const char** name) = 0;
+  NS_IMETHOD GetIIDShared(const nsIID** iid) = 0;
+  NS_IMETHOD IsFunction(bool* _retval) = 0;
+  NS_IMETHOD HasAncestor(const nsIID* iid, bool* _retval) = 0;
+  NS_IMETHOD GetIIDForParamNoAlloc(PRUint16 methodIndex,
+                                   const nsXPTParamInfo* param,
+                                   nsIID* iid) = 0;
+};
+
+NS_DEFINE_STATIC_IID_ACCESSOR(nsIInterfaceInfo, NS_IINTERFACEINFO_IID)
+
+#define NS_DECL_NSIINTERFACEINFO \
+  NS_IMETHOD GetName(char** aName); \
+  NS_IMETHOD GetInterfaceIID(nsIID** aIID); \
+  NS_IMETHOD IsScriptable(bool* _retval); \
+  NS_IMETHOD GetParent(nsIInterfaceInfo** aParent); \
+  NS_IMETHOD GetMethodCount(PRUint16* aMethodCount); \
+  NS_IMETHOD GetConstantCount(PRUint16* aConstantCount); \
+  NS_IMETHOD GetMethodInfo(PRUint16 index, const nsXPTMethodInfo** info); \
+  NS_IMETHOD GetMethodInfoForName(const char* methodName, PRUint16* index, \
+                                  const nsXPTMethodInfo** info); \
+  NS_IMETHOD GetConstant(PRUint16 index, const nsXPTConstant** constant); \
+  NS_IMETHOD GetInfoForParam(PRUint16 methodIndex, \
+                             const nsXPTParamInfo* param, \
+                             nsIInterfaceInfo** _retval); \
+  NS_IMETHOD GetIIDForParam(PRUint16 methodIndex, \
+                            const nsXPTParamInfo* param, nsIID** _retval); \
+  NS_IMETHOD GetTypeForParam(PRUint16 methodIndex, \
+                             const nsXPTParamInfo* param, \
+                             PRUint16 dimension, nsXPTType* _retval); \
+  NS_IMETHOD GetSizeIsArgNumberForParam(PRUint16 methodIndex, \
+                                        const nsXPTParamInfo* param, \
+                                        PRUint16 dimension, \
+                                        PRUint8* _retval); \
+  NS_IMETHOD GetInterfaceIsArgNumberForParam(PRUint16 methodIndex, \
+                                             const nsXPTParamInfo* param, \
+                                             PRUint8* _retval); \
+  NS_IMETHOD IsIID(const nsIID* IID, bool* _retval); \
+  NS_IMETHOD GetNameShared(const char** name); \
+  NS_IMETHOD GetIIDShared(const nsIID** iid); \
+  NS_IMETHOD IsFunction(bool* _retval); \
+  NS_IMETHOD HasAncestor(const nsIID* iid, bool* _retval); \
+  NS_IMETHOD GetIIDForParamNoAlloc(PRUint16 methodIndex, \
+                                   const nsXPTParamInfo* param, nsIID* iid);
+
+#endif /* __gen_nsIInterfaceInfo_h__ */
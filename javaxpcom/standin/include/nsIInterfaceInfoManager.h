@@ -0,0 +1,76 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef __gen_nsIInterfaceInfoManager_h__
+#define __gen_nsIInterfaceInfoManager_h__
+
+#include "nsISupports.h"
+
+class nsIInterfaceInfo;
+
+#define NS_IINTERFACEINFOMANAGER_IID \
+  {0x2f1d3c33, 0x4390, 0x4fa2, \
+    { 0x85, 0x69, 0xff, 0x72, 0x7b, 0x83, 0x5a, 0x7d }}
+
+/**
+ * Looks up interface information by IID or by name.  The stand-in's
+ * manager only knows the interfaces compiled into its typelib tables.
+ */
+class nsIInterfaceInfoManager : public nsISupports
+{
+public:
+  NS_DECLARE_STATIC_IID_ACCESSOR(NS_IINTERFACEINFOMANAGER_IID)
+
+  NS_IMETHOD GetInfoForIID(const nsIID* iid, nsIInterfaceInfo** _retval) = 0;
+  NS_IMETHOD GetInfoForName(const char* name, nsIInterfaceInfo** _retval) = 0;
+  NS_IMETHOD GetIIDForName(const char* name, nsIID** _retval) = 0;
+  NS_IMETHOD GetNameForIID(const nsIID* iid, char** _retval) = 0;
+};
+
+NS_DEFINE_STATIC_IID_ACCESSOR(nsIInterfaceInfoManager,
+                              NS_IINTERFACEINFOMANAGER_IID)
+
+#define NS_DECL_NSIINTERFACEINFOMANAGER \
+  NS_IMETHOD GetInfoForIID(const nsIID* iid, nsIInterfaceInfo** _retval); \
+  NS_IMETHOD GetInfoForName(const char* name, nsIInterfaceInfo** _retval); \
+  NS_IMETHOD GetIIDForName(const char* name, nsIID** _retval); \
+  NS_IMETHOD GetNameForIID(const nsIID* iid, char** _retval);
+
+#define NS_INTERFACEINFOMANAGER_SERVICE_CONTRACTID \
+  "@mozilla.org/xpti/interfaceinfomanager-service;1"
+
+#endif /* __gen_nsIInterfaceInfoManager_h__ */
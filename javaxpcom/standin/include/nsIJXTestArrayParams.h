@@ -0,0 +1,119 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef __gen_nsIJXTestArrayParams_h__
+#define __gen_nsIJXTestArrayParams_h__
+
+/*
+ * Written by hand from old/xpcom/tests/testparams/nsIJXTestArrayParams.idl.
+ */
+
+#include "nsISupports.h"
+
+#define NS_IJXTESTARRAYPARAMS_IID_STR "fb520bac-92cf-4a6b-a2f3-eb63313d7d84"
+
+#define NS_IJXTESTARRAYPARAMS_IID \
+  {0xfb520bac, 0x92cf, 0x4a6b, \
+    { 0xa2, 0xf3, 0xeb, 0x63, 0x31, 0x3d, 0x7d, 0x84 }}
+
+class nsIJXTestArrayParams : public nsISupports
+{
+public:
+  NS_DECLARE_STATIC_IID_ACCESSOR(NS_IJXTESTARRAYPARAMS_IID)
+
+  /* void multiplyEachItemInIntegerArray2 (in PRInt32 val, [array, size_is (count)] inout PRInt32 valueArray, in PRUint32 count); */
+  NS_IMETHOD MultiplyEachItemInIntegerArray2(PRInt32 val,
+                                             PRInt32** valueArray,
+                                             PRUint32 count) = 0;
+
+  /* void copyIntArray ([array, size_is (count)] in PRInt32 srcArray, in PRUint32 count, [array, size_is (count)] out PRInt32 dstArray); */
+  NS_IMETHOD CopyIntArray(PRInt32* srcArray, PRUint32 count,
+                          PRInt32** dstArray) = 0;
+
+  /* void returnIntArray ([array, size_is (count)] in PRInt32 srcArray, in PRUint32 count, [retval, array, size_is (count)] out PRInt32 dstArray); */
+  NS_IMETHOD ReturnIntArray(PRInt32* srcArray, PRUint32 count,
+                            PRInt32** _retval) = 0;
+
+  /* void copyByteArray ([array, size_is (count)] in octet srcArray, in PRUint32 count, [array, size_is (count)] out octet dstArray); */
+  NS_IMETHOD CopyByteArray(PRUint8* srcArray, PRUint32 count,
+                           PRUint8** dstArray) = 0;
+
+  /* void returnByteArray ([array, size_is (count)] in octet srcArray, in PRUint32 count, [retval, array, size_is (count)] out octet dstArray); */
+  NS_IMETHOD ReturnByteArray(PRUint8* srcArray, PRUint32 count,
+                             PRUint8** _retval) = 0;
+
+  /* void copySizedString ([size_is (count)] in string srcString, in PRUint32 count, [size_is (count)] out string dstString); */
+  NS_IMETHOD CopySizedString(const char* srcString, PRUint32 count,
+                             char** dstString) = 0;
+
+  /* void returnSizedString ([size_is (count)] in string srcString, in PRUint32 count, [retval, size_is (count)] out string dstString); */
+  NS_IMETHOD ReturnSizedString(const char* srcString, PRUint32 count,
+                               char** _retval) = 0;
+
+  /* void copySizedWString ([size_is (count)] in wstring srcString, in PRUint32 count, [size_is (count)] out wstring dstString); */
+  NS_IMETHOD CopySizedWString(const PRUnichar* srcString, PRUint32 count,
+                              PRUnichar** dstString) = 0;
+
+  /* void returnSizedWString ([size_is (count)] in wstring srcString, in PRUint32 count, [retval, size_is (count)] out wstring dstString); */
+  NS_IMETHOD ReturnSizedWString(const PRUnichar* srcString, PRUint32 count,
+                                PRUnichar** _retval) = 0;
+};
+
+NS_DEFINE_STATIC_IID_ACCESSOR(nsIJXTestArrayParams, NS_IJXTESTARRAYPARAMS_IID)
+
+#define NS_DECL_NSIJXTESTARRAYPARAMS \
+  NS_IMETHOD MultiplyEachItemInIntegerArray2(PRInt32 val, \
+                                             PRInt32** valueArray, \
+                                             PRUint32 count); \
+  NS_IMETHOD CopyIntArray(PRInt32* srcArray, PRUint32 count, \
+                          PRInt32** dstArray); \
+  NS_IMETHOD ReturnIntArray(PRInt32* srcArray, PRUint32 count, \
+                            PRInt32** _retval); \
+  NS_IMETHOD CopyByteArray(PRUint8* srcArray, PRUint32 count, \
+                           PRUint8** dstArray); \
+  NS_IMETHOD ReturnByteArray(PRUint8* srcArray, PRUint32 count, \
+                             PRUint8** _retval); \
+  NS_IMETHOD CopySizedString(const char* srcString, PRUint32 count, \
+                             char** dstString); \
+  NS_IMETHOD ReturnSizedString(const char* srcString, PRUint32 count, \
+                               char** _retval); \
+  NS_IMETHOD CopySizedWString(const PRUnichar* srcString, PRUint32 count, \
+                              PRUnichar** dstString); \
+  NS_IMETHOD ReturnSizedWString(const PRUnichar* srcString, PRUint32 count, \
+                                PRUnichar** _retval);
+
+#endif /* __gen_nsIJXTestArrayParams_h__ */
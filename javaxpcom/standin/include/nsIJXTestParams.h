@@ -0,0 +1,67 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef __gen_nsIJXTestParams_h__
+#define __gen_nsIJXTestParams_h__
+
+/*
+ * Written by hand from old/xpcom/tests/testparams/nsIJXTestParams.idl.
+ */
+
+#include "nsISupports.h"
+
+#define NS_IJXTESTPARAMS_IID_STR "529d2d15-028e-438f-9007-b3d7ebbe132f"
+
+#define NS_IJXTESTPARAMS_IID \
+  {0x529d2d15, 0x028e, 0x438f, \
+    { 0x90, 0x07, 0xb3, 0xd7, 0xeb, 0xbe, 0x13, 0x2f }}
+
+class nsIJXTestParams : public nsISupports
+{
+public:
+  NS_DECLARE_STATIC_IID_ACCESSOR(NS_IJXTESTPARAMS_IID)
+
+  /* void runTests (in nsISupports tests); */
+  NS_IMETHOD RunTests(nsISupports* tests) = 0;
+};
+
+NS_DEFINE_STATIC_IID_ACCESSOR(nsIJXTestParams, NS_IJXTESTPARAMS_IID)
+
+#define NS_DECL_NSIJXTESTPARAMS \
+  NS_IMETHOD RunTests(nsISupports* tests);
+
+#endif /* __gen_nsIJXTestParams_h__ */
@@ -0,0 +1,85 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef __gen_nsIServiceManager_h__
+#define __gen_nsIServiceManager_h__
+
+#include "nsISupports.h"
+
+#define NS_ISERVICEMANAGER_IID \
+  {0x8bb35ed9, 0xe332, 0x462d, \
+    { 0x91, 0x55, 0x4a, 0x00, 0x2a, 0xb5, 0xc9, 0x58 }}
+
+class nsIServiceManager : public nsISupports
+{
+public:
+  NS_DECLARE_STATIC_IID_ACCESSOR(NS_ISERVICEMANAGER_IID)
+
+  /* void getService (in nsCIDRef aClass, in nsIIDRef aIID, [iid_is (aIID), retval] out nsQIResult result); */
+  NS_IMETHOD GetService(const nsCID& aClass, const nsIID& aIID,
+                        void** result) = 0;
+
+  /* void getServiceByContractID (in string aContractID, in nsIIDRef aIID, [iid_is (aIID), retval] out nsQIResult result); */
+  NS_IMETHOD GetServiceByContractID(const char* aContractID,
+                                    const nsIID& aIID, void** result) = 0;
+
+  /* boolean isServiceInstantiated (in nsCIDRef aClass, in nsIIDRef aIID); */
+  NS_IMETHOD IsServiceInstantiated(const nsCID& aClass, const nsIID& aIID,
+                                   bool* _retval) = 0;
+
+  /* boolean isServiceInstantiatedByContractID (in string aContractID, in nsIIDRef aIID); */
+  NS_IMETHOD IsServiceInstantiatedByContractID(const char* aContractID,
+                                               const nsIID& aIID,
+                                               bool* _retval) = 0;
+};
+
+NS_DEFINE_STATIC_IID_ACCESSOR(nsIServiceManager, NS_ISERVICEMANAGER_IID)
+
+#define NS_DECL_NSISERVICEMANAGER \
+  NS_IMETHOD GetService(const nsCID& aClass, const nsIID& aIID, \
+                        void** result); \
+  NS_IMETHOD GetServiceByContractID(const char* aContractID, \
+                                    const nsIID& aIID, void** result); \
+  NS_IMETHOD IsServiceInstantiated(const nsCID& aClass, const nsIID& aIID, \
+                                   bool* _retval); \
+  NS_IMETHOD IsServiceInstantiatedByContractID(const char* aContractID, \
+                                               const nsIID& aIID, \
+                                               bool* _retval);
+
+#include "nsXPCOM.h"
+
+#endif /* __gen_nsIServiceManager_h__ */
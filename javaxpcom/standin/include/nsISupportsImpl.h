@@ -0,0 +1,229 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef nsISupportsImpl_h__
+#define nsISupportsImpl_h__
+
+#include "nscore.h"
+#include "nsISupports.h"
+#include "nsDebug.h"
+#include "pratom.h"
+#include "mozilla/Atomics.h"
+
+#define NS_ADDREF(_ptr)         (_ptr)->AddRef()
+#define NS_ADDREF_THIS()        AddRef()
+#define NS_IF_ADDREF(_expr)     ((_expr) ? (void)(_expr)->AddRef() : (void)0)
+#define NS_RELEASE(_ptr)        do { (_ptr)->Release(); (_ptr) = 0; } while (0)
+#define NS_RELEASE_THIS()       Release()
+#define NS_IF_RELEASE(_expr)    do { if (_expr) { (_expr)->Release(); (_expr) = 0; } } while (0)
+
+/* Refcount logging and owning-thread checks are not part of the stand-in. */
+#define NS_LOG_ADDREF(_p, _rc, _type, _size)  do { } while (0)
+#define NS_LOG_RELEASE(_p, _rc, _type)        do { } while (0)
+#define NS_DECL_OWNINGTHREAD
+#define NS_ASSERT_OWNINGTHREAD(_class)        do { } while (0)
+
+class nsAutoRefCnt
+{
+public:
+  nsAutoRefCnt() : mValue(0) {}
+  explicit nsAutoRefCnt(nsrefcnt aValue) : mValue(aValue) {}
+
+  nsrefcnt operator++() { return ++mValue; }
+  nsrefcnt operator--() { return --mValue; }
+  nsrefcnt operator=(nsrefcnt aValue) { return (mValue = aValue); }
+  operator nsrefcnt() const { return mValue; }
+  nsrefcnt get() const { return mValue; }
+
+private:
+  nsrefcnt operator++(int);
+  nsrefcnt operator--(int);
+  nsrefcnt mValue;
+};
+
+namespace mozilla {
+
+class ThreadSafeAutoRefCnt
+{
+public:
+  ThreadSafeAutoRefCnt() : mValue(0) {}
+  explicit ThreadSafeAutoRefCnt(nsrefcnt aValue) : mValue(aValue) {}
+
+  nsrefcnt operator++() { return ++mValue; }
+  nsrefcnt operator--() { return --mValue; }
+  nsrefcnt operator=(nsrefcnt aValue) { return (mValue = aValue); }
+  operator nsrefcnt() const { return mValue; }
+  nsrefcnt get() const { return mValue; }
+
+private:
+  nsrefcnt operator++(int);
+  nsrefcnt operator--(int);
+  Atomic<nsrefcnt> mValue;
+};
+
+} // namespace mozilla
+
+#define NS_DECL_ISUPPORTS \
+public: \
+  NS_IMETHOD QueryInterface(REFNSIID aIID, void** aInstancePtr); \
+  NS_IMETHOD_(MozExternalRefCountType) AddRef(void); \
+  NS_IMETHOD_(MozExternalRefCountType) Release(void); \
+protected: \
+  nsAutoRefCnt mRefCnt; \
+  NS_DECL_OWNINGTHREAD \
+public:
+
+#define NS_DECL_THREADSAFE_ISUPPORTS \
+public: \
+  NS_IMETHOD QueryInterface(REFNSIID aIID, void** aInstancePtr); \
+  NS_IMETHOD_(MozExternalRefCountType) AddRef(void); \
+  NS_IMETHOD_(MozExternalRefCountType) Release(void); \
+protected: \
+  ::mozilla::ThreadSafeAutoRefCnt mRefCnt; \
+  NS_DECL_OWNINGTHREAD \
+public:
+
+#define NS_IMPL_ADDREF(_class) \
+NS_IMETHODIMP_(MozExternalRefCountType) _class::AddRef(void) \
+{ \
+  nsrefcnt count = ++mRefCnt; \
+  NS_LOG_ADDREF(this, count, #_class, sizeof(*this)); \
+  return count; \
+}
+
+#define NS_IMPL_RELEASE(_class) \
+NS_IMETHODIMP_(MozExternalRefCountType) _class::Release(void) \
+{ \
+  NS_PRECONDITION(0 != mRefCnt, "dup release"); \
+  nsrefcnt count = --mRefCnt; \
+  NS_LOG_RELEASE(this, count, #_class); \
+  if (count == 0) { \
+    mRefCnt = 1; /* stabilize */ \
+    delete (this); \
+    return 0; \
+  } \
+  return count; \
+}
+
+/*
+ * QueryInterface for a list of interfaces.  Gecko generates this with a
+ * chain of preprocessor macros; the stand-in walks the list with a variadic
+ * template instead.  The first interface listed supplies the nsISupports
+ * pointer, as in Gecko.
+ */
+namespace mozilla {
+namespace detail {
+
+template <class Class>
+inline nsresult
+QueryInterfaceList(Class*, REFNSIID, void**)
+{
+  return NS_NOINTERFACE;
+}
+
+template <class Class, class Interface, class... Rest>
+inline nsresult
+QueryInterfaceList(Class* aThis, REFNSIID aIID, void** aResult)
+{
+  if (aIID.Equals(NS_GET_TEMPLATE_IID(Interface))) {
+    Interface* foundInterface = static_cast<Interface*>(aThis);
+    foundInterface->AddRef();
+    *aResult = foundInterface;
+    return NS_OK;
+  }
+  return QueryInterfaceList<Class, Rest...>(aThis, aIID, aResult);
+}
+
+template <class Class, class First, class... Rest>
+inline nsresult
+QueryInterfaceTable(Class* aThis, REFNSIID aIID, void** aResult)
+{
+  NS_ASSERTION(aResult, "QueryInterface requires a non-NULL destination!");
+  if (aIID.Equals(NS_GET_IID(nsISupports))) {
+    nsISupports* foundInterface =
+      static_cast<nsISupports*>(static_cast<First*>(aThis));
+    foundInterface->AddRef();
+    *aResult = foundInterface;
+    return NS_OK;
+  }
+  nsresult rv = QueryInterfaceList<Class, First, Rest...>(aThis, aIID,
+                                                          aResult);
+  if (NS_FAILED(rv))
+    *aResult = nullptr;
+  return rv;
+}
+
+} // namespace detail
+} // namespace mozilla
+
+#define NS_IMPL_QUERY_INTERFACE(_class, ...) \
+NS_IMETHODIMP _class::QueryInterface(REFNSIID aIID, void** aInstancePtr) \
+{ \
+  return ::mozilla::detail::QueryInterfaceTable<_class, __VA_ARGS__>( \
+           this, aIID, aInstancePtr); \
+}
+
+#define NS_IMPL_ISUPPORTS(_class, ...) \
+  NS_IMPL_ADDREF(_class) \
+  NS_IMPL_RELEASE(_class) \
+  NS_IMPL_QUERY_INTERFACE(_class, __VA_ARGS__)
+
+#define NS_IMPL_ISUPPORTS_INHERITED(_class, _super, ...) \
+NS_IMETHODIMP_(MozExternalRefCountType) _class::AddRef(void) \
+{ \
+  return _super::AddRef(); \
+} \
+NS_IMETHODIMP_(MozExternalRefCountType) _class::Release(void) \
+{ \
+  return _super::Release(); \
+} \
+NS_IMETHODIMP _class::QueryInterface(REFNSIID aIID, void** aInstancePtr) \
+{ \
+  nsresult rv = ::mozilla::detail::QueryInterfaceList<_class, __VA_ARGS__>( \
+                  this, aIID, aInstancePtr); \
+  if (NS_FAILED(rv)) \
+    rv = _super::QueryInterface(aIID, aInstancePtr); \
+  return rv; \
+}
+
+#define NS_DECL_ISUPPORTS_INHERITED \
+public: \
+  NS_IMETHOD QueryInterface(REFNSIID aIID, void** aInstancePtr); \
+  NS_IMETHOD_(MozExternalRefCountType) AddRef(void); \
+  NS_IMETHOD_(MozExternalRefCountType) Release(void);
+
+#endif /* nsISupportsImpl_h__ */
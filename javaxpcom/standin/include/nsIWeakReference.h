@@ -0,0 +1,115 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef __gen_nsIWeakReference_h__
+#define __gen_nsIWeakReference_h__
+
+#include "nsISupports.h"
+#include "nsCOMPtr.h"
+
+#define NS_IWEAKREFERENCE_IID \
+  {0x9188bc85, 0xf92e, 0x11d2, \
+    { 0x81, 0xef, 0x00, 0x60, 0x08, 0x3a, 0x0b, 0xcf }}
+
+/**
+ * An instance of |nsIWeakReference| is a proxy object that cooperates with
+ * its referent to give clients a non-owning, non-dangling reference.
+ */
+class nsIWeakReference : public nsISupports
+{
+public:
+  NS_DECLARE_STATIC_IID_ACCESSOR(NS_IWEAKREFERENCE_IID)
+
+  /* void QueryReferent (in nsIIDRef uuid, [iid_is (uuid), retval] out nsQIResult result); */
+  NS_IMETHOD QueryReferent(const nsIID& uuid, void** result) = 0;
+
+  virtual size_t SizeOfOnlyThis(mozilla::MallocSizeOf aMallocSizeOf) const = 0;
+};
+
+NS_DEFINE_STATIC_IID_ACCESSOR(nsIWeakReference, NS_IWEAKREFERENCE_IID)
+
+#define NS_DECL_NSIWEAKREFERENCE \
+  NS_IMETHOD QueryReferent(const nsIID& uuid, void** result);
+
+#define NS_ISUPPORTSWEAKREFERENCE_IID \
+  {0x9188bc86, 0xf92e, 0x11d2, \
+    { 0x81, 0xef, 0x00, 0x60, 0x08, 0x3a, 0x0b, 0xcf }}
+
+/**
+ * |nsISupportsWeakReference| is a factory for weak references to the object
+ * that implements it.
+ */
+class nsISupportsWeakReference : public nsISupports
+{
+public:
+  NS_DECLARE_STATIC_IID_ACCESSOR(NS_ISUPPORTSWEAKREFERENCE_IID)
+
+  /* nsIWeakReference GetWeakReference (); */
+  NS_IMETHOD GetWeakReference(nsIWeakReference** _retval) = 0;
+};
+
+NS_DEFINE_STATIC_IID_ACCESSOR(nsISupportsWeakReference,
+                              NS_ISUPPORTSWEAKREFERENCE_IID)
+
+#define NS_DECL_NSISUPPORTSWEAKREFERENCE \
+  NS_IMETHOD GetWeakReference(nsIWeakReference** _retval);
+
+typedef nsCOMPtr<nsIWeakReference> nsWeakPtr;
+
+class nsQueryReferent : public nsCOMPtr_helper
+{
+public:
+  nsQueryReferent(nsIWeakReference* aWeakPtr, nsresult* aError)
+    : mWeakPtr(aWeakPtr), mErrorPtr(aError)
+  {
+  }
+
+  virtual nsresult NS_FASTCALL operator()(const nsIID& aIID,
+                                          void** aResult) const;
+
+private:
+  nsIWeakReference* mWeakPtr;
+  nsresult* mErrorPtr;
+};
+
+inline const nsQueryReferent
+do_QueryReferent(nsIWeakReference* aRawPtr, nsresult* aError = 0)
+{
+  return nsQueryReferent(aRawPtr, aError);
+}
+
+#endif /* __gen_nsIWeakReference_h__ */
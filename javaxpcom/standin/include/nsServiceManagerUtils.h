@@ -0,0 +1,79 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef nsServiceManagerUtils_h__
+#define nsServiceManagerUtils_h__
+
+#include "nsCOMPtr.h"
+
+class nsGetServiceByContractID : public nsCOMPtr_helper
+{
+public:
+  nsGetServiceByContractID(const char* aContractID, nsresult* aErrorPtr)
+    : mContractID(aContractID), mErrorPtr(aErrorPtr)
+  {
+  }
+
+  virtual nsresult NS_FASTCALL operator()(const nsIID& aIID,
+                                          void** aResult) const;
+
+private:
+  const char* mContractID;
+  nsresult* mErrorPtr;
+};
+
+inline const nsGetServiceByContractID
+do_GetService(const char* aContractID, nsresult* aError = 0)
+{
+  return nsGetServiceByContractID(aContractID, aError);
+}
+
+nsresult
+CallGetService(const char* aContractID, const nsIID& aIID, void** aResult);
+
+template <class DestinationType>
+inline nsresult
+CallGetService(const char* aContractID, DestinationType** aDestination)
+{
+  NS_PRECONDITION(aContractID, "null parameter");
+  NS_PRECONDITION(aDestination, "null parameter");
+
+  return CallGetService(aContractID, NS_GET_TEMPLATE_IID(DestinationType),
+                        reinterpret_cast<void**>(aDestination));
+}
+
+#endif /* nsServiceManagerUtils_h__ */
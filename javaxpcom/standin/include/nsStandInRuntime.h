@@ -0,0 +1,102 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef nsStandInRuntime_h__
+#define nsStandInRuntime_h__
+
+/*
+ * The pieces of the stand-in runtime that have no Gecko counterpart: how
+ * components and typelibs get into it, and how the fake main thread is
+ * started and stopped.
+ *
+ * The runtime starts empty apart from its own services (the interface info
+ * manager) and the test components in src/nsJXTestParams.cpp.  Embedders
+ * such as the benchmarks add theirs before calling NS_InitXPCOM2.
+ */
+
+#include "nscore.h"
+#include "nsID.h"
+
+class nsISupports;
+struct XPTHeader;
+
+/**
+ * Creates an instance of a component.  Aggregation is not supported, so
+ * aOuter is always null.
+ */
+typedef nsresult (*nsStandInConstructorProc)(nsISupports* aOuter,
+                                             REFNSIID aIID, void** aResult);
+
+struct nsStandInComponent
+{
+  const char* contractID;
+  nsCID cid;
+  nsStandInConstructorProc constructor;
+
+  /* Services are created once, on first use, and released at shutdown. */
+  bool isService;
+};
+
+/**
+ * Adds components to the runtime.  The table must stay valid until
+ * NS_ShutdownXPCOM.  A contract ID registered twice resolves to the later
+ * registration, as in Gecko.
+ */
+XPCOM_API(nsresult)
+NS_RegisterStandInComponents(const nsStandInComponent* aComponents,
+                             PRUint32 aCount);
+
+/**
+ * Adds a typelib to the interface info manager.  The typelib must stay
+ * valid for the life of the process; interface infos keep pointers into it.
+ */
+XPCOM_API(nsresult)
+NS_RegisterStandInTypelib(const XPTHeader* aHeader);
+
+/**
+ * Makes the calling thread the main thread and gives it an event queue.
+ * Called by NS_InitXPCOM2.
+ */
+nsresult NS_InitMainThread();
+
+/**
+ * Runs the events still queued on the main thread and drops it.  Called by
+ * NS_ShutdownXPCOM.
+ */
+void NS_ShutdownMainThread();
+
+#endif /* nsStandInRuntime_h__ */
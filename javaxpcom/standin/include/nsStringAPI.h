@@ -0,0 +1,520 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef nsStringAPI_h__
+#define nsStringAPI_h__
+
+/*
+ * The subset of Gecko's external string API that JavaXPCOM uses.
+ *
+ * nsAString and nsACString hold a pointer to their characters, a length and
+ * a set of flags.  Strings that own their buffer keep it null-terminated;
+ * dependent strings point at characters owned by someone else and copy them
+ * the first time they are modified.
+ */
+
+#include <string.h>
+#include "nscore.h"
+#include "nsXPCOM.h"
+#include "nsCRTGlue.h"
+
+class nsAString
+{
+public:
+  typedef PRUnichar char_type;
+  typedef nsAString self_type;
+  typedef PRUint32  size_type;
+  typedef PRUint32  index_type;
+
+  size_type Length() const { return mLength; }
+  bool IsEmpty() const { return mLength == 0; }
+
+  const char_type* BeginReading() const { return mData; }
+  const char_type* EndReading() const { return mData + mLength; }
+
+  /**
+   * Returns a writable pointer to the characters, copying them first if the
+   * string does not own its buffer.
+   */
+  char_type* BeginWriting();
+  char_type* EndWriting() { return BeginWriting() + mLength; }
+
+  /**
+   * Returns the characters.  They are only guaranteed to be null-terminated
+   * if the string owns its buffer or was created from a null-terminated
+   * string.
+   */
+  const char_type* get() const { return mData; }
+
+  char_type operator[](index_type aIndex) const { return mData[aIndex]; }
+  char_type CharAt(index_type aIndex) const { return mData[aIndex]; }
+  char_type First() const { return mData[0]; }
+  char_type Last() const { return mData[mLength - 1]; }
+
+  bool SetLength(size_type aNewLength);
+  void Truncate(size_type aNewLength = 0);
+
+  void Assign(const self_type& aString);
+  void Assign(const char_type* aData, size_type aLength = PR_UINT32_MAX);
+  void Assign(char_type aChar) { Assign(&aChar, 1); }
+  void AssignLiteral(const char* aData) { AssignASCII(aData); }
+  void AssignASCII(const char* aData, size_type aLength = PR_UINT32_MAX);
+
+  self_type& operator=(const self_type& aString)
+  {
+    Assign(aString);
+    return *this;
+  }
+  self_type& operator=(const char_type* aData)
+  {
+    Assign(aData);
+    return *this;
+  }
+  self_type& operator=(char_type aChar)
+  {
+    Assign(aChar);
+    return *this;
+  }
+
+  void Replace(index_type aCutStart, size_type aCutLength,
+               const char_type* aData, size_type aLength = PR_UINT32_MAX);
+  void Replace(index_type aCutStart, size_type aCutLength,
+               const self_type& aString)
+  {
+    Replace(aCutStart, aCutLength, aString.BeginReading(), aString.Length());
+  }
+
+  void Append(const self_type& aString)
+  {
+    Replace(mLength, 0, aString);
+  }
+  void Append(const char_type* aData, size_type aLength = PR_UINT32_MAX)
+  {
+    Replace(mLength, 0, aData, aLength);
+  }
+  void Append(char_type aChar) { Replace(mLength, 0, &aChar, 1); }
+  void AppendLiteral(const char* aData) { AppendASCII(aData); }
+  void AppendASCII(const char* aData, size_type aLength = PR_UINT32_MAX);
+
+  self_type& operator+=(const self_type& aString)
+  {
+    Append(aString);
+    return *this;
+  }
+  self_type& operator+=(const char_type* aData)
+  {
+    Append(aData);
+    return *this;
+  }
+  self_type& operator+=(char_type aChar)
+  {
+    Append(aChar);
+    return *this;
+  }
+
+  void Insert(char_type aChar, index_type aPos) { Replace(aPos, 0, &aChar, 1); }
+  void Insert(const self_type& aString, index_type aPos)
+  {
+    Replace(aPos, 0, aString);
+  }
+  void Cut(index_type aCutStart, size_type aCutLength)
+  {
+    Replace(aCutStart, aCutLength, nullptr, 0);
+  }
+
+  void SetCharAt(char_type aChar, index_type aIndex)
+  {
+    BeginWriting()[aIndex] = aChar;
+  }
+
+  bool Equals(const char_type* aOther) const;
+  bool Equals(const self_type& aOther) const;
+  bool EqualsLiteral(const char* aASCIIString) const;
+
+  bool operator==(const self_type& aOther) const { return Equals(aOther); }
+  bool operator!=(const self_type& aOther) const { return !Equals(aOther); }
+
+  PRInt32 FindChar(char_type aChar, index_type aOffset = 0) const;
+
+  bool IsVoid() const { return (mFlags & F_VOIDED) != 0; }
+  void SetIsVoid(bool aVal);
+
+protected:
+  enum
+  {
+    F_NONE       = 0,
+    F_TERMINATED = 1 << 0,  // mData[mLength] is a null character
+    F_VOIDED     = 1 << 1,  // the string is "void" (null)
+    F_OWNED      = 1 << 2   // mData was allocated by this string
+  };
+
+  nsAString();
+  nsAString(const char_type* aData, size_type aLength, PRUint32 aFlags);
+  ~nsAString();
+
+  char_type* mData;
+  size_type  mLength;
+  PRUint32   mFlags;
+
+private:
+  nsAString(const self_type& aString);
+};
+
+class nsACString
+{
+public:
+  typedef char      char_type;
+  typedef nsACString self_type;
+  typedef PRUint32  size_type;
+  typedef PRUint32  index_type;
+
+  size_type Length() const { return mLength; }
+  bool IsEmpty() const { return mLength == 0; }
+
+  const char_type* BeginReading() const { return mData; }
+  const char_type* EndReading() const { return mData + mLength; }
+
+  /**
+   * Returns a writable pointer to the characters, copying them first if the
+   * string does not own its buffer.
+   */
+  char_type* BeginWriting();
+  char_type* EndWriting() { return BeginWriting() + mLength; }
+
+  /**
+   * Returns the characters.  They are only guaranteed to be null-terminated
+   * if the string owns its buffer or was created from a null-terminated
+   * string.
+   */
+  const char_type* get() const { return mData; }
+
+  char_type operator[](index_type aIndex) const { return mData[aIndex]; }
+  char_type CharAt(index_type aIndex) const { return mData[aIndex]; }
+  char_type First() const { return mData[0]; }
+  char_type Last() const { return mData[mLength - 1]; }
+
+  bool SetLength(size_type aNewLength);
+  void Truncate(size_type aNewLength = 0);
+
+  void Assign(const self_type& aString);
+  void Assign(const char_type* aData, size_type aLength = PR_UINT32_MAX);
+  void Assign(char_type aChar) { Assign(&aChar, 1); }
+  void AssignLiteral(const char_type* aData) { Assign(aData); }
+  void AssignASCII(const char_type* aData, size_type aLength = PR_UINT32_MAX)
+  {
+    Assign(aData, aLength);
+  }
+
+  self_type& operator=(const self_type& aString)
+  {
+    Assign(aString);
+    return *this;
+  }
+  self_type& operator=(const char_type* aData)
+  {
+    Assign(aData);
+    return *this;
+  }
+  self_type& operator=(char_type aChar)
+  {
+    Assign(aChar);
+    return *this;
+  }
+
+  void Replace(index_type aCutStart, size_type aCutLength,
+               const char_type* aData, size_type aLength = PR_UINT32_MAX);
+  void Replace(index_type aCutStart, size_type aCutLength,
+               const self_type& aString)
+  {
+    Replace(aCutStart, aCutLength, aString.BeginReading(), aString.Length());
+  }
+
+  void Append(const self_type& aString)
+  {
+    Replace(mLength, 0, aString);
+  }
+  void Append(const char_type* aData, size_type aLength = PR_UINT32_MAX)
+  {
+    Replace(mLength, 0, aData, aLength);
+  }
+  void Append(char_type aChar) { Replace(mLength, 0, &aChar, 1); }
+  void AppendLiteral(const char_type* aData) { Append(aData); }
+  void AppendASCII(const char_type* aData, size_type aLength = PR_UINT32_MAX)
+  {
+    Append(aData, aLength);
+  }
+  void AppendInt(PRInt32 aInteger, PRInt32 aRadix = 10);
+
+  self_type& operator+=(const self_type& aString)
+  {
+    Append(aString);
+    return *this;
+  }
+  self_type& operator+=(const char_type* aData)
+  {
+    Append(aData);
+    return *this;
+  }
+  self_type& operator+=(char_type aChar)
+  {
+    Append(aChar);
+    return *this;
+  }
+
+  void Insert(char_type aChar, index_type aPos) { Replace(aPos, 0, &aChar, 1); }
+  void Insert(const char_type* aData, index_type aPos)
+  {
+    Replace(aPos, 0, aData);
+  }
+  void Insert(const self_type& aString, index_type aPos)
+  {
+    Replace(aPos, 0, aString);
+  }
+  void Cut(index_type aCutStart, size_type aCutLength)
+  {
+    Replace(aCutStart, aCutLength, nullptr, 0);
+  }
+
+  void SetCharAt(char_type aChar, index_type aIndex)
+  {
+    BeginWriting()[aIndex] = aChar;
+  }
+
+  bool Equals(const char_type* aOther) const;
+  bool Equals(const self_type& aOther) const;
+  bool EqualsLiteral(const char_type* aOther) const { return Equals(aOther); }
+
+  bool operator==(const self_type& aOther) const { return Equals(aOther); }
+  bool operator!=(const self_type& aOther) const { return !Equals(aOther); }
+
+  PRInt32 Find(const char_type* aStr, index_type aOffset = 0) const;
+  PRInt32 FindChar(char_type aChar, index_type aOffset = 0) const;
+
+  bool IsVoid() const { return (mFlags & F_VOIDED) != 0; }
+  void SetIsVoid(bool aVal);
+
+protected:
+  enum
+  {
+    F_NONE       = 0,
+    F_TERMINATED = 1 << 0,  // mData[mLength] is a null character
+    F_VOIDED     = 1 << 1,  // the string is "void" (null)
+    F_OWNED      = 1 << 2   // mData was allocated by this string
+  };
+
+  nsACString();
+  nsACString(const char_type* aData, size_type aLength, PRUint32 aFlags);
+  ~nsACString();
+
+  char_type* mData;
+  size_type  mLength;
+  PRUint32   mFlags;
+
+private:
+  nsACString(const self_type& aString);
+};
+
+/**
+ * Strings that own their buffer.
+ */
+class nsString : public nsAString
+{
+public:
+  typedef nsString self_type;
+
+  nsString() {}
+  nsString(const self_type& aString) : nsAString() { Assign(aString); }
+  explicit nsString(const nsAString& aString) : nsAString() { Assign(aString); }
+  explicit nsString(const char_type* aData, size_type aLength = PR_UINT32_MAX)
+    : nsAString()
+  {
+    Assign(aData, aLength);
+  }
+
+  self_type& operator=(const self_type& aString)
+  {
+    Assign(aString);
+    return *this;
+  }
+  self_type& operator=(const nsAString& aString)
+  {
+    Assign(aString);
+    return *this;
+  }
+  self_type& operator=(const char_type* aData)
+  {
+    Assign(aData);
+    return *this;
+  }
+};
+
+class nsCString : public nsACString
+{
+public:
+  typedef nsCString self_type;
+
+  nsCString() {}
+  nsCString(const self_type& aString) : nsACString() { Assign(aString); }
+  explicit nsCString(const nsACString& aString) : nsACString()
+  {
+    Assign(aString);
+  }
+  explicit nsCString(const char_type* aData, size_type aLength = PR_UINT32_MAX)
+    : nsACString()
+  {
+    Assign(aData, aLength);
+  }
+
+  self_type& operator=(const self_type& aString)
+  {
+    Assign(aString);
+    return *this;
+  }
+  self_type& operator=(const nsACString& aString)
+  {
+    Assign(aString);
+    return *this;
+  }
+  self_type& operator=(const char_type* aData)
+  {
+    Assign(aData);
+    return *this;
+  }
+};
+
+typedef nsString  nsAutoString;
+typedef nsCString nsAutoCString;
+
+/**
+ * Strings that refer to characters owned by someone else.  The characters
+ * must outlive the string, or be modified through it (which copies them).
+ */
+class nsDependentString : public nsString
+{
+public:
+  explicit nsDependentString(const char_type* aData,
+                             size_type aLength = PR_UINT32_MAX);
+};
+
+class nsDependentCString : public nsCString
+{
+public:
+  explicit nsDependentCString(const char_type* aData,
+                              size_type aLength = PR_UINT32_MAX);
+};
+
+class nsDependentSubstring : public nsAString
+{
+public:
+  nsDependentSubstring() {}
+  nsDependentSubstring(const char_type* aData, size_type aLength)
+    : nsAString(aData, aLength, F_NONE)
+  {
+  }
+  nsDependentSubstring(const char_type* aStart, const char_type* aEnd)
+    : nsAString(aStart, size_type(aEnd - aStart), F_NONE)
+  {
+  }
+};
+
+class nsDependentCSubstring : public nsACString
+{
+public:
+  nsDependentCSubstring() {}
+  nsDependentCSubstring(const char_type* aData, size_type aLength)
+    : nsACString(aData, aLength, F_NONE)
+  {
+  }
+  nsDependentCSubstring(const char_type* aStart, const char_type* aEnd)
+    : nsACString(aStart, size_type(aEnd - aStart), F_NONE)
+  {
+  }
+};
+
+#define NS_LITERAL_STRING(s)  nsDependentString(MOZ_UTF16(s), \
+                                                MOZ_ARRAY_LENGTH(s) - 1)
+#define NS_LITERAL_CSTRING(s) nsDependentCString(s, MOZ_ARRAY_LENGTH(s) - 1)
+
+/*
+ * Encoding conversions.
+ */
+
+class NS_ConvertUTF16toUTF8 : public nsCString
+{
+public:
+  explicit NS_ConvertUTF16toUTF8(const nsAString& aString);
+  explicit NS_ConvertUTF16toUTF8(const PRUnichar* aData,
+                                 PRUint32 aLength = PR_UINT32_MAX);
+};
+
+class NS_ConvertUTF8toUTF16 : public nsString
+{
+public:
+  explicit NS_ConvertUTF8toUTF16(const nsACString& aString);
+  explicit NS_ConvertUTF8toUTF16(const char* aData,
+                                 PRUint32 aLength = PR_UINT32_MAX);
+};
+
+class NS_ConvertASCIItoUTF16 : public nsString
+{
+public:
+  explicit NS_ConvertASCIItoUTF16(const nsACString& aString);
+  explicit NS_ConvertASCIItoUTF16(const char* aData,
+                                  PRUint32 aLength = PR_UINT32_MAX);
+};
+
+class NS_LossyConvertUTF16toASCII : public nsCString
+{
+public:
+  explicit NS_LossyConvertUTF16toASCII(const nsAString& aString);
+  explicit NS_LossyConvertUTF16toASCII(const PRUnichar* aData,
+                                       PRUint32 aLength = PR_UINT32_MAX);
+};
+
+void CopyUTF16toUTF8(const nsAString& aSource, nsACString& aDest);
+void CopyUTF8toUTF16(const nsACString& aSource, nsAString& aDest);
+void AppendUTF16toUTF8(const nsAString& aSource, nsACString& aDest);
+void AppendUTF8toUTF16(const nsACString& aSource, nsAString& aDest);
+
+/**
+ * Returns a null-terminated copy of the string allocated with NS_Alloc.
+ */
+PRUnichar* ToNewUnicode(const nsAString& aString);
+char* ToNewCString(const nsACString& aString);
+char* ToNewUTF8String(const nsAString& aString);
+
+#endif /* nsStringAPI_h__ */
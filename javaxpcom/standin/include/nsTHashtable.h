@@ -0,0 +1,214 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef nsTHashtable_h__
+#define nsTHashtable_h__
+
+/*
+ * A type-safe wrapper around PLDHashTable.  EntryType is one of the classes
+ * in nsHashKeys.h, or a class with the same members.
+ */
+
+#include <new>
+#include <string.h>
+#include "nscore.h"
+#include "pldhash.h"
+#include "nsDebug.h"
+
+template <class EntryType>
+class nsTHashtable
+{
+public:
+  typedef typename EntryType::KeyType KeyType;
+  typedef typename EntryType::KeyTypePointer KeyTypePointer;
+
+  nsTHashtable();
+  explicit nsTHashtable(PRUint32 aInitSize);
+  ~nsTHashtable();
+
+  PRUint32 Count() const { return mTable.entryCount; }
+
+  /**
+   * Returns the entry for aKey, or null if there is none.
+   */
+  EntryType* GetEntry(KeyType aKey) const
+  {
+    return static_cast<EntryType*>(
+      PL_DHashTableSearch(const_cast<PLDHashTable*>(&mTable),
+                          EntryType::KeyToPointer(aKey)));
+  }
+
+  bool Contains(KeyType aKey) const { return !!GetEntry(aKey); }
+
+  /**
+   * Returns the entry for aKey, adding one if there is none.  Returns null
+   * if out of memory.
+   */
+  EntryType* PutEntry(KeyType aKey)
+  {
+    return static_cast<EntryType*>(
+      PL_DHashTableAdd(&mTable, EntryType::KeyToPointer(aKey)));
+  }
+
+  void RemoveEntry(KeyType aKey)
+  {
+    PL_DHashTableRemove(&mTable, EntryType::KeyToPointer(aKey));
+  }
+
+  void RawRemoveEntry(EntryType* aEntry)
+  {
+    PL_DHashTableRawRemove(&mTable, aEntry);
+  }
+
+  typedef PLDHashOperator (*Enumerator)(EntryType* aEntry, void* userArg);
+
+  PRUint32 EnumerateEntries(Enumerator aEnumFunc, void* aUserArg)
+  {
+    s_EnumArgs args = { aEnumFunc, aUserArg };
+    return PL_DHashTableEnumerate(&mTable, s_EnumStub, &args);
+  }
+
+  void Clear()
+  {
+    PL_DHashTableEnumerate(&mTable, s_ClearEntryStub, nullptr);
+  }
+
+protected:
+  PLDHashTable mTable;
+
+  static PLDHashNumber s_HashKey(PLDHashTable* aTable, const void* aKey)
+  {
+    return EntryType::HashKey(reinterpret_cast<KeyTypePointer>(aKey));
+  }
+
+  static bool s_MatchEntry(PLDHashTable* aTable,
+                           const PLDHashEntryHdr* aEntry, const void* aKey)
+  {
+    return static_cast<const EntryType*>(aEntry)->KeyEquals(
+      reinterpret_cast<KeyTypePointer>(aKey));
+  }
+
+  static void s_CopyEntry(PLDHashTable* aTable, const PLDHashEntryHdr* aFrom,
+                          PLDHashEntryHdr* aTo)
+  {
+    EntryType* fromEntry =
+      const_cast<EntryType*>(static_cast<const EntryType*>(aFrom));
+    new (aTo) EntryType(*fromEntry);
+    fromEntry->~EntryType();
+  }
+
+  static void s_ClearEntry(PLDHashTable* aTable, PLDHashEntryHdr* aEntry)
+  {
+    static_cast<EntryType*>(aEntry)->~EntryType();
+  }
+
+  static bool s_InitEntry(PLDHashTable* aTable, PLDHashEntryHdr* aEntry,
+                          const void* aKey)
+  {
+    new (aEntry) EntryType(reinterpret_cast<KeyTypePointer>(aKey));
+    return true;
+  }
+
+  struct s_EnumArgs
+  {
+    Enumerator userFunc;
+    void* userArg;
+  };
+
+  static PLDHashOperator s_EnumStub(PLDHashTable* aTable,
+                                    PLDHashEntryHdr* aEntry,
+                                    PRUint32 aNumber, void* aArg)
+  {
+    s_EnumArgs* eargs = static_cast<s_EnumArgs*>(aArg);
+    return (eargs->userFunc)(static_cast<EntryType*>(aEntry), eargs->userArg);
+  }
+
+  static PLDHashOperator s_ClearEntryStub(PLDHashTable* aTable,
+                                          PLDHashEntryHdr* aEntry,
+                                          PRUint32 aNumber, void* aArg)
+  {
+    return PL_DHASH_REMOVE;
+  }
+
+private:
+  void Init(PRUint32 aInitSize);
+
+  nsTHashtable(nsTHashtable<EntryType>& aToCopy);
+  nsTHashtable<EntryType>& operator=(nsTHashtable<EntryType>& aToEqual);
+};
+
+template <class EntryType>
+nsTHashtable<EntryType>::nsTHashtable()
+{
+  Init(16);
+}
+
+template <class EntryType>
+nsTHashtable<EntryType>::nsTHashtable(PRUint32 aInitSize)
+{
+  Init(aInitSize);
+}
+
+template <class EntryType>
+nsTHashtable<EntryType>::~nsTHashtable()
+{
+  PL_DHashTableFinish(&mTable);
+}
+
+template <class EntryType>
+void
+nsTHashtable<EntryType>::Init(PRUint32 aInitSize)
+{
+  static const PLDHashTableOps sOps =
+  {
+    ::PL_DHashAllocTable,
+    ::PL_DHashFreeTable,
+    s_HashKey,
+    s_MatchEntry,
+    EntryType::ALLOW_MEMMOVE ? ::PL_DHashMoveEntryStub : s_CopyEntry,
+    s_ClearEntry,
+    ::PL_DHashFinalizeStub,
+    s_InitEntry
+  };
+
+  if (!PL_DHashTableInit(&mTable, &sOps, nullptr, sizeof(EntryType),
+                         aInitSize)) {
+    NS_RUNTIMEABORT("OOM");
+  }
+}
+
+#endif /* nsTHashtable_h__ */
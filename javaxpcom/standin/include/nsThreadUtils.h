@@ -0,0 +1,107 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef nsThreadUtils_h__
+#define nsThreadUtils_h__
+
+#include "nsIThread.h"
+#include "nsIRunnable.h"
+#include "nsCOMPtr.h"
+#include "nsServiceManagerUtils.h"
+#include "prthread.h"
+
+/**
+ * Returns the main thread, which is the thread that called NS_InitXPCOM2.
+ */
+nsresult NS_GetMainThread(nsIThread** aResult);
+
+/**
+ * Returns the calling thread if it is the main thread; other threads have no
+ * nsIThread in the stand-in.
+ */
+nsresult NS_GetCurrentThread(nsIThread** aResult);
+
+bool NS_IsMainThread();
+
+/**
+ * Queues an event on the main thread.  It runs the next time the main thread
+ * processes events.
+ */
+nsresult NS_DispatchToMainThread(nsIRunnable* aEvent,
+                                 PRUint32 aDispatchFlags =
+                                   nsIEventTarget::DISPATCH_NORMAL);
+
+nsresult NS_DispatchToCurrentThread(nsIRunnable* aEvent);
+
+/**
+ * Runs events queued on the calling thread until there are none left.
+ */
+nsresult NS_ProcessPendingEvents(nsIThread* aThread);
+
+inline already_AddRefed<nsIThread>
+do_GetMainThread()
+{
+  nsIThread* thread = nullptr;
+  NS_GetMainThread(&thread);
+  return already_AddRefed<nsIThread>(thread);
+}
+
+inline already_AddRefed<nsIThread>
+do_GetCurrentThread()
+{
+  nsIThread* thread = nullptr;
+  NS_GetCurrentThread(&thread);
+  return already_AddRefed<nsIThread>(thread);
+}
+
+/**
+ * Base class for events: implements nsISupports with a thread-safe reference
+ * count, since events are usually created on one thread and run on another.
+ */
+class nsRunnable : public nsIRunnable
+{
+public:
+  NS_DECL_THREADSAFE_ISUPPORTS
+  NS_DECL_NSIRUNNABLE
+
+  nsRunnable() {}
+
+protected:
+  virtual ~nsRunnable() {}
+};
+
+#endif /* nsThreadUtils_h__ */
@@ -0,0 +1,98 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef nsVoidArray_h___
+#define nsVoidArray_h___
+
+/*
+ * A growable array of void pointers, as in Gecko's nsVoidArray.
+ */
+
+#include "nscore.h"
+#include "nsDebug.h"
+
+class nsVoidArray
+{
+public:
+  nsVoidArray();
+  explicit nsVoidArray(PRInt32 aCount);
+  ~nsVoidArray();
+
+  PRInt32 Count() const { return mCount; }
+
+  void* ElementAt(PRInt32 aIndex) const
+  {
+    NS_ASSERTION(aIndex >= 0 && aIndex < mCount, "index out of range");
+    return mArray[aIndex];
+  }
+
+  void* SafeElementAt(PRInt32 aIndex) const
+  {
+    if (PRUint32(aIndex) >= PRUint32(mCount))
+      return nullptr;
+    return mArray[aIndex];
+  }
+
+  void* operator[](PRInt32 aIndex) const { return ElementAt(aIndex); }
+
+  PRInt32 IndexOf(void* aPossibleElement) const;
+
+  bool InsertElementAt(void* aElement, PRInt32 aIndex);
+  bool AppendElement(void* aElement)
+  {
+    return InsertElementAt(aElement, Count());
+  }
+
+  bool ReplaceElementAt(void* aElement, PRInt32 aIndex);
+
+  bool RemoveElement(void* aElement);
+  bool RemoveElementAt(PRInt32 aIndex);
+
+  void Clear() { mCount = 0; }
+
+private:
+  bool GrowArrayBy(PRInt32 aGrowBy);
+
+  void**  mArray;
+  PRInt32 mCount;
+  PRInt32 mCapacity;
+
+  nsVoidArray(const nsVoidArray& aOther);
+  nsVoidArray& operator=(const nsVoidArray& aOther);
+};
+
+#endif /* nsVoidArray_h___ */
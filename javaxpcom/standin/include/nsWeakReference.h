@@ -0,0 +1,113 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef nsWeakReference_h__
+#define nsWeakReference_h__
+
+#include "nsIWeakReference.h"
+
+class nsWeakReference;
+
+/**
+ * Mix-in that implements nsISupportsWeakReference.  The class that inherits
+ * it must answer nsISupportsWeakReference in its QueryInterface.
+ */
+class nsSupportsWeakReference : public nsISupportsWeakReference
+{
+public:
+  nsSupportsWeakReference() : mProxy(nullptr) {}
+
+  NS_DECL_NSISUPPORTSWEAKREFERENCE
+
+protected:
+  inline ~nsSupportsWeakReference();
+
+private:
+  friend class nsWeakReference;
+
+  // Called (only) by an |nsWeakReference| from _its_ dtor.
+  void NoticeProxyDestruction() { mProxy = nullptr; }
+
+  nsWeakReference* mProxy;
+
+protected:
+  inline void ClearWeakReferences();
+  bool HasWeakReferences() const { return mProxy != nullptr; }
+};
+
+class nsWeakReference final : public nsIWeakReference
+{
+public:
+  NS_DECL_ISUPPORTS
+  NS_DECL_NSIWEAKREFERENCE
+  virtual size_t SizeOfOnlyThis(mozilla::MallocSizeOf aMallocSizeOf) const;
+
+private:
+  friend class nsSupportsWeakReference;
+
+  nsWeakReference(nsSupportsWeakReference* aReferent)
+    : mReferent(aReferent)
+  {
+  }
+
+  ~nsWeakReference()
+  {
+    if (mReferent)
+      mReferent->NoticeProxyDestruction();
+  }
+
+  void NoticeReferentDestruction() { mReferent = nullptr; }
+
+  nsSupportsWeakReference* mReferent;
+};
+
+inline void
+nsSupportsWeakReference::ClearWeakReferences()
+{
+  if (mProxy) {
+    mProxy->NoticeReferentDestruction();
+    mProxy = nullptr;
+  }
+}
+
+inline
+nsSupportsWeakReference::~nsSupportsWeakReference()
+{
+  ClearWeakReferences();
+}
+
+#endif /* nsWeakReference_h__ */
@@ -0,0 +1,98 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef nscore_h___
+#define nscore_h___
+
+/*
+ * Basic XPCOM declarations.  See ../README.md.
+ */
+
+#include "prtypes.h"
+#include "mozilla/Char16.h"
+#include "mozilla/mozalloc.h"
+#include <new>
+
+typedef char16_t PRUnichar;
+
+#define nsnull nullptr
+
+class nsAString;
+class nsACString;
+
+typedef PRUint32 nsresult;
+typedef PRUint32 nsrefcnt;
+typedef nsrefcnt MozExternalRefCountType;
+
+#define NS_EXPORT         __attribute__((visibility("default")))
+#define NS_HIDDEN         __attribute__((visibility("hidden")))
+#define NS_EXTERNAL_VIS   NS_EXPORT
+#define NS_COM_GLUE
+#define NS_STDCALL
+#define NS_FASTCALL
+#define NS_FROZENCALL
+
+#define NS_IMETHOD_(type) virtual type NS_STDCALL
+#define NS_IMETHOD        NS_IMETHOD_(nsresult)
+#define NS_IMETHODIMP_(type) type NS_STDCALL
+#define NS_IMETHODIMP     NS_IMETHODIMP_(nsresult)
+#define NS_METHOD_(type)  type NS_STDCALL
+#define NS_METHOD         NS_METHOD_(nsresult)
+#define NS_CALLBACK_(_type, _name) _type (NS_STDCALL * _name)
+#define NS_CALLBACK(_name) NS_CALLBACK_(nsresult, _name)
+
+#define XPCOM_API(type)   extern "C" NS_EXPORT type
+#define NS_STRINGAPI(type) XPCOM_API(type)
+
+#define MOZ_STACK_CLASS
+#define MOZ_NONHEAP_CLASS
+#define MOZ_ARRAY_LENGTH(array) (sizeof(array) / sizeof((array)[0]))
+#define MOZ_LIKELY(x)     __builtin_expect(!!(x), 1)
+#define MOZ_UNLIKELY(x)   __builtin_expect(!!(x), 0)
+
+#define CPP_THROW_NEW     throw()
+
+#define NS_INT32_TO_PTR(x)  ((void*)(intptr_t)(x))
+#define NS_PTR_TO_INT32(x)  ((int32_t)(intptr_t)(x))
+
+#define NS_ARRAY_LENGTH(array_) MOZ_ARRAY_LENGTH(array_)
+
+namespace mozilla {
+typedef size_t (*MallocSizeOf)(const void* p);
+}
+
+#endif /* nscore_h___ */
@@ -0,0 +1,197 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef pldhash_h___
+#define pldhash_h___
+
+/*
+ * Double hashing, open addressing hash table of fixed-size entries, with the
+ * same interface as Gecko's PLDHashTable.  Entries start with a
+ * PLDHashEntryHdr whose keyHash is 0 for free entries, 1 for removed ones
+ * and at least 2 for live ones.
+ */
+
+#include "nscore.h"
+
+typedef PRUint32 PLDHashNumber;
+
+typedef struct PLDHashTable     PLDHashTable;
+typedef struct PLDHashEntryHdr  PLDHashEntryHdr;
+typedef struct PLDHashEntryStub PLDHashEntryStub;
+typedef struct PLDHashTableOps  PLDHashTableOps;
+
+struct PLDHashEntryHdr
+{
+  PLDHashNumber keyHash;
+};
+
+#define PL_DHASH_ENTRY_IS_FREE(entry)     ((entry)->keyHash == 0)
+#define PL_DHASH_ENTRY_IS_BUSY(entry)     (!PL_DHASH_ENTRY_IS_FREE(entry))
+#define PL_DHASH_ENTRY_IS_LIVE(entry)     ((entry)->keyHash >= 2)
+
+typedef enum PLDHashOperator {
+  PL_DHASH_LOOKUP = 0,
+  PL_DHASH_ADD = 1,
+  PL_DHASH_REMOVE = 2,
+  PL_DHASH_NEXT = 0,
+  PL_DHASH_STOP = 1
+} PLDHashOperator;
+
+typedef void* (*PLDHashAllocTable)(PLDHashTable* table, PRUint32 nbytes);
+typedef void (*PLDHashFreeTable)(PLDHashTable* table, void* ptr);
+typedef PLDHashNumber (*PLDHashHashKey)(PLDHashTable* table, const void* key);
+typedef bool (*PLDHashMatchEntry)(PLDHashTable* table,
+                                  const PLDHashEntryHdr* entry,
+                                  const void* key);
+typedef void (*PLDHashMoveEntry)(PLDHashTable* table,
+                                 const PLDHashEntryHdr* from,
+                                 PLDHashEntryHdr* to);
+typedef void (*PLDHashClearEntry)(PLDHashTable* table,
+                                  PLDHashEntryHdr* entry);
+typedef void (*PLDHashFinalize)(PLDHashTable* table);
+typedef bool (*PLDHashInitEntry)(PLDHashTable* table, PLDHashEntryHdr* entry,
+                                 const void* key);
+
+struct PLDHashTableOps
+{
+  PLDHashAllocTable   allocTable;
+  PLDHashFreeTable    freeTable;
+  PLDHashHashKey      hashKey;
+  PLDHashMatchEntry   matchEntry;
+  PLDHashMoveEntry    moveEntry;
+  PLDHashClearEntry   clearEntry;
+  PLDHashFinalize     finalize;
+  PLDHashInitEntry    initEntry;    /* optional */
+};
+
+struct PLDHashTable
+{
+  const PLDHashTableOps* ops;
+  void*                  data;          /* ops- and instance-specific data */
+  PRInt16                hashShift;     /* multiplicative hash shift */
+  PRUint32               entrySize;     /* number of bytes in an entry */
+  PRUint32               entryCount;    /* number of entries in table */
+  PRUint32               removedCount;  /* removed entry sentinels in table */
+  PRUint32               generation;    /* entry storage generation number */
+  char*                  entryStore;    /* entry storage */
+};
+
+/*
+ * Entries used by the stub ops start with a pointer-sized key.
+ */
+struct PLDHashEntryStub
+{
+  PLDHashEntryHdr hdr;
+  const void*     key;
+};
+
+PR_BEGIN_EXTERN_C
+
+void* PL_DHashAllocTable(PLDHashTable* table, PRUint32 nbytes);
+void PL_DHashFreeTable(PLDHashTable* table, void* ptr);
+PLDHashNumber PL_DHashStringKey(PLDHashTable* table, const void* key);
+PLDHashNumber PL_DHashVoidPtrKeyStub(PLDHashTable* table, const void* key);
+bool PL_DHashMatchEntryStub(PLDHashTable* table, const PLDHashEntryHdr* entry,
+                            const void* key);
+bool PL_DHashMatchStringKey(PLDHashTable* table, const PLDHashEntryHdr* entry,
+                            const void* key);
+void PL_DHashMoveEntryStub(PLDHashTable* table, const PLDHashEntryHdr* from,
+                           PLDHashEntryHdr* to);
+void PL_DHashClearEntryStub(PLDHashTable* table, PLDHashEntryHdr* entry);
+void PL_DHashFinalizeStub(PLDHashTable* table);
+
+/**
+ * Returns ops for tables whose entries start like PLDHashEntryStub and are
+ * keyed by pointer identity.
+ */
+const PLDHashTableOps* PL_DHashGetStubOps(void);
+
+PLDHashTable* PL_NewDHashTable(const PLDHashTableOps* ops, void* data,
+                               PRUint32 entrySize, PRUint32 capacity);
+void PL_DHashTableDestroy(PLDHashTable* table);
+
+bool PL_DHashTableInit(PLDHashTable* table, const PLDHashTableOps* ops,
+                       void* data, PRUint32 entrySize, PRUint32 capacity);
+void PL_DHashTableFinish(PLDHashTable* table);
+
+/**
+ * Looks up, adds or removes the entry for key.  A lookup returns an entry
+ * that is free if key is not in the table; an add returns the existing or a
+ * new entry (null on out of memory); a remove returns null.
+ */
+PLDHashEntryHdr* PL_DHashTableOperate(PLDHashTable* table, const void* key,
+                                      PLDHashOperator op);
+
+/**
+ * Convenience forms of PL_DHashTableOperate: Search returns null if key is
+ * not in the table.
+ */
+PLDHashEntryHdr* PL_DHashTableSearch(PLDHashTable* table, const void* key);
+PLDHashEntryHdr* PL_DHashTableAdd(PLDHashTable* table, const void* key);
+void PL_DHashTableRemove(PLDHashTable* table, const void* key);
+
+/**
+ * Removes an entry found by a lookup or enumeration without looking it up
+ * again.
+ */
+void PL_DHashTableRawRemove(PLDHashTable* table, PLDHashEntryHdr* entry);
+
+typedef PLDHashOperator (*PLDHashEnumerator)(PLDHashTable* table,
+                                             PLDHashEntryHdr* hdr,
+                                             PRUint32 number, void* arg);
+
+/**
+ * Calls etor for each live entry.  etor returns PL_DHASH_NEXT, or a
+ * combination of PL_DHASH_STOP and PL_DHASH_REMOVE.  Returns the number of
+ * entries visited.
+ */
+PRUint32 PL_DHashTableEnumerate(PLDHashTable* table, PLDHashEnumerator etor,
+                                void* arg);
+
+PR_END_EXTERN_C
+
+/*
+ * The bridge creates its tables without ops-specific data.
+ */
+inline PLDHashTable*
+PL_NewDHashTable(const PLDHashTableOps* ops, PRUint32 entrySize,
+                 PRUint32 capacity = 16)
+{
+  return PL_NewDHashTable(ops, nullptr, entrySize, capacity);
+}
+
+#endif /* pldhash_h___ */
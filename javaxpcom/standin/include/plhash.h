@@ -0,0 +1,126 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef plhash_h___
+#define plhash_h___
+
+/*
+ * API to portable hash table code, as in NSPR's plhash.h.
+ */
+
+#include "prtypes.h"
+
+PR_BEGIN_EXTERN_C
+
+typedef struct PLHashEntry  PLHashEntry;
+typedef struct PLHashTable  PLHashTable;
+typedef PRUint32 PLHashNumber;
+#define PL_HASH_BITS 32
+typedef PLHashNumber (PR_CALLBACK* PLHashFunction)(const void* key);
+typedef PRIntn (PR_CALLBACK* PLHashComparator)(const void* v1,
+                                               const void* v2);
+typedef PRIntn (PR_CALLBACK* PLHashEnumerator)(PLHashEntry* he, PRIntn i,
+                                               void* arg);
+
+/* Flag bits in PLHashEnumerator's return value */
+#define HT_ENUMERATE_NEXT       0       /* continue enumerating entries */
+#define HT_ENUMERATE_STOP       1       /* stop enumerating entries */
+#define HT_ENUMERATE_REMOVE     2       /* remove and free the current entry */
+#define HT_ENUMERATE_UNHASH     4       /* just unhash the current entry */
+
+typedef struct PLHashAllocOps {
+    void* (PR_CALLBACK* allocTable)(void* pool, PRSize size);
+    void (PR_CALLBACK* freeTable)(void* pool, void* item);
+    PLHashEntry* (PR_CALLBACK* allocEntry)(void* pool, const void* key);
+    void (PR_CALLBACK* freeEntry)(void* pool, PLHashEntry* he, PRUintn flag);
+} PLHashAllocOps;
+
+#define HT_FREE_VALUE   0               /* just free the entry's value */
+#define HT_FREE_ENTRY   1               /* free value and entire entry */
+
+struct PLHashEntry {
+    PLHashEntry*        next;           /* hash chain linkage */
+    PLHashNumber        keyHash;        /* key hash function result */
+    const void*         key;            /* ptr to opaque key */
+    void*               value;          /* ptr to opaque value */
+};
+
+struct PLHashTable {
+    PLHashEntry**       buckets;        /* vector of hash buckets */
+    PRUint32            nentries;       /* number of entries in table */
+    PRUint32            shift;          /* multiplicative hash shift */
+    PLHashFunction      keyHash;        /* key hash function */
+    PLHashComparator    keyCompare;     /* key comparison function */
+    PLHashComparator    valueCompare;   /* value comparison function */
+    const PLHashAllocOps* allocOps;     /* allocation operations */
+    void*               allocPriv;      /* allocation private data */
+};
+
+PLHashTable* PL_NewHashTable(PRUint32 numBuckets, PLHashFunction keyHash,
+                             PLHashComparator keyCompare,
+                             PLHashComparator valueCompare,
+                             const PLHashAllocOps* allocOps, void* allocPriv);
+
+void PL_HashTableDestroy(PLHashTable* ht);
+
+PLHashEntry* PL_HashTableAdd(PLHashTable* ht, const void* key, void* value);
+PRBool PL_HashTableRemove(PLHashTable* ht, const void* key);
+void* PL_HashTableLookup(PLHashTable* ht, const void* key);
+PRIntn PL_HashTableEnumerateEntries(PLHashTable* ht, PLHashEnumerator f,
+                                    void* arg);
+
+/* Low-level access, used to add an entry after a failed lookup. */
+PLHashEntry** PL_HashTableRawLookup(PLHashTable* ht, PLHashNumber keyHash,
+                                    const void* key);
+PLHashEntry* PL_HashTableRawAdd(PLHashTable* ht, PLHashEntry** hep,
+                                PLHashNumber keyHash, const void* key,
+                                void* value);
+void PL_HashTableRawRemove(PLHashTable* ht, PLHashEntry** hep,
+                           PLHashEntry* he);
+
+/* General-purpose C string hash function. */
+PLHashNumber PL_HashString(const void* key);
+
+/* Compare strings using strcmp(), return true if equal. */
+PRIntn PL_CompareStrings(const void* v1, const void* v2);
+
+/* Stub function just returns v1 == v2 */
+PRIntn PL_CompareValues(const void* v1, const void* v2);
+
+PR_END_EXTERN_C
+
+#endif /* plhash_h___ */
@@ -0,0 +1,57 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef pratom_h___
+#define pratom_h___
+
+#include "prtypes.h"
+
+PR_BEGIN_EXTERN_C
+
+PRInt32 PR_AtomicIncrement(PRInt32* val);
+PRInt32 PR_AtomicDecrement(PRInt32* val);
+PRInt32 PR_AtomicSet(PRInt32* val, PRInt32 newval);
+PRInt32 PR_AtomicAdd(PRInt32* ptr, PRInt32 val);
+
+#define PR_ATOMIC_INCREMENT(val)      PR_AtomicIncrement(val)
+#define PR_ATOMIC_DECREMENT(val)      PR_AtomicDecrement(val)
+#define PR_ATOMIC_SET(val, newval)    PR_AtomicSet(val, newval)
+#define PR_ATOMIC_ADD(ptr, val)       PR_AtomicAdd(ptr, val)
+
+PR_END_EXTERN_C
+
+#endif /* pratom_h___ */
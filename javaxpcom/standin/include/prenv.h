@@ -15,7 +15,7 @@
  *
  * The Initial Developer of the Original Code is
  * IBM Corporation.
- * Portions created by the Initial Developer are Copyright (C) 2004
+ * Portions created by the Initial Developer are Copyright (C) 2005
  * IBM Corporation. All Rights Reserved.
  *
  * Contributor(s):
@@ -35,19 +35,15 @@
  *
  * ***** END LICENSE BLOCK ***** */
 
-package org.mozilla.xpcom.internal;
+#ifndef prenv_h___
+#define prenv_h___
 
+#include "prtypes.h"
 
-/**
- * This interface forms the foundation of any XPCOMJavaProxy that is created.
- * It allows us to handle any JVM calls to <code>finalize</code> when the Proxy
- * is garbage collected.
- */
-public interface XPCOMJavaProxyBase {
+PR_BEGIN_EXTERN_C
 
-  /**
-   * @see java.lang.Object#finalize()
-   */
-  void finalize() throws Throwable;
+char* PR_GetEnv(const char* var);
 
-}
+PR_END_EXTERN_C
+
+#endif /* prenv_h___ */
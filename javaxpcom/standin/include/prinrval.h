@@ -0,0 +1,62 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef prinrval_h___
+#define prinrval_h___
+
+#include "prtypes.h"
+
+PR_BEGIN_EXTERN_C
+
+/* The stand-in counts intervals in microseconds. */
+typedef PRUint32 PRIntervalTime;
+
+#define PR_INTERVAL_NO_WAIT     0UL
+#define PR_INTERVAL_NO_TIMEOUT  0xffffffffUL
+
+PRIntervalTime PR_IntervalNow(void);
+PRUint32 PR_TicksPerSecond(void);
+PRIntervalTime PR_SecondsToInterval(PRUint32 seconds);
+PRIntervalTime PR_MillisecondsToInterval(PRUint32 milli);
+PRIntervalTime PR_MicrosecondsToInterval(PRUint32 micro);
+PRUint32 PR_IntervalToSeconds(PRIntervalTime ticks);
+PRUint32 PR_IntervalToMilliseconds(PRIntervalTime ticks);
+PRUint32 PR_IntervalToMicroseconds(PRIntervalTime ticks);
+
+PR_END_EXTERN_C
+
+#endif /* prinrval_h___ */
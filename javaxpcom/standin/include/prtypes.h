@@ -0,0 +1,109 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef prtypes_h___
+#define prtypes_h___
+
+/*
+ * Stand-in for the NSPR types used by JavaXPCOM.  See ../README.md.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+#define PR_BEGIN_EXTERN_C       extern "C" {
+#define PR_END_EXTERN_C         }
+#else
+#define PR_BEGIN_EXTERN_C
+#define PR_END_EXTERN_C
+#endif
+
+#define PR_EXTERN(__type)       extern __type
+#define PR_IMPLEMENT(__type)    __type
+#define PR_CALLBACK
+
+typedef int8_t    PRInt8;
+typedef uint8_t   PRUint8;
+typedef int16_t   PRInt16;
+typedef uint16_t  PRUint16;
+typedef int32_t   PRInt32;
+typedef uint32_t  PRUint32;
+typedef int64_t   PRInt64;
+typedef uint64_t  PRUint64;
+typedef int       PRIntn;
+typedef unsigned int PRUintn;
+typedef double    PRFloat64;
+typedef size_t    PRSize;
+typedef ptrdiff_t PRPtrdiff;
+typedef uintptr_t PRUptrdiff;
+typedef intptr_t  PRWord;
+typedef uintptr_t PRUword;
+
+/*
+ * XPCOM's boolean type (T_BOOL) is bool, and JavaXPCOM marshals booleans as
+ * PRBool, so the stand-in makes the two the same type.
+ */
+#ifdef __cplusplus
+typedef bool PRBool;
+#else
+typedef PRIntn PRBool;
+#endif
+#define PR_TRUE   1
+#define PR_FALSE  0
+
+typedef enum { PR_FAILURE = -1, PR_SUCCESS = 0 } PRStatus;
+
+#define PR_INT16_MAX    32767
+#define PR_UINT16_MAX   65535U
+#define PR_INT32_MAX    2147483647
+#define PR_UINT32_MAX   4294967295U
+
+#define PR_BIT(n)         ((PRUint32)1 << (n))
+#define PR_ROUNDUP(x, y)  ((((x) + ((y) - 1)) / (y)) * (y))
+#define PR_MIN(x, y)      ((x) < (y) ? (x) : (y))
+#define PR_MAX(x, y)      ((x) > (y) ? (x) : (y))
+#define PR_ABS(x)         ((x) < 0 ? -(x) : (x))
+
+#define PR_STATIC_ASSERT(condition) \
+    extern void pr_static_assert(int arg[(condition) ? 1 : -1])
+
+#define LL_INIT(hi, lo)   ((((PRInt64)(hi)) << 32) + (PRUint32)(lo))
+
+#define PR_ASSERT(expr)   ((void) 0)
+
+#endif /* prtypes_h___ */
@@ -0,0 +1,217 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef __xpt_struct_h__
+#define __xpt_struct_h__
+
+/*
+ * The in-memory form of XPCOM typelib data, laid out as in Gecko's
+ * xpt_struct.h.  The stand-in has no typelib loader; its tables are written
+ * by hand (see src/nsStandInTypelib.cpp).
+ */
+
+#include "nscore.h"
+#include "nsID.h"
+
+typedef struct XPTHeader XPTHeader;
+typedef struct XPTInterfaceDirectoryEntry XPTInterfaceDirectoryEntry;
+typedef struct XPTInterfaceDescriptor XPTInterfaceDescriptor;
+typedef struct XPTConstDescriptor XPTConstDescriptor;
+typedef struct XPTMethodDescriptor XPTMethodDescriptor;
+typedef struct XPTParamDescriptor XPTParamDescriptor;
+typedef struct XPTTypeDescriptor XPTTypeDescriptor;
+typedef struct XPTTypeDescriptorPrefix XPTTypeDescriptorPrefix;
+
+/*
+ * A typelib: its interface directory, sorted however the author likes.
+ * Gecko's header also records the file magic, version and data pool, which
+ * a hand-written table has no use for.
+ */
+struct XPTHeader {
+    PRUint16                    num_interfaces;
+    XPTInterfaceDirectoryEntry* interface_directory;
+};
+
+/*
+ * A directory entry names an interface.  Interface type descriptors refer
+ * to other interfaces by their 1-based index in the same directory.  An
+ * entry with a null interface_descriptor refers to an interface described
+ * by another typelib and is resolved by IID, as Gecko resolves interfaces
+ * across .xpt files.
+ */
+struct XPTInterfaceDirectoryEntry {
+    nsID                   iid;
+    const char*            name;
+    const char*            name_space;
+    XPTInterfaceDescriptor* interface_descriptor;
+};
+
+struct XPTInterfaceDescriptor {
+    PRUint16                parent_interface;   /* 1-based, 0 for none */
+    PRUint16                num_methods;
+    XPTMethodDescriptor*    method_descriptors;
+    PRUint16                num_constants;
+    XPTConstDescriptor*     const_descriptors;
+    PRUint8                 flags;
+
+    /* Element types of arrays, referred to by index from array types. */
+    XPTTypeDescriptor*      additional_types;
+    PRUint16                num_additional_types;
+};
+
+#define XPT_ID_SCRIPTABLE           0x80
+#define XPT_ID_FUNCTION             0x40
+#define XPT_ID_BUILTINCLASS         0x20
+#define XPT_ID_FLAGMASK             0xe0
+
+#define XPT_ID_IS_SCRIPTABLE(flags) (!!(flags & XPT_ID_SCRIPTABLE))
+#define XPT_ID_IS_FUNCTION(flags)   (!!(flags & XPT_ID_FUNCTION))
+
+struct XPTTypeDescriptorPrefix {
+    PRUint8 flags;
+};
+
+#define XPT_TDP_POINTER          0x80
+#define XPT_TDP_UNIQUE_POINTER   0x40
+#define XPT_TDP_REFERENCE        0x20
+#define XPT_TDP_FLAGMASK         0xe0
+#define XPT_TDP_TAGMASK          (~XPT_TDP_FLAGMASK)
+#define XPT_TDP_TAG(tdp)         ((tdp).flags & XPT_TDP_TAGMASK)
+
+#define XPT_TDP_IS_POINTER(flags)        (flags & XPT_TDP_POINTER)
+#define XPT_TDP_IS_UNIQUE_POINTER(flags) (flags & XPT_TDP_UNIQUE_POINTER)
+#define XPT_TDP_IS_REFERENCE(flags)      (flags & XPT_TDP_REFERENCE)
+
+enum XPTTypeDescriptorTags {
+    TD_INT8              = 0,
+    TD_INT16             = 1,
+    TD_INT32             = 2,
+    TD_INT64             = 3,
+    TD_UINT8             = 4,
+    TD_UINT16            = 5,
+    TD_UINT32            = 6,
+    TD_UINT64            = 7,
+    TD_FLOAT             = 8,
+    TD_DOUBLE            = 9,
+    TD_BOOL              = 10,
+    TD_CHAR              = 11,
+    TD_WCHAR             = 12,
+    TD_VOID              = 13,
+    TD_PNSIID            = 14,
+    TD_DOMSTRING         = 15,
+    TD_PSTRING           = 16,
+    TD_PWSTRING          = 17,
+    TD_INTERFACE_TYPE    = 18,
+    TD_INTERFACE_IS_TYPE = 19,
+    TD_ARRAY             = 20,
+    TD_PSTRING_SIZE_IS   = 21,
+    TD_PWSTRING_SIZE_IS  = 22,
+    TD_UTF8STRING        = 23,
+    TD_CSTRING           = 24,
+    TD_ASTRING           = 25,
+    TD_JSVAL             = 26
+};
+
+struct XPTTypeDescriptor {
+    XPTTypeDescriptorPrefix prefix;
+    PRUint8 argnum;                 /* used for iid_is and size_is */
+    PRUint8 argnum2;                /* used for length_is */
+    union {
+        PRUint16 iface;             /* used for TD_INTERFACE_TYPE */
+        PRUint16 additional_type;   /* used for TD_ARRAY */
+    } type;
+};
+
+#define XPT_COPY_TYPE(to, from)                                               \
+  (to).prefix.flags = (from).prefix.flags;                                    \
+  (to).argnum = (from).argnum;                                                \
+  (to).argnum2 = (from).argnum2;                                              \
+  (to).type.additional_type = (from).type.additional_type;
+
+/* Constants are not supported by the stand-in. */
+struct XPTConstDescriptor {
+    const char*       name;
+    XPTTypeDescriptor type;
+    PRInt64           value;
+};
+
+struct XPTParamDescriptor {
+    PRUint8           flags;
+    XPTTypeDescriptor type;
+};
+
+#define XPT_PD_IN       0x80
+#define XPT_PD_OUT      0x40
+#define XPT_PD_RETVAL   0x20
+#define XPT_PD_SHARED   0x10
+#define XPT_PD_DIPPER   0x08
+#define XPT_PD_OPTIONAL 0x04
+#define XPT_PD_FLAGMASK 0xfc
+
+#define XPT_PD_IS_IN(flags)       (flags & XPT_PD_IN)
+#define XPT_PD_IS_OUT(flags)      (flags & XPT_PD_OUT)
+#define XPT_PD_IS_RETVAL(flags)   (flags & XPT_PD_RETVAL)
+#define XPT_PD_IS_SHARED(flags)   (flags & XPT_PD_SHARED)
+#define XPT_PD_IS_DIPPER(flags)   (flags & XPT_PD_DIPPER)
+#define XPT_PD_IS_OPTIONAL(flags) (flags & XPT_PD_OPTIONAL)
+
+struct XPTMethodDescriptor {
+    const char*         name;
+    XPTParamDescriptor* params;
+    XPTParamDescriptor* result;
+    PRUint8             flags;
+    PRUint8             num_args;
+};
+
+#define XPT_MD_GETTER   0x80
+#define XPT_MD_SETTER   0x40
+#define XPT_MD_NOTXPCOM 0x20
+#define XPT_MD_CTOR     0x10
+#define XPT_MD_HIDDEN   0x08
+#define XPT_MD_OPT_ARGC 0x04
+#define XPT_MD_CONTEXT  0x02
+#define XPT_MD_FLAGMASK 0xfe
+
+#define XPT_MD_IS_GETTER(flags)     (flags & XPT_MD_GETTER)
+#define XPT_MD_IS_SETTER(flags)     (flags & XPT_MD_SETTER)
+#define XPT_MD_IS_NOTXPCOM(flags)   (flags & XPT_MD_NOTXPCOM)
+#define XPT_MD_IS_CTOR(flags)       (flags & XPT_MD_CTOR)
+#define XPT_MD_IS_HIDDEN(flags)     (flags & XPT_MD_HIDDEN)
+#define XPT_MD_WANTS_OPT_ARGC(flags) (flags & XPT_MD_OPT_ARGC)
+#define XPT_MD_WANTS_CONTEXT(flags) (flags & XPT_MD_CONTEXT)
+
+#endif /* __xpt_struct_h__ */
@@ -0,0 +1,216 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef xptcall_h___
+#define xptcall_h___
+
+/*
+ * Calling XPCOM methods by index and implementing interfaces whose layout
+ * is only known at runtime, as in Gecko's xptcall.h.
+ *
+ * The stand-in implements both directions in plain C++, without per-
+ * platform assembly (see src/xptcall.cpp); only the x86-64 and AArch64
+ * ELF calling conventions are supported.
+ */
+
+#include "nscore.h"
+#include "nsISupports.h"
+#include "xptinfo.h"
+
+struct nsXPTCMiniVariant
+{
+    union
+    {
+        PRInt8    i8;
+        PRInt16   i16;
+        PRInt32   i32;
+        PRInt64   i64;
+        PRUint8   u8;
+        PRUint16  u16;
+        PRUint32  u32;
+        PRUint64  u64;
+        float     f;
+        double    d;
+        bool      b;
+        char      c;
+        PRUnichar wc;
+        void*     p;
+    } val;
+};
+
+struct nsXPTCVariant : public nsXPTCMiniVariant
+{
+    // No ctors or dtors so that we can use arrays of these on the stack
+    // with no penalty.
+
+    // inherits 'val' here
+    void*     ptr;
+    nsXPTType type;
+    PRUint8   flags;
+
+    enum
+    {
+        //
+        // Bitflag definitions
+        //
+
+        // Indicates that ptr (above, and distinct from val.p) is the value
+        // that should be passed on the stack.
+        //
+        // In theory, ptr could point anywhere. But in practice it always
+        // points to &val. So this flag is used to pass 'val' by reference,
+        // letting us avoid the extra allocation we would incur if we were to
+        // use val.p.
+        //
+        // Various parts of XPConnect assume that ptr==&val, so we enforce it
+        // explicitly with SetIndirect() and IsIndirect().
+        //
+        // Since ptr always points to &val, the semantics of this flag are
+        // kind of dumb, since the ptr field is unnecessary. But changing
+        // them would require changing dozens of assembly files, so they're
+        // likely to stay the way they are.
+        PTR_IS_DATA    = 0x1,
+
+        // Indicates that the value we hold requires some sort of cleanup
+        // (memory deallocation, interface release, JS::Value unrooting,
+        // etc). The precise cleanup that is performed depends on the 'type'
+        // field above. If the value is an array, this flag applies to both
+        // the array itself and its elements.
+        VAL_NEEDS_CLEANUP = 0x2
+    };
+
+    void ClearFlags()         {flags = 0;}
+    void SetIndirect()        {ptr = &val; flags |= PTR_IS_DATA;}
+    void SetValNeedsCleanup() {flags |= VAL_NEEDS_CLEANUP;}
+
+    bool IsIndirect()         const  {return 0 != (flags & PTR_IS_DATA);}
+    bool DoesValNeedCleanup() const  {return 0 != (flags & VAL_NEEDS_CLEANUP);}
+
+    // Internal use only. Use IsIndirect() instead.
+    bool IsPtrData()       const  {return 0 != (flags & PTR_IS_DATA);}
+
+    void Init(const nsXPTCMiniVariant& mv, const nsXPTType& t, PRUint8 f)
+    {
+        type = t;
+        flags = f;
+
+        if(f & PTR_IS_DATA)
+        {
+            ptr = mv.val.p;
+            val.p = nullptr;
+        }
+        else
+        {
+            ptr = nullptr;
+            val.p = nullptr; // make sure 'val.p' is always initialized
+            switch(t.TagPart()) {
+              case nsXPTType::T_I8:                val.i8  = mv.val.i8;  break;
+              case nsXPTType::T_I16:               val.i16 = mv.val.i16; break;
+              case nsXPTType::T_I32:               val.i32 = mv.val.i32; break;
+              case nsXPTType::T_I64:               val.i64 = mv.val.i64; break;
+              case nsXPTType::T_U8:                val.u8  = mv.val.u8;  break;
+              case nsXPTType::T_U16:               val.u16 = mv.val.u16; break;
+              case nsXPTType::T_U32:               val.u32 = mv.val.u32; break;
+              case nsXPTType::T_U64:               val.u64 = mv.val.u64; break;
+              case nsXPTType::T_FLOAT:             val.f   = mv.val.f;   break;
+              case nsXPTType::T_DOUBLE:            val.d   = mv.val.d;   break;
+              case nsXPTType::T_BOOL:              val.b   = mv.val.b;   break;
+              case nsXPTType::T_CHAR:              val.c   = mv.val.c;   break;
+              case nsXPTType::T_WCHAR:             val.wc  = mv.val.wc;  break;
+              case nsXPTType::T_VOID:              /* fall through */
+              case nsXPTType::T_IID:               /* fall through */
+              case nsXPTType::T_DOMSTRING:         /* fall through */
+              case nsXPTType::T_CHAR_STR:          /* fall through */
+              case nsXPTType::T_WCHAR_STR:         /* fall through */
+              case nsXPTType::T_INTERFACE:         /* fall through */
+              case nsXPTType::T_INTERFACE_IS:      /* fall through */
+              case nsXPTType::T_ARRAY:             /* fall through */
+              case nsXPTType::T_PSTRING_SIZE_IS:   /* fall through */
+              case nsXPTType::T_PWSTRING_SIZE_IS:  /* fall through */
+              case nsXPTType::T_UTF8STRING:        /* fall through */
+              case nsXPTType::T_CSTRING:           /* fall through */
+              default:                             val.p   = mv.val.p;   break;
+            }
+        }
+    }
+};
+
+class nsIXPTCProxy : public nsISupports
+{
+public:
+    NS_IMETHOD CallMethod(PRUint16 aMethodIndex,
+                          const XPTMethodDescriptor *aInfo,
+                          nsXPTCMiniVariant *aParams) = 0;
+};
+
+/**
+ * This is a typedef to avoid confusion between the canonical
+ * nsISupports* that provides object identity and an interface pointer
+ * for inheriting interfaces that aren't known at compile-time.
+ */
+typedef nsISupports nsISomeInterface;
+
+/**
+ * Get a proxy object to implement the specified interface.
+ *
+ * @param aIID    The IID of the interface to implement.
+ * @param aOuter  An object to receive method calls from the proxy object.
+ *                The stub forwards QueryInterface/AddRef/Release to the
+ *                outer object. The proxy object does not hold a reference to
+ *                the outer object; it is the caller's responsibility to
+ *                ensure that this pointer remains valid until the stub has
+ *                been destroyed.
+ * @param aStub   Out parameter for the new proxy object. The object is
+ *                not addrefed. The object never destroys itself. It must be
+ *                explicitly destroyed by calling
+ *                NS_DestroyXPTCallStub when it is no longer needed.
+ */
+XPCOM_API(nsresult)
+NS_GetXPTCallStub(REFNSIID aIID, nsIXPTCProxy* aOuter,
+                  nsISomeInterface* *aStub);
+
+/**
+ * Destroys an XPTCall stub previously created with NS_GetXPTCallStub.
+ */
+XPCOM_API(void)
+NS_DestroyXPTCallStub(nsISomeInterface* aStub);
+
+XPCOM_API(nsresult)
+NS_InvokeByIndex(nsISupports* that, PRUint32 methodIndex,
+                 PRUint32 paramCount, nsXPTCVariant* params);
+
+#endif /* xptcall_h___ */
@@ -0,0 +1,215 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef xptiinfo_h___
+#define xptiinfo_h___
+
+/*
+ * C++ wrappers for the typelib structures, as in Gecko's xptinfo.h.
+ */
+
+#include "nscore.h"
+#include "xpt_struct.h"
+
+class nsXPTType : public XPTTypeDescriptorPrefix
+{
+public:
+    nsXPTType() {}
+    nsXPTType(const XPTTypeDescriptorPrefix& prefix)
+        {*(XPTTypeDescriptorPrefix*)this = prefix;}
+
+    nsXPTType(const PRUint8& prefix)
+        {*(PRUint8*)this = prefix;}
+
+    nsXPTType& operator=(PRUint8 val)
+        {flags = val; return *this;}
+
+    nsXPTType& operator=(const nsXPTType& other)
+        {flags = other.flags; return *this;}
+
+    operator PRUint8() const
+        {return flags;}
+
+    // 'Arithmetic' here roughly means that the value is self-contained and
+    // doesn't depend on anything else in paramter list, or on any state.
+    bool IsArithmetic() const
+        {return flags <= T_WCHAR;}
+
+    // We used to abuse 'pointer' flag bit in typelib format quite extensively.
+    // We've gotten rid of most of the cases, but there's still a fair amount
+    // of refactoring to be done in XPCWrappedJSClass before we can safely stop
+    // asking about this. In the mean time, we've got a temporary version of
+    // IsPointer() that should be equivalent to what's in the typelib.
+    bool deprecated_IsPointer() const
+        {return !IsArithmetic() && TagPart() != T_JSVAL;}
+
+    bool IsPointer() const
+        {return 0 != (XPT_TDP_IS_POINTER(flags));}
+
+    bool IsReference() const
+        {return 0 != (XPT_TDP_IS_REFERENCE(flags));}
+
+    bool IsInterfacePointer() const
+        {  switch (TagPart()) {
+             default:
+               return false;
+             case T_INTERFACE:
+             case T_INTERFACE_IS:
+               return true;
+           }
+        }
+
+    bool IsArray() const
+        {return TagPart() == T_ARRAY;}
+
+    // 'Dependent' means that params of this type are dependent upon other
+    // params. e.g. an T_INTERFACE_IS is dependent upon some other param at
+    // runtime to say what the interface type of this param really is.
+    bool IsDependent() const
+        {  switch (TagPart()) {
+             default:
+               return false;
+             case T_INTERFACE_IS:
+             case TD_ARRAY:
+             case T_PSTRING_SIZE_IS:
+             case T_PWSTRING_SIZE_IS:
+               return true;
+           }
+        }
+
+    PRUint8 TagPart() const
+        {return (PRUint8) (flags & XPT_TDP_TAGMASK);}
+
+    enum
+    {
+        T_I8                = TD_INT8             ,
+        T_I16               = TD_INT16            ,
+        T_I32               = TD_INT32            ,
+        T_I64               = TD_INT64            ,
+        T_U8                = TD_UINT8            ,
+        T_U16               = TD_UINT16           ,
+        T_U32               = TD_UINT32           ,
+        T_U64               = TD_UINT64           ,
+        T_FLOAT             = TD_FLOAT            ,
+        T_DOUBLE            = TD_DOUBLE           ,
+        T_BOOL              = TD_BOOL             ,
+        T_CHAR              = TD_CHAR             ,
+        T_WCHAR             = TD_WCHAR            ,
+        T_VOID              = TD_VOID             ,
+        T_IID               = TD_PNSIID           ,
+        T_DOMSTRING         = TD_DOMSTRING        ,
+        T_CHAR_STR          = TD_PSTRING          ,
+        T_WCHAR_STR         = TD_PWSTRING         ,
+        T_INTERFACE         = TD_INTERFACE_TYPE   ,
+        T_INTERFACE_IS      = TD_INTERFACE_IS_TYPE,
+        T_ARRAY             = TD_ARRAY            ,
+        T_PSTRING_SIZE_IS   = TD_PSTRING_SIZE_IS  ,
+        T_PWSTRING_SIZE_IS  = TD_PWSTRING_SIZE_IS ,
+        T_UTF8STRING        = TD_UTF8STRING       ,
+        T_CSTRING           = TD_CSTRING          ,
+        T_ASTRING           = TD_ASTRING          ,
+        T_JSVAL             = TD_JSVAL
+    };
+};
+
+class nsXPTParamInfo : public XPTParamDescriptor
+{
+public:
+    nsXPTParamInfo(const XPTParamDescriptor& desc)
+        {*(XPTParamDescriptor*)this = desc;}
+
+    bool IsIn()  const    {return 0 != (XPT_PD_IS_IN(flags));}
+    bool IsOut() const    {return 0 != (XPT_PD_IS_OUT(flags));}
+    bool IsRetval() const {return 0 != (XPT_PD_IS_RETVAL(flags));}
+    bool IsShared() const {return 0 != (XPT_PD_IS_SHARED(flags));}
+    bool IsDipper() const {return 0 != (XPT_PD_IS_DIPPER(flags));}
+    bool IsOptional() const {return 0 != (XPT_PD_IS_OPTIONAL(flags));}
+    const nsXPTType GetType() const {return type.prefix;}
+
+    // Whether this parameter is passed indirectly on the stack. This mainly
+    // applies to out/inout params, but we use it unconditionally for certain
+    // types.
+    bool IsIndirect() const {return IsOut() ||
+                               GetType().TagPart() == nsXPTType::T_JSVAL;}
+
+private:
+    nsXPTParamInfo();  // no implementation
+};
+
+class nsXPTMethodInfo : public XPTMethodDescriptor
+{
+public:
+    nsXPTMethodInfo(const XPTMethodDescriptor& desc)
+        {*(XPTMethodDescriptor*)this = desc;}
+
+    bool IsGetter()      const {return 0 != (XPT_MD_IS_GETTER(flags) );}
+    bool IsSetter()      const {return 0 != (XPT_MD_IS_SETTER(flags) );}
+    bool IsNotXPCOM()    const {return 0 != (XPT_MD_IS_NOTXPCOM(flags));}
+    bool IsConstructor() const {return 0 != (XPT_MD_IS_CTOR(flags)   );}
+    bool IsHidden()      const {return 0 != (XPT_MD_IS_HIDDEN(flags) );}
+    bool WantsOptArgc()  const {return 0 != (XPT_MD_WANTS_OPT_ARGC(flags));}
+    bool WantsContext()  const {return 0 != (XPT_MD_WANTS_CONTEXT(flags));}
+    const char* GetName()  const {return name;}
+    PRUint8 GetParamCount()  const {return num_args;}
+    const nsXPTParamInfo GetParam(PRUint8 idx) const
+        {
+            NS_PRECONDITION(idx < GetParamCount(),"bad arg");
+            return params[idx];
+        }
+    const nsXPTParamInfo GetResult() const
+        {return *result;}
+private:
+    nsXPTMethodInfo();  // no implementation
+};
+
+class nsXPTConstant : public XPTConstDescriptor
+{
+public:
+    nsXPTConstant(const XPTConstDescriptor& desc)
+        {*(XPTConstDescriptor*)this = desc;}
+
+    const char* GetName() const
+        {return name;}
+
+    const nsXPTType GetType() const
+        {return type.prefix;}
+
+private:
+    nsXPTConstant();  // no implementation
+};
+
+#endif /* xptiinfo_h___ */
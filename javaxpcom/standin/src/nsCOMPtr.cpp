@@ -0,0 +1,74 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * Out-of-line nsCOMPtr helpers.
+ */
+
+#include "nsCOMPtr.h"
+#include "nsIWeakReference.h"
+
+nsresult NS_FASTCALL
+nsQueryInterface::operator()(const nsIID& aIID, void** aAnswer) const
+{
+  nsresult status;
+  if (mRawPtr) {
+    status = mRawPtr->QueryInterface(aIID, aAnswer);
+  } else {
+    status = NS_ERROR_NULL_POINTER;
+  }
+
+  if (mErrorPtr)
+    *mErrorPtr = status;
+  return status;
+}
+
+nsresult NS_FASTCALL
+nsQueryReferent::operator()(const nsIID& aIID, void** aAnswer) const
+{
+  nsresult status;
+  if (mWeakPtr) {
+    if (NS_FAILED(status = mWeakPtr->QueryReferent(aIID, aAnswer)))
+      *aAnswer = 0;
+  } else {
+    status = NS_ERROR_NULL_POINTER;
+  }
+
+  if (mErrorPtr)
+    *mErrorPtr = status;
+  return status;
+}
@@ -0,0 +1,93 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * Null-terminated string helpers.
+ */
+
+#include "nsCRTGlue.h"
+#include "nsXPCOM.h"
+
+#include <string.h>
+
+PRUint32
+NS_strlen(const PRUnichar* aString)
+{
+  const PRUnichar* end;
+  for (end = aString; *end; ++end) {
+    // empty loop
+  }
+  return PRUint32(end - aString);
+}
+
+int
+NS_strcmp(const PRUnichar* a, const PRUnichar* b)
+{
+  while (*b) {
+    int r = *a - *b;
+    if (r)
+      return r;
+    ++a;
+    ++b;
+  }
+  return *a != '\0';
+}
+
+PRUnichar*
+NS_strdup(const PRUnichar* aString)
+{
+  PRUint32 len = NS_strlen(aString);
+  PRUnichar* str =
+    static_cast<PRUnichar*>(NS_Alloc((len + 1) * sizeof(PRUnichar)));
+  if (str) {
+    memcpy(str, aString, len * sizeof(PRUnichar));
+    str[len] = '\0';
+  }
+  return str;
+}
+
+char*
+NS_strdup(const char* aString)
+{
+  PRUint32 len = PRUint32(strlen(aString));
+  char* str = static_cast<char*>(NS_Alloc(len + 1));
+  if (str) {
+    memcpy(str, aString, len);
+    str[len] = '\0';
+  }
+  return str;
+}
@@ -0,0 +1,562 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * The stand-in's component manager, which is also its service manager and
+ * component registrar, and XPCOM startup and shutdown.
+ *
+ * Components come from tables of nsStandInComponent rather than from
+ * modules on disk.  The contract ID table outlives any one XPCOM session,
+ * so embedders can register components before NS_InitXPCOM2; services are
+ * released at NS_ShutdownXPCOM.
+ */
+
+#include "nsStandInRuntime.h"
+#include "nsIServiceManager.h"
+#include "nsIComponentManager.h"
+#include "nsIComponentRegistrar.h"
+#include "nsIInterfaceInfoManager.h"
+#include "nsServiceManagerUtils.h"
+#include "nsThreadUtils.h"
+#include "nsXULAppAPI.h"
+#include "nsCOMPtr.h"
+#include "nsDebug.h"
+#include "xptiprivate.h"
+#include "nsJXTestParams.h"
+#include "pldhash.h"
+#include "prinit.h"
+#include "prlock.h"
+
+struct ContractTableEntry : public PLDHashEntryHdr
+{
+  const char* key;                        // the contract ID
+  const nsStandInComponent* component;
+  nsISupports* service;                   // owning; null until first use
+};
+
+static PLDHashTable gContractTable;
+static PRLock* gContractLock = nullptr;
+static PRCallOnceType gContractTableOnce;
+
+static PRStatus
+InitContractTable()
+{
+  static const PLDHashTableOps ops = {
+    PL_DHashAllocTable,
+    PL_DHashFreeTable,
+    PL_DHashStringKey,
+    PL_DHashMatchStringKey,
+    PL_DHashMoveEntryStub,
+    PL_DHashClearEntryStub,
+    PL_DHashFinalizeStub,
+    nullptr
+  };
+
+  gContractLock = PR_NewLock();
+  if (!gContractLock ||
+      !PL_DHashTableInit(&gContractTable, &ops, nullptr,
+                         sizeof(ContractTableEntry), 32)) {
+    return PR_FAILURE;
+  }
+  return PR_SUCCESS;
+}
+
+nsresult
+NS_RegisterStandInComponents(const nsStandInComponent* aComponents,
+                             PRUint32 aCount)
+{
+  NS_ENSURE_ARG_POINTER(aComponents);
+  if (PR_CallOnce(&gContractTableOnce, InitContractTable) != PR_SUCCESS)
+    return NS_ERROR_OUT_OF_MEMORY;
+
+  nsresult rv = NS_OK;
+  PR_Lock(gContractLock);
+  for (PRUint32 i = 0; i < aCount; ++i) {
+    const nsStandInComponent* component = &aComponents[i];
+    ContractTableEntry* entry = static_cast<ContractTableEntry*>
+      (PL_DHashTableAdd(&gContractTable, component->contractID));
+    if (!entry) {
+      rv = NS_ERROR_OUT_OF_MEMORY;
+      break;
+    }
+
+    // A later registration replaces an earlier one.
+    NS_IF_RELEASE(entry->service);
+    entry->key = component->contractID;
+    entry->component = component;
+  }
+  PR_Unlock(gContractLock);
+  return rv;
+}
+
+static nsresult
+InterfaceInfoManagerConstructor(nsISupports* aOuter, REFNSIID aIID,
+                                void** aResult)
+{
+  NS_ENSURE_NO_AGGREGATION(aOuter);
+  return xptiInterfaceInfoManager::GetSingleton()->
+    QueryInterface(aIID, aResult);
+}
+
+// {13bef784-f8e0-4f96-85c1-09f9ef4f9a19}
+#define NS_INTERFACEINFOMANAGER_CID \
+  { 0x13bef784, 0xf8e0, 0x4f96, \
+    { 0x85, 0xc1, 0x09, 0xf9, 0xef, 0x4f, 0x9a, 0x19 } }
+
+static const nsStandInComponent kBuiltinComponents[] = {
+  { NS_INTERFACEINFOMANAGER_SERVICE_CONTRACTID, NS_INTERFACEINFOMANAGER_CID,
+    InterfaceInfoManagerConstructor, true }
+};
+
+/***************************************************************************/
+
+class nsComponentManagerImpl final : public nsIComponentManager,
+                                     public nsIServiceManager,
+                                     public nsIComponentRegistrar
+{
+public:
+  NS_DECL_THREADSAFE_ISUPPORTS
+  NS_DECL_NSICOMPONENTMANAGER
+  NS_DECL_NSISERVICEMANAGER
+  NS_DECL_NSICOMPONENTREGISTRAR
+
+  nsComponentManagerImpl() {}
+
+  /* Releases every service that has been created. */
+  void ReleaseServices();
+
+private:
+  ~nsComponentManagerImpl() {}
+
+  /**
+   * Finds the component for a contract ID, or for a CID if aContractID is
+   * null.  The entry is only valid while gContractLock is held.
+   */
+  ContractTableEntry* GetEntryLocked(const char* aContractID,
+                                     const nsCID* aCID);
+
+  nsresult GetServiceInternal(const char* aContractID, const nsCID* aCID,
+                              const nsIID& aIID, void** aResult);
+  nsresult CreateInstanceInternal(const char* aContractID, const nsCID* aCID,
+                                  nsISupports* aDelegate, const nsIID& aIID,
+                                  void** aResult);
+  nsresult IsServiceInstantiatedInternal(const char* aContractID,
+                                         const nsCID* aCID,
+                                         const nsIID& aIID, bool* aResult);
+
+  static PLDHashOperator FindCIDEnumerator(PLDHashTable* aTable,
+                                           PLDHashEntryHdr* aHdr,
+                                           PRUint32 aNumber, void* aArg);
+  static PLDHashOperator ReleaseServiceEnumerator(PLDHashTable* aTable,
+                                                  PLDHashEntryHdr* aHdr,
+                                                  PRUint32 aNumber,
+                                                  void* aArg);
+};
+
+static nsComponentManagerImpl* gComponentManager = nullptr;
+
+NS_IMPL_ADDREF(nsComponentManagerImpl)
+NS_IMPL_RELEASE(nsComponentManagerImpl)
+NS_IMPL_QUERY_INTERFACE(nsComponentManagerImpl, nsIComponentManager,
+                        nsIServiceManager, nsIComponentRegistrar)
+
+struct FindCIDClosure
+{
+  const nsCID* cid;
+  ContractTableEntry* result;
+};
+
+PLDHashOperator
+nsComponentManagerImpl::FindCIDEnumerator(PLDHashTable* aTable,
+                                          PLDHashEntryHdr* aHdr,
+                                          PRUint32 aNumber, void* aArg)
+{
+  ContractTableEntry* entry = static_cast<ContractTableEntry*>(aHdr);
+  FindCIDClosure* closure = static_cast<FindCIDClosure*>(aArg);
+  if (entry->component->cid.Equals(*closure->cid)) {
+    closure->result = entry;
+    return PL_DHASH_STOP;
+  }
+  return PL_DHASH_NEXT;
+}
+
+ContractTableEntry*
+nsComponentManagerImpl::GetEntryLocked(const char* aContractID,
+                                       const nsCID* aCID)
+{
+  if (aContractID) {
+    return static_cast<ContractTableEntry*>
+      (PL_DHashTableSearch(&gContractTable, aContractID));
+  }
+
+  // There are only a handful of components, so CIDs are looked up by
+  // walking the table rather than keeping a second one.
+  FindCIDClosure closure = { aCID, nullptr };
+  PL_DHashTableEnumerate(&gContractTable, FindCIDEnumerator, &closure);
+  return closure.result;
+}
+
+nsresult
+nsComponentManagerImpl::CreateInstanceInternal(const char* aContractID,
+                                               const nsCID* aCID,
+                                               nsISupports* aDelegate,
+                                               const nsIID& aIID,
+                                               void** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  *aResult = nullptr;
+
+  PR_Lock(gContractLock);
+  ContractTableEntry* entry = GetEntryLocked(aContractID, aCID);
+  nsStandInConstructorProc constructor =
+    entry ? entry->component->constructor : nullptr;
+  PR_Unlock(gContractLock);
+
+  if (!constructor)
+    return NS_ERROR_FACTORY_NOT_REGISTERED;
+
+  return constructor(aDelegate, aIID, aResult);
+}
+
+nsresult
+nsComponentManagerImpl::GetServiceInternal(const char* aContractID,
+                                           const nsCID* aCID,
+                                           const nsIID& aIID,
+                                           void** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  *aResult = nullptr;
+
+  PR_Lock(gContractLock);
+  ContractTableEntry* entry = GetEntryLocked(aContractID, aCID);
+  if (!entry) {
+    PR_Unlock(gContractLock);
+    return NS_ERROR_FACTORY_NOT_REGISTERED;
+  }
+
+  nsCOMPtr<nsISupports> service = entry->service;
+  const nsStandInComponent* component = entry->component;
+  PR_Unlock(gContractLock);
+
+  if (!service) {
+    // Create the service outside the lock, since its constructor may well
+    // ask for other services.  If another thread wins the race, use its
+    // instance instead.
+    nsresult rv = component->constructor(nullptr, NS_GET_IID(nsISupports),
+                                         getter_AddRefs(service));
+    NS_ENSURE_SUCCESS(rv, rv);
+
+    PR_Lock(gContractLock);
+    entry = GetEntryLocked(aContractID, aCID);
+    if (entry && entry->component == component) {
+      if (entry->service)
+        service = entry->service;
+      else
+        NS_ADDREF(entry->service = service);
+    }
+    PR_Unlock(gContractLock);
+  }
+
+  return service->QueryInterface(aIID, aResult);
+}
+
+nsresult
+nsComponentManagerImpl::IsServiceInstantiatedInternal(const char* aContractID,
+                                                      const nsCID* aCID,
+                                                      const nsIID& aIID,
+                                                      bool* aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  *aResult = false;
+
+  PR_Lock(gContractLock);
+  ContractTableEntry* entry = GetEntryLocked(aContractID, aCID);
+  nsCOMPtr<nsISupports> service = entry ? entry->service : nullptr;
+  PR_Unlock(gContractLock);
+
+  if (!service)
+    return NS_ERROR_SERVICE_NOT_AVAILABLE;
+
+  nsCOMPtr<nsISupports> iface;
+  *aResult = NS_SUCCEEDED(service->QueryInterface(aIID,
+                                                  getter_AddRefs(iface)));
+  return NS_OK;
+}
+
+PLDHashOperator
+nsComponentManagerImpl::ReleaseServiceEnumerator(PLDHashTable* aTable,
+                                                 PLDHashEntryHdr* aHdr,
+                                                 PRUint32 aNumber,
+                                                 void* aArg)
+{
+  ContractTableEntry* entry = static_cast<ContractTableEntry*>(aHdr);
+  nsISupports** services = static_cast<nsISupports**>(aArg);
+  if (entry->service) {
+    services[aNumber] = entry->service;
+    entry->service = nullptr;
+  }
+  return PL_DHASH_NEXT;
+}
+
+void
+nsComponentManagerImpl::ReleaseServices()
+{
+  // Collect the services under the lock and release them after it, since
+  // a service's destructor may ask for other services.
+  PR_Lock(gContractLock);
+  PRUint32 count = gContractTable.entryCount;
+  nsISupports** services = new nsISupports*[count];
+  memset(services, 0, count * sizeof(nsISupports*));
+  PL_DHashTableEnumerate(&gContractTable, ReleaseServiceEnumerator,
+                         services);
+  PR_Unlock(gContractLock);
+
+  for (PRUint32 i = 0; i < count; ++i)
+    NS_IF_RELEASE(services[i]);
+  delete [] services;
+}
+
+NS_IMETHODIMP
+nsComponentManagerImpl::GetClassObject(const nsCID& aClass,
+                                       const nsIID& aIID, void** aResult)
+{
+  // The stand-in's components have constructors, not factories.
+  NS_ENSURE_ARG_POINTER(aResult);
+  *aResult = nullptr;
+  return NS_ERROR_NOT_IMPLEMENTED;
+}
+
+NS_IMETHODIMP
+nsComponentManagerImpl::GetClassObjectByContractID(const char* aContractID,
+                                                   const nsIID& aIID,
+                                                   void** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  *aResult = nullptr;
+  return NS_ERROR_NOT_IMPLEMENTED;
+}
+
+NS_IMETHODIMP
+nsComponentManagerImpl::CreateInstance(const nsCID& aClass,
+                                       nsISupports* aDelegate,
+                                       const nsIID& aIID, void** aResult)
+{
+  return CreateInstanceInternal(nullptr, &aClass, aDelegate, aIID, aResult);
+}
+
+NS_IMETHODIMP
+nsComponentManagerImpl::CreateInstanceByContractID(const char* aContractID,
+                                                   nsISupports* aDelegate,
+                                                   const nsIID& aIID,
+                                                   void** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aContractID);
+  return CreateInstanceInternal(aContractID, nullptr, aDelegate, aIID,
+                                aResult);
+}
+
+NS_IMETHODIMP
+nsComponentManagerImpl::GetService(const nsCID& aClass, const nsIID& aIID,
+                                   void** aResult)
+{
+  return GetServiceInternal(nullptr, &aClass, aIID, aResult);
+}
+
+NS_IMETHODIMP
+nsComponentManagerImpl::GetServiceByContractID(const char* aContractID,
+                                               const nsIID& aIID,
+                                               void** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aContractID);
+  return GetServiceInternal(aContractID, nullptr, aIID, aResult);
+}
+
+NS_IMETHODIMP
+nsComponentManagerImpl::IsServiceInstantiated(const nsCID& aClass,
+                                              const nsIID& aIID,
+                                              bool* aResult)
+{
+  return IsServiceInstantiatedInternal(nullptr, &aClass, aIID, aResult);
+}
+
+NS_IMETHODIMP
+nsComponentManagerImpl::IsServiceInstantiatedByContractID(
+    const char* aContractID, const nsIID& aIID, bool* aResult)
+{
+  NS_ENSURE_ARG_POINTER(aContractID);
+  return IsServiceInstantiatedInternal(aContractID, nullptr, aIID, aResult);
+}
+
+NS_IMETHODIMP
+nsComponentManagerImpl::IsContractIDRegistered(const char* aContractID,
+                                               bool* aResult)
+{
+  NS_ENSURE_ARG_POINTER(aContractID);
+  NS_ENSURE_ARG_POINTER(aResult);
+
+  PR_Lock(gContractLock);
+  *aResult = GetEntryLocked(aContractID, nullptr) != nullptr;
+  PR_Unlock(gContractLock);
+  return NS_OK;
+}
+
+/***************************************************************************/
+
+nsresult NS_FASTCALL
+nsGetServiceByContractID::operator()(const nsIID& aIID, void** aResult) const
+{
+  nsresult status = CallGetService(mContractID, aIID, aResult);
+  if (NS_FAILED(status))
+    *aResult = nullptr;
+
+  if (mErrorPtr)
+    *mErrorPtr = status;
+  return status;
+}
+
+nsresult
+CallGetService(const char* aContractID, const nsIID& aIID, void** aResult)
+{
+  NS_ENSURE_TRUE(gComponentManager, NS_ERROR_NOT_INITIALIZED);
+  return gComponentManager->GetServiceByContractID(aContractID, aIID,
+                                                   aResult);
+}
+
+/*
+ * The binary directory and the application's directory service provider
+ * are accepted but unused: the stand-in loads nothing from disk and has no
+ * directory service.
+ */
+nsresult
+NS_InitXPCOM2(nsIServiceManager** aResult,
+              nsIFile* aBinDirectory,
+              nsIDirectoryServiceProvider* aAppFileLocationProvider)
+{
+  NS_ENSURE_TRUE(!gComponentManager, NS_ERROR_ALREADY_INITIALIZED);
+
+  nsresult rv = NS_InitMainThread();
+  NS_ENSURE_SUCCESS(rv, rv);
+
+  rv = NS_RegisterStandInComponents(kBuiltinComponents,
+                                    sizeof(kBuiltinComponents) /
+                                    sizeof(kBuiltinComponents[0]));
+  if (NS_SUCCEEDED(rv))
+    rv = NS_RegisterStandInComponents(kJXTestComponents,
+                                      kJXTestComponentCount);
+  if (NS_FAILED(rv)) {
+    NS_ShutdownMainThread();
+    return rv;
+  }
+
+  gComponentManager = new nsComponentManagerImpl();
+  NS_ADDREF(gComponentManager);
+
+  if (aResult)
+    NS_ADDREF(*aResult = gComponentManager);
+  return NS_OK;
+}
+
+nsresult
+NS_ShutdownXPCOM(nsIServiceManager* aServMgr)
+{
+  NS_ENSURE_TRUE(gComponentManager, NS_ERROR_NOT_INITIALIZED);
+  NS_ENSURE_TRUE(NS_IsMainThread(), NS_ERROR_NOT_SAME_THREAD);
+
+  // Let pending events run while services are still around.
+  NS_ProcessPendingEvents(nullptr);
+
+  NS_IF_RELEASE(aServMgr);
+  gComponentManager->ReleaseServices();
+  NS_ShutdownMainThread();
+  NS_RELEASE(gComponentManager);
+  return NS_OK;
+}
+
+nsresult
+NS_GetServiceManager(nsIServiceManager** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  NS_ENSURE_TRUE(gComponentManager, NS_ERROR_NOT_INITIALIZED);
+  NS_ADDREF(*aResult = gComponentManager);
+  return NS_OK;
+}
+
+nsresult
+NS_GetComponentManager(nsIComponentManager** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  NS_ENSURE_TRUE(gComponentManager, NS_ERROR_NOT_INITIALIZED);
+  NS_ADDREF(*aResult = gComponentManager);
+  return NS_OK;
+}
+
+nsresult
+NS_GetComponentRegistrar(nsIComponentRegistrar** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  NS_ENSURE_TRUE(gComponentManager, NS_ERROR_NOT_INITIALIZED);
+  NS_ADDREF(*aResult = gComponentManager);
+  return NS_OK;
+}
+
+/*
+ * There is no libxul to embed; use Mozilla.initXPCOM instead of
+ * Mozilla.initEmbedding.
+ */
+
+nsresult
+XRE_InitEmbedding2(nsIFile* aLibXULDirectory, nsIFile* aAppDirectory,
+                   nsIDirectoryServiceProvider* aAppDirProvider)
+{
+  return NS_ERROR_NOT_IMPLEMENTED;
+}
+
+void
+XRE_TermEmbedding()
+{
+}
+
+nsresult
+XRE_LockProfileDirectory(nsIFile* aDirectory, nsISupports** aLockObj)
+{
+  return NS_ERROR_NOT_IMPLEMENTED;
+}
+
+void
+XRE_NotifyProfile()
+{
+}
@@ -0,0 +1,89 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * NS_DebugBreak: prints assertions and warnings to stderr and aborts on
+ * NS_DEBUG_ABORT.  XPCOM_DEBUG_BREAK=abort makes assertions fatal too, as
+ * in Gecko; other values are ignored.
+ */
+
+#include "nsDebug.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void
+NS_DebugBreak(PRUint32 aSeverity, const char* aStr, const char* aExpr,
+              const char* aFile, PRInt32 aLine)
+{
+  const char* sevString;
+  switch (aSeverity) {
+    case NS_DEBUG_WARNING:
+      sevString = "WARNING";
+      break;
+    case NS_DEBUG_BREAK:
+      sevString = "###!!! BREAK";
+      break;
+    case NS_DEBUG_ABORT:
+      sevString = "###!!! ABORT";
+      break;
+    default:
+      aSeverity = NS_DEBUG_ASSERTION;
+      sevString = "###!!! ASSERTION";
+      break;
+  }
+
+  fprintf(stderr, "[%d] %s: %s", 0, sevString, aStr ? aStr : "");
+  if (aExpr)
+    fprintf(stderr, ": '%s'", aExpr);
+  if (aFile)
+    fprintf(stderr, ", file %s", aFile);
+  if (aLine != -1)
+    fprintf(stderr, ", line %d", aLine);
+  fputc('\n', stderr);
+  fflush(stderr);
+
+  if (aSeverity == NS_DEBUG_ABORT)
+    abort();
+
+  if (aSeverity == NS_DEBUG_ASSERTION) {
+    const char* breakMode = getenv("XPCOM_DEBUG_BREAK");
+    if (breakMode && strcmp(breakMode, "abort") == 0)
+      abort();
+  }
+}
@@ -0,0 +1,121 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * nsID parsing and formatting.
+ */
+
+#include "nsID.h"
+#include "nsMemory.h"
+#include "prprf.h"
+
+static const char gIDFormat[] =
+  "{%08x-%04x-%04x-%02x%02x-%02x%02x%02x%02x%02x%02x}";
+
+/*
+ * Parses 'aDigits' hex digits from 'aStr' into 'aResult', advancing 'aStr'.
+ */
+static bool
+ParseHex(const char*& aStr, PRUint32 aDigits, PRUint32* aResult)
+{
+  PRUint32 value = 0;
+  for (PRUint32 i = 0; i < aDigits; i++, aStr++) {
+    char c = *aStr;
+    value <<= 4;
+    if (c >= '0' && c <= '9')
+      value |= PRUint32(c - '0');
+    else if (c >= 'a' && c <= 'f')
+      value |= PRUint32(c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F')
+      value |= PRUint32(c - 'A' + 10);
+    else
+      return false;
+  }
+  *aResult = value;
+  return true;
+}
+
+bool
+nsID::Parse(const char* aIDStr)
+{
+  if (!aIDStr)
+    return false;
+
+  bool expectBrace = (*aIDStr == '{');
+  if (expectBrace)
+    aIDStr++;
+
+  PRUint32 value;
+  if (!ParseHex(aIDStr, 8, &value) || *aIDStr++ != '-')
+    return false;
+  m0 = value;
+  if (!ParseHex(aIDStr, 4, &value) || *aIDStr++ != '-')
+    return false;
+  m1 = PRUint16(value);
+  if (!ParseHex(aIDStr, 4, &value) || *aIDStr++ != '-')
+    return false;
+  m2 = PRUint16(value);
+
+  for (int i = 0; i < 8; i++) {
+    if (!ParseHex(aIDStr, 2, &value))
+      return false;
+    m3[i] = PRUint8(value);
+    if (i == 1 && *aIDStr++ != '-')
+      return false;
+  }
+
+  return expectBrace ? *aIDStr == '}' : true;
+}
+
+char*
+nsID::ToString() const
+{
+  char* res = static_cast<char*>(NS_Alloc(NSID_LENGTH));
+  if (res)
+    ToProvidedString(*reinterpret_cast<char(*)[NSID_LENGTH]>(res));
+  return res;
+}
+
+void
+nsID::ToProvidedString(char (&aDest)[NSID_LENGTH]) const
+{
+  PR_snprintf(aDest, NSID_LENGTH, gIDFormat,
+              m0, PRUint32(m1), PRUint32(m2),
+              PRUint32(m3[0]), PRUint32(m3[1]), PRUint32(m3[2]),
+              PRUint32(m3[3]), PRUint32(m3[4]), PRUint32(m3[5]),
+              PRUint32(m3[6]), PRUint32(m3[7]));
+}
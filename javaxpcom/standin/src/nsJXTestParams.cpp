@@ -0,0 +1,260 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * The native side of TestParams.java.
+ *
+ * runTests() plays the part of nsJXTestParams.js: it calls back into the
+ * Java object it is given.  The JS component drives nsIEcho and the
+ * xpconnect test interfaces, which the stand-in does not describe, so this
+ * one drives nsIJXTestArrayParams instead, and does nothing for objects
+ * that do not implement it.
+ */
+
+#include "nsJXTestParams.h"
+#include "nsIJXTestParams.h"
+#include "nsIJXTestArrayParams.h"
+#include "nsCOMPtr.h"
+#include "nsMemory.h"
+#include "nsCRTGlue.h"
+
+#include <string.h>
+
+class nsJXTestParams final : public nsIJXTestParams,
+                             public nsIJXTestArrayParams
+{
+public:
+  NS_DECL_ISUPPORTS
+  NS_DECL_NSIJXTESTPARAMS
+  NS_DECL_NSIJXTESTARRAYPARAMS
+
+  nsJXTestParams() {}
+
+private:
+  ~nsJXTestParams() {}
+};
+
+NS_IMPL_ISUPPORTS(nsJXTestParams, nsIJXTestParams, nsIJXTestArrayParams)
+
+/* Copies aCount elements of aSrc into a new NS_Alloc'd buffer. */
+template <class T>
+static nsresult
+CloneArray(const T* aSrc, PRUint32 aCount, T** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  if (aCount == 0) {
+    *aResult = nullptr;
+    return NS_OK;
+  }
+  NS_ENSURE_ARG_POINTER(aSrc);
+
+  *aResult = static_cast<T*>(nsMemory::Clone(aSrc, aCount * sizeof(T)));
+  return *aResult ? NS_OK : NS_ERROR_OUT_OF_MEMORY;
+}
+
+/* Like CloneArray, and adds a terminating null. */
+template <class T>
+static nsresult
+CloneSizedString(const T* aSrc, PRUint32 aCount, T** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  if (!aSrc) {
+    *aResult = nullptr;
+    return NS_OK;
+  }
+
+  T* str = static_cast<T*>(NS_Alloc((aCount + 1) * sizeof(T)));
+  NS_ENSURE_TRUE(str, NS_ERROR_OUT_OF_MEMORY);
+  memcpy(str, aSrc, aCount * sizeof(T));
+  str[aCount] = T(0);
+  *aResult = str;
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+nsJXTestParams::MultiplyEachItemInIntegerArray2(PRInt32 aVal,
+                                                PRInt32** aValueArray,
+                                                PRUint32 aCount)
+{
+  NS_ENSURE_ARG_POINTER(aValueArray);
+  for (PRUint32 i = 0; i < aCount; i++)
+    (*aValueArray)[i] *= aVal;
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+nsJXTestParams::CopyIntArray(PRInt32* aSrcArray, PRUint32 aCount,
+                             PRInt32** aDstArray)
+{
+  return CloneArray(aSrcArray, aCount, aDstArray);
+}
+
+NS_IMETHODIMP
+nsJXTestParams::ReturnIntArray(PRInt32* aSrcArray, PRUint32 aCount,
+                               PRInt32** aResult)
+{
+  return CloneArray(aSrcArray, aCount, aResult);
+}
+
+NS_IMETHODIMP
+nsJXTestParams::CopyByteArray(PRUint8* aSrcArray, PRUint32 aCount,
+                              PRUint8** aDstArray)
+{
+  return CloneArray(aSrcArray, aCount, aDstArray);
+}
+
+NS_IMETHODIMP
+nsJXTestParams::ReturnByteArray(PRUint8* aSrcArray, PRUint32 aCount,
+                                PRUint8** aResult)
+{
+  return CloneArray(aSrcArray, aCount, aResult);
+}
+
+NS_IMETHODIMP
+nsJXTestParams::CopySizedString(const char* aSrcString, PRUint32 aCount,
+                                char** aDstString)
+{
+  return CloneSizedString(aSrcString, aCount, aDstString);
+}
+
+NS_IMETHODIMP
+nsJXTestParams::ReturnSizedString(const char* aSrcString, PRUint32 aCount,
+                                  char** aResult)
+{
+  return CloneSizedString(aSrcString, aCount, aResult);
+}
+
+NS_IMETHODIMP
+nsJXTestParams::CopySizedWString(const PRUnichar* aSrcString,
+                                 PRUint32 aCount, PRUnichar** aDstString)
+{
+  return CloneSizedString(aSrcString, aCount, aDstString);
+}
+
+NS_IMETHODIMP
+nsJXTestParams::ReturnSizedWString(const PRUnichar* aSrcString,
+                                   PRUint32 aCount, PRUnichar** aResult)
+{
+  return CloneSizedString(aSrcString, aCount, aResult);
+}
+
+NS_IMETHODIMP
+nsJXTestParams::RunTests(nsISupports* aTests)
+{
+  NS_ENSURE_ARG(aTests);
+
+  nsCOMPtr<nsIJXTestArrayParams> tests = do_QueryInterface(aTests);
+  if (!tests)
+    return NS_OK;
+
+  static const PRUint32 kCount = 5;
+  PRInt32 ints[kCount] = { 1, -2, 3, -4, 5 };
+  PRUint8 bytes[kCount] = { 0, 1, 127, 128, 255 };
+  static const char kString[] = "hello";
+  static const PRUnichar kWString[] = { 'h', 0x00e9, 'l', 0x4e16, 'o', 0 };
+
+  nsresult rv;
+
+  PRInt32* intResult = nullptr;
+  rv = tests->ReturnIntArray(ints, kCount, &intResult);
+  NS_ENSURE_SUCCESS(rv, rv);
+  bool ok = intResult && memcmp(intResult, ints, sizeof(ints)) == 0;
+  NS_Free(intResult);
+  NS_ENSURE_TRUE(ok, NS_ERROR_FAILURE);
+
+  intResult = ints;
+  rv = tests->MultiplyEachItemInIntegerArray2(3, &intResult, kCount);
+  NS_ENSURE_SUCCESS(rv, rv);
+  ok = intResult && intResult[0] == 3 && intResult[kCount - 1] == 15;
+  if (intResult != ints)
+    NS_Free(intResult);
+  NS_ENSURE_TRUE(ok, NS_ERROR_FAILURE);
+
+  PRUint8* byteResult = nullptr;
+  rv = tests->CopyByteArray(bytes, kCount, &byteResult);
+  NS_ENSURE_SUCCESS(rv, rv);
+  ok = byteResult && memcmp(byteResult, bytes, sizeof(bytes)) == 0;
+  NS_Free(byteResult);
+  NS_ENSURE_TRUE(ok, NS_ERROR_FAILURE);
+
+  char* stringResult = nullptr;
+  rv = tests->ReturnSizedString(kString, sizeof(kString) - 1, &stringResult);
+  NS_ENSURE_SUCCESS(rv, rv);
+  ok = stringResult && strcmp(stringResult, kString) == 0;
+  NS_Free(stringResult);
+  NS_ENSURE_TRUE(ok, NS_ERROR_FAILURE);
+
+  PRUnichar* wstringResult = nullptr;
+  rv = tests->CopySizedWString(kWString, NS_strlen(kWString),
+                               &wstringResult);
+  NS_ENSURE_SUCCESS(rv, rv);
+  ok = wstringResult && NS_strcmp(wstringResult, kWString) == 0;
+  NS_Free(wstringResult);
+  NS_ENSURE_TRUE(ok, NS_ERROR_FAILURE);
+
+  return NS_OK;
+}
+
+static nsresult
+nsJXTestParamsConstructor(nsISupports* aOuter, REFNSIID aIID,
+                          void** aResult)
+{
+  NS_ENSURE_NO_AGGREGATION(aOuter);
+
+  nsCOMPtr<nsIJXTestParams> inst = new nsJXTestParams();
+  return inst->QueryInterface(aIID, aResult);
+}
+
+// {c3b1fb22-8a70-4b53-9d04-2e5f2a0d7a61}
+#define NS_JXTESTPARAMS_CID \
+  { 0xc3b1fb22, 0x8a70, 0x4b53, \
+    { 0x9d, 0x04, 0x2e, 0x5f, 0x2a, 0x0d, 0x7a, 0x61 } }
+
+// {6a1e0d47-3f5c-4e8a-b2d9-51c7e04b9f13}
+#define NS_JXTESTXPC_CID \
+  { 0x6a1e0d47, 0x3f5c, 0x4e8a, \
+    { 0xb2, 0xd9, 0x51, 0xc7, 0xe0, 0x4b, 0x9f, 0x13 } }
+
+const nsStandInComponent kJXTestComponents[] = {
+  { "@mozilla.org/javaxpcom/tests/params;1", NS_JXTESTPARAMS_CID,
+    nsJXTestParamsConstructor, false },
+  { "@mozilla.org/javaxpcom/tests/xpc;1", NS_JXTESTXPC_CID,
+    nsJXTestParamsConstructor, false }
+};
+
+const PRUint32 kJXTestComponentCount =
+  sizeof(kJXTestComponents) / sizeof(kJXTestComponents[0]);
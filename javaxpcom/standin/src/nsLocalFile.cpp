@@ -0,0 +1,244 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * nsILocalFile for Unix paths.  Paths are stored in the native charset,
+ * which the stand-in takes to be UTF-8.
+ */
+
+#include "nsILocalFile.h"
+#include "nsStringAPI.h"
+#include "nsCOMPtr.h"
+
+#include <sys/stat.h>
+#include <errno.h>
+#include <unistd.h>
+
+class nsLocalFile final : public nsILocalFile
+{
+public:
+  NS_DECL_ISUPPORTS
+  NS_DECL_NSIFILE
+  NS_DECL_NSILOCALFILE
+
+  nsLocalFile() {}
+  explicit nsLocalFile(const nsACString& aPath) : mPath(aPath) {}
+
+private:
+  ~nsLocalFile() {}
+
+  nsresult Stat(struct stat* aStat);
+
+  nsCString mPath;
+};
+
+NS_IMPL_ISUPPORTS(nsLocalFile, nsILocalFile, nsIFile)
+
+nsresult
+nsLocalFile::Stat(struct stat* aStat)
+{
+  NS_ENSURE_TRUE(!mPath.IsEmpty(), NS_ERROR_NOT_INITIALIZED);
+
+  if (stat(mPath.get(), aStat) == -1)
+    return errno == ENOENT || errno == ENOTDIR ? NS_ERROR_FILE_NOT_FOUND
+                                               : NS_ERROR_FAILURE;
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+nsLocalFile::Append(const nsAString& aNode)
+{
+  return AppendNative(NS_ConvertUTF16toUTF8(aNode));
+}
+
+NS_IMETHODIMP
+nsLocalFile::AppendNative(const nsACString& aNode)
+{
+  NS_ENSURE_TRUE(!mPath.IsEmpty(), NS_ERROR_NOT_INITIALIZED);
+
+  // Only single components may be appended, as in Gecko.
+  if (aNode.IsEmpty() || aNode.FindChar('/') != -1 ||
+      aNode.Equals("..")) {
+    return NS_ERROR_FILE_UNRECOGNIZED_PATH;
+  }
+
+  if (mPath.Last() != '/')
+    mPath.Append('/');
+  mPath.Append(aNode);
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+nsLocalFile::GetLeafName(nsAString& aLeafName)
+{
+  NS_ENSURE_TRUE(!mPath.IsEmpty(), NS_ERROR_NOT_INITIALIZED);
+
+  PRInt32 slash = -1, next;
+  while ((next = mPath.FindChar('/', slash + 1)) != -1)
+    slash = next;
+
+  CopyUTF8toUTF16(nsDependentCSubstring(mPath.BeginReading() + slash + 1,
+                                        mPath.EndReading()),
+                  aLeafName);
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+nsLocalFile::SetLeafName(const nsAString& aLeafName)
+{
+  nsCOMPtr<nsIFile> parent;
+  nsresult rv = GetParent(getter_AddRefs(parent));
+  NS_ENSURE_SUCCESS(rv, rv);
+  NS_ENSURE_TRUE(parent, NS_ERROR_FILE_UNRECOGNIZED_PATH);
+
+  nsCString path;
+  parent->GetNativePath(path);
+  mPath.Assign(path);
+  return Append(aLeafName);
+}
+
+NS_IMETHODIMP
+nsLocalFile::GetPath(nsAString& aPath)
+{
+  CopyUTF8toUTF16(mPath, aPath);
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+nsLocalFile::GetNativePath(nsACString& aNativePath)
+{
+  aNativePath.Assign(mPath);
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+nsLocalFile::Exists(bool* aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  NS_ENSURE_TRUE(!mPath.IsEmpty(), NS_ERROR_NOT_INITIALIZED);
+
+  *aResult = access(mPath.get(), F_OK) == 0;
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+nsLocalFile::IsDirectory(bool* aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+
+  struct stat st;
+  nsresult rv = Stat(&st);
+  NS_ENSURE_SUCCESS(rv, rv);
+
+  *aResult = S_ISDIR(st.st_mode);
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+nsLocalFile::Clone(nsIFile** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  NS_ADDREF(*aResult = new nsLocalFile(mPath));
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+nsLocalFile::GetParent(nsIFile** aParent)
+{
+  NS_ENSURE_ARG_POINTER(aParent);
+  NS_ENSURE_TRUE(!mPath.IsEmpty(), NS_ERROR_NOT_INITIALIZED);
+  *aParent = nullptr;
+
+  // Ignore a trailing slash, and give the root no parent.
+  PRUint32 end = mPath.Length();
+  if (end > 1 && mPath.Last() == '/')
+    --end;
+  if (end == 1)
+    return NS_OK;
+
+  PRInt32 slash = -1, next;
+  while ((next = mPath.FindChar('/', slash + 1)) != -1 &&
+         PRUint32(next) < end - 1) {
+    slash = next;
+  }
+  if (slash == -1)
+    return NS_OK;
+
+  nsDependentCSubstring parentPath(mPath.BeginReading(),
+                                   slash == 0 ? 1 : PRUint32(slash));
+  NS_ADDREF(*aParent = new nsLocalFile(parentPath));
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+nsLocalFile::InitWithPath(const nsAString& aFilePath)
+{
+  return InitWithNativePath(NS_ConvertUTF16toUTF8(aFilePath));
+}
+
+NS_IMETHODIMP
+nsLocalFile::InitWithNativePath(const nsACString& aFilePath)
+{
+  if (aFilePath.IsEmpty() || aFilePath.First() != '/')
+    return NS_ERROR_FILE_UNRECOGNIZED_PATH;
+
+  mPath.Assign(aFilePath);
+  return NS_OK;
+}
+
+nsresult
+NS_NewNativeLocalFile(const nsACString& aPath, bool aFollowLinks,
+                      nsIFile** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+
+  nsCOMPtr<nsILocalFile> file = new nsLocalFile();
+  if (!aPath.IsEmpty()) {
+    nsresult rv = file->InitWithNativePath(aPath);
+    NS_ENSURE_SUCCESS(rv, rv);
+  }
+
+  file.forget(aResult);
+  return NS_OK;
+}
+
+nsresult
+NS_NewLocalFile(const nsAString& aPath, bool aFollowLinks, nsIFile** aResult)
+{
+  return NS_NewNativeLocalFile(NS_ConvertUTF16toUTF8(aPath), aFollowLinks,
+                               aResult);
+}
@@ -0,0 +1,142 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * XPCOM and mozalloc allocation entry points.  Everything is backed by the
+ * C heap, so memory from any of them may be freed with any other.
+ */
+
+#include "nsMemory.h"
+#include "nsDebug.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void*
+NS_Alloc(size_t aSize)
+{
+  return malloc(aSize);
+}
+
+void*
+NS_Realloc(void* aPtr, size_t aSize)
+{
+  return realloc(aPtr, aSize);
+}
+
+void
+NS_Free(void* aPtr)
+{
+  free(aPtr);
+}
+
+void*
+nsMemory::Clone(const void* aPtr, size_t aSize)
+{
+  void* newPtr = NS_Alloc(aSize);
+  if (newPtr)
+    memcpy(newPtr, aPtr, aSize);
+  return newPtr;
+}
+
+/* The infallible versions abort instead of returning null. */
+
+void*
+moz_xmalloc(size_t size)
+{
+  void* ptr = malloc(size);
+  if (!ptr && size)
+    NS_RUNTIMEABORT("out of memory");
+  return ptr;
+}
+
+void*
+moz_xcalloc(size_t nmemb, size_t size)
+{
+  void* ptr = calloc(nmemb, size);
+  if (!ptr && nmemb && size)
+    NS_RUNTIMEABORT("out of memory");
+  return ptr;
+}
+
+void*
+moz_xrealloc(void* ptr, size_t size)
+{
+  void* newptr = realloc(ptr, size);
+  if (!newptr && size)
+    NS_RUNTIMEABORT("out of memory");
+  return newptr;
+}
+
+char*
+moz_xstrdup(const char* str)
+{
+  char* dup = strdup(str);
+  if (!dup)
+    NS_RUNTIMEABORT("out of memory");
+  return dup;
+}
+
+void*
+moz_malloc(size_t size)
+{
+  return malloc(size);
+}
+
+void*
+moz_calloc(size_t nmemb, size_t size)
+{
+  return calloc(nmemb, size);
+}
+
+void*
+moz_realloc(void* ptr, size_t size)
+{
+  return realloc(ptr, size);
+}
+
+char*
+moz_strdup(const char* str)
+{
+  return strdup(str);
+}
+
+void
+moz_free(void* ptr)
+{
+  free(ptr);
+}
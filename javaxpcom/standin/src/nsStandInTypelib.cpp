@@ -0,0 +1,386 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * Typelib data for the interfaces built into the stand-in, written out by
+ * hand in the form xpidl would have generated.  Each method's entries must
+ * follow the declaration order of the interface's C++ header, since that
+ * order is the vtable layout NS_InvokeByIndex and the xptcall stubs rely on.
+ *
+ * Interface references are 1-based indices into kInterfaceDirectory; keep
+ * the IDX_ constants in step with it.
+ */
+
+#include "xptiprivate.h"
+#include "nsIServiceManager.h"
+#include "nsIComponentManager.h"
+#include "nsIComponentRegistrar.h"
+#include "nsILocalFile.h"
+#include "nsIJXTestParams.h"
+#include "nsIJXTestArrayParams.h"
+
+enum {
+  IDX_nsISupports = 1,
+  IDX_nsIServiceManager,
+  IDX_nsIComponentManager,
+  IDX_nsIComponentRegistrar,
+  IDX_nsIFile,
+  IDX_nsILocalFile,
+  IDX_nsIJXTestParams,
+  IDX_nsIJXTestArrayParams
+};
+
+/* Type descriptors */
+#define T_SIMPLE(tag)         { { tag }, 0, 0, { 0 } }
+#define T_REF(tag)            { { XPT_TDP_POINTER | XPT_TDP_REFERENCE | tag }, \
+                                0, 0, { 0 } }
+#define T_PTR(tag)            { { XPT_TDP_POINTER | tag }, 0, 0, { 0 } }
+#define T_IFACE(idx)          { { XPT_TDP_POINTER | TD_INTERFACE_TYPE }, \
+                                0, 0, { idx } }
+#define T_IFACE_IS(arg)       { { XPT_TDP_POINTER | TD_INTERFACE_IS_TYPE }, \
+                                arg, 0, { 0 } }
+#define T_SIZE_IS(tag, arg)   { { XPT_TDP_POINTER | tag }, arg, arg, { 0 } }
+#define T_ARRAY(addl, arg)    { { XPT_TDP_POINTER | TD_ARRAY }, \
+                                arg, arg, { addl } }
+
+/* Parameter flags */
+#define P_IN      XPT_PD_IN
+#define P_OUT     XPT_PD_OUT
+#define P_INOUT   (XPT_PD_IN | XPT_PD_OUT)
+#define P_RETVAL  (XPT_PD_OUT | XPT_PD_RETVAL)
+#define P_DIPPER  (XPT_PD_IN | XPT_PD_DIPPER | XPT_PD_RETVAL)
+
+#define METHOD(name, params, flags) \
+  { name, params, &kResult, flags, \
+    PRUint8(sizeof(params) / sizeof(XPTParamDescriptor)) }
+#define METHOD0(name, flags) \
+  { name, nullptr, &kResult, flags, 0 }
+
+#define INTERFACE(parent, methods, flags) \
+  { parent, PRUint16(sizeof(methods) / sizeof(XPTMethodDescriptor)), \
+    methods, 0, nullptr, flags, nullptr, 0 }
+#define INTERFACE_WITH_TYPES(parent, methods, flags, types) \
+  { parent, PRUint16(sizeof(methods) / sizeof(XPTMethodDescriptor)), \
+    methods, 0, nullptr, flags, types, \
+    PRUint16(sizeof(types) / sizeof(XPTTypeDescriptor)) }
+
+// Every method returns an nsresult.
+static XPTParamDescriptor kResult = { P_RETVAL, T_SIMPLE(TD_UINT32) };
+
+/***************************************************************************/
+/* nsISupports */
+
+static XPTParamDescriptor nsISupports_QueryInterface[] = {
+  { P_IN,     T_REF(TD_PNSIID) },
+  { P_RETVAL, T_IFACE_IS(0) }
+};
+
+static XPTMethodDescriptor nsISupports_methods[] = {
+  METHOD("QueryInterface", nsISupports_QueryInterface, 0),
+  METHOD0("AddRef", XPT_MD_NOTXPCOM | XPT_MD_HIDDEN),
+  METHOD0("Release", XPT_MD_NOTXPCOM | XPT_MD_HIDDEN)
+};
+
+static XPTInterfaceDescriptor nsISupports_desc =
+  INTERFACE(0, nsISupports_methods, XPT_ID_SCRIPTABLE);
+
+/***************************************************************************/
+/* nsIServiceManager */
+
+static XPTParamDescriptor nsIServiceManager_getService[] = {
+  { P_IN,     T_REF(TD_PNSIID) },
+  { P_IN,     T_REF(TD_PNSIID) },
+  { P_RETVAL, T_IFACE_IS(1) }
+};
+
+static XPTParamDescriptor nsIServiceManager_getServiceByContractID[] = {
+  { P_IN,     T_PTR(TD_PSTRING) },
+  { P_IN,     T_REF(TD_PNSIID) },
+  { P_RETVAL, T_IFACE_IS(1) }
+};
+
+static XPTParamDescriptor nsIServiceManager_isServiceInstantiated[] = {
+  { P_IN,     T_REF(TD_PNSIID) },
+  { P_IN,     T_REF(TD_PNSIID) },
+  { P_RETVAL, T_SIMPLE(TD_BOOL) }
+};
+
+static XPTParamDescriptor
+nsIServiceManager_isServiceInstantiatedByContractID[] = {
+  { P_IN,     T_PTR(TD_PSTRING) },
+  { P_IN,     T_REF(TD_PNSIID) },
+  { P_RETVAL, T_SIMPLE(TD_BOOL) }
+};
+
+static XPTMethodDescriptor nsIServiceManager_methods[] = {
+  METHOD("getService", nsIServiceManager_getService, 0),
+  METHOD("getServiceByContractID",
+         nsIServiceManager_getServiceByContractID, 0),
+  METHOD("isServiceInstantiated",
+         nsIServiceManager_isServiceInstantiated, 0),
+  METHOD("isServiceInstantiatedByContractID",
+         nsIServiceManager_isServiceInstantiatedByContractID, 0)
+};
+
+static XPTInterfaceDescriptor nsIServiceManager_desc =
+  INTERFACE(IDX_nsISupports, nsIServiceManager_methods, XPT_ID_SCRIPTABLE);
+
+/***************************************************************************/
+/* nsIComponentManager */
+
+static XPTParamDescriptor nsIComponentManager_getClassObject[] = {
+  { P_IN,     T_REF(TD_PNSIID) },
+  { P_IN,     T_REF(TD_PNSIID) },
+  { P_RETVAL, T_IFACE_IS(1) }
+};
+
+static XPTParamDescriptor nsIComponentManager_getClassObjectByContractID[] = {
+  { P_IN,     T_PTR(TD_PSTRING) },
+  { P_IN,     T_REF(TD_PNSIID) },
+  { P_RETVAL, T_IFACE_IS(1) }
+};
+
+static XPTParamDescriptor nsIComponentManager_createInstance[] = {
+  { P_IN,     T_REF(TD_PNSIID) },
+  { P_IN,     T_IFACE(IDX_nsISupports) },
+  { P_IN,     T_REF(TD_PNSIID) },
+  { P_RETVAL, T_IFACE_IS(2) }
+};
+
+static XPTParamDescriptor nsIComponentManager_createInstanceByContractID[] = {
+  { P_IN,     T_PTR(TD_PSTRING) },
+  { P_IN,     T_IFACE(IDX_nsISupports) },
+  { P_IN,     T_REF(TD_PNSIID) },
+  { P_RETVAL, T_IFACE_IS(2) }
+};
+
+static XPTMethodDescriptor nsIComponentManager_methods[] = {
+  METHOD("getClassObject", nsIComponentManager_getClassObject, 0),
+  METHOD("getClassObjectByContractID",
+         nsIComponentManager_getClassObjectByContractID, 0),
+  METHOD("createInstance", nsIComponentManager_createInstance, 0),
+  METHOD("createInstanceByContractID",
+         nsIComponentManager_createInstanceByContractID, 0)
+};
+
+static XPTInterfaceDescriptor nsIComponentManager_desc =
+  INTERFACE(IDX_nsISupports, nsIComponentManager_methods, XPT_ID_SCRIPTABLE);
+
+/***************************************************************************/
+/* nsIComponentRegistrar */
+
+static XPTParamDescriptor nsIComponentRegistrar_isContractIDRegistered[] = {
+  { P_IN,     T_PTR(TD_PSTRING) },
+  { P_RETVAL, T_SIMPLE(TD_BOOL) }
+};
+
+static XPTMethodDescriptor nsIComponentRegistrar_methods[] = {
+  METHOD("isContractIDRegistered",
+         nsIComponentRegistrar_isContractIDRegistered, 0)
+};
+
+static XPTInterfaceDescriptor nsIComponentRegistrar_desc =
+  INTERFACE(IDX_nsISupports, nsIComponentRegistrar_methods,
+            XPT_ID_SCRIPTABLE);
+
+/***************************************************************************/
+/* nsIFile */
+
+static XPTParamDescriptor nsIFile_inAString[] = {
+  { P_IN,     T_REF(TD_ASTRING) }
+};
+
+static XPTParamDescriptor nsIFile_inACString[] = {
+  { P_IN,     T_REF(TD_CSTRING) }
+};
+
+static XPTParamDescriptor nsIFile_getAString[] = {
+  { P_DIPPER, T_REF(TD_ASTRING) }
+};
+
+static XPTParamDescriptor nsIFile_getACString[] = {
+  { P_DIPPER, T_REF(TD_CSTRING) }
+};
+
+static XPTParamDescriptor nsIFile_getBool[] = {
+  { P_RETVAL, T_SIMPLE(TD_BOOL) }
+};
+
+static XPTParamDescriptor nsIFile_getFile[] = {
+  { P_RETVAL, T_IFACE(IDX_nsIFile) }
+};
+
+static XPTMethodDescriptor nsIFile_methods[] = {
+  METHOD("append", nsIFile_inAString, 0),
+  METHOD("appendNative", nsIFile_inACString, XPT_MD_HIDDEN),
+  METHOD("leafName", nsIFile_getAString, XPT_MD_GETTER),
+  METHOD("leafName", nsIFile_inAString, XPT_MD_SETTER),
+  METHOD("path", nsIFile_getAString, XPT_MD_GETTER),
+  METHOD("nativePath", nsIFile_getACString, XPT_MD_GETTER | XPT_MD_HIDDEN),
+  METHOD("exists", nsIFile_getBool, 0),
+  METHOD("isDirectory", nsIFile_getBool, 0),
+  METHOD("clone", nsIFile_getFile, 0),
+  METHOD("parent", nsIFile_getFile, XPT_MD_GETTER),
+  METHOD("initWithPath", nsIFile_inAString, 0),
+  METHOD("initWithNativePath", nsIFile_inACString, XPT_MD_HIDDEN)
+};
+
+static XPTInterfaceDescriptor nsIFile_desc =
+  INTERFACE(IDX_nsISupports, nsIFile_methods, XPT_ID_SCRIPTABLE);
+
+/* nsILocalFile only renames nsIFile. */
+static XPTInterfaceDescriptor nsILocalFile_desc =
+  { IDX_nsIFile, 0, nullptr, 0, nullptr, XPT_ID_SCRIPTABLE, nullptr, 0 };
+
+/***************************************************************************/
+/* nsIJXTestParams */
+
+static XPTParamDescriptor nsIJXTestParams_runTests[] = {
+  { P_IN,     T_IFACE(IDX_nsISupports) }
+};
+
+static XPTMethodDescriptor nsIJXTestParams_methods[] = {
+  METHOD("runTests", nsIJXTestParams_runTests, 0)
+};
+
+static XPTInterfaceDescriptor nsIJXTestParams_desc =
+  INTERFACE(IDX_nsISupports, nsIJXTestParams_methods, XPT_ID_SCRIPTABLE);
+
+/***************************************************************************/
+/* nsIJXTestArrayParams */
+
+// Element types of the arrays below, by index.
+enum { ADDL_INT32 = 0, ADDL_UINT8 };
+
+static XPTTypeDescriptor nsIJXTestArrayParams_types[] = {
+  T_SIMPLE(TD_INT32),
+  T_SIMPLE(TD_UINT8)
+};
+
+static XPTParamDescriptor
+nsIJXTestArrayParams_multiplyEachItemInIntegerArray2[] = {
+  { P_IN,     T_SIMPLE(TD_INT32) },
+  { P_INOUT,  T_ARRAY(ADDL_INT32, 2) },
+  { P_IN,     T_SIMPLE(TD_UINT32) }
+};
+
+static XPTParamDescriptor nsIJXTestArrayParams_copyIntArray[] = {
+  { P_IN,     T_ARRAY(ADDL_INT32, 1) },
+  { P_IN,     T_SIMPLE(TD_UINT32) },
+  { P_OUT,    T_ARRAY(ADDL_INT32, 1) }
+};
+
+static XPTParamDescriptor nsIJXTestArrayParams_returnIntArray[] = {
+  { P_IN,     T_ARRAY(ADDL_INT32, 1) },
+  { P_IN,     T_SIMPLE(TD_UINT32) },
+  { P_RETVAL, T_ARRAY(ADDL_INT32, 1) }
+};
+
+static XPTParamDescriptor nsIJXTestArrayParams_copyByteArray[] = {
+  { P_IN,     T_ARRAY(ADDL_UINT8, 1) },
+  { P_IN,     T_SIMPLE(TD_UINT32) },
+  { P_OUT,    T_ARRAY(ADDL_UINT8, 1) }
+};
+
+static XPTParamDescriptor nsIJXTestArrayParams_returnByteArray[] = {
+  { P_IN,     T_ARRAY(ADDL_UINT8, 1) },
+  { P_IN,     T_SIMPLE(TD_UINT32) },
+  { P_RETVAL, T_ARRAY(ADDL_UINT8, 1) }
+};
+
+static XPTParamDescriptor nsIJXTestArrayParams_copySizedString[] = {
+  { P_IN,     T_SIZE_IS(TD_PSTRING_SIZE_IS, 1) },
+  { P_IN,     T_SIMPLE(TD_UINT32) },
+  { P_OUT,    T_SIZE_IS(TD_PSTRING_SIZE_IS, 1) }
+};
+
+static XPTParamDescriptor nsIJXTestArrayParams_returnSizedString[] = {
+  { P_IN,     T_SIZE_IS(TD_PSTRING_SIZE_IS, 1) },
+  { P_IN,     T_SIMPLE(TD_UINT32) },
+  { P_RETVAL, T_SIZE_IS(TD_PSTRING_SIZE_IS, 1) }
+};
+
+static XPTParamDescriptor nsIJXTestArrayParams_copySizedWString[] = {
+  { P_IN,     T_SIZE_IS(TD_PWSTRING_SIZE_IS, 1) },
+  { P_IN,     T_SIMPLE(TD_UINT32) },
+  { P_OUT,    T_SIZE_IS(TD_PWSTRING_SIZE_IS, 1) }
+};
+
+static XPTParamDescriptor nsIJXTestArrayParams_returnSizedWString[] = {
+  { P_IN,     T_SIZE_IS(TD_PWSTRING_SIZE_IS, 1) },
+  { P_IN,     T_SIMPLE(TD_UINT32) },
+  { P_RETVAL, T_SIZE_IS(TD_PWSTRING_SIZE_IS, 1) }
+};
+
+static XPTMethodDescriptor nsIJXTestArrayParams_methods[] = {
+  METHOD("multiplyEachItemInIntegerArray2",
+         nsIJXTestArrayParams_multiplyEachItemInIntegerArray2, 0),
+  METHOD("copyIntArray", nsIJXTestArrayParams_copyIntArray, 0),
+  METHOD("returnIntArray", nsIJXTestArrayParams_returnIntArray, 0),
+  METHOD("copyByteArray", nsIJXTestArrayParams_copyByteArray, 0),
+  METHOD("returnByteArray", nsIJXTestArrayParams_returnByteArray, 0),
+  METHOD("copySizedString", nsIJXTestArrayParams_copySizedString, 0),
+  METHOD("returnSizedString", nsIJXTestArrayParams_returnSizedString, 0),
+  METHOD("copySizedWString", nsIJXTestArrayParams_copySizedWString, 0),
+  METHOD("returnSizedWString", nsIJXTestArrayParams_returnSizedWString, 0)
+};
+
+static XPTInterfaceDescriptor nsIJXTestArrayParams_desc =
+  INTERFACE_WITH_TYPES(IDX_nsISupports, nsIJXTestArrayParams_methods,
+                       XPT_ID_SCRIPTABLE, nsIJXTestArrayParams_types);
+
+/***************************************************************************/
+
+static XPTInterfaceDirectoryEntry kInterfaceDirectory[] = {
+  { NS_ISUPPORTS_IID, "nsISupports", "", &nsISupports_desc },
+  { NS_ISERVICEMANAGER_IID, "nsIServiceManager", "",
+    &nsIServiceManager_desc },
+  { NS_ICOMPONENTMANAGER_IID, "nsIComponentManager", "",
+    &nsIComponentManager_desc },
+  { NS_ICOMPONENTREGISTRAR_IID, "nsIComponentRegistrar", "",
+    &nsIComponentRegistrar_desc },
+  { NS_IFILE_IID, "nsIFile", "", &nsIFile_desc },
+  { NS_ILOCALFILE_IID, "nsILocalFile", "", &nsILocalFile_desc },
+  { NS_IJXTESTPARAMS_IID, "nsIJXTestParams", "", &nsIJXTestParams_desc },
+  { NS_IJXTESTARRAYPARAMS_IID, "nsIJXTestArrayParams", "",
+    &nsIJXTestArrayParams_desc }
+};
+
+const XPTHeader kStandInTypelib = {
+  PRUint16(sizeof(kInterfaceDirectory) / sizeof(XPTInterfaceDirectoryEntry)),
+  kInterfaceDirectory
+};
@@ -0,0 +1,473 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * The stand-in's implementation of the external string API.
+ */
+
+#include "nsStringAPI.h"
+#include "nsMemory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Flag values shared by nsAString and nsACString; see nsStringAPI.h. */
+enum
+{
+  kTerminated = 1 << 0,
+  kOwned      = 1 << 2
+};
+
+template<class CharT>
+struct EmptyBuffer
+{
+  static const CharT sData[1];
+};
+
+template<class CharT>
+const CharT EmptyBuffer<CharT>::sData[1] = { CharT(0) };
+
+template<class CharT>
+static PRUint32
+StringLength(const CharT* aData)
+{
+  const CharT* end = aData;
+  while (*end)
+    ++end;
+  return PRUint32(end - aData);
+}
+
+/*
+ * Makes a string own a buffer for aNewLength characters plus a null
+ * terminator, keeping the first min(aLength, aNewLength) characters.
+ * Clears the void flag.
+ */
+template<class CharT>
+static bool
+EnsureOwned(CharT*& aData, PRUint32& aLength, PRUint32& aFlags,
+            PRUint32 aNewLength)
+{
+  if (aNewLength == PR_UINT32_MAX)
+    return false;
+
+  CharT* data;
+  if (aFlags & kOwned) {
+    data = static_cast<CharT*>(realloc(aData, (aNewLength + 1) *
+                                              sizeof(CharT)));
+    if (!data)
+      return false;
+  } else {
+    data = static_cast<CharT*>(malloc((aNewLength + 1) * sizeof(CharT)));
+    if (!data)
+      return false;
+    PRUint32 keep = aLength < aNewLength ? aLength : aNewLength;
+    memcpy(data, aData, keep * sizeof(CharT));
+  }
+
+  data[aNewLength] = CharT(0);
+  aData = data;
+  aLength = aNewLength;
+  aFlags = kOwned | kTerminated;
+  return true;
+}
+
+#define nsTAString_CharT nsAString
+#define CharT PRUnichar
+#include "nsTStringAPI.inc"
+#undef nsTAString_CharT
+#undef CharT
+
+#define nsTAString_CharT nsACString
+#define CharT char
+#include "nsTStringAPI.inc"
+#undef nsTAString_CharT
+#undef CharT
+
+/* nsAString *****************************************************************/
+
+void
+nsAString::AssignASCII(const char* aData, size_type aLength)
+{
+  Truncate();
+  AppendASCII(aData, aLength);
+}
+
+void
+nsAString::AppendASCII(const char* aData, size_type aLength)
+{
+  if (!aData)
+    return;
+  if (aLength == PR_UINT32_MAX)
+    aLength = PRUint32(strlen(aData));
+
+  PRUint32 oldLength = mLength;
+  if (!SetLength(oldLength + aLength))
+    return;
+  for (PRUint32 i = 0; i < aLength; i++)
+    mData[oldLength + i] = PRUnichar((unsigned char) aData[i]);
+}
+
+bool
+nsAString::EqualsLiteral(const char* aASCIIString) const
+{
+  PRUint32 length = PRUint32(strlen(aASCIIString));
+  if (length != mLength)
+    return false;
+  for (PRUint32 i = 0; i < length; i++) {
+    if (mData[i] != PRUnichar((unsigned char) aASCIIString[i]))
+      return false;
+  }
+  return true;
+}
+
+/* nsACString ****************************************************************/
+
+void
+nsACString::AppendInt(PRInt32 aInteger, PRInt32 aRadix)
+{
+  char buf[20];
+  const char* fmt;
+  switch (aRadix) {
+    case 8:
+      fmt = "%o";
+      break;
+    case 16:
+      fmt = "%x";
+      break;
+    default:
+      fmt = "%d";
+      break;
+  }
+  int len = snprintf(buf, sizeof(buf), fmt, aInteger);
+  if (len > 0)
+    Append(buf, PRUint32(len));
+}
+
+PRInt32
+nsACString::Find(const char* aStr, index_type aOffset) const
+{
+  PRUint32 strLen = PRUint32(strlen(aStr));
+  if (aOffset > mLength || strLen > mLength - aOffset)
+    return -1;
+  for (PRUint32 i = aOffset; i + strLen <= mLength; i++) {
+    if (memcmp(mData + i, aStr, strLen) == 0)
+      return PRInt32(i);
+  }
+  return -1;
+}
+
+/* Dependent strings *********************************************************/
+
+nsDependentString::nsDependentString(const char_type* aData,
+                                     size_type aLength)
+{
+  mData = const_cast<char_type*>(aData);
+  mLength = aLength == PR_UINT32_MAX ? StringLength(aData) : aLength;
+  mFlags = aLength == PR_UINT32_MAX ? F_TERMINATED : F_NONE;
+}
+
+nsDependentCString::nsDependentCString(const char_type* aData,
+                                       size_type aLength)
+{
+  mData = const_cast<char_type*>(aData);
+  mLength = aLength == PR_UINT32_MAX ? StringLength(aData) : aLength;
+  mFlags = aLength == PR_UINT32_MAX ? F_TERMINATED : F_NONE;
+}
+
+/* Encoding conversions ******************************************************/
+
+static const PRUnichar kReplacementChar = 0xFFFD;
+
+static PRUint32
+UTF8LengthOf(const PRUnichar* aSource, PRUint32 aLength)
+{
+  PRUint32 length = 0;
+  for (PRUint32 i = 0; i < aLength; i++) {
+    PRUnichar c = aSource[i];
+    if (c < 0x80) {
+      length += 1;
+    } else if (c < 0x800) {
+      length += 2;
+    } else if (c >= 0xD800 && c <= 0xDBFF && i + 1 < aLength &&
+               aSource[i + 1] >= 0xDC00 && aSource[i + 1] <= 0xDFFF) {
+      length += 4;
+      i++;
+    } else {
+      // Includes unpaired surrogates, written as U+FFFD.
+      length += 3;
+    }
+  }
+  return length;
+}
+
+static void
+AppendUTF16toUTF8(const PRUnichar* aSource, PRUint32 aLength,
+                  nsACString& aDest)
+{
+  PRUint32 oldLength = aDest.Length();
+  if (!aDest.SetLength(oldLength + UTF8LengthOf(aSource, aLength)))
+    return;
+
+  unsigned char* out = (unsigned char*) aDest.BeginWriting() + oldLength;
+  for (PRUint32 i = 0; i < aLength; i++) {
+    PRUint32 c = aSource[i];
+    if (c >= 0xD800 && c <= 0xDFFF) {
+      if (c <= 0xDBFF && i + 1 < aLength &&
+          aSource[i + 1] >= 0xDC00 && aSource[i + 1] <= 0xDFFF) {
+        c = 0x10000 + ((c - 0xD800) << 10) + (aSource[i + 1] - 0xDC00);
+        i++;
+      } else {
+        c = kReplacementChar;
+      }
+    }
+
+    if (c < 0x80) {
+      *out++ = (unsigned char) c;
+    } else if (c < 0x800) {
+      *out++ = (unsigned char) (0xC0 | (c >> 6));
+      *out++ = (unsigned char) (0x80 | (c & 0x3F));
+    } else if (c < 0x10000) {
+      *out++ = (unsigned char) (0xE0 | (c >> 12));
+      *out++ = (unsigned char) (0x80 | ((c >> 6) & 0x3F));
+      *out++ = (unsigned char) (0x80 | (c & 0x3F));
+    } else {
+      *out++ = (unsigned char) (0xF0 | (c >> 18));
+      *out++ = (unsigned char) (0x80 | ((c >> 12) & 0x3F));
+      *out++ = (unsigned char) (0x80 | ((c >> 6) & 0x3F));
+      *out++ = (unsigned char) (0x80 | (c & 0x3F));
+    }
+  }
+}
+
+/*
+ * Decodes one UTF-8 sequence starting at aSource[*aIndex], advancing
+ * *aIndex past it.  Malformed input decodes to U+FFFD, one byte at a time.
+ */
+static PRUint32
+DecodeUTF8(const unsigned char* aSource, PRUint32 aLength, PRUint32* aIndex)
+{
+  PRUint32 i = *aIndex;
+  unsigned char c = aSource[i];
+  PRUint32 needed, ucs4, min;
+
+  if (c < 0x80) {
+    *aIndex = i + 1;
+    return c;
+  } else if ((c & 0xE0) == 0xC0) {
+    needed = 1; ucs4 = c & 0x1F; min = 0x80;
+  } else if ((c & 0xF0) == 0xE0) {
+    needed = 2; ucs4 = c & 0x0F; min = 0x800;
+  } else if ((c & 0xF8) == 0xF0) {
+    needed = 3; ucs4 = c & 0x07; min = 0x10000;
+  } else {
+    *aIndex = i + 1;
+    return kReplacementChar;
+  }
+
+  if (needed >= aLength - i) {
+    *aIndex = i + 1;
+    return kReplacementChar;
+  }
+  for (PRUint32 j = 1; j <= needed; j++) {
+    if ((aSource[i + j] & 0xC0) != 0x80) {
+      *aIndex = i + 1;
+      return kReplacementChar;
+    }
+    ucs4 = (ucs4 << 6) | (aSource[i + j] & 0x3F);
+  }
+
+  if (ucs4 < min || ucs4 > 0x10FFFF || (ucs4 >= 0xD800 && ucs4 <= 0xDFFF)) {
+    *aIndex = i + 1;
+    return kReplacementChar;
+  }
+  *aIndex = i + needed + 1;
+  return ucs4;
+}
+
+static void
+AppendUTF8toUTF16(const char* aSource, PRUint32 aLength, nsAString& aDest)
+{
+  const unsigned char* source = (const unsigned char*) aSource;
+
+  PRUint32 utf16Length = 0;
+  for (PRUint32 i = 0; i < aLength; ) {
+    PRUint32 c = DecodeUTF8(source, aLength, &i);
+    utf16Length += c >= 0x10000 ? 2 : 1;
+  }
+
+  PRUint32 oldLength = aDest.Length();
+  if (!aDest.SetLength(oldLength + utf16Length))
+    return;
+
+  PRUnichar* out = aDest.BeginWriting() + oldLength;
+  for (PRUint32 i = 0; i < aLength; ) {
+    PRUint32 c = DecodeUTF8(source, aLength, &i);
+    if (c >= 0x10000) {
+      c -= 0x10000;
+      *out++ = PRUnichar(0xD800 | (c >> 10));
+      *out++ = PRUnichar(0xDC00 | (c & 0x3FF));
+    } else {
+      *out++ = PRUnichar(c);
+    }
+  }
+}
+
+NS_ConvertUTF16toUTF8::NS_ConvertUTF16toUTF8(const nsAString& aString)
+{
+  ::AppendUTF16toUTF8(aString.BeginReading(), aString.Length(), *this);
+}
+
+NS_ConvertUTF16toUTF8::NS_ConvertUTF16toUTF8(const PRUnichar* aData,
+                                             PRUint32 aLength)
+{
+  if (aData) {
+    if (aLength == PR_UINT32_MAX)
+      aLength = StringLength(aData);
+    ::AppendUTF16toUTF8(aData, aLength, *this);
+  }
+}
+
+NS_ConvertUTF8toUTF16::NS_ConvertUTF8toUTF16(const nsACString& aString)
+{
+  ::AppendUTF8toUTF16(aString.BeginReading(), aString.Length(), *this);
+}
+
+NS_ConvertUTF8toUTF16::NS_ConvertUTF8toUTF16(const char* aData,
+                                             PRUint32 aLength)
+{
+  if (aData) {
+    if (aLength == PR_UINT32_MAX)
+      aLength = PRUint32(strlen(aData));
+    ::AppendUTF8toUTF16(aData, aLength, *this);
+  }
+}
+
+NS_ConvertASCIItoUTF16::NS_ConvertASCIItoUTF16(const nsACString& aString)
+{
+  AppendASCII(aString.BeginReading(), aString.Length());
+}
+
+NS_ConvertASCIItoUTF16::NS_ConvertASCIItoUTF16(const char* aData,
+                                               PRUint32 aLength)
+{
+  AppendASCII(aData, aLength);
+}
+
+NS_LossyConvertUTF16toASCII::NS_LossyConvertUTF16toASCII(
+                                                   const nsAString& aString)
+{
+  PRUint32 length = aString.Length();
+  if (SetLength(length)) {
+    const PRUnichar* in = aString.BeginReading();
+    char* out = BeginWriting();
+    for (PRUint32 i = 0; i < length; i++)
+      out[i] = char(in[i]);
+  }
+}
+
+NS_LossyConvertUTF16toASCII::NS_LossyConvertUTF16toASCII(
+                                                   const PRUnichar* aData,
+                                                   PRUint32 aLength)
+{
+  if (!aData)
+    return;
+  if (aLength == PR_UINT32_MAX)
+    aLength = StringLength(aData);
+  if (SetLength(aLength)) {
+    char* out = BeginWriting();
+    for (PRUint32 i = 0; i < aLength; i++)
+      out[i] = char(aData[i]);
+  }
+}
+
+void
+CopyUTF16toUTF8(const nsAString& aSource, nsACString& aDest)
+{
+  aDest.Truncate();
+  AppendUTF16toUTF8(aSource, aDest);
+}
+
+void
+CopyUTF8toUTF16(const nsACString& aSource, nsAString& aDest)
+{
+  aDest.Truncate();
+  AppendUTF8toUTF16(aSource, aDest);
+}
+
+void
+AppendUTF16toUTF8(const nsAString& aSource, nsACString& aDest)
+{
+  AppendUTF16toUTF8(aSource.BeginReading(), aSource.Length(), aDest);
+}
+
+void
+AppendUTF8toUTF16(const nsACString& aSource, nsAString& aDest)
+{
+  AppendUTF8toUTF16(aSource.BeginReading(), aSource.Length(), aDest);
+}
+
+PRUnichar*
+ToNewUnicode(const nsAString& aString)
+{
+  PRUint32 length = aString.Length();
+  PRUnichar* result =
+    static_cast<PRUnichar*>(NS_Alloc((length + 1) * sizeof(PRUnichar)));
+  if (result) {
+    memcpy(result, aString.BeginReading(), length * sizeof(PRUnichar));
+    result[length] = PRUnichar(0);
+  }
+  return result;
+}
+
+char*
+ToNewCString(const nsACString& aString)
+{
+  PRUint32 length = aString.Length();
+  char* result = static_cast<char*>(NS_Alloc(length + 1));
+  if (result) {
+    memcpy(result, aString.BeginReading(), length);
+    result[length] = '\0';
+  }
+  return result;
+}
+
+char*
+ToNewUTF8String(const nsAString& aString)
+{
+  NS_ConvertUTF16toUTF8 utf8(aString);
+  return ToNewCString(utf8);
+}
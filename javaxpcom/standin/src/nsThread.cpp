@@ -0,0 +1,394 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * The stand-in's fake main thread.  The thread that calls NS_InitXPCOM2
+ * becomes the main thread; it owns the only event queue, which other
+ * threads fill with NS_DispatchToMainThread and the main thread drains with
+ * NS_ProcessPendingEvents or nsIThread::ProcessNextEvent.
+ */
+
+#include "nsStandInRuntime.h"
+#include "nsThreadUtils.h"
+#include "nsProxyRelease.h"
+#include "prmon.h"
+
+#include <pthread.h>
+
+NS_IMPL_ADDREF(nsRunnable)
+NS_IMPL_RELEASE(nsRunnable)
+NS_IMPL_QUERY_INTERFACE(nsRunnable, nsIRunnable)
+
+NS_IMETHODIMP
+nsRunnable::Run()
+{
+  // Do nothing
+  return NS_OK;
+}
+
+/**
+ * An event on the queue.  Events run in the order they were dispatched.
+ */
+struct nsThreadEvent
+{
+  nsIRunnable* mRunnable;    // owning
+  nsThreadEvent* mNext;
+};
+
+class nsMainThread final : public nsIThread
+{
+public:
+  NS_DECL_THREADSAFE_ISUPPORTS
+  NS_DECL_NSIEVENTTARGET
+  NS_DECL_NSITHREAD
+
+  nsMainThread()
+    : mMonitor(PR_NewMonitor()), mHead(nullptr), mTail(nullptr),
+      mThread(pthread_self())
+  {
+  }
+
+  bool IsCurrent() const { return pthread_equal(mThread, pthread_self()); }
+
+  bool PutEvent(nsIRunnable* aEvent);
+
+  /* Runs everything left in the queue and releases the monitor. */
+  void Shutdown();
+
+private:
+  ~nsMainThread()
+  {
+    PR_DestroyMonitor(mMonitor);
+  }
+
+  nsIRunnable* GetEvent(bool aMayWait);
+
+  PRMonitor* mMonitor;
+  nsThreadEvent* mHead;
+  nsThreadEvent* mTail;
+  pthread_t mThread;
+};
+
+static nsMainThread* gMainThread = nullptr;
+
+NS_IMPL_ADDREF(nsMainThread)
+NS_IMPL_RELEASE(nsMainThread)
+NS_IMPL_QUERY_INTERFACE(nsMainThread, nsIThread, nsIEventTarget)
+
+bool
+nsMainThread::PutEvent(nsIRunnable* aEvent)
+{
+  nsThreadEvent* event = new nsThreadEvent;
+  NS_ADDREF(aEvent);
+  event->mRunnable = aEvent;
+  event->mNext = nullptr;
+
+  PR_EnterMonitor(mMonitor);
+  if (mTail)
+    mTail->mNext = event;
+  else
+    mHead = event;
+  mTail = event;
+  PR_Notify(mMonitor);
+  PR_ExitMonitor(mMonitor);
+  return true;
+}
+
+nsIRunnable*
+nsMainThread::GetEvent(bool aMayWait)
+{
+  PR_EnterMonitor(mMonitor);
+  while (!mHead && aMayWait)
+    PR_Wait(mMonitor, PR_INTERVAL_NO_TIMEOUT);
+
+  nsIRunnable* runnable = nullptr;
+  nsThreadEvent* event = mHead;
+  if (event) {
+    mHead = event->mNext;
+    if (!mHead)
+      mTail = nullptr;
+    runnable = event->mRunnable;
+    delete event;
+  }
+  PR_ExitMonitor(mMonitor);
+  return runnable;
+}
+
+void
+nsMainThread::Shutdown()
+{
+  nsIRunnable* runnable;
+  while ((runnable = GetEvent(false)) != nullptr) {
+    runnable->Run();
+    NS_RELEASE(runnable);
+  }
+}
+
+/**
+ * Wraps an event dispatched with DISPATCH_SYNC from another thread, so the
+ * dispatching thread can wait for it to finish.
+ */
+class nsSyncRunnable : public nsRunnable
+{
+public:
+  nsSyncRunnable(nsIRunnable* aEvent)
+    : mEvent(aEvent), mMonitor(PR_NewMonitor()), mDone(false)
+  {
+  }
+
+  NS_IMETHOD Run()
+  {
+    mEvent->Run();
+    PR_EnterMonitor(mMonitor);
+    mDone = true;
+    PR_Notify(mMonitor);
+    PR_ExitMonitor(mMonitor);
+    return NS_OK;
+  }
+
+  void Wait()
+  {
+    PR_EnterMonitor(mMonitor);
+    while (!mDone)
+      PR_Wait(mMonitor, PR_INTERVAL_NO_TIMEOUT);
+    PR_ExitMonitor(mMonitor);
+  }
+
+protected:
+  ~nsSyncRunnable()
+  {
+    PR_DestroyMonitor(mMonitor);
+  }
+
+private:
+  nsCOMPtr<nsIRunnable> mEvent;
+  PRMonitor* mMonitor;
+  bool mDone;
+};
+
+NS_IMETHODIMP
+nsMainThread::Dispatch(nsIRunnable* aEvent, PRUint32 aFlags)
+{
+  NS_ENSURE_ARG_POINTER(aEvent);
+
+  if (aFlags & DISPATCH_SYNC) {
+    // Run it now if we are already on the main thread; otherwise queue it
+    // and block until the main thread gets to it.
+    if (IsCurrent())
+      return aEvent->Run();
+
+    nsSyncRunnable* wrapper = new nsSyncRunnable(aEvent);
+    NS_ADDREF(wrapper);
+    PutEvent(wrapper);
+    wrapper->Wait();
+    NS_RELEASE(wrapper);
+    return NS_OK;
+  }
+
+  return PutEvent(aEvent) ? NS_OK : NS_ERROR_OUT_OF_MEMORY;
+}
+
+NS_IMETHODIMP
+nsMainThread::IsOnCurrentThread(bool* aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  *aResult = IsCurrent();
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+nsMainThread::HasPendingEvents(bool* aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  NS_ENSURE_TRUE(IsCurrent(), NS_ERROR_NOT_SAME_THREAD);
+
+  PR_EnterMonitor(mMonitor);
+  *aResult = mHead != nullptr;
+  PR_ExitMonitor(mMonitor);
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+nsMainThread::ProcessNextEvent(bool aMayWait, bool* aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  NS_ENSURE_TRUE(IsCurrent(), NS_ERROR_NOT_SAME_THREAD);
+
+  nsIRunnable* runnable = GetEvent(aMayWait);
+  *aResult = runnable != nullptr;
+  if (runnable) {
+    runnable->Run();
+    NS_RELEASE(runnable);
+  }
+  return NS_OK;
+}
+
+nsresult
+NS_InitMainThread()
+{
+  NS_ENSURE_TRUE(!gMainThread, NS_ERROR_ALREADY_INITIALIZED);
+
+  gMainThread = new nsMainThread();
+  NS_ADDREF(gMainThread);
+  return NS_OK;
+}
+
+void
+NS_ShutdownMainThread()
+{
+  if (!gMainThread)
+    return;
+
+  NS_ASSERTION(gMainThread->IsCurrent(),
+               "XPCOM must be shut down on the main thread");
+  gMainThread->Shutdown();
+  NS_RELEASE(gMainThread);
+}
+
+nsresult
+NS_GetMainThread(nsIThread** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  NS_ENSURE_TRUE(gMainThread, NS_ERROR_NOT_INITIALIZED);
+
+  NS_ADDREF(*aResult = gMainThread);
+  return NS_OK;
+}
+
+nsresult
+NS_GetCurrentThread(nsIThread** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  if (!NS_IsMainThread()) {
+    *aResult = nullptr;
+    return NS_ERROR_NOT_AVAILABLE;
+  }
+  return NS_GetMainThread(aResult);
+}
+
+bool
+NS_IsMainThread()
+{
+  return gMainThread && gMainThread->IsCurrent();
+}
+
+nsresult
+NS_DispatchToMainThread(nsIRunnable* aEvent, PRUint32 aDispatchFlags)
+{
+  NS_ENSURE_TRUE(gMainThread, NS_ERROR_NOT_INITIALIZED);
+  return gMainThread->Dispatch(aEvent, aDispatchFlags);
+}
+
+nsresult
+NS_DispatchToCurrentThread(nsIRunnable* aEvent)
+{
+  NS_ENSURE_TRUE(NS_IsMainThread(), NS_ERROR_NOT_AVAILABLE);
+  return gMainThread->Dispatch(aEvent, nsIEventTarget::DISPATCH_NORMAL);
+}
+
+nsresult
+NS_ProcessPendingEvents(nsIThread* aThread)
+{
+  nsCOMPtr<nsIThread> thread = aThread;
+  if (!thread) {
+    nsresult rv = NS_GetCurrentThread(getter_AddRefs(thread));
+    NS_ENSURE_SUCCESS(rv, rv);
+  }
+
+  nsresult rv;
+  bool processed;
+  do {
+    rv = thread->ProcessNextEvent(false, &processed);
+  } while (NS_SUCCEEDED(rv) && processed);
+  return rv;
+}
+
+/**
+ * Releases an object when run.
+ */
+class nsProxyReleaseEvent : public nsRunnable
+{
+public:
+  nsProxyReleaseEvent(nsISupports* aDoomed)
+    : mDoomed(aDoomed)
+  {
+  }
+
+  NS_IMETHOD Run()
+  {
+    mDoomed->Release();
+    return NS_OK;
+  }
+
+private:
+  nsISupports* mDoomed;
+};
+
+nsresult
+NS_ProxyRelease(nsIEventTarget* aTarget, nsISupports* aDoomed,
+                bool aAlwaysProxy)
+{
+  nsresult rv;
+
+  if (!aDoomed) {
+    // nothing to do
+    return NS_OK;
+  }
+
+  if (!aTarget) {
+    NS_RELEASE(aDoomed);
+    return NS_OK;
+  }
+
+  if (!aAlwaysProxy) {
+    bool onCurrentThread = false;
+    rv = aTarget->IsOnCurrentThread(&onCurrentThread);
+    if (NS_SUCCEEDED(rv) && onCurrentThread) {
+      NS_RELEASE(aDoomed);
+      return NS_OK;
+    }
+  }
+
+  nsCOMPtr<nsIRunnable> ev = new nsProxyReleaseEvent(aDoomed);
+  rv = aTarget->Dispatch(ev, nsIEventTarget::DISPATCH_NORMAL);
+  if (NS_FAILED(rv)) {
+    NS_WARNING("failed to post proxy release event");
+    // It is better to leak the aDoomed object than risk crashing as
+    // a result of deleting it on the wrong thread.
+  }
+  return rv;
+}
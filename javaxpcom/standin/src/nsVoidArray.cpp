@@ -0,0 +1,152 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * A growable array of void pointers.
+ */
+
+#include "nsVoidArray.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const PRInt32 kMinGrowArrayBy = 8;
+
+nsVoidArray::nsVoidArray()
+  : mArray(nullptr), mCount(0), mCapacity(0)
+{
+}
+
+nsVoidArray::nsVoidArray(PRInt32 aCount)
+  : mArray(nullptr), mCount(0), mCapacity(0)
+{
+  if (aCount > 0)
+    GrowArrayBy(aCount);
+}
+
+nsVoidArray::~nsVoidArray()
+{
+  free(mArray);
+}
+
+bool
+nsVoidArray::GrowArrayBy(PRInt32 aGrowBy)
+{
+  // Double the capacity, or grow by at least kMinGrowArrayBy, whichever is
+  // larger, so appends stay amortized O(1).
+  PRInt32 newCapacity = mCapacity * 2;
+  if (newCapacity < mCapacity + aGrowBy)
+    newCapacity = mCapacity + aGrowBy;
+  if (newCapacity < kMinGrowArrayBy)
+    newCapacity = kMinGrowArrayBy;
+
+  void** newArray =
+    static_cast<void**>(realloc(mArray, newCapacity * sizeof(void*)));
+  if (!newArray)
+    return false;
+
+  mArray = newArray;
+  mCapacity = newCapacity;
+  return true;
+}
+
+PRInt32
+nsVoidArray::IndexOf(void* aPossibleElement) const
+{
+  for (PRInt32 i = 0; i < mCount; i++) {
+    if (mArray[i] == aPossibleElement)
+      return i;
+  }
+  return -1;
+}
+
+bool
+nsVoidArray::InsertElementAt(void* aElement, PRInt32 aIndex)
+{
+  if (aIndex < 0 || aIndex > mCount)
+    return false;
+
+  if (mCount == mCapacity && !GrowArrayBy(1))
+    return false;
+
+  if (aIndex < mCount) {
+    memmove(mArray + aIndex + 1, mArray + aIndex,
+            (mCount - aIndex) * sizeof(void*));
+  }
+  mArray[aIndex] = aElement;
+  mCount++;
+  return true;
+}
+
+bool
+nsVoidArray::ReplaceElementAt(void* aElement, PRInt32 aIndex)
+{
+  if (aIndex < 0)
+    return false;
+
+  if (aIndex >= mCapacity && !GrowArrayBy(aIndex + 1 - mCapacity))
+    return false;
+
+  // Slots between the old end and aIndex are nulled, as in Gecko.
+  if (aIndex >= mCount) {
+    memset(mArray + mCount, 0, (aIndex - mCount) * sizeof(void*));
+    mCount = aIndex + 1;
+  }
+  mArray[aIndex] = aElement;
+  return true;
+}
+
+bool
+nsVoidArray::RemoveElementAt(PRInt32 aIndex)
+{
+  if (aIndex < 0 || aIndex >= mCount)
+    return false;
+
+  mCount--;
+  if (aIndex < mCount) {
+    memmove(mArray + aIndex, mArray + aIndex + 1,
+            (mCount - aIndex) * sizeof(void*));
+  }
+  return true;
+}
+
+bool
+nsVoidArray::RemoveElement(void* aElement)
+{
+  PRInt32 index = IndexOf(aElement);
+  return index >= 0 ? RemoveElementAt(index) : false;
+}
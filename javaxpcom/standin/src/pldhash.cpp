@@ -0,0 +1,426 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * Open-addressed hash tables with the pldhash API.
+ *
+ * Gecko's implementation uses double hashing and a collision bit in each
+ * entry's keyHash.  The stand-in probes linearly and leaves removed
+ * sentinels behind instead; the entry states callers can see are the same:
+ * keyHash 0 is free, 1 is removed and anything else is live.
+ */
+
+#include "pldhash.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PL_DHASH_MIN_SIZE       16
+#define PL_DHASH_BITS           32
+#define PL_DHASH_GOLDEN_RATIO   0x9E3779B9U
+
+#define ENTRY_IS_REMOVED(entry) ((entry)->keyHash == 1)
+#define MARK_ENTRY_FREE(entry)  ((entry)->keyHash = 0)
+#define MARK_ENTRY_REMOVED(entry) ((entry)->keyHash = 1)
+
+#define TABLE_SIZE(table)       (PRUint32(1) << (PL_DHASH_BITS - (table)->hashShift))
+#define ADDRESS_ENTRY(table, index) \
+    ((PLDHashEntryHdr*)((table)->entryStore + (index) * (table)->entrySize))
+
+/* Keep the load factor, counting removed sentinels, under 3/4. */
+#define MAX_LOAD(size)          ((size) - ((size) >> 2))
+
+/* Stub ops ******************************************************************/
+
+void*
+PL_DHashAllocTable(PLDHashTable* table, PRUint32 nbytes)
+{
+  return malloc(nbytes);
+}
+
+void
+PL_DHashFreeTable(PLDHashTable* table, void* ptr)
+{
+  free(ptr);
+}
+
+PLDHashNumber
+PL_DHashStringKey(PLDHashTable* table, const void* key)
+{
+  PLDHashNumber h = 0;
+  for (const unsigned char* s = (const unsigned char*) key; *s; s++)
+    h = ((h << 4) | (h >> 28)) ^ *s;
+  return h;
+}
+
+PLDHashNumber
+PL_DHashVoidPtrKeyStub(PLDHashTable* table, const void* key)
+{
+  return PLDHashNumber(PRUword(key) >> 2);
+}
+
+bool
+PL_DHashMatchEntryStub(PLDHashTable* table, const PLDHashEntryHdr* entry,
+                       const void* key)
+{
+  const PLDHashEntryStub* stub = (const PLDHashEntryStub*) entry;
+  return stub->key == key;
+}
+
+bool
+PL_DHashMatchStringKey(PLDHashTable* table, const PLDHashEntryHdr* entry,
+                       const void* key)
+{
+  const PLDHashEntryStub* stub = (const PLDHashEntryStub*) entry;
+
+  // XXX tolerate null keys on account of sloppy Mozilla callers.
+  return stub->key == key ||
+         (stub->key && key &&
+          strcmp((const char*) stub->key, (const char*) key) == 0);
+}
+
+void
+PL_DHashMoveEntryStub(PLDHashTable* table, const PLDHashEntryHdr* from,
+                      PLDHashEntryHdr* to)
+{
+  memcpy(to, from, table->entrySize);
+}
+
+void
+PL_DHashClearEntryStub(PLDHashTable* table, PLDHashEntryHdr* entry)
+{
+  memset(entry, 0, table->entrySize);
+}
+
+void
+PL_DHashFinalizeStub(PLDHashTable* table)
+{
+}
+
+static const PLDHashTableOps stub_ops = {
+  PL_DHashAllocTable,
+  PL_DHashFreeTable,
+  PL_DHashVoidPtrKeyStub,
+  PL_DHashMatchEntryStub,
+  PL_DHashMoveEntryStub,
+  PL_DHashClearEntryStub,
+  PL_DHashFinalizeStub,
+  nullptr
+};
+
+const PLDHashTableOps*
+PL_DHashGetStubOps(void)
+{
+  return &stub_ops;
+}
+
+/* Tables ********************************************************************/
+
+PLDHashTable*
+PL_NewDHashTable(const PLDHashTableOps* ops, void* data, PRUint32 entrySize,
+                 PRUint32 capacity)
+{
+  PLDHashTable* table = (PLDHashTable*) malloc(sizeof(*table));
+  if (!table)
+    return nullptr;
+  if (!PL_DHashTableInit(table, ops, data, entrySize, capacity)) {
+    free(table);
+    return nullptr;
+  }
+  return table;
+}
+
+void
+PL_DHashTableDestroy(PLDHashTable* table)
+{
+  PL_DHashTableFinish(table);
+  free(table);
+}
+
+static PRIntn
+CeilingLog2(PRUint32 n)
+{
+  PRIntn log2 = 0;
+  while ((PRUint32(1) << log2) < n)
+    log2++;
+  return log2;
+}
+
+bool
+PL_DHashTableInit(PLDHashTable* table, const PLDHashTableOps* ops, void* data,
+                  PRUint32 entrySize, PRUint32 capacity)
+{
+  table->ops = ops;
+  table->data = data;
+
+  // 'capacity' is the number of entries the caller expects; size the table
+  // so that many fit under the maximum load.
+  PRUint32 size = capacity + (capacity >> 1) + 1;
+  if (size < PL_DHASH_MIN_SIZE)
+    size = PL_DHASH_MIN_SIZE;
+  PRIntn log2 = CeilingLog2(size);
+  if (log2 >= PL_DHASH_BITS - 1)
+    return false;
+
+  table->hashShift = PRInt16(PL_DHASH_BITS - log2);
+  table->entrySize = entrySize;
+  table->entryCount = table->removedCount = 0;
+  table->generation = 0;
+
+  PRUint32 nbytes = (PRUint32(1) << log2) * entrySize;
+  table->entryStore = (char*) ops->allocTable(table, nbytes);
+  if (!table->entryStore)
+    return false;
+  memset(table->entryStore, 0, nbytes);
+  return true;
+}
+
+void
+PL_DHashTableFinish(PLDHashTable* table)
+{
+  table->ops->finalize(table);
+
+  PRUint32 size = TABLE_SIZE(table);
+  for (PRUint32 i = 0; i < size; i++) {
+    PLDHashEntryHdr* entry = ADDRESS_ENTRY(table, i);
+    if (PL_DHASH_ENTRY_IS_LIVE(entry))
+      table->ops->clearEntry(table, entry);
+  }
+
+  table->ops->freeTable(table, table->entryStore);
+  table->entryStore = nullptr;
+}
+
+static PLDHashNumber
+ComputeKeyHash(PLDHashTable* table, const void* key)
+{
+  PLDHashNumber keyHash = table->ops->hashKey(table, key);
+  keyHash *= PL_DHASH_GOLDEN_RATIO;
+
+  // Avoid 0 and 1 hash codes, they indicate free and removed entries.
+  if (keyHash < 2)
+    keyHash -= 2;
+  return keyHash;
+}
+
+/*
+ * Returns the live entry for 'key' if there is one.  Otherwise returns the
+ * slot an insertion should use: the first removed sentinel on the probe
+ * path, or the free entry that ended it.
+ */
+static PLDHashEntryHdr*
+SearchTable(PLDHashTable* table, const void* key, PLDHashNumber keyHash)
+{
+  PRUint32 sizeMask = TABLE_SIZE(table) - 1;
+  PRUint32 index = keyHash >> table->hashShift;
+  PLDHashMatchEntry matchEntry = table->ops->matchEntry;
+  PLDHashEntryHdr* firstRemoved = nullptr;
+
+  for (;;) {
+    PLDHashEntryHdr* entry = ADDRESS_ENTRY(table, index);
+    if (PL_DHASH_ENTRY_IS_FREE(entry))
+      return firstRemoved ? firstRemoved : entry;
+
+    if (ENTRY_IS_REMOVED(entry)) {
+      if (!firstRemoved)
+        firstRemoved = entry;
+    } else if (entry->keyHash == keyHash && matchEntry(table, entry, key)) {
+      return entry;
+    }
+
+    index = (index + 1) & sizeMask;
+  }
+}
+
+/* Like SearchTable, for rehashing: no keys match and nothing is removed. */
+static PLDHashEntryHdr*
+FindFreeEntry(PLDHashTable* table, PLDHashNumber keyHash)
+{
+  PRUint32 sizeMask = TABLE_SIZE(table) - 1;
+  PRUint32 index = keyHash >> table->hashShift;
+  for (;;) {
+    PLDHashEntryHdr* entry = ADDRESS_ENTRY(table, index);
+    if (PL_DHASH_ENTRY_IS_FREE(entry))
+      return entry;
+    index = (index + 1) & sizeMask;
+  }
+}
+
+static bool
+ChangeTable(PLDHashTable* table, PRIntn deltaLog2)
+{
+  PRIntn oldLog2 = PL_DHASH_BITS - table->hashShift;
+  PRIntn newLog2 = oldLog2 + deltaLog2;
+  if (newLog2 >= PL_DHASH_BITS - 1)
+    return false;
+
+  PRUint32 oldSize = PRUint32(1) << oldLog2;
+  PRUint32 newSize = PRUint32(1) << newLog2;
+  PRUint32 nbytes = newSize * table->entrySize;
+  char* newEntryStore = (char*) table->ops->allocTable(table, nbytes);
+  if (!newEntryStore)
+    return false;
+  memset(newEntryStore, 0, nbytes);
+
+  char* oldEntryStore = table->entryStore;
+  table->hashShift = PRInt16(PL_DHASH_BITS - newLog2);
+  table->removedCount = 0;
+  table->generation++;
+  table->entryStore = newEntryStore;
+
+  PLDHashMoveEntry moveEntry = table->ops->moveEntry;
+  for (PRUint32 i = 0; i < oldSize; i++) {
+    PLDHashEntryHdr* oldEntry =
+      (PLDHashEntryHdr*)(oldEntryStore + i * table->entrySize);
+    if (PL_DHASH_ENTRY_IS_LIVE(oldEntry)) {
+      PLDHashEntryHdr* newEntry = FindFreeEntry(table, oldEntry->keyHash);
+      moveEntry(table, oldEntry, newEntry);
+      newEntry->keyHash = oldEntry->keyHash;
+    }
+  }
+
+  table->ops->freeTable(table, oldEntryStore);
+  return true;
+}
+
+PLDHashEntryHdr*
+PL_DHashTableOperate(PLDHashTable* table, const void* key, PLDHashOperator op)
+{
+  PLDHashNumber keyHash = ComputeKeyHash(table, key);
+  PLDHashEntryHdr* entry;
+
+  switch (op) {
+    case PL_DHASH_LOOKUP:
+      return SearchTable(table, key, keyHash);
+
+    case PL_DHASH_ADD:
+    {
+      PRUint32 size = TABLE_SIZE(table);
+      if (table->entryCount + table->removedCount + 1 > MAX_LOAD(size)) {
+        // Compress if a quarter or more of the slots are sentinels,
+        // otherwise grow.
+        PRIntn deltaLog2 = (table->removedCount >= (size >> 2)) ? 0 : 1;
+        if (!ChangeTable(table, deltaLog2) &&
+            table->entryCount + table->removedCount + 1 >= size) {
+          return nullptr;
+        }
+      }
+
+      entry = SearchTable(table, key, keyHash);
+      if (!PL_DHASH_ENTRY_IS_LIVE(entry)) {
+        if (table->ops->initEntry &&
+            !table->ops->initEntry(table, entry, key)) {
+          // We haven't claimed entry yet; fail with null return.
+          memset(entry + 1, 0, table->entrySize - sizeof(*entry));
+          return nullptr;
+        }
+        if (ENTRY_IS_REMOVED(entry))
+          table->removedCount--;
+        entry->keyHash = keyHash;
+        table->entryCount++;
+      }
+      return entry;
+    }
+
+    case PL_DHASH_REMOVE:
+      entry = SearchTable(table, key, keyHash);
+      if (PL_DHASH_ENTRY_IS_LIVE(entry))
+        PL_DHashTableRawRemove(table, entry);
+      return nullptr;
+
+    default:
+      return nullptr;
+  }
+}
+
+PLDHashEntryHdr*
+PL_DHashTableSearch(PLDHashTable* table, const void* key)
+{
+  PLDHashEntryHdr* entry = PL_DHashTableOperate(table, key, PL_DHASH_LOOKUP);
+  return PL_DHASH_ENTRY_IS_LIVE(entry) ? entry : nullptr;
+}
+
+PLDHashEntryHdr*
+PL_DHashTableAdd(PLDHashTable* table, const void* key)
+{
+  return PL_DHashTableOperate(table, key, PL_DHASH_ADD);
+}
+
+void
+PL_DHashTableRemove(PLDHashTable* table, const void* key)
+{
+  PL_DHashTableOperate(table, key, PL_DHASH_REMOVE);
+}
+
+void
+PL_DHashTableRawRemove(PLDHashTable* table, PLDHashEntryHdr* entry)
+{
+  table->ops->clearEntry(table, entry);
+
+  // A removed sentinel is only needed if a later entry's probe path may
+  // run through this slot.
+  PRUint32 index = PRUint32(((char*) entry - table->entryStore) /
+                            table->entrySize);
+  PRUint32 next = (index + 1) & (TABLE_SIZE(table) - 1);
+  if (PL_DHASH_ENTRY_IS_FREE(ADDRESS_ENTRY(table, next))) {
+    MARK_ENTRY_FREE(entry);
+  } else {
+    MARK_ENTRY_REMOVED(entry);
+    table->removedCount++;
+  }
+  table->entryCount--;
+}
+
+PRUint32
+PL_DHashTableEnumerate(PLDHashTable* table, PLDHashEnumerator etor, void* arg)
+{
+  PRUint32 size = TABLE_SIZE(table);
+  PRUint32 i = 0;
+
+  for (PRUint32 index = 0; index < size; index++) {
+    PLDHashEntryHdr* entry = ADDRESS_ENTRY(table, index);
+    if (PL_DHASH_ENTRY_IS_LIVE(entry)) {
+      PLDHashOperator op = etor(table, entry, i++, arg);
+      if (op & PL_DHASH_REMOVE)
+        PL_DHashTableRawRemove(table, entry);
+      if (op & PL_DHASH_STOP)
+        break;
+    }
+  }
+
+  return i;
+}
@@ -0,0 +1,337 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * PL hash tables: chained hashing as in NSPR's plhash.c.
+ */
+
+#include "plhash.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PL_HASH_GOLDEN_RATIO 0x9E3779B9U
+#define MINBUCKETSLOG2       4
+#define MINBUCKETS           (1 << MINBUCKETSLOG2)
+
+/* Compute the number of buckets in ht */
+#define NBUCKETS(ht)    (1 << (PL_HASH_BITS - (ht)->shift))
+
+/* The smallest table has 16 buckets */
+#define OVERLOADED(n)   ((n) - ((n) >> 3))
+#define UNDERLOADED(n)  (((n) > MINBUCKETS) ? ((n) >> 2) : 0)
+
+static void* PR_CALLBACK
+DefaultAllocTable(void* pool, PRSize size)
+{
+  return malloc(size);
+}
+
+static void PR_CALLBACK
+DefaultFreeTable(void* pool, void* item)
+{
+  free(item);
+}
+
+static PLHashEntry* PR_CALLBACK
+DefaultAllocEntry(void* pool, const void* key)
+{
+  return (PLHashEntry*) malloc(sizeof(PLHashEntry));
+}
+
+static void PR_CALLBACK
+DefaultFreeEntry(void* pool, PLHashEntry* he, PRUintn flag)
+{
+  if (flag == HT_FREE_ENTRY)
+    free(he);
+}
+
+static const PLHashAllocOps defaultHashAllocOps = {
+  DefaultAllocTable, DefaultFreeTable,
+  DefaultAllocEntry, DefaultFreeEntry
+};
+
+PLHashTable*
+PL_NewHashTable(PRUint32 n, PLHashFunction keyHash,
+                PLHashComparator keyCompare, PLHashComparator valueCompare,
+                const PLHashAllocOps* allocOps, void* allocPriv)
+{
+  if (n <= MINBUCKETS) {
+    n = MINBUCKETSLOG2;
+  } else {
+    PRUint32 log2 = 0;
+    while ((PRUint32(1) << log2) < n)
+      log2++;
+    n = log2;
+  }
+
+  if (!allocOps)
+    allocOps = &defaultHashAllocOps;
+
+  PLHashTable* ht =
+    (PLHashTable*) allocOps->allocTable(allocPriv, sizeof(*ht));
+  if (!ht)
+    return NULL;
+  memset(ht, 0, sizeof(*ht));
+  ht->shift = PL_HASH_BITS - n;
+  n = 1 << n;
+
+  PRSize nb = n * sizeof(PLHashEntry*);
+  ht->buckets = (PLHashEntry**) allocOps->allocTable(allocPriv, nb);
+  if (!ht->buckets) {
+    allocOps->freeTable(allocPriv, ht);
+    return NULL;
+  }
+  memset(ht->buckets, 0, nb);
+
+  ht->keyHash = keyHash;
+  ht->keyCompare = keyCompare;
+  ht->valueCompare = valueCompare;
+  ht->allocOps = allocOps;
+  ht->allocPriv = allocPriv;
+  return ht;
+}
+
+void
+PL_HashTableDestroy(PLHashTable* ht)
+{
+  const PLHashAllocOps* allocOps = ht->allocOps;
+  void* allocPriv = ht->allocPriv;
+
+  PRUint32 n = NBUCKETS(ht);
+  for (PRUint32 i = 0; i < n; i++) {
+    PLHashEntry* next;
+    for (PLHashEntry* he = ht->buckets[i]; he; he = next) {
+      next = he->next;
+      allocOps->freeEntry(allocPriv, he, HT_FREE_ENTRY);
+    }
+  }
+
+  allocOps->freeTable(allocPriv, ht->buckets);
+  allocOps->freeTable(allocPriv, ht);
+}
+
+static PLHashEntry**
+BucketHead(PLHashTable* ht, PLHashNumber keyHash)
+{
+  PLHashNumber h = keyHash * PL_HASH_GOLDEN_RATIO;
+  h >>= ht->shift;
+  return &ht->buckets[h];
+}
+
+PLHashEntry**
+PL_HashTableRawLookup(PLHashTable* ht, PLHashNumber keyHash, const void* key)
+{
+  PLHashEntry** hep0 = BucketHead(ht, keyHash);
+  PLHashEntry** hep = hep0;
+  PLHashEntry* he;
+
+  while ((he = *hep) != 0) {
+    if (he->keyHash == keyHash && (*ht->keyCompare)(key, he->key)) {
+      // Move to front of chain if not already there
+      if (hep != hep0) {
+        *hep = he->next;
+        he->next = *hep0;
+        *hep0 = he;
+        return hep0;
+      }
+      return hep;
+    }
+    hep = &he->next;
+  }
+  return hep;
+}
+
+static PRBool
+Resize(PLHashTable* ht, PRInt32 aDeltaShift)
+{
+  PRUint32 oldSize = NBUCKETS(ht);
+  PLHashEntry** oldbuckets = ht->buckets;
+
+  PRUint32 newShift = ht->shift - aDeltaShift;
+  PRUint32 newSize = PRUint32(1) << (PL_HASH_BITS - newShift);
+  PRSize nb = newSize * sizeof(PLHashEntry*);
+  PLHashEntry** newbuckets =
+    (PLHashEntry**) ht->allocOps->allocTable(ht->allocPriv, nb);
+  if (!newbuckets)
+    return PR_FALSE;
+  memset(newbuckets, 0, nb);
+
+  ht->shift = newShift;
+  ht->buckets = newbuckets;
+
+  for (PRUint32 i = 0; i < oldSize; i++) {
+    PLHashEntry* next;
+    for (PLHashEntry* he = oldbuckets[i]; he; he = next) {
+      next = he->next;
+      PLHashEntry** hep = BucketHead(ht, he->keyHash);
+      he->next = *hep;
+      *hep = he;
+    }
+  }
+
+  ht->allocOps->freeTable(ht->allocPriv, oldbuckets);
+  return PR_TRUE;
+}
+
+PLHashEntry*
+PL_HashTableRawAdd(PLHashTable* ht, PLHashEntry** hep, PLHashNumber keyHash,
+                   const void* key, void* value)
+{
+  // Grow the table if it is overloaded
+  PRUint32 n = NBUCKETS(ht);
+  if (ht->nentries >= OVERLOADED(n)) {
+    if (!Resize(ht, 1))
+      return NULL;
+    hep = PL_HashTableRawLookup(ht, keyHash, key);
+  }
+
+  // Make a new key value entry
+  PLHashEntry* he = ht->allocOps->allocEntry(ht->allocPriv, key);
+  if (!he)
+    return NULL;
+  he->keyHash = keyHash;
+  he->key = key;
+  he->value = value;
+  he->next = *hep;
+  *hep = he;
+  ht->nentries++;
+  return he;
+}
+
+PLHashEntry*
+PL_HashTableAdd(PLHashTable* ht, const void* key, void* value)
+{
+  PLHashNumber keyHash = (*ht->keyHash)(key);
+  PLHashEntry** hep = PL_HashTableRawLookup(ht, keyHash, key);
+  PLHashEntry* he = *hep;
+  if (he) {
+    // Hit; see if values match
+    if ((*ht->valueCompare)(he->value, value)) {
+      // key,value pair is already present in table
+      return he;
+    }
+    if (he->value)
+      ht->allocOps->freeEntry(ht->allocPriv, he, HT_FREE_VALUE);
+    he->value = value;
+    return he;
+  }
+  return PL_HashTableRawAdd(ht, hep, keyHash, key, value);
+}
+
+void
+PL_HashTableRawRemove(PLHashTable* ht, PLHashEntry** hep, PLHashEntry* he)
+{
+  *hep = he->next;
+  ht->allocOps->freeEntry(ht->allocPriv, he, HT_FREE_ENTRY);
+
+  // Shrink table if it's underloaded
+  PRUint32 n = NBUCKETS(ht);
+  if (--ht->nentries < UNDERLOADED(n))
+    Resize(ht, -1);
+}
+
+PRBool
+PL_HashTableRemove(PLHashTable* ht, const void* key)
+{
+  PLHashNumber keyHash = (*ht->keyHash)(key);
+  PLHashEntry** hep = PL_HashTableRawLookup(ht, keyHash, key);
+  PLHashEntry* he = *hep;
+  if (!he)
+    return PR_FALSE;
+
+  // Hit; remove element
+  PL_HashTableRawRemove(ht, hep, he);
+  return PR_TRUE;
+}
+
+void*
+PL_HashTableLookup(PLHashTable* ht, const void* key)
+{
+  PLHashNumber keyHash = (*ht->keyHash)(key);
+  PLHashEntry** hep = PL_HashTableRawLookup(ht, keyHash, key);
+  return *hep ? (*hep)->value : NULL;
+}
+
+PRIntn
+PL_HashTableEnumerateEntries(PLHashTable* ht, PLHashEnumerator f, void* arg)
+{
+  PRIntn n = 0;
+  PRUint32 nbuckets = NBUCKETS(ht);
+  PLHashEntry** hep;
+  PLHashEntry* he;
+
+  for (PRUint32 i = 0; i < nbuckets; i++) {
+    hep = &ht->buckets[i];
+    while ((he = *hep) != 0) {
+      PRIntn rv = (*f)(he, n, arg);
+      n++;
+      if (rv & HT_ENUMERATE_REMOVE) {
+        // Unlink without shrinking; the loop is walking the buckets.
+        *hep = he->next;
+        ht->allocOps->freeEntry(ht->allocPriv, he, HT_FREE_ENTRY);
+        ht->nentries--;
+      } else {
+        hep = &he->next;
+      }
+      if (rv & HT_ENUMERATE_STOP)
+        return n;
+    }
+  }
+  return n;
+}
+
+PLHashNumber
+PL_HashString(const void* key)
+{
+  PLHashNumber h = 0;
+  for (const unsigned char* s = (const unsigned char*) key; *s; s++)
+    h = ((h << 4) | (h >> 28)) ^ *s;
+  return h;
+}
+
+PRIntn
+PL_CompareStrings(const void* v1, const void* v2)
+{
+  return strcmp((const char*) v1, (const char*) v2) == 0;
+}
+
+PRIntn
+PL_CompareValues(const void* v1, const void* v2)
+{
+  return v1 == v2;
+}
@@ -0,0 +1,630 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * The parts of NSPR that the bridge and the stand-in use, implemented on
+ * top of pthreads and libc.
+ */
+
+#include "prlock.h"
+#include "prmon.h"
+#include "prcmon.h"
+#include "prthread.h"
+#include "prinit.h"
+#include "prinrval.h"
+#include "prmem.h"
+#include "prprf.h"
+#include "prenv.h"
+#include "pratom.h"
+#include "prlog.h"
+#include "mozilla/TimeStamp.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Locks *********************************************************************/
+
+struct PRLock
+{
+  pthread_mutex_t mutex;
+};
+
+PRLock*
+PR_NewLock(void)
+{
+  PRLock* lock = PR_NEW(PRLock);
+  if (!lock)
+    return NULL;
+  pthread_mutex_init(&lock->mutex, NULL);
+  return lock;
+}
+
+void
+PR_DestroyLock(PRLock* lock)
+{
+  pthread_mutex_destroy(&lock->mutex);
+  PR_Free(lock);
+}
+
+void
+PR_Lock(PRLock* lock)
+{
+  pthread_mutex_lock(&lock->mutex);
+}
+
+PRStatus
+PR_Unlock(PRLock* lock)
+{
+  return pthread_mutex_unlock(&lock->mutex) == 0 ? PR_SUCCESS : PR_FAILURE;
+}
+
+/* Monitors ******************************************************************/
+
+struct PRMonitor
+{
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+  pthread_t       owner;
+  PRUint32        entryCount;
+};
+
+PRMonitor*
+PR_NewMonitor(void)
+{
+  PRMonitor* mon = PR_NEWZAP(PRMonitor);
+  if (!mon)
+    return NULL;
+  pthread_mutex_init(&mon->mutex, NULL);
+  pthread_cond_init(&mon->cond, NULL);
+  return mon;
+}
+
+void
+PR_DestroyMonitor(PRMonitor* mon)
+{
+  pthread_cond_destroy(&mon->cond);
+  pthread_mutex_destroy(&mon->mutex);
+  PR_Free(mon);
+}
+
+// |owner| is zero whenever no thread holds the monitor.  Only the holder
+// writes it, so a thread that reads its own id there already owns 'mon'.
+static PRBool
+IsMonitorOwner(PRMonitor* mon)
+{
+  return __atomic_load_n(&mon->owner, __ATOMIC_RELAXED) == pthread_self();
+}
+
+void
+PR_EnterMonitor(PRMonitor* mon)
+{
+  if (IsMonitorOwner(mon)) {
+    mon->entryCount++;
+    return;
+  }
+  pthread_mutex_lock(&mon->mutex);
+  __atomic_store_n(&mon->owner, pthread_self(), __ATOMIC_RELAXED);
+  mon->entryCount = 1;
+}
+
+PRStatus
+PR_ExitMonitor(PRMonitor* mon)
+{
+  if (!IsMonitorOwner(mon))
+    return PR_FAILURE;
+  if (--mon->entryCount == 0) {
+    __atomic_store_n(&mon->owner, pthread_t(0), __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&mon->mutex);
+  }
+  return PR_SUCCESS;
+}
+
+PRStatus
+PR_Wait(PRMonitor* mon, PRIntervalTime ticks)
+{
+  if (!IsMonitorOwner(mon))
+    return PR_FAILURE;
+
+  PRUint32 savedCount = mon->entryCount;
+  mon->entryCount = 0;
+  __atomic_store_n(&mon->owner, pthread_t(0), __ATOMIC_RELAXED);
+
+  int rv;
+  if (ticks == PR_INTERVAL_NO_TIMEOUT) {
+    rv = pthread_cond_wait(&mon->cond, &mon->mutex);
+  } else {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    PRUint64 nsec = PRUint64(deadline.tv_nsec) +
+                    PRUint64(PR_IntervalToMicroseconds(ticks)) * 1000;
+    deadline.tv_sec += time_t(nsec / 1000000000);
+    deadline.tv_nsec = long(nsec % 1000000000);
+    rv = pthread_cond_timedwait(&mon->cond, &mon->mutex, &deadline);
+  }
+
+  __atomic_store_n(&mon->owner, pthread_self(), __ATOMIC_RELAXED);
+  mon->entryCount = savedCount;
+  return (rv == 0 || rv == ETIMEDOUT) ? PR_SUCCESS : PR_FAILURE;
+}
+
+PRStatus
+PR_Notify(PRMonitor* mon)
+{
+  pthread_cond_signal(&mon->cond);
+  return PR_SUCCESS;
+}
+
+PRStatus
+PR_NotifyAll(PRMonitor* mon)
+{
+  pthread_cond_broadcast(&mon->cond);
+  return PR_SUCCESS;
+}
+
+/* Cached monitors ***********************************************************/
+
+/*
+ * Each address gets its own monitor, kept in a small chained hash table for
+ * the life of the process.  NSPR recycles idle cached monitors; the bridge
+ * only uses a handful of addresses, so the stand-in never does, and the
+ * recycle callback is accepted but never called.
+ */
+
+struct CMonEntry
+{
+  void*      address;
+  PRMonitor* mon;
+  CMonEntry* next;
+};
+
+#define CMON_HASH_SIZE 64
+
+static pthread_mutex_t gCMonLock = PTHREAD_MUTEX_INITIALIZER;
+static CMonEntry* gCMonTable[CMON_HASH_SIZE];
+
+static PRMonitor*
+LookupCMonitor(void* address, PRBool aCreate)
+{
+  PRUint32 bucket = PRUint32((PRUword(address) >> 3) % CMON_HASH_SIZE);
+
+  pthread_mutex_lock(&gCMonLock);
+  CMonEntry* entry = gCMonTable[bucket];
+  while (entry && entry->address != address)
+    entry = entry->next;
+
+  if (!entry && aCreate) {
+    entry = PR_NEW(CMonEntry);
+    if (entry) {
+      entry->address = address;
+      entry->mon = PR_NewMonitor();
+      entry->next = gCMonTable[bucket];
+      gCMonTable[bucket] = entry;
+    }
+  }
+  pthread_mutex_unlock(&gCMonLock);
+
+  return entry ? entry->mon : NULL;
+}
+
+PRMonitor*
+PR_CEnterMonitor(void* address)
+{
+  PRMonitor* mon = LookupCMonitor(address, PR_TRUE);
+  if (mon)
+    PR_EnterMonitor(mon);
+  return mon;
+}
+
+PRStatus
+PR_CExitMonitor(void* address)
+{
+  PRMonitor* mon = LookupCMonitor(address, PR_FALSE);
+  return mon ? PR_ExitMonitor(mon) : PR_FAILURE;
+}
+
+PRStatus
+PR_CWait(void* address, PRIntervalTime ticks)
+{
+  PRMonitor* mon = LookupCMonitor(address, PR_FALSE);
+  return mon ? PR_Wait(mon, ticks) : PR_FAILURE;
+}
+
+PRStatus
+PR_CNotify(void* address)
+{
+  PRMonitor* mon = LookupCMonitor(address, PR_FALSE);
+  return mon ? PR_Notify(mon) : PR_FAILURE;
+}
+
+PRStatus
+PR_CNotifyAll(void* address)
+{
+  PRMonitor* mon = LookupCMonitor(address, PR_FALSE);
+  return mon ? PR_NotifyAll(mon) : PR_FAILURE;
+}
+
+void
+PR_CSetOnMonitorRecycle(void (PR_CALLBACK* callback)(void* address))
+{
+}
+
+/* Threads *******************************************************************/
+
+struct PRThread
+{
+  char* name;
+};
+
+static pthread_key_t gThreadKey;
+static pthread_once_t gThreadKeyOnce = PTHREAD_ONCE_INIT;
+
+static void
+DestroyPRThread(void* aThread)
+{
+  PRThread* thread = static_cast<PRThread*>(aThread);
+  free(thread->name);
+  PR_Free(thread);
+}
+
+static void
+CreateThreadKey()
+{
+  pthread_key_create(&gThreadKey, DestroyPRThread);
+}
+
+PRThread*
+PR_GetCurrentThread(void)
+{
+  pthread_once(&gThreadKeyOnce, CreateThreadKey);
+  PRThread* thread = static_cast<PRThread*>(pthread_getspecific(gThreadKey));
+  if (!thread) {
+    thread = PR_NEWZAP(PRThread);
+    pthread_setspecific(gThreadKey, thread);
+  }
+  return thread;
+}
+
+const char*
+PR_GetThreadName(const PRThread* thread)
+{
+  return thread ? thread->name : NULL;
+}
+
+PRStatus
+PR_SetCurrentThreadName(const char* name)
+{
+  PRThread* thread = PR_GetCurrentThread();
+  if (!thread)
+    return PR_FAILURE;
+  free(thread->name);
+  thread->name = name ? strdup(name) : NULL;
+  return PR_SUCCESS;
+}
+
+PRStatus
+PR_NewThreadPrivateIndex(PRUintn* newIndex, PRThreadPrivateDTOR destructor)
+{
+  pthread_key_t key;
+  if (pthread_key_create(&key, destructor) != 0)
+    return PR_FAILURE;
+  *newIndex = PRUintn(key);
+  return PR_SUCCESS;
+}
+
+PRStatus
+PR_SetThreadPrivate(PRUintn tpdIndex, void* priv)
+{
+  return pthread_setspecific(pthread_key_t(tpdIndex), priv) == 0 ?
+           PR_SUCCESS : PR_FAILURE;
+}
+
+void*
+PR_GetThreadPrivate(PRUintn tpdIndex)
+{
+  return pthread_getspecific(pthread_key_t(tpdIndex));
+}
+
+/* Initialization ************************************************************/
+
+static pthread_mutex_t gCallOnceLock = PTHREAD_MUTEX_INITIALIZER;
+
+PRStatus
+PR_CallOnce(PRCallOnceType* once, PRCallOnceFN func)
+{
+  if (__atomic_load_n(&once->initialized, __ATOMIC_ACQUIRE))
+    return once->status;
+
+  // Holding one lock for every PRCallOnceType serializes unrelated
+  // initializers, but they are rare and short.
+  pthread_mutex_lock(&gCallOnceLock);
+  if (!once->initialized) {
+    once->inProgress = 1;
+    once->status = func();
+    once->inProgress = 0;
+    __atomic_store_n(&once->initialized, 1, __ATOMIC_RELEASE);
+  }
+  pthread_mutex_unlock(&gCallOnceLock);
+
+  return once->status;
+}
+
+/* Intervals *****************************************************************/
+
+PRIntervalTime
+PR_IntervalNow(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return PRIntervalTime(PRUint64(now.tv_sec) * 1000000 +
+                        PRUint64(now.tv_nsec) / 1000);
+}
+
+PRUint32
+PR_TicksPerSecond(void)
+{
+  return 1000000;
+}
+
+PRIntervalTime
+PR_SecondsToInterval(PRUint32 seconds)
+{
+  return seconds * 1000000;
+}
+
+PRIntervalTime
+PR_MillisecondsToInterval(PRUint32 milli)
+{
+  return milli * 1000;
+}
+
+PRIntervalTime
+PR_MicrosecondsToInterval(PRUint32 micro)
+{
+  return micro;
+}
+
+PRUint32
+PR_IntervalToSeconds(PRIntervalTime ticks)
+{
+  return ticks / 1000000;
+}
+
+PRUint32
+PR_IntervalToMilliseconds(PRIntervalTime ticks)
+{
+  return ticks / 1000;
+}
+
+PRUint32
+PR_IntervalToMicroseconds(PRIntervalTime ticks)
+{
+  return ticks;
+}
+
+mozilla::TimeStamp
+mozilla::TimeStamp::Now()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return TimeStamp(PRUint64(now.tv_sec) * 1000000000 + PRUint64(now.tv_nsec));
+}
+
+/* Memory ********************************************************************/
+
+void*
+PR_Malloc(PRUint32 size)
+{
+  return malloc(size);
+}
+
+void*
+PR_Calloc(PRUint32 nelem, PRUint32 elsize)
+{
+  return calloc(nelem, elsize);
+}
+
+void*
+PR_Realloc(void* ptr, PRUint32 size)
+{
+  return realloc(ptr, size);
+}
+
+void
+PR_Free(void* ptr)
+{
+  free(ptr);
+}
+
+/* Formatting ****************************************************************/
+
+/*
+ * NSPR has its own printf engine.  The bridge only uses conversions that
+ * mean the same thing to libc, so the stand-in forwards to it.
+ */
+
+PRUint32
+PR_snprintf(char* out, PRUint32 outlen, const char* fmt, ...)
+{
+  if (outlen == 0)
+    return 0;
+
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(out, outlen, fmt, ap);
+  va_end(ap);
+
+  if (n < 0)
+    return PRUint32(-1);
+  return PRUint32(n) < outlen ? PRUint32(n) : outlen - 1;
+}
+
+char*
+PR_vsmprintf(const char* fmt, va_list ap)
+{
+  va_list copy;
+  va_copy(copy, ap);
+  int n = vsnprintf(NULL, 0, fmt, copy);
+  va_end(copy);
+  if (n < 0)
+    return NULL;
+
+  char* result = static_cast<char*>(PR_Malloc(PRUint32(n) + 1));
+  if (result)
+    vsnprintf(result, size_t(n) + 1, fmt, ap);
+  return result;
+}
+
+char*
+PR_smprintf(const char* fmt, ...)
+{
+  va_list ap;
+  va_start(ap, fmt);
+  char* result = PR_vsmprintf(fmt, ap);
+  va_end(ap);
+  return result;
+}
+
+void
+PR_smprintf_free(char* mem)
+{
+  PR_Free(mem);
+}
+
+/* Environment ***************************************************************/
+
+char*
+PR_GetEnv(const char* var)
+{
+  return getenv(var);
+}
+
+/* Atomics *******************************************************************/
+
+PRInt32
+PR_AtomicIncrement(PRInt32* val)
+{
+  return __atomic_add_fetch(val, 1, __ATOMIC_SEQ_CST);
+}
+
+PRInt32
+PR_AtomicDecrement(PRInt32* val)
+{
+  return __atomic_sub_fetch(val, 1, __ATOMIC_SEQ_CST);
+}
+
+PRInt32
+PR_AtomicSet(PRInt32* val, PRInt32 newval)
+{
+  return __atomic_exchange_n(val, newval, __ATOMIC_SEQ_CST);
+}
+
+PRInt32
+PR_AtomicAdd(PRInt32* ptr, PRInt32 val)
+{
+  return __atomic_add_fetch(ptr, val, __ATOMIC_SEQ_CST);
+}
+
+/* Logging *******************************************************************/
+
+/*
+ * NSPR_LOG_MODULES takes the same "name:level,name:level" list as NSPR;
+ * "all" applies to every module.  Output always goes to stderr.
+ */
+
+static pthread_mutex_t gLogLock = PTHREAD_MUTEX_INITIALIZER;
+static PRLogModuleInfo* gLogModules = NULL;
+
+static PRLogModuleLevel
+GetConfiguredLevel(const char* name)
+{
+  const char* modules = getenv("NSPR_LOG_MODULES");
+  if (!modules)
+    return PR_LOG_NONE;
+
+  PRLogModuleLevel level = PR_LOG_NONE;
+  size_t nameLen = strlen(name);
+  const char* p = modules;
+  while (*p) {
+    const char* end = strchr(p, ',');
+    if (!end)
+      end = p + strlen(p);
+
+    const char* colon = static_cast<const char*>(memchr(p, ':', end - p));
+    size_t entryLen = colon ? size_t(colon - p) : size_t(end - p);
+    int entryLevel = colon ? atoi(colon + 1) : PR_LOG_DEBUG;
+
+    if ((entryLen == nameLen && strncmp(p, name, nameLen) == 0) ||
+        (entryLen == 3 && strncmp(p, "all", 3) == 0)) {
+      level = PRLogModuleLevel(entryLevel);
+    }
+
+    p = *end ? end + 1 : end;
+  }
+  return level;
+}
+
+PRLogModuleInfo*
+PR_NewLogModule(const char* name)
+{
+  PRLogModuleInfo* module = PR_NEWZAP(PRLogModuleInfo);
+  if (!module)
+    return NULL;
+  module->name = strdup(name);
+  module->level = GetConfiguredLevel(name);
+
+  pthread_mutex_lock(&gLogLock);
+  module->next = gLogModules;
+  gLogModules = module;
+  pthread_mutex_unlock(&gLogLock);
+
+  return module;
+}
+
+void
+PR_LogPrint(const char* fmt, ...)
+{
+  va_list ap;
+  va_start(ap, fmt);
+  pthread_mutex_lock(&gLogLock);
+  vfprintf(stderr, fmt, ap);
+  pthread_mutex_unlock(&gLogLock);
+  va_end(ap);
+}
@@ -0,0 +1,392 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * NS_InvokeByIndex and the xptcall stubs, without assembly.
+ *
+ * Gecko needs per-platform assembly for both directions.  On the two
+ * calling conventions the stand-in supports, a plain C++ function with a
+ * fixed signature can stand in for it instead:
+ *
+ *   (this, N integer slots, 8 doubles, 16 stack slots)
+ *
+ * where N is the number of integer argument registers left after 'this'
+ * (5 on x86-64 System V, 7 on AArch64).  Both ABIs assign integer and
+ * floating point arguments to their own register files in order, spill the
+ * rest to 8-byte stack slots in order, and read a narrower argument from
+ * the low bits of its register or slot.  So any XPCOM method with up to
+ * N + 8 + 16 arguments can be called through this signature, and a
+ * function with this signature sees the raw bits of any such call.
+ *
+ * Apple's AArch64 ABI packs stack arguments by size, and Windows uses a
+ * single argument sequence for both register files, so neither works with
+ * this scheme.
+ */
+
+#include "xptcall.h"
+#include "xptiprivate.h"
+#include "nsDebug.h"
+
+#include <string.h>
+
+#if defined(_WIN32) || defined(__APPLE__) || \
+    !(defined(__x86_64__) || defined(__aarch64__))
+#error "the xptcall stand-in supports only x86-64 and AArch64 ELF targets"
+#endif
+
+typedef PRUint64 Slot;
+
+#if defined(__x86_64__)
+
+// rsi, rdx, rcx, r8, r9; rdi holds 'this'.
+#define GPR_COUNT 5
+#define GPR_PARAMS Slot g0, Slot g1, Slot g2, Slot g3, Slot g4
+#define GPR_TYPES Slot, Slot, Slot, Slot, Slot
+#define GPR_ARGS(a) a[0], a[1], a[2], a[3], a[4]
+#define GPR_SAVE(a) \
+  a[0] = g0; a[1] = g1; a[2] = g2; a[3] = g3; a[4] = g4;
+
+#else
+
+// x1-x7; x0 holds 'this'.
+#define GPR_COUNT 7
+#define GPR_PARAMS \
+  Slot g0, Slot g1, Slot g2, Slot g3, Slot g4, Slot g5, Slot g6
+#define GPR_TYPES Slot, Slot, Slot, Slot, Slot, Slot, Slot
+#define GPR_ARGS(a) a[0], a[1], a[2], a[3], a[4], a[5], a[6]
+#define GPR_SAVE(a) \
+  a[0] = g0; a[1] = g1; a[2] = g2; a[3] = g3; a[4] = g4; a[5] = g5; \
+  a[6] = g6;
+
+#endif
+
+// xmm0-xmm7 or v0-v7.
+#define FPR_COUNT 8
+#define FPR_PARAMS \
+  double f0, double f1, double f2, double f3, \
+  double f4, double f5, double f6, double f7
+#define FPR_TYPES double, double, double, double, \
+                  double, double, double, double
+#define FPR_ARGS(a) a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]
+#define FPR_SAVE(a) \
+  a[0] = f0; a[1] = f1; a[2] = f2; a[3] = f3; \
+  a[4] = f4; a[5] = f5; a[6] = f6; a[7] = f7;
+
+#define STACK_COUNT 16
+#define STACK_PARAMS \
+  Slot s0, Slot s1, Slot s2, Slot s3, Slot s4, Slot s5, Slot s6, Slot s7, \
+  Slot s8, Slot s9, Slot s10, Slot s11, Slot s12, Slot s13, Slot s14, \
+  Slot s15
+#define STACK_TYPES \
+  Slot, Slot, Slot, Slot, Slot, Slot, Slot, Slot, \
+  Slot, Slot, Slot, Slot, Slot, Slot, Slot, Slot
+#define STACK_ARGS(a) \
+  a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], \
+  a[8], a[9], a[10], a[11], a[12], a[13], a[14], a[15]
+#define STACK_SAVE(a) \
+  a[0] = s0; a[1] = s1; a[2] = s2; a[3] = s3; a[4] = s4; a[5] = s5; \
+  a[6] = s6; a[7] = s7; a[8] = s8; a[9] = s9; a[10] = s10; a[11] = s11; \
+  a[12] = s12; a[13] = s13; a[14] = s14; a[15] = s15;
+
+/**
+ * The arguments of one call, sorted into the places the ABI puts them.
+ */
+struct CallFrame
+{
+  Slot gpr[GPR_COUNT];
+  double fpr[FPR_COUNT];
+  Slot stack[STACK_COUNT];
+};
+
+static inline double
+SlotToDouble(Slot aBits)
+{
+  double d;
+  memcpy(&d, &aBits, sizeof(d));
+  return d;
+}
+
+static inline Slot
+DoubleToSlot(double aValue)
+{
+  Slot bits;
+  memcpy(&bits, &aValue, sizeof(bits));
+  return bits;
+}
+
+/***************************************************************************/
+/* NS_InvokeByIndex */
+
+typedef nsresult (*InvokeFunc)(nsISupports* aThat, GPR_TYPES, FPR_TYPES,
+                               STACK_TYPES);
+
+nsresult
+NS_InvokeByIndex(nsISupports* that, PRUint32 methodIndex,
+                 PRUint32 paramCount, nsXPTCVariant* params)
+{
+  CallFrame frame;
+  memset(&frame, 0, sizeof(frame));
+  PRUint32 nGPR = 0, nFPR = 0, nStack = 0;
+
+  for (PRUint32 i = 0; i < paramCount; i++) {
+    const nsXPTCVariant* s = &params[i];
+    Slot value = 0;
+    bool isFloat = false;
+
+    if (s->IsPtrData()) {
+      value = reinterpret_cast<Slot>(s->ptr);
+    } else {
+      switch (s->type.TagPart()) {
+        case nsXPTType::T_FLOAT:
+          // The callee reads the low 32 bits of the register.
+          memcpy(&value, &s->val.f, sizeof(float));
+          isFloat = true;
+          break;
+        case nsXPTType::T_DOUBLE:
+          value = DoubleToSlot(s->val.d);
+          isFloat = true;
+          break;
+        case nsXPTType::T_I8:    value = Slot(PRInt64(s->val.i8));   break;
+        case nsXPTType::T_I16:   value = Slot(PRInt64(s->val.i16));  break;
+        case nsXPTType::T_I32:   value = Slot(PRInt64(s->val.i32));  break;
+        case nsXPTType::T_I64:   value = Slot(s->val.i64);           break;
+        case nsXPTType::T_U8:    value = s->val.u8;                  break;
+        case nsXPTType::T_U16:   value = s->val.u16;                 break;
+        case nsXPTType::T_U32:   value = s->val.u32;                 break;
+        case nsXPTType::T_U64:   value = s->val.u64;                 break;
+        case nsXPTType::T_BOOL:  value = s->val.b ? 1 : 0;           break;
+        case nsXPTType::T_CHAR:  value = Slot(PRInt64(s->val.c));    break;
+        case nsXPTType::T_WCHAR: value = s->val.wc;                  break;
+        default:
+          value = reinterpret_cast<Slot>(s->val.p);
+          break;
+      }
+    }
+
+    if (isFloat && nFPR < FPR_COUNT) {
+      frame.fpr[nFPR++] = SlotToDouble(value);
+    } else if (!isFloat && nGPR < GPR_COUNT) {
+      frame.gpr[nGPR++] = value;
+    } else if (nStack < STACK_COUNT) {
+      frame.stack[nStack++] = value;
+    } else {
+      NS_WARNING("too many parameters for NS_InvokeByIndex");
+      return NS_ERROR_NOT_IMPLEMENTED;
+    }
+  }
+
+  void** vtable = *reinterpret_cast<void***>(that);
+  InvokeFunc method = reinterpret_cast<InvokeFunc>(vtable[methodIndex]);
+  return method(that, GPR_ARGS(frame.gpr), FPR_ARGS(frame.fpr),
+                STACK_ARGS(frame.stack));
+}
+
+/***************************************************************************/
+/* Stubs */
+
+// Methods past this index cannot be implemented by a stub; no interface the
+// bridge uses comes close.
+#define STUB_VTABLE_SIZE 256
+
+// Most methods have fewer parameters than this; only longer ones allocate.
+#define PARAM_BUFFER_COUNT 16
+
+/**
+ * The object NS_GetXPTCallStub hands out.  Its first word is the pointer
+ * to a vtable of the functions below, which is all a caller of an XPCOM
+ * interface looks at, so it can pose as any interface.
+ */
+struct nsXPTCStub
+{
+  void** mVtable;
+  nsIXPTCProxy* mOuter;
+  xptiInterfaceEntry* mEntry;
+
+  nsresult CallMethod(PRUint16 aMethodIndex, const CallFrame& aFrame);
+};
+
+nsresult
+nsXPTCStub::CallMethod(PRUint16 aMethodIndex, const CallFrame& aFrame)
+{
+  const nsXPTMethodInfo* info;
+  nsresult rv = mEntry->GetMethodInfo(aMethodIndex, &info);
+  if (NS_FAILED(rv))
+    return rv;
+
+  PRUint8 paramCount = info->GetParamCount();
+  nsXPTCMiniVariant paramBuffer[PARAM_BUFFER_COUNT];
+  nsXPTCMiniVariant* dispatchParams = paramBuffer;
+  if (paramCount > PARAM_BUFFER_COUNT)
+    dispatchParams = new nsXPTCMiniVariant[paramCount];
+
+  // Walk the parameters the way the caller assigned them.
+  PRUint32 nGPR = 0, nFPR = 0, nStack = 0;
+  for (PRUint8 i = 0; i < paramCount; i++) {
+    const nsXPTParamInfo param = info->GetParam(i);
+    PRUint8 tag = param.GetType().TagPart();
+    bool isFloat = !param.IsIndirect() &&
+                   (tag == nsXPTType::T_FLOAT || tag == nsXPTType::T_DOUBLE);
+
+    // A float arrives in the low 32 bits of its register or slot, which is
+    // where val.f overlays val.u64.
+    Slot value;
+    if (isFloat && nFPR < FPR_COUNT) {
+      value = DoubleToSlot(aFrame.fpr[nFPR++]);
+    } else if (!isFloat && nGPR < GPR_COUNT) {
+      value = aFrame.gpr[nGPR++];
+    } else if (nStack < STACK_COUNT) {
+      value = aFrame.stack[nStack++];
+    } else {
+      NS_WARNING("too many parameters for an xptcall stub");
+      rv = NS_ERROR_NOT_IMPLEMENTED;
+      break;
+    }
+    dispatchParams[i].val.u64 = value;
+  }
+
+  if (NS_SUCCEEDED(rv))
+    rv = mOuter->CallMethod(aMethodIndex, info, dispatchParams);
+
+  if (dispatchParams != paramBuffer)
+    delete [] dispatchParams;
+  return rv;
+}
+
+/*
+ * The stub's nsISupports methods.  QueryInterface answers the stub's own
+ * IID with the stub itself and forwards everything else to the outer
+ * object; reference counts belong to the outer object.
+ */
+
+static nsresult
+StubQueryInterface(nsXPTCStub* aSelf, const nsIID& aIID, void** aResult)
+{
+  if (aSelf->mEntry->IID().Equals(aIID)) {
+    aSelf->mOuter->AddRef();
+    *aResult = aSelf;
+    return NS_OK;
+  }
+  return aSelf->mOuter->QueryInterface(aIID, aResult);
+}
+
+static MozExternalRefCountType
+StubAddRef(nsXPTCStub* aSelf)
+{
+  return aSelf->mOuter->AddRef();
+}
+
+static MozExternalRefCountType
+StubRelease(nsXPTCStub* aSelf)
+{
+  return aSelf->mOuter->Release();
+}
+
+template <int N>
+static nsresult
+StubMethod(nsXPTCStub* aSelf, GPR_PARAMS, FPR_PARAMS, STACK_PARAMS)
+{
+  CallFrame frame;
+  GPR_SAVE(frame.gpr)
+  FPR_SAVE(frame.fpr)
+  STACK_SAVE(frame.stack)
+  return aSelf->CallMethod(N, frame);
+}
+
+template <int N>
+struct StubVtableFiller
+{
+  static void Fill(void** aVtable)
+  {
+    aVtable[N] = reinterpret_cast<void*>(&StubMethod<N>);
+    StubVtableFiller<N - 1>::Fill(aVtable);
+  }
+};
+
+template <>
+struct StubVtableFiller<2>
+{
+  static void Fill(void** aVtable)
+  {
+    aVtable[0] = reinterpret_cast<void*>(&StubQueryInterface);
+    aVtable[1] = reinterpret_cast<void*>(&StubAddRef);
+    aVtable[2] = reinterpret_cast<void*>(&StubRelease);
+  }
+};
+
+static void**
+BuildStubVtable()
+{
+  static void* vtable[STUB_VTABLE_SIZE];
+  StubVtableFiller<STUB_VTABLE_SIZE - 1>::Fill(vtable);
+  return vtable;
+}
+
+nsresult
+NS_GetXPTCallStub(REFNSIID aIID, nsIXPTCProxy* aOuter,
+                  nsISomeInterface** aResult)
+{
+  NS_ENSURE_ARG(aOuter);
+  NS_ENSURE_ARG_POINTER(aResult);
+
+  xptiInterfaceEntry* entry =
+    xptiInterfaceInfoManager::GetSingleton()->GetEntryForIID(aIID);
+  if (!entry)
+    return NS_ERROR_FAILURE;
+
+  PRUint16 methodCount;
+  entry->GetMethodCount(&methodCount);
+  if (methodCount > STUB_VTABLE_SIZE) {
+    NS_WARNING("interface has too many methods for an xptcall stub");
+    return NS_ERROR_NOT_IMPLEMENTED;
+  }
+
+  static void** sVtable = BuildStubVtable();
+
+  nsXPTCStub* stub = new nsXPTCStub;
+  stub->mVtable = sVtable;
+  stub->mOuter = aOuter;
+  stub->mEntry = entry;
+
+  *aResult = reinterpret_cast<nsISomeInterface*>(stub);
+  return NS_OK;
+}
+
+void
+NS_DestroyXPTCallStub(nsISomeInterface* aStub)
+{
+  delete reinterpret_cast<nsXPTCStub*>(aStub);
+}
@@ -0,0 +1,585 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * Interface entries and the nsIInterfaceInfo implementation.  The lookups
+ * follow Gecko's xptiInterfaceInfo.cpp: method and constant indices below
+ * an interface's base index belong to an ancestor, and parameter queries
+ * are answered by the interface that declares the method, since array
+ * element types live in that interface's descriptor.
+ */
+
+#include "xptiprivate.h"
+#include "nsMemory.h"
+#include "nsDebug.h"
+
+#include <string.h>
+
+xptiInterfaceEntry::xptiInterfaceEntry(const XPTHeader* aTypelib,
+                                       const XPTInterfaceDirectoryEntry*
+                                         aDirEntry)
+  : mTypelib(aTypelib),
+    mDirEntry(aDirEntry),
+    mParent(nullptr),
+    mMethodBaseIndex(0),
+    mConstantBaseIndex(0),
+    mResolved(false),
+    mInfo(nullptr)
+{
+}
+
+bool
+xptiInterfaceEntry::EnsureResolved()
+{
+  if (mResolved)
+    return true;
+
+  const XPTInterfaceDescriptor* desc = Descriptor();
+  if (desc->parent_interface) {
+    NS_ENSURE_TRUE(desc->parent_interface <= mTypelib->num_interfaces,
+                   false);
+    const XPTInterfaceDirectoryEntry* parentDirEntry =
+      &mTypelib->interface_directory[desc->parent_interface - 1];
+
+    xptiInterfaceEntry* parent = xptiInterfaceInfoManager::GetSingleton()->
+      GetEntryForIIDLocked(parentDirEntry->iid);
+    if (!parent) {
+      NS_WARNING("interface parent is not registered");
+      return false;
+    }
+
+    const XPTInterfaceDescriptor* parentDesc = parent->Descriptor();
+    mParent = parent;
+    mMethodBaseIndex = parent->mMethodBaseIndex + parentDesc->num_methods;
+    mConstantBaseIndex =
+      parent->mConstantBaseIndex + parentDesc->num_constants;
+  }
+
+  mInfo = new xptiInterfaceInfo(this);
+  NS_ADDREF(mInfo);
+  mResolved = true;
+  return true;
+}
+
+already_AddRefed<xptiInterfaceInfo>
+xptiInterfaceEntry::InterfaceInfo()
+{
+  NS_ASSERTION(mResolved, "interface entry is not resolved");
+  NS_ADDREF(mInfo);
+  return already_AddRefed<xptiInterfaceInfo>(mInfo);
+}
+
+nsresult
+xptiInterfaceEntry::GetParent(nsIInterfaceInfo** aParent)
+{
+  if (!mParent) {
+    *aParent = nullptr;
+    return NS_OK;
+  }
+  *aParent = mParent->InterfaceInfo().take();
+  return NS_OK;
+}
+
+nsresult
+xptiInterfaceEntry::GetMethodCount(PRUint16* aCount)
+{
+  *aCount = mMethodBaseIndex + Descriptor()->num_methods;
+  return NS_OK;
+}
+
+nsresult
+xptiInterfaceEntry::GetConstantCount(PRUint16* aCount)
+{
+  *aCount = mConstantBaseIndex + Descriptor()->num_constants;
+  return NS_OK;
+}
+
+nsresult
+xptiInterfaceEntry::GetMethodInfo(PRUint16 aIndex,
+                                  const nsXPTMethodInfo** aInfo)
+{
+  if (aIndex < mMethodBaseIndex)
+    return mParent->GetMethodInfo(aIndex, aInfo);
+
+  if (aIndex >= mMethodBaseIndex + Descriptor()->num_methods) {
+    NS_ERROR("bad param");
+    *aInfo = nullptr;
+    return NS_ERROR_INVALID_ARG;
+  }
+
+  // else...
+  *aInfo = reinterpret_cast<const nsXPTMethodInfo*>
+    (&Descriptor()->method_descriptors[aIndex - mMethodBaseIndex]);
+  return NS_OK;
+}
+
+nsresult
+xptiInterfaceEntry::GetMethodInfoForName(const char* aMethodName,
+                                         PRUint16* aIndex,
+                                         const nsXPTMethodInfo** aInfo)
+{
+  const XPTInterfaceDescriptor* desc = Descriptor();
+  for (PRUint16 i = 0; i < desc->num_methods; ++i) {
+    const nsXPTMethodInfo* info = reinterpret_cast<const nsXPTMethodInfo*>
+      (&desc->method_descriptors[i]);
+    if (strcmp(aMethodName, info->GetName()) == 0) {
+      *aIndex = i + mMethodBaseIndex;
+      *aInfo = info;
+      return NS_OK;
+    }
+  }
+
+  if (mParent)
+    return mParent->GetMethodInfoForName(aMethodName, aIndex, aInfo);
+
+  *aIndex = 0;
+  *aInfo = nullptr;
+  return NS_ERROR_INVALID_ARG;
+}
+
+nsresult
+xptiInterfaceEntry::GetConstant(PRUint16 aIndex,
+                                const nsXPTConstant** aConstant)
+{
+  if (aIndex < mConstantBaseIndex)
+    return mParent->GetConstant(aIndex, aConstant);
+
+  if (aIndex >= mConstantBaseIndex + Descriptor()->num_constants) {
+    NS_PRECONDITION(0, "bad param");
+    *aConstant = nullptr;
+    return NS_ERROR_INVALID_ARG;
+  }
+
+  // else...
+  *aConstant = reinterpret_cast<const nsXPTConstant*>
+    (&Descriptor()->const_descriptors[aIndex - mConstantBaseIndex]);
+  return NS_OK;
+}
+
+nsresult
+xptiInterfaceEntry::GetEntryForParam(PRUint16 aMethodIndex,
+                                     const nsXPTParamInfo* aParam,
+                                     xptiInterfaceEntry** aEntry)
+{
+  if (aMethodIndex < mMethodBaseIndex)
+    return mParent->GetEntryForParam(aMethodIndex, aParam, aEntry);
+
+  if (aMethodIndex >= mMethodBaseIndex + Descriptor()->num_methods) {
+    NS_ERROR("bad param");
+    return NS_ERROR_INVALID_ARG;
+  }
+
+  const XPTTypeDescriptor* td = &aParam->type;
+  while (XPT_TDP_TAG(td->prefix) == TD_ARRAY)
+    td = &Descriptor()->additional_types[td->type.additional_type];
+
+  if (XPT_TDP_TAG(td->prefix) != TD_INTERFACE_TYPE) {
+    NS_ERROR("not an interface");
+    return NS_ERROR_INVALID_ARG;
+  }
+
+  if (td->type.iface == 0 || td->type.iface > mTypelib->num_interfaces) {
+    NS_ERROR("bad interface index");
+    return NS_ERROR_INVALID_ARG;
+  }
+
+  const XPTInterfaceDirectoryEntry* dirEntry =
+    &mTypelib->interface_directory[td->type.iface - 1];
+  xptiInterfaceEntry* entry =
+    xptiInterfaceInfoManager::GetSingleton()->GetEntryForIID(dirEntry->iid);
+  if (!entry)
+    return NS_ERROR_FAILURE;
+
+  *aEntry = entry;
+  return NS_OK;
+}
+
+nsresult
+xptiInterfaceEntry::GetInfoForParam(PRUint16 aMethodIndex,
+                                    const nsXPTParamInfo* aParam,
+                                    nsIInterfaceInfo** aInfo)
+{
+  xptiInterfaceEntry* entry;
+  nsresult rv = GetEntryForParam(aMethodIndex, aParam, &entry);
+  if (NS_FAILED(rv))
+    return rv;
+
+  *aInfo = entry->InterfaceInfo().take();
+  return NS_OK;
+}
+
+nsresult
+xptiInterfaceEntry::GetIIDForParam(PRUint16 aMethodIndex,
+                                   const nsXPTParamInfo* aParam,
+                                   nsIID** aIID)
+{
+  xptiInterfaceEntry* entry;
+  nsresult rv = GetEntryForParam(aMethodIndex, aParam, &entry);
+  if (NS_FAILED(rv))
+    return rv;
+
+  *aIID = static_cast<nsIID*>(nsMemory::Clone(&entry->IID(), sizeof(nsIID)));
+  return *aIID ? NS_OK : NS_ERROR_OUT_OF_MEMORY;
+}
+
+nsresult
+xptiInterfaceEntry::GetIIDForParamNoAlloc(PRUint16 aMethodIndex,
+                                          const nsXPTParamInfo* aParam,
+                                          nsIID* aIID)
+{
+  xptiInterfaceEntry* entry;
+  nsresult rv = GetEntryForParam(aMethodIndex, aParam, &entry);
+  if (NS_FAILED(rv))
+    return rv;
+
+  *aIID = entry->IID();
+  return NS_OK;
+}
+
+// this is a private helper
+nsresult
+xptiInterfaceEntry::GetTypeInArray(const nsXPTParamInfo* aParam,
+                                   PRUint16 aDimension,
+                                   const XPTTypeDescriptor** aType)
+{
+  const XPTTypeDescriptor* td = &aParam->type;
+  const XPTTypeDescriptor* additionalTypes = Descriptor()->additional_types;
+
+  for (PRUint16 i = 0; i < aDimension; i++) {
+    if (XPT_TDP_TAG(td->prefix) != TD_ARRAY) {
+      NS_ERROR("bad dimension");
+      return NS_ERROR_INVALID_ARG;
+    }
+    td = &additionalTypes[td->type.additional_type];
+  }
+
+  *aType = td;
+  return NS_OK;
+}
+
+nsresult
+xptiInterfaceEntry::GetTypeForParam(PRUint16 aMethodIndex,
+                                    const nsXPTParamInfo* aParam,
+                                    PRUint16 aDimension, nsXPTType* aType)
+{
+  if (aMethodIndex < mMethodBaseIndex)
+    return mParent->GetTypeForParam(aMethodIndex, aParam, aDimension, aType);
+
+  if (aMethodIndex >= mMethodBaseIndex + Descriptor()->num_methods) {
+    NS_ERROR("bad index");
+    return NS_ERROR_INVALID_ARG;
+  }
+
+  const XPTTypeDescriptor* td;
+  if (aDimension) {
+    nsresult rv = GetTypeInArray(aParam, aDimension, &td);
+    if (NS_FAILED(rv))
+      return rv;
+  } else {
+    td = &aParam->type;
+  }
+
+  *aType = nsXPTType(td->prefix);
+  return NS_OK;
+}
+
+nsresult
+xptiInterfaceEntry::GetSizeIsArgNumberForParam(PRUint16 aMethodIndex,
+                                               const nsXPTParamInfo* aParam,
+                                               PRUint16 aDimension,
+                                               PRUint8* aArgNum)
+{
+  if (aMethodIndex < mMethodBaseIndex) {
+    return mParent->GetSizeIsArgNumberForParam(aMethodIndex, aParam,
+                                               aDimension, aArgNum);
+  }
+
+  if (aMethodIndex >= mMethodBaseIndex + Descriptor()->num_methods) {
+    NS_ERROR("bad index");
+    return NS_ERROR_INVALID_ARG;
+  }
+
+  const XPTTypeDescriptor* td;
+  if (aDimension) {
+    nsresult rv = GetTypeInArray(aParam, aDimension, &td);
+    if (NS_FAILED(rv))
+      return rv;
+  } else {
+    td = &aParam->type;
+  }
+
+  // verify that this is a type that has size_is
+  switch (XPT_TDP_TAG(td->prefix)) {
+    case TD_ARRAY:
+    case TD_PSTRING_SIZE_IS:
+    case TD_PWSTRING_SIZE_IS:
+      break;
+    default:
+      NS_ERROR("not a size_is");
+      return NS_ERROR_INVALID_ARG;
+  }
+
+  *aArgNum = td->argnum;
+  return NS_OK;
+}
+
+nsresult
+xptiInterfaceEntry::GetInterfaceIsArgNumberForParam(PRUint16 aMethodIndex,
+                                                    const nsXPTParamInfo*
+                                                      aParam,
+                                                    PRUint8* aArgNum)
+{
+  if (aMethodIndex < mMethodBaseIndex) {
+    return mParent->GetInterfaceIsArgNumberForParam(aMethodIndex, aParam,
+                                                    aArgNum);
+  }
+
+  if (aMethodIndex >= mMethodBaseIndex + Descriptor()->num_methods) {
+    NS_ERROR("bad index");
+    return NS_ERROR_INVALID_ARG;
+  }
+
+  const XPTTypeDescriptor* td = &aParam->type;
+  while (XPT_TDP_TAG(td->prefix) == TD_ARRAY)
+    td = &Descriptor()->additional_types[td->type.additional_type];
+
+  if (XPT_TDP_TAG(td->prefix) != TD_INTERFACE_IS_TYPE) {
+    NS_ERROR("not an iid_is");
+    return NS_ERROR_INVALID_ARG;
+  }
+
+  *aArgNum = td->argnum;
+  return NS_OK;
+}
+
+nsresult
+xptiInterfaceEntry::HasAncestor(const nsIID* aIID, bool* aResult)
+{
+  *aResult = false;
+  for (xptiInterfaceEntry* current = this; current;
+       current = current->mParent) {
+    if (current->IID().Equals(*aIID)) {
+      *aResult = true;
+      break;
+    }
+  }
+  return NS_OK;
+}
+
+/***************************************************************************/
+
+NS_IMPL_ADDREF(xptiInterfaceInfo)
+NS_IMPL_RELEASE(xptiInterfaceInfo)
+NS_IMPL_QUERY_INTERFACE(xptiInterfaceInfo, nsIInterfaceInfo)
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetName(char** aName)
+{
+  NS_ENSURE_ARG_POINTER(aName);
+  const char* name = mEntry->Name();
+  *aName = static_cast<char*>(nsMemory::Clone(name, strlen(name) + 1));
+  return *aName ? NS_OK : NS_ERROR_OUT_OF_MEMORY;
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetInterfaceIID(nsIID** aIID)
+{
+  NS_ENSURE_ARG_POINTER(aIID);
+  *aIID = static_cast<nsIID*>(nsMemory::Clone(&mEntry->IID(), sizeof(nsIID)));
+  return *aIID ? NS_OK : NS_ERROR_OUT_OF_MEMORY;
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::IsScriptable(bool* aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  *aResult = XPT_ID_IS_SCRIPTABLE(mEntry->Descriptor()->flags);
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetParent(nsIInterfaceInfo** aParent)
+{
+  NS_ENSURE_ARG_POINTER(aParent);
+  return mEntry->GetParent(aParent);
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetMethodCount(PRUint16* aCount)
+{
+  NS_ENSURE_ARG_POINTER(aCount);
+  return mEntry->GetMethodCount(aCount);
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetConstantCount(PRUint16* aCount)
+{
+  NS_ENSURE_ARG_POINTER(aCount);
+  return mEntry->GetConstantCount(aCount);
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetMethodInfo(PRUint16 aIndex,
+                                 const nsXPTMethodInfo** aInfo)
+{
+  NS_ENSURE_ARG_POINTER(aInfo);
+  return mEntry->GetMethodInfo(aIndex, aInfo);
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetMethodInfoForName(const char* aMethodName,
+                                        PRUint16* aIndex,
+                                        const nsXPTMethodInfo** aInfo)
+{
+  NS_ENSURE_ARG_POINTER(aMethodName);
+  NS_ENSURE_ARG_POINTER(aIndex);
+  NS_ENSURE_ARG_POINTER(aInfo);
+  return mEntry->GetMethodInfoForName(aMethodName, aIndex, aInfo);
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetConstant(PRUint16 aIndex,
+                               const nsXPTConstant** aConstant)
+{
+  NS_ENSURE_ARG_POINTER(aConstant);
+  return mEntry->GetConstant(aIndex, aConstant);
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetInfoForParam(PRUint16 aMethodIndex,
+                                   const nsXPTParamInfo* aParam,
+                                   nsIInterfaceInfo** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aParam);
+  NS_ENSURE_ARG_POINTER(aResult);
+  return mEntry->GetInfoForParam(aMethodIndex, aParam, aResult);
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetIIDForParam(PRUint16 aMethodIndex,
+                                  const nsXPTParamInfo* aParam,
+                                  nsIID** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aParam);
+  NS_ENSURE_ARG_POINTER(aResult);
+  return mEntry->GetIIDForParam(aMethodIndex, aParam, aResult);
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetTypeForParam(PRUint16 aMethodIndex,
+                                   const nsXPTParamInfo* aParam,
+                                   PRUint16 aDimension, nsXPTType* aResult)
+{
+  NS_ENSURE_ARG_POINTER(aParam);
+  NS_ENSURE_ARG_POINTER(aResult);
+  return mEntry->GetTypeForParam(aMethodIndex, aParam, aDimension, aResult);
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetSizeIsArgNumberForParam(PRUint16 aMethodIndex,
+                                              const nsXPTParamInfo* aParam,
+                                              PRUint16 aDimension,
+                                              PRUint8* aResult)
+{
+  NS_ENSURE_ARG_POINTER(aParam);
+  NS_ENSURE_ARG_POINTER(aResult);
+  return mEntry->GetSizeIsArgNumberForParam(aMethodIndex, aParam, aDimension,
+                                            aResult);
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetInterfaceIsArgNumberForParam(PRUint16 aMethodIndex,
+                                                   const nsXPTParamInfo*
+                                                     aParam,
+                                                   PRUint8* aResult)
+{
+  NS_ENSURE_ARG_POINTER(aParam);
+  NS_ENSURE_ARG_POINTER(aResult);
+  return mEntry->GetInterfaceIsArgNumberForParam(aMethodIndex, aParam,
+                                                 aResult);
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::IsIID(const nsIID* aIID, bool* aResult)
+{
+  NS_ENSURE_ARG_POINTER(aIID);
+  NS_ENSURE_ARG_POINTER(aResult);
+  *aResult = mEntry->IID().Equals(*aIID);
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetNameShared(const char** aName)
+{
+  NS_ENSURE_ARG_POINTER(aName);
+  *aName = mEntry->Name();
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetIIDShared(const nsIID** aIID)
+{
+  NS_ENSURE_ARG_POINTER(aIID);
+  *aIID = &mEntry->IID();
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::IsFunction(bool* aResult)
+{
+  NS_ENSURE_ARG_POINTER(aResult);
+  *aResult = XPT_ID_IS_FUNCTION(mEntry->Descriptor()->flags);
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::HasAncestor(const nsIID* aIID, bool* aResult)
+{
+  NS_ENSURE_ARG_POINTER(aIID);
+  NS_ENSURE_ARG_POINTER(aResult);
+  return mEntry->HasAncestor(aIID, aResult);
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfo::GetIIDForParamNoAlloc(PRUint16 aMethodIndex,
+                                         const nsXPTParamInfo* aParam,
+                                         nsIID* aIID)
+{
+  NS_ENSURE_ARG_POINTER(aParam);
+  NS_ENSURE_ARG_POINTER(aIID);
+  return mEntry->GetIIDForParamNoAlloc(aMethodIndex, aParam, aIID);
+}
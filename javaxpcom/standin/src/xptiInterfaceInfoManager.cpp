@@ -0,0 +1,278 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * The interface info manager: a table of interface entries by IID, filled
+ * from the typelibs registered with NS_RegisterStandInTypelib.
+ */
+
+#include "xptiprivate.h"
+#include "nsStandInRuntime.h"
+#include "nsMemory.h"
+#include "nsDebug.h"
+#include "prinit.h"
+
+#include <string.h>
+
+struct IIDTableEntry : public PLDHashEntryHdr
+{
+  const nsIID* key;
+  xptiInterfaceEntry* value;
+};
+
+static PLDHashNumber
+IIDHash(PLDHashTable* aTable, const void* aKey)
+{
+  // The first word of a UUID is random enough on its own.
+  return static_cast<const nsIID*>(aKey)->m0;
+}
+
+static bool
+IIDMatch(PLDHashTable* aTable, const PLDHashEntryHdr* aEntry,
+         const void* aKey)
+{
+  const IIDTableEntry* entry = static_cast<const IIDTableEntry*>(aEntry);
+  return entry->key->Equals(*static_cast<const nsIID*>(aKey));
+}
+
+static const PLDHashTableOps kIIDTableOps = {
+  PL_DHashAllocTable,
+  PL_DHashFreeTable,
+  IIDHash,
+  IIDMatch,
+  PL_DHashMoveEntryStub,
+  PL_DHashClearEntryStub,
+  PL_DHashFinalizeStub,
+  nullptr
+};
+
+NS_IMPL_ADDREF(xptiInterfaceInfoManager)
+NS_IMPL_RELEASE(xptiInterfaceInfoManager)
+NS_IMPL_QUERY_INTERFACE(xptiInterfaceInfoManager, nsIInterfaceInfoManager)
+
+xptiInterfaceInfoManager::xptiInterfaceInfoManager()
+  : mLock(PR_NewLock())
+{
+  PL_DHashTableInit(&mIIDTable, &kIIDTableOps, nullptr,
+                    sizeof(IIDTableEntry), 64);
+}
+
+xptiInterfaceInfoManager::~xptiInterfaceInfoManager()
+{
+  NS_NOTREACHED("the interface info manager is never destroyed");
+}
+
+xptiInterfaceInfoManager*
+xptiInterfaceInfoManager::GetSingleton()
+{
+  static xptiInterfaceInfoManager* gInstance = nullptr;
+  static PRCallOnceType once;
+
+  struct Init {
+    static PRStatus Create()
+    {
+      gInstance = new xptiInterfaceInfoManager();
+      NS_ADDREF(gInstance);
+      gInstance->RegisterTypelib(&kStandInTypelib);
+      return PR_SUCCESS;
+    }
+  };
+
+  PR_CallOnce(&once, Init::Create);
+  return gInstance;
+}
+
+nsresult
+xptiInterfaceInfoManager::RegisterTypelib(const XPTHeader* aHeader)
+{
+  NS_ENSURE_ARG_POINTER(aHeader);
+
+  nsresult rv = NS_OK;
+  PR_Lock(mLock);
+  for (PRUint16 i = 0; i < aHeader->num_interfaces; ++i) {
+    const XPTInterfaceDirectoryEntry* dirEntry =
+      &aHeader->interface_directory[i];
+
+    // Entries without a descriptor refer to interfaces from elsewhere.
+    if (!dirEntry->interface_descriptor)
+      continue;
+
+    IIDTableEntry* entry = static_cast<IIDTableEntry*>
+      (PL_DHashTableAdd(&mIIDTable, &dirEntry->iid));
+    if (!entry) {
+      rv = NS_ERROR_OUT_OF_MEMORY;
+      break;
+    }
+    if (entry->key) {
+      NS_WARNING("interface is described by more than one typelib");
+      continue;
+    }
+
+    entry->value = new xptiInterfaceEntry(aHeader, dirEntry);
+    entry->key = &entry->value->IID();
+  }
+  PR_Unlock(mLock);
+  return rv;
+}
+
+xptiInterfaceEntry*
+xptiInterfaceInfoManager::GetEntryForIIDLocked(const nsIID& aIID)
+{
+  IIDTableEntry* entry = static_cast<IIDTableEntry*>
+    (PL_DHashTableSearch(&mIIDTable, &aIID));
+  if (!entry || !entry->value->EnsureResolved())
+    return nullptr;
+  return entry->value;
+}
+
+xptiInterfaceEntry*
+xptiInterfaceInfoManager::GetEntryForIID(const nsIID& aIID)
+{
+  PR_Lock(mLock);
+  xptiInterfaceEntry* entry = GetEntryForIIDLocked(aIID);
+  PR_Unlock(mLock);
+  return entry;
+}
+
+struct FindNameClosure
+{
+  const char* name;
+  xptiInterfaceEntry* result;
+};
+
+PLDHashOperator
+xptiInterfaceInfoManager::FindNameEnumerator(PLDHashTable* aTable,
+                                             PLDHashEntryHdr* aHdr,
+                                             PRUint32 aNumber, void* aArg)
+{
+  IIDTableEntry* entry = static_cast<IIDTableEntry*>(aHdr);
+  FindNameClosure* closure = static_cast<FindNameClosure*>(aArg);
+  if (strcmp(entry->value->Name(), closure->name) == 0) {
+    closure->result = entry->value;
+    return PL_DHASH_STOP;
+  }
+  return PL_DHASH_NEXT;
+}
+
+xptiInterfaceEntry*
+xptiInterfaceInfoManager::GetEntryForName(const char* aName)
+{
+  // Lookups by name are rare enough that a walk over the table will do.
+  FindNameClosure closure = { aName, nullptr };
+
+  PR_Lock(mLock);
+  PL_DHashTableEnumerate(&mIIDTable, FindNameEnumerator, &closure);
+  if (closure.result && !closure.result->EnsureResolved())
+    closure.result = nullptr;
+  PR_Unlock(mLock);
+
+  return closure.result;
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfoManager::GetInfoForIID(const nsIID* aIID,
+                                        nsIInterfaceInfo** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aIID);
+  NS_ENSURE_ARG_POINTER(aResult);
+
+  xptiInterfaceEntry* entry = GetEntryForIID(*aIID);
+  if (!entry) {
+    *aResult = nullptr;
+    return NS_ERROR_FAILURE;
+  }
+
+  *aResult = entry->InterfaceInfo().take();
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfoManager::GetInfoForName(const char* aName,
+                                         nsIInterfaceInfo** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aName);
+  NS_ENSURE_ARG_POINTER(aResult);
+
+  xptiInterfaceEntry* entry = GetEntryForName(aName);
+  if (!entry) {
+    *aResult = nullptr;
+    return NS_ERROR_FAILURE;
+  }
+
+  *aResult = entry->InterfaceInfo().take();
+  return NS_OK;
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfoManager::GetIIDForName(const char* aName, nsIID** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aName);
+  NS_ENSURE_ARG_POINTER(aResult);
+
+  xptiInterfaceEntry* entry = GetEntryForName(aName);
+  if (!entry) {
+    *aResult = nullptr;
+    return NS_ERROR_FAILURE;
+  }
+
+  *aResult = static_cast<nsIID*>
+    (nsMemory::Clone(&entry->IID(), sizeof(nsIID)));
+  return *aResult ? NS_OK : NS_ERROR_OUT_OF_MEMORY;
+}
+
+NS_IMETHODIMP
+xptiInterfaceInfoManager::GetNameForIID(const nsIID* aIID, char** aResult)
+{
+  NS_ENSURE_ARG_POINTER(aIID);
+  NS_ENSURE_ARG_POINTER(aResult);
+
+  xptiInterfaceEntry* entry = GetEntryForIID(*aIID);
+  if (!entry) {
+    *aResult = nullptr;
+    return NS_ERROR_FAILURE;
+  }
+
+  const char* name = entry->Name();
+  *aResult = static_cast<char*>(nsMemory::Clone(name, strlen(name) + 1));
+  return *aResult ? NS_OK : NS_ERROR_OUT_OF_MEMORY;
+}
+
+nsresult
+NS_RegisterStandInTypelib(const XPTHeader* aHeader)
+{
+  return xptiInterfaceInfoManager::GetSingleton()->RegisterTypelib(aHeader);
+}
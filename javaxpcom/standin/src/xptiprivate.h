@@ -0,0 +1,182 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef xptiprivate_h___
+#define xptiprivate_h___
+
+/*
+ * The stand-in's interface info manager.  As in Gecko, every interface the
+ * manager knows has an xptiInterfaceEntry, which points into the typelib
+ * that describes it and resolves its parent lazily; the nsIInterfaceInfo
+ * handed out for it is an xptiInterfaceInfo that forwards to the entry.
+ *
+ * Entries and typelibs are never freed, so infos stay valid for the life of
+ * the process, even after XPCOM shutdown.
+ */
+
+#include "nsIInterfaceInfo.h"
+#include "nsIInterfaceInfoManager.h"
+#include "nsCOMPtr.h"
+#include "xpt_struct.h"
+#include "pldhash.h"
+#include "prlock.h"
+
+class xptiInterfaceInfo;
+
+class xptiInterfaceEntry
+{
+public:
+  xptiInterfaceEntry(const XPTHeader* aTypelib,
+                     const XPTInterfaceDirectoryEntry* aDirEntry);
+
+  const nsID& IID() const { return mDirEntry->iid; }
+  const char* Name() const { return mDirEntry->name; }
+  const XPTInterfaceDescriptor* Descriptor() const
+  {
+    return mDirEntry->interface_descriptor;
+  }
+
+  /**
+   * Finds the parent and the method and constant base indices.  Fails if an
+   * ancestor is missing from the manager.  Called with the manager's lock
+   * held.
+   */
+  bool EnsureResolved();
+  bool IsResolved() const { return mResolved; }
+
+  /** Returns the info for this entry, AddRef'd. */
+  already_AddRefed<xptiInterfaceInfo> InterfaceInfo();
+
+  // These match the nsIInterfaceInfo methods; the entry must be resolved.
+  nsresult GetParent(nsIInterfaceInfo** aParent);
+  nsresult GetMethodCount(PRUint16* aCount);
+  nsresult GetConstantCount(PRUint16* aCount);
+  nsresult GetMethodInfo(PRUint16 aIndex, const nsXPTMethodInfo** aInfo);
+  nsresult GetMethodInfoForName(const char* aMethodName, PRUint16* aIndex,
+                                const nsXPTMethodInfo** aInfo);
+  nsresult GetConstant(PRUint16 aIndex, const nsXPTConstant** aConstant);
+  nsresult GetInfoForParam(PRUint16 aMethodIndex,
+                           const nsXPTParamInfo* aParam,
+                           nsIInterfaceInfo** aInfo);
+  nsresult GetIIDForParam(PRUint16 aMethodIndex,
+                          const nsXPTParamInfo* aParam, nsIID** aIID);
+  nsresult GetTypeForParam(PRUint16 aMethodIndex,
+                           const nsXPTParamInfo* aParam,
+                           PRUint16 aDimension, nsXPTType* aType);
+  nsresult GetSizeIsArgNumberForParam(PRUint16 aMethodIndex,
+                                      const nsXPTParamInfo* aParam,
+                                      PRUint16 aDimension, PRUint8* aArgNum);
+  nsresult GetInterfaceIsArgNumberForParam(PRUint16 aMethodIndex,
+                                           const nsXPTParamInfo* aParam,
+                                           PRUint8* aArgNum);
+  nsresult GetIIDForParamNoAlloc(PRUint16 aMethodIndex,
+                                 const nsXPTParamInfo* aParam, nsIID* aIID);
+  nsresult HasAncestor(const nsIID* aIID, bool* aResult);
+
+private:
+  nsresult GetEntryForParam(PRUint16 aMethodIndex,
+                            const nsXPTParamInfo* aParam,
+                            xptiInterfaceEntry** aEntry);
+  nsresult GetTypeInArray(const nsXPTParamInfo* aParam, PRUint16 aDimension,
+                          const XPTTypeDescriptor** aType);
+
+  const XPTHeader* mTypelib;
+  const XPTInterfaceDirectoryEntry* mDirEntry;
+  xptiInterfaceEntry* mParent;
+  PRUint16 mMethodBaseIndex;
+  PRUint16 mConstantBaseIndex;
+  bool mResolved;
+
+  // Created on first use and kept until the process exits.
+  xptiInterfaceInfo* mInfo;
+};
+
+class xptiInterfaceInfo final : public nsIInterfaceInfo
+{
+public:
+  NS_DECL_THREADSAFE_ISUPPORTS
+  NS_DECL_NSIINTERFACEINFO
+
+  explicit xptiInterfaceInfo(xptiInterfaceEntry* aEntry) : mEntry(aEntry) {}
+
+private:
+  ~xptiInterfaceInfo() {}
+
+  xptiInterfaceEntry* mEntry;
+};
+
+class xptiInterfaceInfoManager final : public nsIInterfaceInfoManager
+{
+public:
+  NS_DECL_THREADSAFE_ISUPPORTS
+  NS_DECL_NSIINTERFACEINFOMANAGER
+
+  /** The manager lives from first use until the process exits. */
+  static xptiInterfaceInfoManager* GetSingleton();
+
+  nsresult RegisterTypelib(const XPTHeader* aHeader);
+
+  /**
+   * Returns the resolved entry for aIID, or null if the IID is unknown or
+   * an ancestor of it is.
+   */
+  xptiInterfaceEntry* GetEntryForIID(const nsIID& aIID);
+
+  /** Like GetEntryForIID, with the manager's lock already held. */
+  xptiInterfaceEntry* GetEntryForIIDLocked(const nsIID& aIID);
+
+private:
+  xptiInterfaceInfoManager();
+  ~xptiInterfaceInfoManager();
+
+  xptiInterfaceEntry* GetEntryForName(const char* aName);
+
+  static PLDHashOperator FindNameEnumerator(PLDHashTable* aTable,
+                                            PLDHashEntryHdr* aHdr,
+                                            PRUint32 aNumber, void* aArg);
+
+  PRLock* mLock;
+  PLDHashTable mIIDTable;
+};
+
+/**
+ * The typelib for the interfaces the bridge and its tests need, written by
+ * hand in nsStandInTypelib.cpp.  The manager registers it first.
+ */
+extern const XPTHeader kStandInTypelib;
+
+#endif /* xptiprivate_h___ */
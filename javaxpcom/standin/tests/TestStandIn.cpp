@@ -0,0 +1,517 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is
+ * IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2005
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+ * Exercises the stand-in runtime without a JVM: the interface info
+ * manager, both xptcall directions, the component manager and the fake
+ * main thread.  Prints one line per check and exits non-zero on failure.
+ */
+
+#include "nsXPCOM.h"
+#include "nsIServiceManager.h"
+#include "nsIComponentManager.h"
+#include "nsIInterfaceInfo.h"
+#include "nsIInterfaceInfoManager.h"
+#include "nsIJXTestParams.h"
+#include "nsIJXTestArrayParams.h"
+#include "nsServiceManagerUtils.h"
+#include "nsThreadUtils.h"
+#include "nsProxyRelease.h"
+#include "nsXPTCUtils.h"
+#include "nsStandInRuntime.h"
+#include "nsStringAPI.h"
+#include "nsCOMPtr.h"
+#include "pldhash.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+static int gFailures = 0;
+
+static void
+Check(bool aCondition, const char* aWhat)
+{
+  printf("%s: %s\n", aCondition ? "PASS" : "FAIL", aWhat);
+  if (!aCondition)
+    ++gFailures;
+}
+
+/***************************************************************************/
+/*
+ * An interface with enough arguments of mixed types to use up both
+ * register files and spill to the stack, described by its own typelib.
+ */
+
+#define NS_ISTANDINTESTMIXED_IID \
+  {0x0d5b6c2e, 0x1f4a, 0x4c39, \
+    { 0x9a, 0x8e, 0x3b, 0x72, 0x5d, 0x61, 0xc0, 0x4f }}
+
+class nsIStandInTestMixed : public nsISupports
+{
+public:
+  NS_DECLARE_STATIC_IID_ACCESSOR(NS_ISTANDINTESTMIXED_IID)
+
+  NS_IMETHOD Mix(PRInt8 a, double b, PRInt16 c, float d, PRInt32 e,
+                 PRInt64 f, PRUint8 g, double h, float i, PRUint64 j,
+                 bool k, double l, double m, double n, double o, double p,
+                 double q, PRUnichar r, PRInt32 s, double* _retval) = 0;
+};
+
+NS_DEFINE_STATIC_IID_ACCESSOR(nsIStandInTestMixed, NS_ISTANDINTESTMIXED_IID)
+
+static const PRUint8 kMixedArgCount = 20;
+
+#define T(tag)  { { tag }, 0, 0, { 0 } }
+
+static XPTParamDescriptor kMixParams[kMixedArgCount] = {
+  { XPT_PD_IN, T(TD_INT8) },   { XPT_PD_IN, T(TD_DOUBLE) },
+  { XPT_PD_IN, T(TD_INT16) },  { XPT_PD_IN, T(TD_FLOAT) },
+  { XPT_PD_IN, T(TD_INT32) },  { XPT_PD_IN, T(TD_INT64) },
+  { XPT_PD_IN, T(TD_UINT8) },  { XPT_PD_IN, T(TD_DOUBLE) },
+  { XPT_PD_IN, T(TD_FLOAT) },  { XPT_PD_IN, T(TD_UINT64) },
+  { XPT_PD_IN, T(TD_BOOL) },   { XPT_PD_IN, T(TD_DOUBLE) },
+  { XPT_PD_IN, T(TD_DOUBLE) }, { XPT_PD_IN, T(TD_DOUBLE) },
+  { XPT_PD_IN, T(TD_DOUBLE) }, { XPT_PD_IN, T(TD_DOUBLE) },
+  { XPT_PD_IN, T(TD_DOUBLE) }, { XPT_PD_IN, T(TD_WCHAR) },
+  { XPT_PD_IN, T(TD_INT32) },
+  { XPT_PD_OUT | XPT_PD_RETVAL, T(TD_DOUBLE) }
+};
+
+static XPTParamDescriptor kMixResult = { XPT_PD_RETVAL, T(TD_UINT32) };
+
+static XPTMethodDescriptor kMixMethods[] = {
+  { "mix", kMixParams, &kMixResult, 0, kMixedArgCount }
+};
+
+static XPTInterfaceDescriptor kMixDescriptor = {
+  1, 1, kMixMethods, 0, nullptr, XPT_ID_SCRIPTABLE, nullptr, 0
+};
+
+static XPTInterfaceDirectoryEntry kMixDirectory[] = {
+  // Described by the stand-in's own typelib.
+  { NS_ISUPPORTS_IID, "nsISupports", "", nullptr },
+  { NS_ISTANDINTESTMIXED_IID, "nsIStandInTestMixed", "", &kMixDescriptor }
+};
+
+static const XPTHeader kMixTypelib = { 2, kMixDirectory };
+
+/* The values every Mix call passes, and the sum it returns. */
+static const PRInt8 kA = -8;
+static const double kB = 1.5;
+static const PRInt16 kC = -1600;
+static const float kD = 2.25f;
+static const PRInt32 kE = -320000;
+static const PRInt64 kF = -(PRInt64(1) << 40);
+static const PRUint8 kG = 200;
+static const double kH = 3.5;
+static const float kI = -4.75f;
+static const PRUint64 kJ = PRUint64(1) << 50;
+static const bool kK = true;
+static const double kL = 0.125, kM = 0.25, kN = 0.5, kO = 1.0, kP = 2.0,
+                    kQ = 4.0;
+static const PRUnichar kR = 0x4e16;
+static const PRInt32 kS = 77;
+
+static double
+MixSum(PRInt8 a, double b, PRInt16 c, float d, PRInt32 e, PRInt64 f,
+       PRUint8 g, double h, float i, PRUint64 j, bool k, double l, double m,
+       double n, double o, double p, double q, PRUnichar r, PRInt32 s)
+{
+  return a + b + c + d + e + double(f) + g + h + i + double(j) + (k ? 1 : 0) +
+         l + m + n + o + p + q + r + s;
+}
+
+class nsStandInTestMixed final : public nsIStandInTestMixed
+{
+public:
+  NS_DECL_ISUPPORTS
+
+  NS_IMETHOD Mix(PRInt8 a, double b, PRInt16 c, float d, PRInt32 e,
+                 PRInt64 f, PRUint8 g, double h, float i, PRUint64 j,
+                 bool k, double l, double m, double n, double o, double p,
+                 double q, PRUnichar r, PRInt32 s, double* _retval)
+  {
+    *_retval = MixSum(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p, q, r,
+                      s);
+    return NS_OK;
+  }
+
+private:
+  ~nsStandInTestMixed() {}
+};
+
+NS_IMPL_ISUPPORTS(nsStandInTestMixed, nsIStandInTestMixed)
+
+/**
+ * An xptcall stub that checks it receives the same arguments a direct
+ * call would have passed.
+ */
+class MixedProxy final : protected nsAutoXPTCStub
+{
+public:
+  NS_DECL_ISUPPORTS
+
+  MixedProxy() : mCalled(false), mArgsMatch(false) {}
+
+  nsresult Init() { return InitStub(NS_GET_IID(nsIStandInTestMixed)); }
+  nsIStandInTestMixed* Stub()
+  {
+    return reinterpret_cast<nsIStandInTestMixed*>(mXPTCStub);
+  }
+
+  NS_IMETHOD CallMethod(PRUint16 aMethodIndex,
+                        const XPTMethodDescriptor* aInfo,
+                        nsXPTCMiniVariant* aParams)
+  {
+    mCalled = aMethodIndex == 3 && aInfo->num_args == kMixedArgCount;
+    const nsXPTCMiniVariant* v = aParams;
+    mArgsMatch = v[0].val.i8 == kA && v[1].val.d == kB &&
+                 v[2].val.i16 == kC && v[3].val.f == kD &&
+                 v[4].val.i32 == kE && v[5].val.i64 == kF &&
+                 v[6].val.u8 == kG && v[7].val.d == kH &&
+                 v[8].val.f == kI && v[9].val.u64 == kJ &&
+                 v[10].val.b == kK && v[11].val.d == kL &&
+                 v[12].val.d == kM && v[13].val.d == kN &&
+                 v[14].val.d == kO && v[15].val.d == kP &&
+                 v[16].val.d == kQ && v[17].val.wc == kR &&
+                 v[18].val.i32 == kS;
+    *static_cast<double*>(v[19].val.p) = 42.0;
+    return NS_OK;
+  }
+
+  bool mCalled;
+  bool mArgsMatch;
+
+private:
+  ~MixedProxy() {}
+};
+
+NS_IMPL_ADDREF(MixedProxy)
+NS_IMPL_RELEASE(MixedProxy)
+
+NS_IMETHODIMP
+MixedProxy::QueryInterface(REFNSIID aIID, void** aResult)
+{
+  if (aIID.Equals(NS_GET_IID(nsISupports))) {
+    AddRef();
+    *aResult = static_cast<nsIXPTCProxy*>(this);
+    return NS_OK;
+  }
+  *aResult = nullptr;
+  return NS_NOINTERFACE;
+}
+
+static void
+TestMixedArguments()
+{
+  nsresult rv = NS_RegisterStandInTypelib(&kMixTypelib);
+  Check(NS_SUCCEEDED(rv), "register a typelib");
+
+  // NS_InvokeByIndex on a compiled implementation.
+  nsCOMPtr<nsIStandInTestMixed> mixed = new nsStandInTestMixed();
+  nsXPTCVariant params[kMixedArgCount];
+  memset(static_cast<void*>(params), 0, sizeof(params));
+  for (PRUint8 i = 0; i < kMixedArgCount; ++i)
+    params[i].type = kMixParams[i].type.prefix;
+  params[0].val.i8 = kA;    params[1].val.d = kB;
+  params[2].val.i16 = kC;   params[3].val.f = kD;
+  params[4].val.i32 = kE;   params[5].val.i64 = kF;
+  params[6].val.u8 = kG;    params[7].val.d = kH;
+  params[8].val.f = kI;     params[9].val.u64 = kJ;
+  params[10].val.b = kK;    params[11].val.d = kL;
+  params[12].val.d = kM;    params[13].val.d = kN;
+  params[14].val.d = kO;    params[15].val.d = kP;
+  params[16].val.d = kQ;    params[17].val.wc = kR;
+  params[18].val.i32 = kS;
+  params[19].SetIndirect();
+
+  rv = NS_InvokeByIndex(mixed, 3, kMixedArgCount, params);
+  double expected = MixSum(kA, kB, kC, kD, kE, kF, kG, kH, kI, kJ, kK, kL,
+                           kM, kN, kO, kP, kQ, kR, kS);
+  Check(NS_SUCCEEDED(rv) && params[19].val.d == expected,
+        "NS_InvokeByIndex passes mixed and spilled arguments");
+
+  // A compiled call through an xptcall stub.
+  MixedProxy* proxy = new MixedProxy();
+  NS_ADDREF(proxy);
+  rv = proxy->Init();
+  Check(NS_SUCCEEDED(rv), "NS_GetXPTCallStub");
+  if (NS_SUCCEEDED(rv)) {
+    double result = 0;
+    rv = proxy->Stub()->Mix(kA, kB, kC, kD, kE, kF, kG, kH, kI, kJ, kK, kL,
+                            kM, kN, kO, kP, kQ, kR, kS, &result);
+    Check(NS_SUCCEEDED(rv) && proxy->mCalled && result == 42.0,
+          "xptcall stub dispatches to CallMethod");
+    Check(proxy->mArgsMatch, "xptcall stub recovers every argument");
+
+    nsCOMPtr<nsISupports> viaQI;
+    rv = proxy->Stub()->QueryInterface(NS_GET_IID(nsIStandInTestMixed),
+                                       getter_AddRefs(viaQI));
+    Check(NS_SUCCEEDED(rv) && viaQI == proxy->Stub(),
+          "xptcall stub answers QueryInterface for its own IID");
+  }
+  NS_RELEASE(proxy);
+}
+
+/***************************************************************************/
+/*
+ * nsIJXTestParams::runTests drives nsIJXTestArrayParams on whatever it is
+ * given.  Handing it a stub that forwards every call with NS_InvokeByIndex
+ * to the native implementation runs the whole path the bridge uses.
+ */
+
+class ForwardingProxy final : protected nsAutoXPTCStub
+{
+public:
+  NS_DECL_ISUPPORTS
+
+  explicit ForwardingProxy(nsISupports* aTarget) : mTarget(aTarget) {}
+
+  nsresult Init() { return InitStub(NS_GET_IID(nsIJXTestArrayParams)); }
+  nsISupports* Stub() { return mXPTCStub; }
+
+  NS_IMETHOD CallMethod(PRUint16 aMethodIndex,
+                        const XPTMethodDescriptor* aInfo,
+                        nsXPTCMiniVariant* aParams)
+  {
+    const nsXPTMethodInfo* info =
+      static_cast<const nsXPTMethodInfo*>(aInfo);
+    PRUint8 count = info->GetParamCount();
+    nsXPTCVariant params[8];
+    if (count > 8)
+      return NS_ERROR_FAILURE;
+
+    for (PRUint8 i = 0; i < count; ++i) {
+      const nsXPTParamInfo param = info->GetParam(i);
+      params[i].Init(aParams[i], param.GetType(),
+                     param.IsOut() ? nsXPTCVariant::PTR_IS_DATA : 0);
+    }
+    return NS_InvokeByIndex(mTarget, aMethodIndex, count, params);
+  }
+
+private:
+  ~ForwardingProxy() {}
+
+  nsCOMPtr<nsISupports> mTarget;
+};
+
+NS_IMPL_ADDREF(ForwardingProxy)
+NS_IMPL_RELEASE(ForwardingProxy)
+
+NS_IMETHODIMP
+ForwardingProxy::QueryInterface(REFNSIID aIID, void** aResult)
+{
+  if (aIID.Equals(NS_GET_IID(nsIJXTestArrayParams))) {
+    AddRef();
+    *aResult = mXPTCStub;
+    return NS_OK;
+  }
+  if (aIID.Equals(NS_GET_IID(nsISupports))) {
+    AddRef();
+    *aResult = static_cast<nsIXPTCProxy*>(this);
+    return NS_OK;
+  }
+  *aResult = nullptr;
+  return NS_NOINTERFACE;
+}
+
+static void
+TestComponentsAndInfo(nsIServiceManager* aServMgr)
+{
+  nsCOMPtr<nsIInterfaceInfoManager> iim =
+    do_GetService(NS_INTERFACEINFOMANAGER_SERVICE_CONTRACTID);
+  Check(iim != nullptr, "get the interface info manager service");
+  if (!iim)
+    return;
+
+  nsCOMPtr<nsIInterfaceInfo> info;
+  nsIID iid = NS_GET_IID(nsIJXTestArrayParams);
+  iim->GetInfoForIID(&iid, getter_AddRefs(info));
+  Check(info != nullptr, "get info for nsIJXTestArrayParams");
+  if (!info)
+    return;
+
+  PRUint16 count = 0, index = 0;
+  const nsXPTMethodInfo* methodInfo = nullptr;
+  info->GetMethodCount(&count);
+  nsresult rv = info->GetMethodInfoForName("copyIntArray", &index,
+                                           &methodInfo);
+  Check(count == 12 && NS_SUCCEEDED(rv) && index == 4,
+        "method indices count from nsISupports");
+
+  nsXPTType elementType;
+  PRUint8 sizeIs = 0;
+  const nsXPTParamInfo param = methodInfo->GetParam(2);
+  info->GetTypeForParam(index, &param, 1, &elementType);
+  info->GetSizeIsArgNumberForParam(index, &param, 0, &sizeIs);
+  Check(elementType.TagPart() == nsXPTType::T_I32 && sizeIs == 1,
+        "array element type and size_is");
+
+  // QueryInterface's info comes from nsISupports.
+  rv = info->GetMethodInfo(0, &methodInfo);
+  Check(NS_SUCCEEDED(rv) && strcmp(methodInfo->GetName(), "QueryInterface") == 0,
+        "inherited method info");
+
+  nsCOMPtr<nsIComponentManager> compMgr = do_QueryInterface(aServMgr);
+  nsCOMPtr<nsIJXTestParams> params;
+  rv = compMgr->CreateInstanceByContractID(
+         "@mozilla.org/javaxpcom/tests/params;1", nullptr,
+         NS_GET_IID(nsIJXTestParams), getter_AddRefs(params));
+  Check(NS_SUCCEEDED(rv), "create the params test component");
+
+  nsCOMPtr<nsISupports> arrays;
+  rv = compMgr->CreateInstanceByContractID(
+         "@mozilla.org/javaxpcom/tests/xpc;1", nullptr,
+         NS_GET_IID(nsIJXTestArrayParams), getter_AddRefs(arrays));
+  Check(NS_SUCCEEDED(rv), "create the array test component");
+  if (!params || !arrays)
+    return;
+
+  ForwardingProxy* proxy = new ForwardingProxy(arrays);
+  NS_ADDREF(proxy);
+  rv = proxy->Init();
+  if (NS_SUCCEEDED(rv))
+    rv = params->RunTests(proxy->Stub());
+  Check(NS_SUCCEEDED(rv), "runTests through a stub and NS_InvokeByIndex");
+  NS_RELEASE(proxy);
+}
+
+/***************************************************************************/
+
+class CountingRunnable : public nsRunnable
+{
+public:
+  CountingRunnable(int* aCounter) : mCounter(aCounter) {}
+
+  NS_IMETHOD Run()
+  {
+    if (NS_IsMainThread())
+      ++*mCounter;
+    return NS_OK;
+  }
+
+private:
+  int* mCounter;
+};
+
+static void*
+DispatchFromThread(void* aCounter)
+{
+  for (int i = 0; i < 10; ++i) {
+    nsCOMPtr<nsIRunnable> event =
+      new CountingRunnable(static_cast<int*>(aCounter));
+    NS_DispatchToMainThread(event);
+  }
+  return nullptr;
+}
+
+static void
+TestMainThread()
+{
+  Check(NS_IsMainThread(), "the initializing thread is the main thread");
+
+  int counter = 0;
+  pthread_t thread;
+  pthread_create(&thread, nullptr, DispatchFromThread, &counter);
+  pthread_join(thread, nullptr);
+
+  NS_ProcessPendingEvents(nullptr);
+  Check(counter == 10, "events dispatched from another thread run on main");
+}
+
+static void
+TestGlue()
+{
+  nsID id;
+  bool parsed = id.Parse(NS_IJXTESTPARAMS_IID_STR);
+  nsIID expected = NS_GET_IID(nsIJXTestParams);
+  char* str = expected.ToString();
+  Check(parsed && id.Equals(expected) && str &&
+        strcmp(str, "{" NS_IJXTESTPARAMS_IID_STR "}") == 0,
+        "nsID parses and prints");
+  NS_Free(str);
+
+  static const char kUTF8[] = "a\xc3\xa9\xe4\xb8\x96\xf0\x9f\x98\x80";
+  NS_ConvertUTF8toUTF16 utf16(kUTF8);
+  NS_ConvertUTF16toUTF8 utf8(utf16);
+  Check(utf16.Length() == 5 && utf8.Equals(kUTF8),
+        "UTF-8 round trip through UTF-16");
+
+  PLDHashTable* table = PL_NewDHashTable(PL_DHashGetStubOps(),
+                                         sizeof(PLDHashEntryStub));
+  bool ok = table != nullptr;
+  for (PRUptrdiff i = 1; ok && i <= 1000; ++i) {
+    PLDHashEntryStub* entry = reinterpret_cast<PLDHashEntryStub*>
+      (PL_DHashTableAdd(table, reinterpret_cast<void*>(i * 8)));
+    ok = entry != nullptr;
+    if (ok)
+      entry->key = reinterpret_cast<void*>(i * 8);
+  }
+  for (PRUptrdiff i = 1; ok && i <= 1000; i += 2)
+    PL_DHashTableRemove(table, reinterpret_cast<void*>(i * 8));
+  for (PRUptrdiff i = 1; ok && i <= 1000; ++i) {
+    bool found = PL_DHashTableSearch(table, reinterpret_cast<void*>(i * 8));
+    ok = found == (i % 2 == 0);
+  }
+  Check(ok && table->entryCount == 500, "pldhash add, remove and search");
+  if (table)
+    PL_DHashTableDestroy(table);
+}
+
+int
+main(int argc, char** argv)
+{
+  nsCOMPtr<nsIServiceManager> servMgr;
+  nsresult rv = NS_InitXPCOM2(getter_AddRefs(servMgr), nullptr, nullptr);
+  Check(NS_SUCCEEDED(rv), "NS_InitXPCOM2");
+  if (NS_FAILED(rv))
+    return 1;
+
+  TestGlue();
+  TestMainThread();
+  TestComponentsAndInfo(servMgr);
+  TestMixedArguments();
+
+  nsIServiceManager* rawServMgr;
+  servMgr.forget(&rawServMgr);
+  rv = NS_ShutdownXPCOM(rawServMgr);
+  Check(NS_SUCCEEDED(rv), "NS_ShutdownXPCOM");
+
+  printf("%d failure(s)\n", gFailures);
+  return gFailures ? 1 : 0;
+}
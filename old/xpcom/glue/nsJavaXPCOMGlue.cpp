@@ -82,15 +82,26 @@ enum {
   kFunc_GetServiceManager,
   kFunc_NewLocalFile,
   kFunc_CallXPCOMMethod,
-  kFunc_FinalizeProxy,
+  kFunc_ReleaseInstances,
   kFunc_IsSameXPCOMObject,
   kFunc_ReleaseProfileLock,
   kFunc_GetNativeHandleFromAWT,
   kFunc_WrapJavaObject,
-  kFunc_WrapXPCOMObject
+  kFunc_WrapXPCOMObject,
+  kFunc_CallXPCOMMethodByIndex,
+  kFunc_CallXPCOMMethodRaw,
+  kFunc_FreeDirectBuffer,
+  kFunc_WrapListElement,
+  kFunc_ReleaseListArray,
+  kFunc_ScheduleAsyncDrain,
+  kFunc_InvokeBatch,
+  kFunc_ResolveBatchMethod,
+  kFunc_SetCallStatsEnabled,
+  kFunc_GetCallStats,
+  kFunc_ResetCallStats
 };
 
-#define JX_NUM_FUNCS 18
+#define JX_NUM_FUNCS 29
 
 
 // Get path string from java.io.File object.
@@ -161,8 +172,8 @@ LoadXULMethods(JNIEnv* env, jobject aXPCOMPath, void** aFunctions)
             (NSFuncPtr*) &aFunctions[kFunc_NewLocalFile] },
     { "_Java_org_mozilla_xpcom_internal_XPCOMJavaProxy_callXPCOMMethod@20",
             (NSFuncPtr*) &aFunctions[kFunc_CallXPCOMMethod] },
-    { "_Java_org_mozilla_xpcom_internal_XPCOMJavaProxy_finalizeProxy@12",
-            (NSFuncPtr*) &aFunctions[kFunc_FinalizeProxy] },
+    { "_Java_org_mozilla_xpcom_internal_XPCOMJavaProxy_releaseInstances@12",
+            (NSFuncPtr*) &aFunctions[kFunc_ReleaseInstances] },
     { "_Java_org_mozilla_xpcom_internal_XPCOMJavaProxy_isSameXPCOMObject@16",
             (NSFuncPtr*) &aFunctions[kFunc_IsSameXPCOMObject] },
     { "_Java_org_mozilla_xpcom_ProfileLock_release@16",
@@ -173,6 +184,28 @@ LoadXULMethods(JNIEnv* env, jobject aXPCOMPath, void** aFunctions)
             (NSFuncPtr*) &aFunctions[kFunc_WrapJavaObject] },
     { "_Java_org_mozilla_xpcom_internal_JavaXPCOMMethods_wrapXPCOMObject@20",
             (NSFuncPtr*) &aFunctions[kFunc_WrapXPCOMObject] },
+    { "_Java_org_mozilla_xpcom_internal_XPCOMJavaBinding_callXPCOMMethod@20",
+            (NSFuncPtr*) &aFunctions[kFunc_CallXPCOMMethodByIndex] },
+    { "_Java_org_mozilla_xpcom_internal_XPCOMJavaBinding_callXPCOMMethodRaw@20",
+            (NSFuncPtr*) &aFunctions[kFunc_CallXPCOMMethodRaw] },
+    { "_Java_org_mozilla_xpcom_internal_XPCOMDirectBuffer_freeBuffer@16",
+            (NSFuncPtr*) &aFunctions[kFunc_FreeDirectBuffer] },
+    { "_Java_org_mozilla_xpcom_internal_XPCOMInterfaceList_wrapElement@20",
+            (NSFuncPtr*) &aFunctions[kFunc_WrapListElement] },
+    { "_Java_org_mozilla_xpcom_internal_XPCOMInterfaceList_releaseArray@16",
+            (NSFuncPtr*) &aFunctions[kFunc_ReleaseListArray] },
+    { "_Java_org_mozilla_xpcom_internal_XPCOMAsyncQueue_scheduleDrain@8",
+            (NSFuncPtr*) &aFunctions[kFunc_ScheduleAsyncDrain] },
+    { "_Java_org_mozilla_xpcom_internal_XPCOMBatch_invoke@28",
+            (NSFuncPtr*) &aFunctions[kFunc_InvokeBatch] },
+    { "_Java_org_mozilla_xpcom_internal_XPCOMBatch_resolveMethod@20",
+            (NSFuncPtr*) &aFunctions[kFunc_ResolveBatchMethod] },
+    { "_Java_org_mozilla_xpcom_internal_JavaXPCOMMethods_setCallStatsEnabled@12",
+            (NSFuncPtr*) &aFunctions[kFunc_SetCallStatsEnabled] },
+    { "_Java_org_mozilla_xpcom_internal_JavaXPCOMMethods_getCallStats@8",
+            (NSFuncPtr*) &aFunctions[kFunc_GetCallStats] },
+    { "_Java_org_mozilla_xpcom_internal_JavaXPCOMMethods_resetCallStats@8",
+            (NSFuncPtr*) &aFunctions[kFunc_ResetCallStats] },
     { nsnull, nsnull }
   };
 #else
@@ -201,8 +234,8 @@ LoadXULMethods(JNIEnv* env, jobject aXPCOMPath, void** aFunctions)
             (NSFuncPtr*) &aFunctions[kFunc_NewLocalFile] },
     { "Java_org_mozilla_xpcom_internal_XPCOMJavaProxy_callXPCOMMethod",
             (NSFuncPtr*) &aFunctions[kFunc_CallXPCOMMethod] },
-    { "Java_org_mozilla_xpcom_internal_XPCOMJavaProxy_finalizeProxy",
-            (NSFuncPtr*) &aFunctions[kFunc_FinalizeProxy] },
+    { "Java_org_mozilla_xpcom_internal_XPCOMJavaProxy_releaseInstances",
+            (NSFuncPtr*) &aFunctions[kFunc_ReleaseInstances] },
     { "Java_org_mozilla_xpcom_internal_XPCOMJavaProxy_isSameXPCOMObject",
             (NSFuncPtr*) &aFunctions[kFunc_IsSameXPCOMObject] },
     { "Java_org_mozilla_xpcom_ProfileLock_release",
@@ -213,6 +246,28 @@ LoadXULMethods(JNIEnv* env, jobject aXPCOMPath, void** aFunctions)
             (NSFuncPtr*) &aFunctions[kFunc_WrapJavaObject] },
     { "Java_org_mozilla_xpcom_internal_JavaXPCOMMethods_wrapXPCOMObject",
             (NSFuncPtr*) &aFunctions[kFunc_WrapXPCOMObject] },
+    { "Java_org_mozilla_xpcom_internal_XPCOMJavaBinding_callXPCOMMethod",
+            (NSFuncPtr*) &aFunctions[kFunc_CallXPCOMMethodByIndex] },
+    { "Java_org_mozilla_xpcom_internal_XPCOMJavaBinding_callXPCOMMethodRaw",
+            (NSFuncPtr*) &aFunctions[kFunc_CallXPCOMMethodRaw] },
+    { "Java_org_mozilla_xpcom_internal_XPCOMDirectBuffer_freeBuffer",
+            (NSFuncPtr*) &aFunctions[kFunc_FreeDirectBuffer] },
+    { "Java_org_mozilla_xpcom_internal_XPCOMInterfaceList_wrapElement",
+            (NSFuncPtr*) &aFunctions[kFunc_WrapListElement] },
+    { "Java_org_mozilla_xpcom_internal_XPCOMInterfaceList_releaseArray",
+            (NSFuncPtr*) &aFunctions[kFunc_ReleaseListArray] },
+    { "Java_org_mozilla_xpcom_internal_XPCOMAsyncQueue_scheduleDrain",
+            (NSFuncPtr*) &aFunctions[kFunc_ScheduleAsyncDrain] },
+    { "Java_org_mozilla_xpcom_internal_XPCOMBatch_invoke",
+            (NSFuncPtr*) &aFunctions[kFunc_InvokeBatch] },
+    { "Java_org_mozilla_xpcom_internal_XPCOMBatch_resolveMethod",
+            (NSFuncPtr*) &aFunctions[kFunc_ResolveBatchMethod] },
+    { "Java_org_mozilla_xpcom_internal_JavaXPCOMMethods_setCallStatsEnabled",
+            (NSFuncPtr*) &aFunctions[kFunc_SetCallStatsEnabled] },
+    { "Java_org_mozilla_xpcom_internal_JavaXPCOMMethods_getCallStats",
+            (NSFuncPtr*) &aFunctions[kFunc_GetCallStats] },
+    { "Java_org_mozilla_xpcom_internal_JavaXPCOMMethods_resetCallStats",
+            (NSFuncPtr*) &aFunctions[kFunc_ResetCallStats] },
     { nsnull, nsnull }
   };
 #endif
@@ -306,14 +361,46 @@ RegisterNativeMethods(JNIEnv* env, void** aFunctions)
 
   JNINativeMethod proxy_methods[] = {
     { "callXPCOMMethod",
-      "(Ljava/lang/Object;Ljava/lang/String;[Ljava/lang/Object;)Ljava/lang/Object;",
+      "(Ljava/lang/Object;Ljava/lang/reflect/Method;[Ljava/lang/Object;)Ljava/lang/Object;",
       (void*) aFunctions[kFunc_CallXPCOMMethod] },
-    { "finalizeProxyNative", "(Ljava/lang/Object;)V",
-      (void*) aFunctions[kFunc_FinalizeProxy] },
+    { "releaseInstances", "([J)V",
+      (void*) aFunctions[kFunc_ReleaseInstances] },
     { "isSameXPCOMObject", "(Ljava/lang/Object;Ljava/lang/Object;)Z",
       (void*) aFunctions[kFunc_IsSameXPCOMObject] }
   };
 
+  JNINativeMethod binding_methods[] = {
+    { "callXPCOMMethod", "(I[J[Ljava/lang/Object;)Ljava/lang/Object;",
+      (void*) aFunctions[kFunc_CallXPCOMMethodByIndex] },
+    { "callXPCOMMethodRaw", "(I[J[Ljava/lang/Object;)J",
+      (void*) aFunctions[kFunc_CallXPCOMMethodRaw] }
+  };
+
+  JNINativeMethod directBuffer_methods[] = {
+    { "freeBuffer", "(J)V",
+      (void*) aFunctions[kFunc_FreeDirectBuffer] }
+  };
+
+  JNINativeMethod interfaceList_methods[] = {
+    { "wrapElement", "(JI)Ljava/lang/Object;",
+      (void*) aFunctions[kFunc_WrapListElement] },
+    { "releaseArray", "(J)V",
+      (void*) aFunctions[kFunc_ReleaseListArray] }
+  };
+
+  JNINativeMethod asyncQueue_methods[] = {
+    { "scheduleDrain", "()Z",
+      (void*) aFunctions[kFunc_ScheduleAsyncDrain] }
+  };
+
+  JNINativeMethod batch_methods[] = {
+    { "invoke",
+      "(Ljava/nio/ByteBuffer;I[Ljava/lang/Object;Ljava/nio/ByteBuffer;[Ljava/lang/Object;)I",
+      (void*) aFunctions[kFunc_InvokeBatch] },
+    { "resolveMethod", "(JLjava/lang/reflect/Method;)I",
+      (void*) aFunctions[kFunc_ResolveBatchMethod] }
+  };
+
   JNINativeMethod lockProxy_methods[] = {
     { "releaseNative", "(J)V",
       (void*) aFunctions[kFunc_ReleaseProfileLock] }
@@ -323,7 +410,13 @@ RegisterNativeMethods(JNIEnv* env, void** aFunctions)
     { "wrapJavaObject", "(Ljava/lang/Object;Ljava/lang/String;)J",
       (void*) aFunctions[kFunc_WrapJavaObject] },
     { "wrapXPCOMObject", "(JLjava/lang/String;)Ljava/lang/Object;",
-      (void*) aFunctions[kFunc_WrapXPCOMObject] }
+      (void*) aFunctions[kFunc_WrapXPCOMObject] },
+    { "setCallStatsEnabled", "(Z)V",
+      (void*) aFunctions[kFunc_SetCallStatsEnabled] },
+    { "getCallStats", "()Ljava/lang/String;",
+      (void*) aFunctions[kFunc_GetCallStats] },
+    { "resetCallStats", "()V",
+      (void*) aFunctions[kFunc_ResetCallStats] }
   };
 
   jint rc = -1;
@@ -358,6 +451,46 @@ RegisterNativeMethods(JNIEnv* env, void** aFunctions)
   }
   NS_ENSURE_TRUE(rc == 0, NS_ERROR_FAILURE);
 
+  rc = -1;
+  clazz = env->FindClass("org/mozilla/xpcom/internal/XPCOMJavaBinding");
+  if (clazz) {
+    rc = env->RegisterNatives(clazz, binding_methods,
+                          sizeof(binding_methods) / sizeof(binding_methods[0]));
+  }
+  NS_ENSURE_TRUE(rc == 0, NS_ERROR_FAILURE);
+
+  rc = -1;
+  clazz = env->FindClass("org/mozilla/xpcom/internal/XPCOMDirectBuffer");
+  if (clazz) {
+    rc = env->RegisterNatives(clazz, directBuffer_methods,
+                sizeof(directBuffer_methods) / sizeof(directBuffer_methods[0]));
+  }
+  NS_ENSURE_TRUE(rc == 0, NS_ERROR_FAILURE);
+
+  rc = -1;
+  clazz = env->FindClass("org/mozilla/xpcom/internal/XPCOMInterfaceList");
+  if (clazz) {
+    rc = env->RegisterNatives(clazz, interfaceList_methods,
+              sizeof(interfaceList_methods) / sizeof(interfaceList_methods[0]));
+  }
+  NS_ENSURE_TRUE(rc == 0, NS_ERROR_FAILURE);
+
+  rc = -1;
+  clazz = env->FindClass("org/mozilla/xpcom/internal/XPCOMAsyncQueue");
+  if (clazz) {
+    rc = env->RegisterNatives(clazz, asyncQueue_methods,
+                    sizeof(asyncQueue_methods) / sizeof(asyncQueue_methods[0]));
+  }
+  NS_ENSURE_TRUE(rc == 0, NS_ERROR_FAILURE);
+
+  rc = -1;
+  clazz = env->FindClass("org/mozilla/xpcom/internal/XPCOMBatch");
+  if (clazz) {
+    rc = env->RegisterNatives(clazz, batch_methods,
+                              sizeof(batch_methods) / sizeof(batch_methods[0]));
+  }
+  NS_ENSURE_TRUE(rc == 0, NS_ERROR_FAILURE);
+
   rc = -1;
   clazz = env->FindClass("org/mozilla/xpcom/ProfileLock");
   if (clazz) {
@@ -0,0 +1,260 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2007
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+import java.io.File;
+import java.io.FileFilter;
+import java.io.IOException;
+
+import org.mozilla.xpcom.Mozilla;
+import org.mozilla.xpcom.XPCOMException;
+import org.mozilla.interfaces.nsIComponentManager;
+import org.mozilla.interfaces.nsIObserver;
+import org.mozilla.interfaces.nsIObserverService;
+import org.mozilla.interfaces.nsIProperties;
+import org.mozilla.interfaces.nsIServiceManager;
+import org.mozilla.interfaces.nsISupports;
+
+/**
+ * Measures calls that fail, in both directions across the bridge.
+ *
+ * The first case calls a native XPCOM method that returns an error, so every
+ * call throws an XPCOMException in Java.  The second case has XPCOM call a
+ * Java observer that throws an XPCOMException, whose error code is then read
+ * back by the native stub.  Some interfaces signal "not found" this way, so
+ * these paths should cost little more than a successful call.
+ */
+
+public class BenchExceptions {
+
+	public static final String NS_PROPERTIES_CONTRACTID =
+			"@mozilla.org/properties;1";
+	public static final String NS_OBSERVERSERVICE_CONTRACTID =
+			"@mozilla.org/observer-service;1";
+
+	private static final String TOPIC = "bench-exceptions";
+	private static final long NS_ERROR_NOT_AVAILABLE = 0x80040111L;
+	private static final int CALLS = 200000;
+
+	private static File grePath;
+
+	/**
+	 * @param args	0 - full path to XULRunner binary directory
+	 */
+	public static void main(String[] args) {
+		try {
+			checkArgs(args);
+		} catch (IllegalArgumentException e) {
+			System.exit(-1);
+		}
+
+		Mozilla mozilla = Mozilla.getInstance();
+		mozilla.initialize(grePath);
+
+		File profile = null;
+		nsIServiceManager servMgr = null;
+		try {
+			profile = createTempProfileDir();
+			LocationProvider locProvider = new LocationProvider(grePath,
+					profile);
+			servMgr = mozilla.initXPCOM(grePath, locProvider);
+		} catch (IOException e) {
+			e.printStackTrace();
+			System.exit(-1);
+		}
+
+		try {
+			runBenchmark(servMgr);
+		} catch (Exception e) {
+			e.printStackTrace();
+			System.exit(-1);
+		}
+
+		System.gc();
+
+		// cleanup
+		mozilla.shutdownXPCOM(servMgr);
+		deleteDir(profile);
+	}
+
+	private static void runBenchmark(nsIServiceManager aServMgr) {
+		nsIComponentManager componentManager =
+				Mozilla.getInstance().getComponentManager();
+		nsIProperties props = (nsIProperties) componentManager
+				.createInstanceByContractID(NS_PROPERTIES_CONTRACTID, null,
+						nsIProperties.NS_IPROPERTIES_IID);
+		nsIObserverService observerService = (nsIObserverService) aServMgr
+				.getServiceByContractID(NS_OBSERVERSERVICE_CONTRACTID,
+						nsIObserverService.NS_IOBSERVERSERVICE_IID);
+		ThrowingObserver observer = new ThrowingObserver();
+		observerService.addObserver(observer, TOPIC, false);
+
+		// warm up
+		callFailingXPCOMMethod(props, CALLS / 10);
+		notifyThrowingObserver(observerService, CALLS / 10);
+
+		System.out.println("case                      calls/s");
+
+		long start = System.currentTimeMillis();
+		callFailingXPCOMMethod(props, CALLS);
+		report("XPCOM error to Java", start);
+
+		start = System.currentTimeMillis();
+		notifyThrowingObserver(observerService, CALLS);
+		report("Java exception to XPCOM", start);
+
+		observerService.removeObserver(observer, TOPIC);
+		if (observer.calls != CALLS + CALLS / 10) {
+			throw new RuntimeException("Observer was called " +
+					observer.calls + " times");
+		}
+	}
+
+	/**
+	 * Gets a property that doesn't exist, which fails with NS_ERROR_FAILURE.
+	 */
+	private static void callFailingXPCOMMethod(nsIProperties aProps,
+			int aCount) {
+		for (int i = 0; i < aCount; i++) {
+			try {
+				aProps.get("no-such-property", nsISupports.NS_ISUPPORTS_IID);
+				throw new RuntimeException("Expected XPCOMException");
+			} catch (XPCOMException e) {
+			}
+		}
+	}
+
+	private static void notifyThrowingObserver(
+			nsIObserverService aObserverService, int aCount) {
+		for (int i = 0; i < aCount; i++) {
+			aObserverService.notifyObservers(null, TOPIC, null);
+		}
+	}
+
+	private static void report(String aName, long aStart) {
+		long elapsed = Math.max(System.currentTimeMillis() - aStart, 1);
+		System.out.println(pad(aName, -23) +
+				pad(Long.toString(Math.round((double) CALLS * 1000 / elapsed)),
+					10));
+	}
+
+	static class ThrowingObserver implements nsIObserver {
+		int calls = 0;
+
+		public void observe(nsISupports aSubject, String aTopic,
+				String aData) {
+			calls++;
+			throw new XPCOMException(NS_ERROR_NOT_AVAILABLE);
+		}
+
+		public nsISupports queryInterface(String aIID) {
+			return Mozilla.queryInterface(this, aIID);
+		}
+	}
+
+	/**
+	 * Pads the given string with spaces; on the left for a positive width,
+	 * and on the right for a negative one.
+	 */
+	private static String pad(String aString, int aWidth) {
+		StringBuffer buf = new StringBuffer();
+		int width = Math.abs(aWidth);
+		if (aWidth < 0) {
+			buf.append(aString);
+		}
+		for (int i = aString.length(); i < width; i++) {
+			buf.append(' ');
+		}
+		if (aWidth > 0) {
+			buf.append(aString);
+		}
+		return buf.toString();
+	}
+
+	private static void checkArgs(String[] args) {
+		if (args.length != 1) {
+			printUsage();
+			throw new IllegalArgumentException();
+		}
+
+		grePath = new File(args[0]);
+		if (!grePath.exists() || !grePath.isDirectory()) {
+			System.err.println("ERROR: given path doesn't exist");
+			printUsage();
+			throw new IllegalArgumentException();
+		}
+	}
+
+	private static void printUsage() {
+		System.err.println("usage: java BenchExceptions <XULRunner bin dir>");
+	}
+
+	private static File createTempProfileDir() throws IOException {
+		// Get name of temporary profile directory
+		File profile = File.createTempFile("mozilla-test-", null);
+		profile.delete();
+
+		// On some operating systems (particularly Windows), the previous
+		// temporary profile may not have been deleted. Delete them now.
+		File[] files = profile.getParentFile()
+				.listFiles(new FileFilter() {
+					public boolean accept(File file) {
+						if (file.getName().startsWith("mozilla-test-")) {
+							return true;
+						}
+						return false;
+					}
+				});
+		for (int i = 0; i < files.length; i++) {
+			deleteDir(files[i]);
+		}
+
+		// Create temporary profile directory
+		profile.mkdir();
+
+		return profile;
+	}
+
+	private static void deleteDir(File dir) {
+		File[] files = dir.listFiles();
+		for (int i = 0; i < files.length; i++) {
+			if (files[i].isDirectory()) {
+				deleteDir(files[i]);
+			}
+			files[i].delete();
+		}
+		dir.delete();
+	}
+}
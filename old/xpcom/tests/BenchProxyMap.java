@@ -0,0 +1,259 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2007
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+
+import java.io.File;
+import java.io.FileFilter;
+import java.io.IOException;
+
+import org.mozilla.xpcom.Mozilla;
+import org.mozilla.interfaces.nsIComponentManager;
+import org.mozilla.interfaces.nsIMutableArray;
+import org.mozilla.interfaces.nsIServiceManager;
+import org.mozilla.interfaces.nsISupports;
+import org.mozilla.interfaces.nsISupportsCString;
+
+/**
+ * Measures how well the lookup of existing Java proxies for XPCOM objects
+ * scales with the number of threads.
+ *
+ * Each thread fills its own nsIMutableArray with native XPCOM objects, keeps
+ * their Java proxies alive, and then repeatedly gets the objects back out of
+ * the array.  Every call returns an XPCOM object that already has a Java proxy,
+ * so the time is dominated by the call itself and the NativeToJavaProxyMap
+ * lookup.  With no lock shared between threads, throughput should grow nearly
+ * linearly with the thread count, up to the number of available CPUs.
+ */
+
+public class BenchProxyMap {
+
+	public static final String NS_ARRAY_CONTRACTID = "@mozilla.org/array;1";
+	public static final String NS_SUPPORTS_CSTRING_CONTRACTID =
+			"@mozilla.org/supports-cstring;1";
+
+	private static final int[] THREAD_COUNTS = { 1, 2, 4, 8, 16 };
+	private static final int OBJECTS_PER_THREAD = 64;
+	private static final int CALLS_PER_THREAD = 200000;
+
+	private static File grePath;
+
+	/**
+	 * @param args	0 - full path to XULRunner binary directory
+	 */
+	public static void main(String[] args) {
+		try {
+			checkArgs(args);
+		} catch (IllegalArgumentException e) {
+			System.exit(-1);
+		}
+
+		Mozilla mozilla = Mozilla.getInstance();
+		mozilla.initialize(grePath);
+
+		File profile = null;
+		nsIServiceManager servMgr = null;
+		try {
+			profile = createTempProfileDir();
+			LocationProvider locProvider = new LocationProvider(grePath,
+					profile);
+			servMgr = mozilla.initXPCOM(grePath, locProvider);
+		} catch (IOException e) {
+			e.printStackTrace();
+			System.exit(-1);
+		}
+
+		try {
+			runBenchmark();
+		} catch (Exception e) {
+			e.printStackTrace();
+			System.exit(-1);
+		}
+
+		System.gc();
+
+		// cleanup
+		mozilla.shutdownXPCOM(servMgr);
+		deleteDir(profile);
+	}
+
+	private static void runBenchmark() throws InterruptedException {
+		// warm up
+		runThreads(1);
+
+		double base = 0;
+		System.out.println("threads     calls/s  speedup");
+		for (int i = 0; i < THREAD_COUNTS.length; i++) {
+			int threads = THREAD_COUNTS[i];
+			double rate = runThreads(threads);
+			if (base == 0) {
+				base = rate;
+			}
+			System.out.println(pad(Integer.toString(threads), 7) +
+					pad(Long.toString(Math.round(rate)), 12) +
+					pad(Double.toString(Math.round(rate / base * 100) / 100.0),
+						9));
+		}
+	}
+
+	/**
+	 * Runs the lookup loop on the given number of threads at once.
+	 *
+	 * @return  total number of calls per second
+	 */
+	private static double runThreads(int aCount) throws InterruptedException {
+		Worker[] workers = new Worker[aCount];
+		for (int i = 0; i < aCount; i++) {
+			workers[i] = new Worker();
+		}
+
+		long start = System.currentTimeMillis();
+		for (int i = 0; i < aCount; i++) {
+			workers[i].start();
+		}
+		for (int i = 0; i < aCount; i++) {
+			workers[i].join();
+		}
+		long elapsed = Math.max(System.currentTimeMillis() - start, 1);
+
+		for (int i = 0; i < aCount; i++) {
+			if (workers[i].error != null) {
+				throw new RuntimeException(workers[i].error);
+			}
+		}
+		return (double) aCount * CALLS_PER_THREAD * 1000 / elapsed;
+	}
+
+	static class Worker extends Thread {
+		Throwable error;
+
+		public void run() {
+			try {
+				Mozilla mozilla = Mozilla.getInstance();
+				nsIComponentManager componentManager =
+						mozilla.getComponentManager();
+				nsIMutableArray array = (nsIMutableArray) componentManager
+						.createInstanceByContractID(NS_ARRAY_CONTRACTID, null,
+								nsIMutableArray.NS_IMUTABLEARRAY_IID);
+
+				// hold on to the proxies, so they are found in the map
+				nsISupports[] objects = new nsISupports[OBJECTS_PER_THREAD];
+				for (int i = 0; i < OBJECTS_PER_THREAD; i++) {
+					objects[i] = componentManager.createInstanceByContractID(
+							NS_SUPPORTS_CSTRING_CONTRACTID, null,
+							nsISupportsCString.NS_ISUPPORTSCSTRING_IID);
+					array.appendElement(objects[i], false);
+				}
+
+				for (int i = 0; i < CALLS_PER_THREAD; i++) {
+					nsISupports obj = array.queryElementAt(
+							i % OBJECTS_PER_THREAD,
+							nsISupportsCString.NS_ISUPPORTSCSTRING_IID);
+					if (obj != objects[i % OBJECTS_PER_THREAD]) {
+						throw new RuntimeException("Got a new proxy for " +
+								"an existing XPCOM object");
+					}
+				}
+
+				array.clear();
+			} catch (Throwable e) {
+				error = e;
+			}
+		}
+	}
+
+	private static String pad(String aString, int aWidth) {
+		StringBuffer buf = new StringBuffer();
+		for (int i = aString.length(); i < aWidth; i++) {
+			buf.append(' ');
+		}
+		return buf.append(aString).toString();
+	}
+
+	private static void checkArgs(String[] args) {
+		if (args.length != 1) {
+			printUsage();
+			throw new IllegalArgumentException();
+		}
+
+		grePath = new File(args[0]);
+		if (!grePath.exists() || !grePath.isDirectory()) {
+			System.err.println("ERROR: given path doesn't exist");
+			printUsage();
+			throw new IllegalArgumentException();
+		}
+	}
+
+	private static void printUsage() {
+		System.err.println("usage: java BenchProxyMap <XULRunner bin dir>");
+	}
+
+	private static File createTempProfileDir() throws IOException {
+		// Get name of temporary profile directory
+		File profile = File.createTempFile("mozilla-test-", null);
+		profile.delete();
+
+		// On some operating systems (particularly Windows), the previous
+		// temporary profile may not have been deleted. Delete them now.
+		File[] files = profile.getParentFile()
+				.listFiles(new FileFilter() {
+					public boolean accept(File file) {
+						if (file.getName().startsWith("mozilla-test-")) {
+							return true;
+						}
+						return false;
+					}
+				});
+		for (int i = 0; i < files.length; i++) {
+			deleteDir(files[i]);
+		}
+
+		// Create temporary profile directory
+		profile.mkdir();
+
+		return profile;
+	}
+
+	private static void deleteDir(File dir) {
+		File[] files = dir.listFiles();
+		for (int i = 0; i < files.length; i++) {
+			if (files[i].isDirectory()) {
+				deleteDir(files[i]);
+			}
+			files[i].delete();
+		}
+		dir.delete();
+	}
+}
@@ -0,0 +1,276 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2007
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+import java.io.File;
+import java.io.FileFilter;
+import java.io.IOException;
+
+import org.mozilla.xpcom.Mozilla;
+import org.mozilla.interfaces.nsIComponentManager;
+import org.mozilla.interfaces.nsIServiceManager;
+import org.mozilla.interfaces.nsISupportsCString;
+
+/**
+ * Measures passing large strings to and from AUTF8String/ACString params.
+ *
+ * Each case stores a string in an nsISupportsCString (Java to UTF-8) and
+ * reads it back (UTF-8 to Java), for sizes from 1 KB to 1 MB of chars.  The
+ * "ascii" strings take the vectorized fast path; the "mixed" strings add
+ * 2-byte, 3-byte and supplementary characters every few chars.  Results are
+ * in MB of Java chars per second, so they can be compared with a build that
+ * still uses GetStringUTFChars()/NewStringUTF().
+ *
+ * Before timing, each string is checked to survive the round trip unchanged,
+ * including an embedded NUL and a surrogate pair, which the JNI "modified
+ * UTF-8" functions would have mangled.
+ */
+
+public class BenchUTF8Strings {
+
+	public static final String NS_SUPPORTS_CSTRING_CONTRACTID =
+			"@mozilla.org/supports-cstring;1";
+
+	private static final int[] SIZES = { 1024, 64 * 1024, 1024 * 1024 };
+
+	// Total number of chars to convert for each case
+	private static final long CHARS_PER_CASE = 256L * 1024 * 1024;
+
+	private static File grePath;
+
+	/**
+	 * @param args	0 - full path to XULRunner binary directory
+	 */
+	public static void main(String[] args) {
+		try {
+			checkArgs(args);
+		} catch (IllegalArgumentException e) {
+			System.exit(-1);
+		}
+
+		Mozilla mozilla = Mozilla.getInstance();
+		mozilla.initialize(grePath);
+
+		File profile = null;
+		nsIServiceManager servMgr = null;
+		try {
+			profile = createTempProfileDir();
+			LocationProvider locProvider = new LocationProvider(grePath,
+					profile);
+			servMgr = mozilla.initXPCOM(grePath, locProvider);
+		} catch (IOException e) {
+			e.printStackTrace();
+			System.exit(-1);
+		}
+
+		try {
+			runBenchmark();
+		} catch (Exception e) {
+			e.printStackTrace();
+			System.exit(-1);
+		}
+
+		System.gc();
+
+		// cleanup
+		mozilla.shutdownXPCOM(servMgr);
+		deleteDir(profile);
+	}
+
+	private static void runBenchmark() {
+		nsIComponentManager componentManager =
+				Mozilla.getInstance().getComponentManager();
+		nsISupportsCString cstr = (nsISupportsCString) componentManager
+				.createInstanceByContractID(NS_SUPPORTS_CSTRING_CONTRACTID,
+						null, nsISupportsCString.NS_ISUPPORTSCSTRING_IID);
+
+		checkRoundTrip(cstr, "nul\u0000char");
+		checkRoundTrip(cstr, "pair\uD83D\uDE00pair");
+		checkRoundTrip(cstr, "2-byte \u00e9, 3-byte \u20ac");
+
+		System.out.println("case                  set MB/s   get MB/s");
+
+		for (int i = 0; i < SIZES.length; i++) {
+			runCase(cstr, "ascii", makeString(SIZES[i], false));
+			runCase(cstr, "mixed", makeString(SIZES[i], true));
+		}
+	}
+
+	private static void runCase(nsISupportsCString aString, String aName,
+			String aValue) {
+		checkRoundTrip(aString, aValue);
+
+		int count = (int) Math.max(CHARS_PER_CASE / aValue.length(), 1);
+
+		// warm up
+		for (int i = 0; i < count / 10; i++) {
+			aString.setData(aValue);
+			aString.getData();
+		}
+
+		long start = System.currentTimeMillis();
+		for (int i = 0; i < count; i++) {
+			aString.setData(aValue);
+		}
+		long setTime = Math.max(System.currentTimeMillis() - start, 1);
+
+		start = System.currentTimeMillis();
+		for (int i = 0; i < count; i++) {
+			aString.getData();
+		}
+		long getTime = Math.max(System.currentTimeMillis() - start, 1);
+
+		double megs = (double) aValue.length() * count / (1024 * 1024);
+		System.out.println(pad(aName + " " + (aValue.length() / 1024) + "K",
+				-18) + pad(Long.toString(Math.round(megs * 1000 / setTime)),
+				11) + pad(Long.toString(Math.round(megs * 1000 / getTime)),
+				11));
+	}
+
+	private static void checkRoundTrip(nsISupportsCString aString,
+			String aValue) {
+		aString.setData(aValue);
+		if (!aValue.equals(aString.getData())) {
+			throw new RuntimeException("String of length " +
+					aValue.length() + " did not survive the round trip");
+		}
+	}
+
+	/**
+	 * Creates a string of the given length.  If aMixed is true, every eighth
+	 * char is non-ASCII, cycling through 2-byte, 3-byte and supplementary
+	 * (surrogate pair) characters.
+	 */
+	private static String makeString(int aLength, boolean aMixed) {
+		StringBuffer buf = new StringBuffer(aLength);
+		int n = 0;
+		while (buf.length() < aLength) {
+			if (aMixed && n % 8 == 7) {
+				switch ((n / 8) % 3) {
+					case 0:
+						buf.append('\u00e9');
+						break;
+					case 1:
+						buf.append('\u20ac');
+						break;
+					default:
+						if (buf.length() + 2 <= aLength) {
+							buf.append("\uD83D\uDE00");
+						} else {
+							buf.append('x');
+						}
+						break;
+				}
+			} else {
+				buf.append((char) ('a' + n % 26));
+			}
+			n++;
+		}
+		return buf.toString();
+	}
+
+	/**
+	 * Pads the given string with spaces; on the left for a positive width,
+	 * and on the right for a negative one.
+	 */
+	private static String pad(String aString, int aWidth) {
+		StringBuffer buf = new StringBuffer();
+		int width = Math.abs(aWidth);
+		if (aWidth < 0) {
+			buf.append(aString);
+		}
+		for (int i = aString.length(); i < width; i++) {
+			buf.append(' ');
+		}
+		if (aWidth > 0) {
+			buf.append(aString);
+		}
+		return buf.toString();
+	}
+
+	private static void checkArgs(String[] args) {
+		if (args.length != 1) {
+			printUsage();
+			throw new IllegalArgumentException();
+		}
+
+		grePath = new File(args[0]);
+		if (!grePath.exists() || !grePath.isDirectory()) {
+			System.err.println("ERROR: given path doesn't exist");
+			printUsage();
+			throw new IllegalArgumentException();
+		}
+	}
+
+	private static void printUsage() {
+		System.err.println("usage: java BenchUTF8Strings <XULRunner bin dir>");
+	}
+
+	private static File createTempProfileDir() throws IOException {
+		// Get name of temporary profile directory
+		File profile = File.createTempFile("mozilla-test-", null);
+		profile.delete();
+
+		// On some operating systems (particularly Windows), the previous
+		// temporary profile may not have been deleted. Delete them now.
+		File[] files = profile.getParentFile()
+				.listFiles(new FileFilter() {
+					public boolean accept(File file) {
+						if (file.getName().startsWith("mozilla-test-")) {
+							return true;
+						}
+						return false;
+					}
+				});
+		for (int i = 0; i < files.length; i++) {
+			deleteDir(files[i]);
+		}
+
+		// Create temporary profile directory
+		profile.mkdir();
+
+		return profile;
+	}
+
+	private static void deleteDir(File dir) {
+		File[] files = dir.listFiles();
+		for (int i = 0; i < files.length; i++) {
+			if (files[i].isDirectory()) {
+				deleteDir(files[i]);
+			}
+			files[i].delete();
+		}
+		dir.delete();
+	}
+}
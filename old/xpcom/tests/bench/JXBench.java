@@ -0,0 +1,797 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2007
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+
+import java.io.File;
+import java.io.FileFilter;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.OutputStreamWriter;
+import java.io.PrintWriter;
+import java.lang.reflect.Array;
+import java.lang.reflect.InvocationTargetException;
+import java.lang.reflect.Method;
+import java.util.ArrayList;
+import java.util.Iterator;
+
+import org.mozilla.xpcom.Mozilla;
+import org.mozilla.interfaces.nsIJXBenchCallback;
+import org.mozilla.interfaces.nsIJXBenchLinkA;
+import org.mozilla.interfaces.nsIJXBenchLinkB;
+import org.mozilla.interfaces.nsIJXBenchLinkC;
+import org.mozilla.interfaces.nsIJXBenchTarget;
+import org.mozilla.interfaces.nsIServiceManager;
+import org.mozilla.interfaces.nsISupports;
+
+/**
+ * Times Java to XPCOM round trips, in the style of a JMH throughput
+ * benchmark, and writes the results as JSON.
+ *
+ * Each case runs for a number of warmup iterations and then a number of
+ * measured iterations of a fixed length.  An iteration calls the case in
+ * batches, doubling the batch size while a batch takes less than a
+ * millisecond, and scores the number of operations per second.  The JSON
+ * output follows the layout of JMH's "-rf json" results, so the usual JMH
+ * tools can compare two runs.
+ *
+ * The calls go to the JavaScript component in nsJXBench.js, whose methods do
+ * nothing but return constants, so the time of a call is dominated by the
+ * marshalling in nsJavaWrapper.cpp and nsJavaXPTCStub.cpp, plus a constant
+ * XPConnect cost.  The primitive cases call the target through
+ * java.lang.reflect.Method, which adds the same small cost to each of them.
+ */
+
+public class JXBench {
+
+	public static final String JXBENCH_CONTRACTID =
+			"@mozilla.org/javaxpcom/tests/bench;1";
+
+	private static final int[] STRING_BYTES =
+			{ 16, 256, 4096, 65536, 1024 * 1024 };
+	private static final int[] ARRAY_LENGTHS =
+			{ 1, 16, 1024, 65536, 1024 * 1024 };
+
+	private static final String[] PRIMITIVE_TYPES = {
+		"boolean", "octet", "short", "long", "long long", "unsigned short",
+		"unsigned long", "unsigned long long", "float", "double", "char",
+		"wchar"
+	};
+	private static final String[] PRIMITIVE_METHOD_SUFFIXES = {
+		"Boolean", "Octet", "Short", "Long", "LongLong", "UShort", "ULong",
+		"ULongLong", "Float", "Double", "Char", "WChar"
+	};
+
+	// Number of proxies created by the churn case between forced GCs
+	private static final int CHURN_GC_INTERVAL = 1024;
+
+	// A batch is grown until it takes at least this long
+	private static final long MIN_BATCH_NANOS = 1000000;
+	private static final int MAX_BATCH = 1 << 24;
+
+	private static File grePath;
+	private static String outputFile = null;
+	private static String filter = null;
+	private static int warmupIterations = 3;
+	private static int measurementIterations = 5;
+	private static long iterationMillis = 500;
+
+	private static nsIJXBenchTarget target;
+
+	/**
+	 * @param args	0 - full path to XULRunner binary directory
+	 *              followed by any of:
+	 *              -o <file>  write the JSON results to a file instead of
+	 *                         standard output
+	 *              -b <text>  only run cases whose name contains text
+	 *              -wi <n>    number of warmup iterations
+	 *              -i <n>     number of measured iterations
+	 *              -r <ms>    length of an iteration
+	 */
+	public static void main(String[] args) {
+		try {
+			checkArgs(args);
+		} catch (IllegalArgumentException e) {
+			System.exit(-1);
+		}
+
+		Mozilla mozilla = Mozilla.getInstance();
+		mozilla.initialize(grePath);
+
+		File profile = null;
+		nsIServiceManager servMgr = null;
+		try {
+			profile = createTempProfileDir();
+			LocationProvider locProvider = new LocationProvider(grePath,
+					profile);
+			servMgr = mozilla.initXPCOM(grePath, locProvider);
+		} catch (IOException e) {
+			e.printStackTrace();
+			System.exit(-1);
+		}
+
+		try {
+			target = (nsIJXBenchTarget) mozilla.getComponentManager()
+					.createInstanceByContractID(JXBENCH_CONTRACTID, null,
+							nsIJXBenchTarget.NS_IJXBENCHTARGET_IID);
+			ArrayList results = runCases(createCases());
+			writeResults(results);
+		} catch (Exception e) {
+			e.printStackTrace();
+			System.exit(-1);
+		}
+
+		target = null;
+		System.gc();
+
+		// cleanup
+		mozilla.shutdownXPCOM(servMgr);
+		deleteDir(profile);
+	}
+
+	/**
+	 * One benchmark.  <code>run</code> performs the given number of
+	 * operations.
+	 */
+	static abstract class Case {
+		final String name;
+		final String paramName;
+		final String paramValue;
+		int batch = 1;
+
+		Case(String aName) {
+			this(aName, null, null);
+		}
+
+		Case(String aName, String aParamName, String aParamValue) {
+			name = aName;
+			paramName = aParamName;
+			paramValue = aParamValue;
+		}
+
+		void setUp() throws Exception {
+		}
+
+		abstract void run(int aOps) throws Exception;
+
+		String getLabel() {
+			if (paramName == null) {
+				return name;
+			}
+			return name + " (" + paramName + "=" + paramValue + ")";
+		}
+	}
+
+	static class Result {
+		final Case benchCase;
+		final double[] scores;
+
+		Result(Case aCase, double[] aScores) {
+			benchCase = aCase;
+			scores = aScores;
+		}
+
+		double getMean() {
+			double sum = 0;
+			for (int i = 0; i < scores.length; i++) {
+				sum += scores[i];
+			}
+			return sum / scores.length;
+		}
+
+		/**
+		 * Half width of the 99.9% confidence interval of the mean, as JMH
+		 * reports it.
+		 */
+		double getError() {
+			int n = scores.length;
+			if (n < 2) {
+				return Double.NaN;
+			}
+			double mean = getMean();
+			double sumSq = 0;
+			for (int i = 0; i < n; i++) {
+				sumSq += (scores[i] - mean) * (scores[i] - mean);
+			}
+			double stddev = Math.sqrt(sumSq / (n - 1));
+			return studentT999(n - 1) * stddev / Math.sqrt(n);
+		}
+	}
+
+	// Two-sided 99.9% quantiles of Student's t distribution, for 1 to 30
+	// degrees of freedom
+	private static final double[] T_999 = {
+		636.619, 31.599, 12.924, 8.610, 6.869, 5.959, 5.408, 5.041, 4.781,
+		4.587, 4.437, 4.318, 4.221, 4.140, 4.073, 4.015, 3.965, 3.922, 3.883,
+		3.850, 3.819, 3.792, 3.768, 3.745, 3.725, 3.707, 3.690, 3.674, 3.659,
+		3.646
+	};
+
+	private static double studentT999(int aDegrees) {
+		if (aDegrees <= T_999.length) {
+			return T_999[aDegrees - 1];
+		}
+		return 3.291;
+	}
+
+	private static ArrayList createCases() throws Exception {
+		ArrayList cases = new ArrayList();
+
+		// void no-arg calls, both ways
+		cases.add(new Case("javaToXPCOM.voidCall") {
+			void run(int aOps) {
+				for (int i = 0; i < aOps; i++) {
+					target.voidCall();
+				}
+			}
+		});
+		cases.add(new Case("xpcomToJava.voidCall") {
+			nsIJXBenchCallback callback = new Callback();
+
+			void run(int aOps) {
+				target.callVoid(callback, aOps);
+			}
+		});
+
+		// each primitive type as in, out and retval
+		for (int i = 0; i < PRIMITIVE_TYPES.length; i++) {
+			String suffix = PRIMITIVE_METHOD_SUFFIXES[i];
+			cases.add(new ReflectCase("primitive.in", PRIMITIVE_TYPES[i],
+					"in" + suffix));
+			cases.add(new ReflectCase("primitive.out", PRIMITIVE_TYPES[i],
+					"out" + suffix));
+			cases.add(new ReflectCase("primitive.retval", PRIMITIVE_TYPES[i],
+					"ret" + suffix));
+		}
+
+		// strings; an AString of n bytes has n / 2 chars
+		for (int i = 0; i < STRING_BYTES.length; i++) {
+			final int bytes = STRING_BYTES[i];
+			final String param = Integer.toString(bytes);
+			final String wide = makeString(bytes / 2);
+			final String narrow = makeString(bytes);
+
+			cases.add(new Case("string.inAString", "bytes", param) {
+				void run(int aOps) {
+					for (int j = 0; j < aOps; j++) {
+						target.inAString(wide);
+					}
+				}
+			});
+			cases.add(new Case("string.retAString", "bytes", param) {
+				void setUp() {
+					target.setStringLength(bytes / 2);
+				}
+
+				void run(int aOps) {
+					for (int j = 0; j < aOps; j++) {
+						target.retAString();
+					}
+				}
+			});
+			cases.add(new Case("string.inACString", "bytes", param) {
+				void run(int aOps) {
+					for (int j = 0; j < aOps; j++) {
+						target.inACString(narrow);
+					}
+				}
+			});
+			cases.add(new Case("string.retACString", "bytes", param) {
+				void setUp() {
+					target.setStringLength(bytes);
+				}
+
+				void run(int aOps) {
+					for (int j = 0; j < aOps; j++) {
+						target.retACString();
+					}
+				}
+			});
+		}
+
+		// primitive arrays
+		for (int i = 0; i < ARRAY_LENGTHS.length; i++) {
+			final int length = ARRAY_LENGTHS[i];
+			final String param = Integer.toString(length);
+			final short[] octets = new short[length];
+			final int[] longs = new int[length];
+			final double[] doubles = new double[length];
+
+			cases.add(new Case("array.inOctet", "length", param) {
+				void run(int aOps) {
+					for (int j = 0; j < aOps; j++) {
+						target.inOctetArray(length, octets);
+					}
+				}
+			});
+			cases.add(new Case("array.retOctet", "length", param) {
+				void run(int aOps) {
+					for (int j = 0; j < aOps; j++) {
+						target.retOctetArray(length);
+					}
+				}
+			});
+			cases.add(new Case("array.inLong", "length", param) {
+				void run(int aOps) {
+					for (int j = 0; j < aOps; j++) {
+						target.inLongArray(length, longs);
+					}
+				}
+			});
+			cases.add(new Case("array.retLong", "length", param) {
+				void run(int aOps) {
+					for (int j = 0; j < aOps; j++) {
+						target.retLongArray(length);
+					}
+				}
+			});
+			cases.add(new Case("array.inDouble", "length", param) {
+				void run(int aOps) {
+					for (int j = 0; j < aOps; j++) {
+						target.inDoubleArray(length, doubles);
+					}
+				}
+			});
+			cases.add(new Case("array.retDouble", "length", param) {
+				void run(int aOps) {
+					for (int j = 0; j < aOps; j++) {
+						target.retDoubleArray(length);
+					}
+				}
+			});
+		}
+
+		// Interface params.  The "hit" cases pass or return an object whose
+		// stub or proxy already exists; the "miss" cases need a new one on
+		// every call.
+		cases.add(new Case("interface.inHit") {
+			nsISupports object = new JavaObject();
+
+			void run(int aOps) {
+				for (int i = 0; i < aOps; i++) {
+					target.inInterface(object);
+				}
+			}
+		});
+		cases.add(new Case("interface.inMiss") {
+			void run(int aOps) {
+				for (int i = 0; i < aOps; i++) {
+					target.inInterface(new JavaObject());
+				}
+			}
+		});
+		cases.add(new Case("interface.retvalHit") {
+			nsISupports object;
+
+			void setUp() {
+				// hold on to the proxy, so that it is found in the map
+				object = target.retInterface();
+			}
+
+			void run(int aOps) {
+				for (int i = 0; i < aOps; i++) {
+					target.retInterface();
+				}
+			}
+		});
+		cases.add(new Case("interface.retvalMiss") {
+			void run(int aOps) {
+				for (int i = 0; i < aOps; i++) {
+					target.newInterface();
+				}
+			}
+		});
+
+		// QueryInterface along a chain of interfaces of one object
+		cases.add(new Case("qi.chain") {
+			void run(int aOps) {
+				for (int i = 0; i < aOps; i++) {
+					nsIJXBenchLinkA a = (nsIJXBenchLinkA) target.queryInterface(
+							nsIJXBenchLinkA.NS_IJXBENCHLINKA_IID);
+					nsIJXBenchLinkB b = (nsIJXBenchLinkB) a.queryInterface(
+							nsIJXBenchLinkB.NS_IJXBENCHLINKB_IID);
+					nsIJXBenchLinkC c = (nsIJXBenchLinkC) b.queryInterface(
+							nsIJXBenchLinkC.NS_IJXBENCHLINKC_IID);
+					c.queryInterface(nsIJXBenchTarget.NS_IJXBENCHTARGET_IID);
+				}
+			}
+		});
+
+		// Creates proxies for new XPCOM objects and drops them.  The time
+		// includes a GC every CHURN_GC_INTERVAL proxies, so that the cost of
+		// tearing the proxies down is counted too.
+		cases.add(new Case("churn.proxies") {
+			int count = 0;
+
+			void run(int aOps) {
+				for (int i = 0; i < aOps; i++) {
+					target.newInterface();
+					if (++count % CHURN_GC_INTERVAL == 0) {
+						System.gc();
+					}
+				}
+			}
+		});
+
+		return cases;
+	}
+
+	/**
+	 * Calls a method of the target through reflection, with an out param
+	 * passed as a one-element array.
+	 */
+	static class ReflectCase extends Case {
+		final Method method;
+		final Object[] args;
+
+		ReflectCase(String aName, String aType, String aMethodName)
+				throws NoSuchMethodException {
+			super(aName, "type", aType);
+			method = getMethod(nsIJXBenchTarget.class, aMethodName);
+			Class[] types = method.getParameterTypes();
+			args = new Object[types.length];
+			for (int i = 0; i < types.length; i++) {
+				if (types[i].isArray()) {
+					args[i] = Array.newInstance(types[i].getComponentType(), 1);
+				} else {
+					args[i] = getValue(types[i]);
+				}
+			}
+		}
+
+		void run(int aOps) throws Exception {
+			try {
+				for (int i = 0; i < aOps; i++) {
+					method.invoke(target, args);
+				}
+			} catch (InvocationTargetException e) {
+				if (e.getCause() instanceof Exception) {
+					throw (Exception) e.getCause();
+				}
+				throw e;
+			}
+		}
+
+		private static Object getValue(Class aType) {
+			if (aType == Boolean.TYPE) {
+				return Boolean.TRUE;
+			} else if (aType == Byte.TYPE) {
+				return Byte.valueOf((byte) 1);
+			} else if (aType == Short.TYPE) {
+				return Short.valueOf((short) 1);
+			} else if (aType == Integer.TYPE) {
+				return Integer.valueOf(1);
+			} else if (aType == Long.TYPE) {
+				return Long.valueOf(1);
+			} else if (aType == Float.TYPE) {
+				return Float.valueOf(1.5f);
+			} else if (aType == Double.TYPE) {
+				return Double.valueOf(1.5);
+			} else if (aType == Character.TYPE) {
+				return Character.valueOf('a');
+			}
+			throw new IllegalArgumentException("unexpected type " + aType);
+		}
+	}
+
+	static class Callback implements nsIJXBenchCallback {
+		public void call() {
+		}
+
+		public nsISupports queryInterface(String aIID) {
+			return Mozilla.queryInterface(this, aIID);
+		}
+	}
+
+	static class JavaObject implements nsISupports {
+		public nsISupports queryInterface(String aIID) {
+			return Mozilla.queryInterface(this, aIID);
+		}
+	}
+
+	private static ArrayList runCases(ArrayList aCases) throws Exception {
+		ArrayList results = new ArrayList();
+		for (Iterator iter = aCases.iterator(); iter.hasNext(); ) {
+			Case benchCase = (Case) iter.next();
+			if (filter != null && benchCase.getLabel().indexOf(filter) < 0) {
+				continue;
+			}
+
+			benchCase.setUp();
+			for (int i = 0; i < warmupIterations; i++) {
+				runIteration(benchCase);
+			}
+			double[] scores = new double[measurementIterations];
+			for (int i = 0; i < measurementIterations; i++) {
+				scores[i] = runIteration(benchCase);
+			}
+
+			Result result = new Result(benchCase, scores);
+			results.add(result);
+			System.err.println(pad(benchCase.getLabel(), -48) +
+					pad(formatScore(result.getMean()), 16) + " +-" +
+					pad(formatScore(result.getError()), 14) + "  ops/s");
+		}
+		return results;
+	}
+
+	/**
+	 * @return  operations per second
+	 */
+	private static double runIteration(Case aCase) throws Exception {
+		long ops = 0;
+		long start = System.nanoTime();
+		long deadline = start + iterationMillis * 1000000;
+		long now;
+		do {
+			long batchStart = System.nanoTime();
+			aCase.run(aCase.batch);
+			ops += aCase.batch;
+			now = System.nanoTime();
+			if (now - batchStart < MIN_BATCH_NANOS && aCase.batch < MAX_BATCH) {
+				aCase.batch *= 2;
+			}
+		} while (now < deadline);
+		return ops * 1e9 / (now - start);
+	}
+
+	private static void writeResults(ArrayList aResults) throws IOException {
+		PrintWriter out;
+		if (outputFile != null) {
+			out = new PrintWriter(new OutputStreamWriter(
+					new FileOutputStream(outputFile), "UTF-8"));
+		} else {
+			out = new PrintWriter(System.out);
+		}
+
+		String time = iterationMillis + " ms";
+		out.println("[");
+		for (int i = 0; i < aResults.size(); i++) {
+			Result result = (Result) aResults.get(i);
+			Case benchCase = result.benchCase;
+			double mean = result.getMean();
+			double error = result.getError();
+
+			out.println("    {");
+			out.println("        \"benchmark\" : " +
+					quote("JXBench." + benchCase.name) + ",");
+			out.println("        \"mode\" : \"thrpt\",");
+			out.println("        \"threads\" : 1,");
+			out.println("        \"forks\" : 0,");
+			out.println("        \"jdkVersion\" : " +
+					quote(System.getProperty("java.version")) + ",");
+			out.println("        \"vmName\" : " +
+					quote(System.getProperty("java.vm.name")) + ",");
+			out.println("        \"warmupIterations\" : " +
+					warmupIterations + ",");
+			out.println("        \"warmupTime\" : " + quote(time) + ",");
+			out.println("        \"measurementIterations\" : " +
+					measurementIterations + ",");
+			out.println("        \"measurementTime\" : " + quote(time) + ",");
+			if (benchCase.paramName != null) {
+				out.println("        \"params\" : {");
+				out.println("            " + quote(benchCase.paramName) +
+						" : " + quote(benchCase.paramValue));
+				out.println("        },");
+			}
+			out.println("        \"primaryMetric\" : {");
+			out.println("            \"score\" : " + formatNumber(mean) + ",");
+			out.println("            \"scoreError\" : " + formatNumber(error) +
+					",");
+			out.println("            \"scoreConfidence\" : [ " +
+					formatNumber(mean - error) + ", " +
+					formatNumber(mean + error) + " ],");
+			out.println("            \"scoreUnit\" : \"ops/s\",");
+			StringBuffer raw = new StringBuffer();
+			for (int j = 0; j < result.scores.length; j++) {
+				if (j > 0) {
+					raw.append(", ");
+				}
+				raw.append(formatNumber(result.scores[j]));
+			}
+			out.println("            \"rawData\" : [ [ " + raw + " ] ]");
+			out.println("        },");
+			out.println("        \"secondaryMetrics\" : {");
+			out.println("        }");
+			out.println(i + 1 < aResults.size() ? "    }," : "    }");
+		}
+		out.println("]");
+		out.flush();
+		if (outputFile != null) {
+			out.close();
+		}
+	}
+
+	private static String formatNumber(double aValue) {
+		// JSON has no NaN or infinity
+		if (Double.isNaN(aValue) || Double.isInfinite(aValue)) {
+			return "\"NaN\"";
+		}
+		return Double.toString(aValue);
+	}
+
+	private static String formatScore(double aValue) {
+		if (Double.isNaN(aValue)) {
+			return "NaN";
+		}
+		return Long.toString(Math.round(aValue));
+	}
+
+	private static String quote(String aString) {
+		StringBuffer buf = new StringBuffer("\"");
+		for (int i = 0; i < aString.length(); i++) {
+			char c = aString.charAt(i);
+			if (c == '"' || c == '\\') {
+				buf.append('\\').append(c);
+			} else if (c < 0x20) {
+				String hex = Integer.toHexString(c);
+				buf.append("\\u");
+				for (int j = hex.length(); j < 4; j++) {
+					buf.append('0');
+				}
+				buf.append(hex);
+			} else {
+				buf.append(c);
+			}
+		}
+		return buf.append('"').toString();
+	}
+
+	private static String makeString(int aLength) {
+		StringBuffer buf = new StringBuffer(aLength);
+		for (int i = 0; i < aLength; i++) {
+			buf.append((char) ('a' + i % 26));
+		}
+		return buf.toString();
+	}
+
+	private static Method getMethod(Class aClass, String aName)
+			throws NoSuchMethodException {
+		Method[] methods = aClass.getMethods();
+		for (int i = 0; i < methods.length; i++) {
+			if (methods[i].getName().equals(aName)) {
+				return methods[i];
+			}
+		}
+		throw new NoSuchMethodException(aClass.getName() + "." + aName);
+	}
+
+	/**
+	 * Pads a string with spaces to the given width: on the left for a
+	 * positive width, on the right for a negative one.
+	 */
+	private static String pad(String aString, int aWidth) {
+		StringBuffer buf = new StringBuffer();
+		int width = Math.abs(aWidth);
+		if (aWidth < 0) {
+			buf.append(aString);
+		}
+		for (int i = aString.length(); i < width; i++) {
+			buf.append(' ');
+		}
+		if (aWidth > 0) {
+			buf.append(aString);
+		}
+		return buf.toString();
+	}
+
+	private static void checkArgs(String[] args) {
+		if (args.length < 1) {
+			printUsage();
+			throw new IllegalArgumentException();
+		}
+
+		grePath = new File(args[0]);
+		if (!grePath.exists() || !grePath.isDirectory()) {
+			System.err.println("ERROR: given path doesn't exist");
+			printUsage();
+			throw new IllegalArgumentException();
+		}
+
+		try {
+			for (int i = 1; i < args.length; i++) {
+				if (i + 1 >= args.length) {
+					throw new IllegalArgumentException();
+				}
+				String value = args[++i];
+				if (args[i - 1].equals("-o")) {
+					outputFile = value;
+				} else if (args[i - 1].equals("-b")) {
+					filter = value;
+				} else if (args[i - 1].equals("-wi")) {
+					warmupIterations = Integer.parseInt(value);
+				} else if (args[i - 1].equals("-i")) {
+					measurementIterations = Integer.parseInt(value);
+				} else if (args[i - 1].equals("-r")) {
+					iterationMillis = Long.parseLong(value);
+				} else {
+					throw new IllegalArgumentException();
+				}
+			}
+		} catch (IllegalArgumentException e) {
+			// includes NumberFormatException
+			printUsage();
+			throw e;
+		}
+
+		if (warmupIterations < 0 || measurementIterations < 1 ||
+				iterationMillis < 1) {
+			printUsage();
+			throw new IllegalArgumentException();
+		}
+	}
+
+	private static void printUsage() {
+		System.err.println("usage: java JXBench <XULRunner bin dir> " +
+				"[-o <file>] [-b <text>] [-wi <n>] [-i <n>] [-r <ms>]");
+	}
+
+	private static File createTempProfileDir() throws IOException {
+		// Get name of temporary profile directory
+		File profile = File.createTempFile("mozilla-test-", null);
+		profile.delete();
+
+		// On some operating systems (particularly Windows), the previous
+		// temporary profile may not have been deleted. Delete them now.
+		File[] files = profile.getParentFile()
+				.listFiles(new FileFilter() {
+					public boolean accept(File file) {
+						if (file.getName().startsWith("mozilla-test-")) {
+							return true;
+						}
+						return false;
+					}
+				});
+		for (int i = 0; i < files.length; i++) {
+			deleteDir(files[i]);
+		}
+
+		// Create temporary profile directory
+		profile.mkdir();
+
+		return profile;
+	}
+
+	private static void deleteDir(File dir) {
+		File[] files = dir.listFiles();
+		for (int i = 0; i < files.length; i++) {
+			if (files[i].isDirectory()) {
+				deleteDir(files[i]);
+			}
+			files[i].delete();
+		}
+		dir.delete();
+	}
+}
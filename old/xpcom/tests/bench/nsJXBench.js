@@ -0,0 +1,236 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1/GPL 2.0/LGPL 2.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is Java XPCOM Bindings.
+ *
+ * The Initial Developer of the Original Code is IBM Corporation.
+ * Portions created by the Initial Developer are Copyright (C) 2007
+ * IBM Corporation. All Rights Reserved.
+ *
+ * Contributor(s):
+ *   Javier Pedemonte (jhpedemonte@gmail.com)
+ *
+ * Alternatively, the contents of this file may be used under the terms of
+ * either the GNU General Public License Version 2 or later (the "GPL"), or
+ * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
+ * in which case the provisions of the GPL or the LGPL are applicable instead
+ * of those above. If you wish to allow use of your version of this file only
+ * under the terms of either the GPL or the LGPL, and not to allow others to
+ * use your version of this file under the terms of the MPL, indicate your
+ * decision by deleting the provisions above and replace them with the notice
+ * and other provisions required by the GPL or the LGPL. If you do not delete
+ * the provisions above, a recipient may use your version of this file under
+ * the terms of any one of the MPL, the GPL or the LGPL.
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+
+const nsIJXBenchTarget = Components.interfaces.nsIJXBenchTarget;
+const nsIJXBenchLinkA = Components.interfaces.nsIJXBenchLinkA;
+const nsIJXBenchLinkB = Components.interfaces.nsIJXBenchLinkB;
+const nsIJXBenchLinkC = Components.interfaces.nsIJXBenchLinkC;
+const nsISupports = Components.interfaces.nsISupports;
+
+const CLASS_ID = Components.ID("{f31c9a71-6ee7-4527-b7be-c3b7934402c7}");
+const CLASS_NAME = "JavaXPCOM Benchmark Target Javascript XPCOM Component";
+const CONTRACT_ID = "@mozilla.org/javaxpcom/tests/bench;1";
+
+/***********************************************************
+    class definition
+ ***********************************************************/
+
+// plain nsISupports object returned by retInterface and newInterface
+function BenchObject() {
+};
+
+BenchObject.prototype = {
+  QueryInterface: function(aIID) {
+    if (!aIID.equals(nsISupports))
+      throw Components.results.NS_ERROR_NO_INTERFACE;
+    return this;
+  }
+};
+
+// makes an array of aCount elements, and keeps it for the next call
+function cachedArray(aCache, aCount, aValue) {
+  var array = aCache[aCount];
+  if (!array) {
+    array = new Array(aCount);
+    for (var i = 0; i < aCount; i++)
+      array[i] = aValue;
+    aCache[aCount] = array;
+  }
+  return array;
+}
+
+//class constructor
+function BenchTarget() {
+  this._object = new BenchObject();
+  this._string = "";
+  this._octetArrays = {};
+  this._longArrays = {};
+  this._doubleArrays = {};
+};
+
+// class definition
+BenchTarget.prototype = {
+
+  voidCall: function() {},
+
+  callVoid: function(aCallback, aCount) {
+    for (var i = 0; i < aCount; i++)
+      aCallback.call();
+  },
+
+  inBoolean: function(a) {},
+  outBoolean: function(a) { a.value = true; },
+  retBoolean: function() { return true; },
+
+  inOctet: function(a) {},
+  outOctet: function(a) { a.value = 1; },
+  retOctet: function() { return 1; },
+
+  inShort: function(a) {},
+  outShort: function(a) { a.value = 1; },
+  retShort: function() { return 1; },
+
+  inLong: function(a) {},
+  outLong: function(a) { a.value = 1; },
+  retLong: function() { return 1; },
+
+  inLongLong: function(a) {},
+  outLongLong: function(a) { a.value = 1; },
+  retLongLong: function() { return 1; },
+
+  inUShort: function(a) {},
+  outUShort: function(a) { a.value = 1; },
+  retUShort: function() { return 1; },
+
+  inULong: function(a) {},
+  outULong: function(a) { a.value = 1; },
+  retULong: function() { return 1; },
+
+  inULongLong: function(a) {},
+  outULongLong: function(a) { a.value = 1; },
+  retULongLong: function() { return 1; },
+
+  inFloat: function(a) {},
+  outFloat: function(a) { a.value = 1.5; },
+  retFloat: function() { return 1.5; },
+
+  inDouble: function(a) {},
+  outDouble: function(a) { a.value = 1.5; },
+  retDouble: function() { return 1.5; },
+
+  inChar: function(a) {},
+  outChar: function(a) { a.value = "a"; },
+  retChar: function() { return "a"; },
+
+  inWChar: function(a) {},
+  outWChar: function(a) { a.value = "\u20ac"; },
+  retWChar: function() { return "\u20ac"; },
+
+  setStringLength: function(aLength) {
+    var s = "x";
+    while (s.length < aLength)
+      s += s;
+    this._string = s.substring(0, aLength);
+  },
+  inAString: function(a) {},
+  retAString: function() { return this._string; },
+  inACString: function(a) {},
+  retACString: function() { return this._string; },
+
+  inOctetArray: function(aCount, aArray) {},
+  retOctetArray: function(aCount) {
+    return cachedArray(this._octetArrays, aCount, 1);
+  },
+  inLongArray: function(aCount, aArray) {},
+  retLongArray: function(aCount) {
+    return cachedArray(this._longArrays, aCount, 1);
+  },
+  inDoubleArray: function(aCount, aArray) {},
+  retDoubleArray: function(aCount) {
+    return cachedArray(this._doubleArrays, aCount, 1.5);
+  },
+
+  inInterface: function(aObject) {},
+  retInterface: function() { return this._object; },
+  newInterface: function() { return new BenchObject(); },
+
+  QueryInterface: function(aIID) {
+    if (!aIID.equals(nsIJXBenchTarget) &&
+        !aIID.equals(nsIJXBenchLinkA) &&
+        !aIID.equals(nsIJXBenchLinkB) &&
+        !aIID.equals(nsIJXBenchLinkC) &&
+        !aIID.equals(nsISupports))
+      throw Components.results.NS_ERROR_NO_INTERFACE;
+    return this;
+  }
+};
+
+/***********************************************************
+    class factory
+ ***********************************************************/
+var BenchTargetFactory = {
+  createInstance: function (aOuter, aIID)
+  {
+    if (aOuter != null)
+      throw Components.results.NS_ERROR_NO_AGGREGATION;
+    return (new BenchTarget()).QueryInterface(aIID);
+  }
+};
+
+/***********************************************************
+    module definition (xpcom registration)
+ ***********************************************************/
+var BenchTargetModule = {
+  registerSelf: function(aCompMgr, aFileSpec, aLocation, aType)
+  {
+    aCompMgr = aCompMgr.
+        QueryInterface(Components.interfaces.nsIComponentRegistrar);
+    aCompMgr.registerFactoryLocation(CLASS_ID, CLASS_NAME,
+        CONTRACT_ID, aFileSpec, aLocation, aType);
+  },
+
+  unregisterSelf: function(aCompMgr, aLocation, aType)
+  {
+    aCompMgr = aCompMgr.
+        QueryInterface(Components.interfaces.nsIComponentRegistrar);
+    aCompMgr.unregisterFactoryLocation(CLASS_ID, aLocation);
+  },
+
+  getClassObject: function(aCompMgr, aCID, aIID)
+  {
+    if (!aIID.equals(Components.interfaces.nsIFactory))
+      throw Components.results.NS_ERROR_NOT_IMPLEMENTED;
+
+    if (aCID.equals(CLASS_ID))
+      return BenchTargetFactory;
+
+    throw Components.results.NS_ERROR_NO_INTERFACE;
+  },
+
+  canUnload: function(aCompMgr)
+  {
+    return true;
+  }
+};
+
+/***********************************************************
+    module initialization
+ ***********************************************************/
+function NSGetModule(aCompMgr, aFileSpec)
+{
+  return BenchTargetModule;
+}
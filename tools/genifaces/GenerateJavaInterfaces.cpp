@@ -192,9 +192,31 @@ static const char* kNoscriptMethodIfaces[] = {
 #endif
 
 
+// Java expressions that convert a primitive value to (toRaw1 + value +
+// toRaw2) and from (fromRaw1 + raw + fromRaw2) the raw long values passed to
+// XPCOMJavaBinding.
+struct RawConversion
+{
+  const char* toRaw1;
+  const char* toRaw2;
+  const char* fromRaw1;
+  const char* fromRaw2;
+};
+
+// The variants of each method written to a binding class
+enum MethodVariant
+{
+  kPlainMethod,   // same signature as the interface method
+  kDirectMethod,  // "<name>Direct": direct ByteBuffers for octet arrays and
+                  // sized strings
+  kListMethod     // "<name>AsList": java.util.List for an interface array
+                  // result
+};
+
 class Generate
 {
   nsIFile*     mOutputDir;
+  nsIFile*     mBindingsDir;  // null if bindings aren't written
   nsDataHashtable<nsCStringHashKey, PRBool> mIfaceTable;
   nsDataHashtable<nsCStringHashKey, PRBool> mJavaKeywords;
   JSRuntime *jsRuntime;
@@ -205,8 +227,9 @@ class Generate
 #endif
 
 public:
-  Generate(nsIFile* aOutputDir)
-    : mOutputDir(aOutputDir), 
+  Generate(nsIFile* aOutputDir, nsIFile* aBindingsDir)
+    : mOutputDir(aOutputDir),
+    mBindingsDir(aBindingsDir),
     mIfaceTable(100), 
     mJavaKeywords(MOZ_ARRAY_LENGTH(kJavaKeywords)),
     mNoscriptMethodsTable(MOZ_ARRAY_LENGTH(kNoscriptMethodIfaces))
@@ -307,11 +330,11 @@ public:
 
     // create file for interface
     nsCOMPtr<nsIOutputStream> out;
-    rv = OpenIfaceFileStream(iface_name, getter_AddRefs(out));
+    rv = OpenIfaceFileStream(mOutputDir, iface_name, getter_AddRefs(out));
     NS_ENSURE_SUCCESS(rv, rv);
 
     // write contents to file
-    rv = WriteHeader(out, iface_name);
+    rv = WriteHeader(out, iface_name, "org.mozilla.interfaces");
     NS_ENSURE_SUCCESS(rv, rv);
     rv = WriteInterfaceStart(out, aIInfo, parentInfo);
     NS_ENSURE_SUCCESS(rv, rv);
@@ -325,21 +348,124 @@ public:
     NS_ENSURE_SUCCESS(rv, rv);
 
     rv = CloseIfaceFileStream(out);
+    NS_ENSURE_SUCCESS(rv, rv);
+
+    if (mBindingsDir)
+      rv = WriteOneBinding(aIInfo, parentInfo, parentMethodCount);
 
     return rv;
   }
 
-  nsresult OpenIfaceFileStream(const char* aIfaceName,
+  /**
+   * Writes the direct-binding class for the given interface.  The binding of
+   * an interface extends the binding of its parent, so it only needs to
+   * implement the methods declared by the interface itself.
+   */
+  nsresult WriteOneBinding(nsIInterfaceInfo* aIInfo,
+                           nsIInterfaceInfo* aParentInfo,
+                           PRUint16 aParentMethodCount)
+  {
+    static const char kImports[] =
+      "import java.nio.ByteBuffer;\n"
+      "import java.util.List;\n"
+      "import org.mozilla.interfaces.*;\n"
+      "import org.mozilla.xpcom.internal.XPCOMJavaBinding;\n\n";
+    static const char kClassDecl[] = "public class ";
+    static const char kExtendsDecl[] = " extends ";
+    static const char kImplementsDecl[] = " implements ";
+    static const char kCtorDecl1[] = "\n{\n  public ";
+    static const char kCtorDecl2[] =
+      "(long aXPCOMInstance) {\n"
+      "    super(aXPCOMInstance);\n"
+      "  }\n\n";
+
+    const char* iface_name;
+    aIInfo->GetNameShared(&iface_name);
+    nsEmbedCString class_name(iface_name);
+    class_name.Append(NS_LITERAL_CSTRING("Binding"));
+
+    nsEmbedCString parent_name("XPCOMJavaBinding");
+    if (aParentInfo) {
+      const char* name;
+      aParentInfo->GetNameShared(&name);
+      parent_name.Assign(name);
+      parent_name.Append(NS_LITERAL_CSTRING("Binding"));
+    }
+
+    nsCOMPtr<nsIOutputStream> out;
+    nsresult rv = OpenIfaceFileStream(mBindingsDir, class_name.get(),
+                                      getter_AddRefs(out));
+    NS_ENSURE_SUCCESS(rv, rv);
+
+    rv = WriteHeader(out, iface_name, "org.mozilla.interfaces.bindings");
+    NS_ENSURE_SUCCESS(rv, rv);
+
+    PRUint32 count;
+    rv = out->Write(kImports, sizeof(kImports) - 1, &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+    rv = out->Write(kClassDecl, sizeof(kClassDecl) - 1, &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+    rv = out->Write(class_name.get(), class_name.Length(), &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+    rv = out->Write(kExtendsDecl, sizeof(kExtendsDecl) - 1, &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+    rv = out->Write(parent_name.get(), parent_name.Length(), &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+    rv = out->Write(kImplementsDecl, sizeof(kImplementsDecl) - 1, &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+    rv = out->Write(iface_name, strlen(iface_name), &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+    rv = out->Write(kCtorDecl1, sizeof(kCtorDecl1) - 1, &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+    rv = out->Write(class_name.get(), class_name.Length(), &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+    rv = out->Write(kCtorDecl2, sizeof(kCtorDecl2) - 1, &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+
+    PRUint16 methodCount;
+    rv = aIInfo->GetMethodCount(&methodCount);
+    NS_ENSURE_SUCCESS(rv, rv);
+
+    for (PRUint16 i = aParentMethodCount; i < methodCount; i++) {
+      const nsXPTMethodInfo* methodInfo;
+      rv = aIInfo->GetMethodInfo(i, &methodInfo);
+      NS_ENSURE_SUCCESS(rv, rv);
+
+      if (!ShouldWriteMethod(aIInfo, methodInfo))
+        continue;
+
+      rv = WriteOneBindingMethod(out, aIInfo, methodInfo, i, kPlainMethod);
+      NS_ENSURE_SUCCESS(rv, rv);
+
+      if (HasDirectBufferParams(aIInfo, methodInfo, i)) {
+        rv = WriteOneBindingMethod(out, aIInfo, methodInfo, i, kDirectMethod);
+        NS_ENSURE_SUCCESS(rv, rv);
+      }
+
+      const nsXPTParamInfo* resultInfo = GetRetvalParam(methodInfo);
+      if (resultInfo && IsInterfaceArrayParam(aIInfo, i, *resultInfo)) {
+        rv = WriteOneBindingMethod(out, aIInfo, methodInfo, i, kListMethod);
+        NS_ENSURE_SUCCESS(rv, rv);
+      }
+    }
+
+    rv = WriteInterfaceEnd(out);
+    NS_ENSURE_SUCCESS(rv, rv);
+
+    return CloseIfaceFileStream(out);
+  }
+
+  nsresult OpenIfaceFileStream(nsIFile* aDir, const char* aClassName,
                                nsIOutputStream** aResult)
   {
     nsresult rv;
 
-    // create interface file in output dir
+    // create interface file in given dir
     nsCOMPtr<nsIFile> iface_file;
-    rv = mOutputDir->Clone(getter_AddRefs(iface_file));
+    rv = aDir->Clone(getter_AddRefs(iface_file));
     NS_ENSURE_SUCCESS(rv, rv);
     nsEmbedCString filename;
-    filename.Append(aIfaceName);
+    filename.Append(aClassName);
     filename.Append(NS_LITERAL_CSTRING(".java"));
     rv = iface_file->AppendNative(filename);
     NS_ENSURE_SUCCESS(rv, rv);
@@ -367,7 +493,8 @@ public:
     return out->Close();
   }
 
-  nsresult WriteHeader(nsIOutputStream* out, const char* aIfaceName)
+  nsresult WriteHeader(nsIOutputStream* out, const char* aIfaceName,
+                       const char* aPackage)
   {
     static const char kHeader1[] =
       "/**\n"
@@ -376,7 +503,8 @@ public:
       " *\n"
       " * @see <a href=\"http://lxr.mozilla.org/mozilla/search?string=";
     static const char kHeader2[]= "\">\n **/\n\n";
-    static const char kPackage[] = "package org.mozilla.interfaces;\n\n";
+    static const char kPackage1[] = "package ";
+    static const char kPackage2[] = ";\n\n";
 
     PRUint32 count;
     nsresult rv = out->Write(kHeader1, sizeof(kHeader1) - 1, &count);
@@ -391,7 +519,11 @@ public:
 
     rv = out->Write(kHeader2, sizeof(kHeader2) - 1, &count);
     NS_ENSURE_SUCCESS(rv, rv);
-    rv = out->Write(kPackage, sizeof(kPackage) - 1, &count);
+    rv = out->Write(kPackage1, sizeof(kPackage1) - 1, &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+    rv = out->Write(aPackage, strlen(aPackage), &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+    rv = out->Write(kPackage2, sizeof(kPackage2) - 1, &count);
     return rv;
   }
 
@@ -650,27 +782,8 @@ public:
       rv = aIInfo->GetMethodInfo(i, &methodInfo);
       NS_ENSURE_SUCCESS(rv, rv);
 
-#ifdef WRITE_NOSCRIPT_METHODS
-      // XXX
-      // SWT makes use of [noscript] methods in some classes, so output them
-      // for those classes.
-
-      // skip [notxpcom] methods
-      if (methodInfo->IsNotXPCOM())
-        continue;
-
-      // skip most hidden ([noscript]) methods
-      if (methodInfo->IsHidden()) {
-        const char* iface_name;
-        aIInfo->GetNameShared(&iface_name);
-        if (!mNoscriptMethodsTable.Get(nsDependentCString(iface_name), nullptr))
-          continue;
-      }
-#else
-      // skip hidden ([noscript]) or [notxpcom] methods
-      if (methodInfo->IsHidden() || methodInfo->IsNotXPCOM())
+      if (!ShouldWriteMethod(aIInfo, methodInfo))
         continue;
-#endif
 
       rv = WriteOneMethod(out, aIInfo, methodInfo, i);
       NS_ENSURE_SUCCESS(rv, rv);
@@ -679,30 +792,369 @@ public:
     return NS_OK;
   }
 
+  // Returns true if the given method is written out to the Java interface
+  // (and therefore must be implemented by its binding).
+  PRBool ShouldWriteMethod(nsIInterfaceInfo* aIInfo,
+                           const nsXPTMethodInfo* aMethodInfo)
+  {
+#ifdef WRITE_NOSCRIPT_METHODS
+    // XXX
+    // SWT makes use of [noscript] methods in some classes, so output them
+    // for those classes.
+
+    // skip [notxpcom] methods
+    if (aMethodInfo->IsNotXPCOM())
+      return PR_FALSE;
+
+    // skip most hidden ([noscript]) methods
+    if (aMethodInfo->IsHidden()) {
+      const char* iface_name;
+      aIInfo->GetNameShared(&iface_name);
+      if (!mNoscriptMethodsTable.Get(nsDependentCString(iface_name), nullptr))
+        return PR_FALSE;
+    }
+#else
+    // skip hidden ([noscript]) or [notxpcom] methods
+    if (aMethodInfo->IsHidden() || aMethodInfo->IsNotXPCOM())
+      return PR_FALSE;
+#endif
+
+    return PR_TRUE;
+  }
+
   nsresult WriteOneMethod(nsIOutputStream* out, nsIInterfaceInfo* aIInfo,
                           const nsXPTMethodInfo* aMethodInfo,
                           PRUint16 aMethodIndex)
   {
-    static const char kVoidReturn[] = "void";
-    static const char kParamSeparator[] = ", ";
-    static const char kMethodEnd[] = ");\n\n";
+    static const char kMethodEnd[] = ";\n\n";
 
     PRUint32 count;
     nsresult rv = out->Write("  ", 2, &count);
     NS_ENSURE_SUCCESS(rv, rv);
 
-    // write return type
+    rv = WriteMethodSignature(out, aIInfo, aMethodInfo, aMethodIndex,
+                              kPlainMethod);
+    NS_ENSURE_SUCCESS(rv, rv);
+
+    rv = out->Write(kMethodEnd, sizeof(kMethodEnd) - 1, &count);
+    return rv;
+  }
+
+  /**
+   * Writes the implementation of the given method for a binding class.  The
+   * params are passed to XPCOMJavaBinding.callXPCOMMethod() (or
+   * callXPCOMMethodRaw() for primitive results) along with the method index.
+   * 'in' params of primitive types are passed raw in a long[], indexed by
+   * param index; all other params are passed in an Object[].
+   *
+   * @param aVariant  kDirectMethod writes the "<name>Direct" variant of the
+   *                  method, which passes octet arrays and sized strings as
+   *                  direct ByteBuffers (see IsDirectBufferParam);
+   *                  kListMethod writes the "<name>AsList" variant, which
+   *                  returns an interface array as a List whose elements are
+   *                  only wrapped when read
+   */
+  nsresult WriteOneBindingMethod(nsIOutputStream* out,
+                                 nsIInterfaceInfo* aIInfo,
+                                 const nsXPTMethodInfo* aMethodInfo,
+                                 PRUint16 aMethodIndex, MethodVariant aVariant)
+  {
+    static const char kMethodStart[] = " {\n    ";
+    static const char kReturn[] = "return ";
+    static const char kCall[] = "callXPCOMMethod(";
+    static const char kCallRaw[] = "callXPCOMMethodRaw(";
+    static const char kPrimParamsStart[] = ", new long[] { ";
+    static const char kParamsStart[] = ", new Object[] { ";
+    static const char kParamsEnd[] = " }";
+    static const char kNoParams[] = ", null";
+    static const char kMethodEnd[] = ");\n  }\n\n";
+
+    PRUint32 count;
+    nsresult rv = out->Write("  public ", 9, &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+    rv = WriteMethodSignature(out, aIInfo, aMethodInfo, aMethodIndex,
+                              aVariant);
+    NS_ENSURE_SUCCESS(rv, rv);
+    rv = out->Write(kMethodStart, sizeof(kMethodStart) - 1, &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+
+    // convert result to return type
+    const nsXPTParamInfo* resultInfo = GetRetvalParam(aMethodInfo);
+    const RawConversion* resultConv = nullptr;
+    PRBool directResult = PR_FALSE;
+    PRBool listResult = PR_FALSE;
+    if (resultInfo) {
+      rv = out->Write(kReturn, sizeof(kReturn) - 1, &count);
+      NS_ENSURE_SUCCESS(rv, rv);
+
+      const nsXPTType &type = resultInfo->GetType();
+      resultConv = GetRawConversion(type.TagPart());
+      directResult = aVariant == kDirectMethod &&
+                     IsDirectBufferParam(aIInfo, aMethodIndex, *resultInfo);
+      listResult = aVariant == kListMethod;
+      if (resultConv) {
+        rv = out->Write(resultConv->fromRaw1, strlen(resultConv->fromRaw1),
+                        &count);
+      } else if (directResult) {
+        rv = out->Write("(ByteBuffer) ", 13, &count);
+      } else if (listResult) {
+        rv = out->Write("(List) ", 7, &count);
+      } else {
+        rv = out->Write("(", 1, &count);
+        NS_ENSURE_SUCCESS(rv, rv);
+        rv = WriteType(out, &type, aIInfo, aMethodIndex, resultInfo);
+        NS_ENSURE_SUCCESS(rv, rv);
+        rv = out->Write(") ", 2, &count);
+      }
+      NS_ENSURE_SUCCESS(rv, rv);
+    }
+
+    if (resultConv)
+      rv = out->Write(kCallRaw, sizeof(kCallRaw) - 1, &count);
+    else
+      rv = out->Write(kCall, sizeof(kCall) - 1, &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+    char buf[10];
+    snprintf(buf, sizeof(buf), "%d", aMethodIndex);
+    rv = out->Write(buf, strlen(buf), &count);
+    NS_ENSURE_SUCCESS(rv, rv);
+
+    // Find out which arrays we need.  Since both are indexed by param index,
+    // each one gets a placeholder for the params passed in the other.  A
+    // result that is returned as a direct ByteBuffer or a List needs a
+    // ByteBuffer[] or List[] holder in its slot of the Object[].
     PRUint8 paramCount = aMethodInfo->GetParamCount();
-    const nsXPTParamInfo* resultInfo = nullptr;
+    PRUint8 argCount = 0;
+    PRBool hasPrimParams = PR_FALSE;
+    PRBool hasObjectParams = PR_FALSE;
     for (PRUint8 i = 0; i < paramCount; i++) {
       const nsXPTParamInfo &paramInfo = aMethodInfo->GetParam(i);
       if (paramInfo.IsRetval()) {
-        resultInfo = &paramInfo;
-        break;
+        if (directResult || listResult) {
+          argCount = i + 1;
+          hasObjectParams = PR_TRUE;
+        }
+        continue;
+      }
+      argCount = i + 1;
+      if (!paramInfo.IsOut() && GetRawConversion(paramInfo.GetType().TagPart()))
+        hasPrimParams = PR_TRUE;
+      else
+        hasObjectParams = PR_TRUE;
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+      PRBool primPass = (pass == 0);
+      if (!(primPass ? hasPrimParams : hasObjectParams)) {
+        rv = out->Write(kNoParams, sizeof(kNoParams) - 1, &count);
+        NS_ENSURE_SUCCESS(rv, rv);
+        continue;
+      }
+
+      if (primPass)
+        rv = out->Write(kPrimParamsStart, sizeof(kPrimParamsStart) - 1, &count);
+      else
+        rv = out->Write(kParamsStart, sizeof(kParamsStart) - 1, &count);
+      NS_ENSURE_SUCCESS(rv, rv);
+
+      for (PRUint8 j = 0; j < argCount; j++) {
+        const nsXPTParamInfo &paramInfo = aMethodInfo->GetParam(j);
+        const RawConversion* conv = nullptr;
+        if (!paramInfo.IsOut())
+          conv = GetRawConversion(paramInfo.GetType().TagPart());
+
+        if (j != 0) {
+          rv = out->Write(", ", 2, &count);
+          NS_ENSURE_SUCCESS(rv, rv);
+        }
+
+        if (paramInfo.IsRetval() && directResult && !primPass) {
+          rv = out->Write("new ByteBuffer[1]", 17, &count);
+          NS_ENSURE_SUCCESS(rv, rv);
+          continue;
+        }
+        if (paramInfo.IsRetval() && listResult && !primPass) {
+          rv = out->Write("new List[1]", 11, &count);
+          NS_ENSURE_SUCCESS(rv, rv);
+          continue;
+        }
+
+        if (paramInfo.IsRetval() || primPass != (conv != nullptr)) {
+          if (primPass)
+            rv = out->Write("0", 1, &count);
+          else
+            rv = out->Write("null", 4, &count);
+          NS_ENSURE_SUCCESS(rv, rv);
+          continue;
+        }
+
+        if (conv) {
+          rv = out->Write(conv->toRaw1, strlen(conv->toRaw1), &count);
+          NS_ENSURE_SUCCESS(rv, rv);
+        }
+        snprintf(buf, sizeof(buf), "arg%d", j + 1);
+        rv = out->Write(buf, strlen(buf), &count);
+        NS_ENSURE_SUCCESS(rv, rv);
+        if (conv) {
+          rv = out->Write(conv->toRaw2, strlen(conv->toRaw2), &count);
+          NS_ENSURE_SUCCESS(rv, rv);
+        }
       }
+
+      rv = out->Write(kParamsEnd, sizeof(kParamsEnd) - 1, &count);
+      NS_ENSURE_SUCCESS(rv, rv);
+    }
+
+    if (resultConv) {
+      rv = out->Write(")", 1, &count);
+      NS_ENSURE_SUCCESS(rv, rv);
+      rv = out->Write(resultConv->fromRaw2, strlen(resultConv->fromRaw2),
+                      &count);
+      NS_ENSURE_SUCCESS(rv, rv);
+      rv = out->Write(";\n  }\n\n", 7, &count);
+    } else {
+      rv = out->Write(kMethodEnd, sizeof(kMethodEnd) - 1, &count);
+    }
+    return rv;
+  }
+
+  static const nsXPTParamInfo* GetRetvalParam(const nsXPTMethodInfo* aMethodInfo)
+  {
+    PRUint8 paramCount = aMethodInfo->GetParamCount();
+    for (PRUint8 i = 0; i < paramCount; i++) {
+      const nsXPTParamInfo &paramInfo = aMethodInfo->GetParam(i);
+      if (paramInfo.IsRetval())
+        return &paramInfo;
     }
+    return nullptr;
+  }
+
+  /**
+   * For XPIDL types that map to a Java primitive, returns the Java
+   * expressions that convert a value to and from the raw long used by
+   * XPCOMJavaBinding.  Must match the mapping in WriteType().
+   *
+   * @return  null if the given type doesn't map to a Java primitive
+   */
+  static const RawConversion* GetRawConversion(PRUint8 aTag)
+  {
+    static const RawConversion kByte = { "", "", "(byte) ", "" };
+    static const RawConversion kShort = { "", "", "(short) ", "" };
+    static const RawConversion kInt = { "", "", "(int) ", "" };
+    static const RawConversion kLong = { "", "", "", "" };
+    static const RawConversion kChar = { "", "", "(char) ", "" };
+    static const RawConversion kBoolean = { "(", " ? 1 : 0)", "(", " != 0)" };
+    static const RawConversion kFloat = {
+      "Float.floatToRawIntBits(", ")", "Float.intBitsToFloat((int) ", ")"
+    };
+    static const RawConversion kDouble = {
+      "Double.doubleToRawLongBits(", ")", "Double.longBitsToDouble(", ")"
+    };
+
+    switch (aTag) {
+      case nsXPTType::T_I8:
+        return &kByte;
+
+      case nsXPTType::T_I16:
+      case nsXPTType::T_U8:
+        return &kShort;
+
+      case nsXPTType::T_I32:
+      case nsXPTType::T_U16:
+        return &kInt;
+
+      case nsXPTType::T_I64:
+      case nsXPTType::T_U32:
+      case nsXPTType::T_VOID:
+        return &kLong;
+
+      case nsXPTType::T_FLOAT:
+        return &kFloat;
+
+      case nsXPTType::T_U64:
+      case nsXPTType::T_DOUBLE:
+        return &kDouble;
+
+      case nsXPTType::T_BOOL:
+        return &kBoolean;
+
+      case nsXPTType::T_CHAR:
+      case nsXPTType::T_WCHAR:
+        return &kChar;
+
+      default:
+        return nullptr;
+    }
+  }
+
+  /**
+   * Returns true if the given param is an octet array or a sized string.
+   * The "<name>Direct" methods of binding classes pass these as direct
+   * ByteBuffers, which the native code uses without copying.
+   */
+  static PRBool IsDirectBufferParam(nsIInterfaceInfo* aIInfo,
+                                    PRUint16 aMethodIndex,
+                                    const nsXPTParamInfo &aParamInfo)
+  {
+    const nsXPTType &type = aParamInfo.GetType();
+    if (type.TagPart() == nsXPTType::T_PSTRING_SIZE_IS)
+      return PR_TRUE;
+    if (type.TagPart() != nsXPTType::T_ARRAY)
+      return PR_FALSE;
+
+    nsXPTType xpttype;
+    nsresult rv = aIInfo->GetTypeForParam(aMethodIndex, &aParamInfo, 1,
+                                          &xpttype);
+    return NS_SUCCEEDED(rv) && xpttype.TagPart() == nsXPTType::T_U8;
+  }
+
+  /**
+   * Returns true if the given param is an array of interfaces.  The
+   * "<name>AsList" methods of binding classes return these as a List.
+   */
+  static PRBool IsInterfaceArrayParam(nsIInterfaceInfo* aIInfo,
+                                      PRUint16 aMethodIndex,
+                                      const nsXPTParamInfo &aParamInfo)
+  {
+    if (aParamInfo.GetType().TagPart() != nsXPTType::T_ARRAY)
+      return PR_FALSE;
+
+    nsXPTType xpttype;
+    nsresult rv = aIInfo->GetTypeForParam(aMethodIndex, &aParamInfo, 1,
+                                          &xpttype);
+    return NS_SUCCEEDED(rv) &&
+           (xpttype.TagPart() == nsXPTType::T_INTERFACE ||
+            xpttype.TagPart() == nsXPTType::T_INTERFACE_IS);
+  }
+
+  static PRBool HasDirectBufferParams(nsIInterfaceInfo* aIInfo,
+                                      const nsXPTMethodInfo* aMethodInfo,
+                                      PRUint16 aMethodIndex)
+  {
+    for (PRUint8 i = 0; i < aMethodInfo->GetParamCount(); i++) {
+      if (IsDirectBufferParam(aIInfo, aMethodIndex, aMethodInfo->GetParam(i)))
+        return PR_TRUE;
+    }
+    return PR_FALSE;
+  }
+
+  // Writes "<return type> <method name>(<params>)" for the given variant of
+  // the given method.
+  nsresult WriteMethodSignature(nsIOutputStream* out, nsIInterfaceInfo* aIInfo,
+                                const nsXPTMethodInfo* aMethodInfo,
+                                PRUint16 aMethodIndex, MethodVariant aVariant)
+  {
+    static const char kVoidReturn[] = "void";
+    static const char kParamSeparator[] = ", ";
+
+    PRUint32 count;
+    nsresult rv;
+
+    // write return type
+    PRUint8 paramCount = aMethodInfo->GetParamCount();
+    const nsXPTParamInfo* resultInfo = GetRetvalParam(aMethodInfo);
     if (resultInfo) {
-      rv = WriteParam(out, aIInfo, aMethodIndex, resultInfo, 0);
+      rv = WriteParam(out, aIInfo, aMethodIndex, resultInfo, 0, aVariant);
     } else {
       rv = out->Write(kVoidReturn, sizeof(kVoidReturn) - 1, &count);
     }
@@ -726,6 +1178,11 @@ public:
     if (mJavaKeywords.Get(method_name, nullptr)) {
       method_name.Insert('_', 0);
     }
+    if (aVariant == kDirectMethod) {
+      method_name.Append(NS_LITERAL_CSTRING("Direct"));
+    } else if (aVariant == kListMethod) {
+      method_name.Append(NS_LITERAL_CSTRING("AsList"));
+    }
     rv = out->Write(" ", 1, &count);
     NS_ENSURE_SUCCESS(rv, rv);
     rv = out->Write(method_name.get(), method_name.Length(), &count);
@@ -744,24 +1201,32 @@ public:
         NS_ENSURE_SUCCESS(rv, rv);
       }
 
-      rv = WriteParam(out, aIInfo, aMethodIndex, &paramInfo, j + 1);
+      rv = WriteParam(out, aIInfo, aMethodIndex, &paramInfo, j + 1,
+                      aVariant);
       NS_ENSURE_SUCCESS(rv, rv);
     }
 
-    rv = out->Write(kMethodEnd, sizeof(kMethodEnd) - 1, &count);
-    return rv;
+    return out->Write(")", 1, &count);
   }
 
   nsresult WriteParam(nsIOutputStream* out, nsIInterfaceInfo* aIInfo,
                       PRUint16 aMethodIndex, const nsXPTParamInfo* aParamInfo,
-                      PRUint8 aIndex)
+                      PRUint8 aIndex, MethodVariant aVariant)
   {
-    const nsXPTType &type = aParamInfo->GetType();
-    nsresult rv = WriteType(out, &type, aIInfo, aMethodIndex, aParamInfo);
+    PRUint32 count;
+    nsresult rv;
+    if (aVariant == kDirectMethod &&
+        IsDirectBufferParam(aIInfo, aMethodIndex, *aParamInfo)) {
+      rv = out->Write("ByteBuffer", 10, &count);
+    } else if (aVariant == kListMethod && aParamInfo->IsRetval()) {
+      rv = out->Write("List", 4, &count);
+    } else {
+      const nsXPTType &type = aParamInfo->GetType();
+      rv = WriteType(out, &type, aIInfo, aMethodIndex, aParamInfo);
+    }
     NS_ENSURE_SUCCESS(rv, rv);
 
     // if parameter is 'out' or 'inout', make it a Java array
-    PRUint32 count;
     if (aParamInfo->IsOut() && !aParamInfo->IsRetval()) {
       rv = out->Write("[]", 2, &count);
       NS_ENSURE_SUCCESS(rv, rv);
@@ -898,8 +1363,10 @@ public:
 void PrintUsage(char** argv)
 {
   static const char usage_str[] =
-      "Usage: %s -d path\n"
-      "         -d output directory for Java interface files\n";
+      "Usage: %s -d path [-b]\n"
+      "         -d output directory for Java interface files\n"
+      "         -b also write direct-binding classes to the \"bindings\"\n"
+      "            subdirectory of the output directory\n";
   fprintf(stderr, usage_str, argv[0]);
 }
 
@@ -907,6 +1374,7 @@ int main(int argc, char** argv)
 {
   nsresult rv = NS_OK;
   nsCOMPtr<nsIFile> output_dir;
+  PRBool write_bindings = PR_FALSE;
 
   // handle command line arguments
   for (int i = 1; i < argc; i++) {
@@ -939,6 +1407,10 @@ int main(int argc, char** argv)
         break;
       }
 
+      case 'b':
+        write_bindings = PR_TRUE;
+        break;
+
       default: {
         fprintf(stderr, "ERROR: unknown option %s\n", argv[i]);
         rv = NS_ERROR_FAILURE;
@@ -956,7 +1428,25 @@ int main(int argc, char** argv)
   NS_ENSURE_SUCCESS(rv, 1);
 
   {
-    Generate gen(output_dir);
+    // create the output directory for the binding classes
+    nsCOMPtr<nsIFile> bindings_dir;
+    if (write_bindings) {
+      rv = output_dir->Clone(getter_AddRefs(bindings_dir));
+      if (NS_SUCCEEDED(rv))
+        rv = bindings_dir->AppendNative(NS_LITERAL_CSTRING("bindings"));
+      bool exists = PR_FALSE;
+      if (NS_SUCCEEDED(rv))
+        bindings_dir->Exists(&exists);
+      if (NS_SUCCEEDED(rv) && !exists)
+        rv = bindings_dir->Create(nsIFile::DIRECTORY_TYPE, 0755);
+      if (NS_FAILED(rv)) {
+        fprintf(stderr, "ERROR: failed to create bindings directory\n");
+        NS_ShutdownXPCOM(nullptr);
+        return 1;
+      }
+    }
+
+    Generate gen(output_dir, bindings_dir);
     rv = gen.GenerateInterfaces();
   }
   